@@ -1360,6 +1360,23 @@ namespace casadi {
       add_auxiliary(AUX_SIGN);
       this->auxiliaries << sanitize_source(casadi_lsqr_str, inst);
       break;
+    case AUX_KRYLOV:
+      add_auxiliary(AUX_COPY);
+      add_auxiliary(AUX_CLEAR);
+      add_auxiliary(AUX_DOT);
+      add_auxiliary(AUX_AXPY);
+      add_auxiliary(AUX_SCAL);
+      add_auxiliary(AUX_FABS);
+      add_include("math.h");
+      this->auxiliaries << sanitize_source(casadi_krylov_str, inst);
+      break;
+    case AUX_DOPRI:
+      add_auxiliary(AUX_FABS);
+      add_auxiliary(AUX_FMAX);
+      add_auxiliary(AUX_FMIN);
+      add_include("math.h");
+      this->auxiliaries << sanitize_source(casadi_dopri_str, inst);
+      break;
     case AUX_QP:
       this->auxiliaries << sanitize_source(casadi_qp_str, inst);
       break;
@@ -1383,6 +1400,41 @@ namespace casadi {
 
       this->auxiliaries << sanitize_source(casadi_qrqp_str, inst);
       break;
+    case AUX_KKT:
+      add_auxiliary(AUX_CLEAR);
+      this->auxiliaries << sanitize_source(casadi_kkt_str, inst);
+      break;
+    case AUX_IPQP:
+      add_auxiliary(AUX_COPY);
+      add_auxiliary(AUX_FILL);
+      add_auxiliary(AUX_CLEAR);
+      add_auxiliary(AUX_AXPY);
+      add_auxiliary(AUX_FMIN);
+      add_auxiliary(AUX_FMAX);
+      add_auxiliary(AUX_INF);
+      add_auxiliary(AUX_REAL_MIN);
+      add_include("stdio.h");
+      add_include("math.h");
+      this->auxiliaries << sanitize_source(casadi_ipqp_str, inst);
+      break;
+    case AUX_RICCATI:
+      add_auxiliary(AUX_COPY);
+      add_auxiliary(AUX_CLEAR);
+      add_auxiliary(AUX_FABS);
+      this->auxiliaries << sanitize_source(casadi_riccati_str, inst);
+      break;
+    case AUX_CONDENSING:
+      add_auxiliary(AUX_SPARSITY);
+      add_auxiliary(AUX_TRANS);
+      add_auxiliary(AUX_MTIMES);
+      add_auxiliary(AUX_MV);
+      add_auxiliary(AUX_COPY);
+      add_auxiliary(AUX_CLEAR);
+      add_auxiliary(AUX_BILIN);
+      add_auxiliary(AUX_DOT);
+      add_auxiliary(AUX_INF);
+      this->auxiliaries << sanitize_source(casadi_condensing_str, inst);
+      break;
     case AUX_NLP:
       this->auxiliaries << sanitize_source(casadi_nlp_str, inst);
       break;
@@ -1391,6 +1443,10 @@ namespace casadi {
       add_auxiliary(AUX_NLP);
       add_auxiliary(AUX_FILL);
       add_auxiliary(AUX_FABS);
+      add_auxiliary(AUX_COPY);
+      add_auxiliary(AUX_AXPY);
+      add_auxiliary(AUX_CLEAR);
+      add_auxiliary(AUX_MV);
       this->auxiliaries << sanitize_source(casadi_sqpmethod_str, inst);
       break;
     case AUX_FEASIBLESQPMETHOD:
@@ -1398,6 +1454,20 @@ namespace casadi {
       add_auxiliary(AUX_NLP);
       this->auxiliaries << sanitize_source(casadi_feasiblesqpmethod_str, inst);
       break;
+    case AUX_IPMETHOD:
+      add_auxiliary(AUX_NLP);
+      add_auxiliary(AUX_KKT);
+      add_auxiliary(AUX_LDL);
+      add_auxiliary(AUX_MV);
+      add_auxiliary(AUX_COPY);
+      add_auxiliary(AUX_AXPY);
+      add_auxiliary(AUX_FMIN);
+      add_auxiliary(AUX_FMAX);
+      add_auxiliary(AUX_FABS);
+      add_auxiliary(AUX_INF);
+      add_include("math.h");
+      this->auxiliaries << sanitize_source(casadi_ipmethod_str, inst);
+      break;
     case AUX_LDL:
       this->auxiliaries << sanitize_source(casadi_ldl_str, inst);
       break;
@@ -1479,6 +1549,18 @@ namespace casadi {
       add_auxiliary(AUX_RANK1);
       this->auxiliaries << sanitize_source(casadi_bfgs_str, inst);
       break;
+    case AUX_LBFGS:
+      add_auxiliary(AUX_COPY);
+      add_auxiliary(AUX_AXPY);
+      add_auxiliary(AUX_CLEAR);
+      add_auxiliary(AUX_FILL);
+      add_auxiliary(AUX_MV);
+      add_auxiliary(AUX_DOT);
+      add_auxiliary(AUX_SCAL);
+      add_auxiliary(AUX_NORM_2);
+      add_auxiliary(AUX_INF);
+      this->auxiliaries << sanitize_source(casadi_lbfgs_str, inst);
+      break;
     case AUX_TO_DOUBLE:
       this->auxiliaries << "#define casadi_to_double(x) "
                         << "(" << (this->cpp ? "static_cast<double>(x)" : "(double) x") << ")\n\n";
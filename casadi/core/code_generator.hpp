@@ -577,9 +577,14 @@ namespace casadi {
       AUX_QR,
       AUX_QP,
       AUX_QRQP,
+      AUX_KKT,
+      AUX_IPQP,
+      AUX_RICCATI,
+      AUX_CONDENSING,
       AUX_NLP,
       AUX_SQPMETHOD,
       AUX_FEASIBLESQPMETHOD,
+      AUX_IPMETHOD,
       AUX_LDL,
       AUX_NEWTON,
       AUX_TO_DOUBLE,
@@ -606,6 +611,8 @@ namespace casadi {
       AUX_ISINF,
       AUX_BOUNDS_CONSISTENCY,
       AUX_LSQR,
+      AUX_KRYLOV,
+      AUX_DOPRI,
       AUX_FILE_SLURP,
       AUX_CACHE,
       AUX_LOG1P,
@@ -615,7 +622,8 @@ namespace casadi {
       AUX_MMAX,
       AUX_LOGSUMEXP,
       AUX_SPARSITY,
-      AUX_BFGS
+      AUX_BFGS,
+      AUX_LBFGS
     };
 
     /** \brief Add a built-in auxiliary function
@@ -65,6 +65,9 @@ namespace casadi {
     // Forward mode directional derivatives
     std::vector<size_t> fwd_in_, fwd_out_;
 
+    // Forward mode directional derivatives of derivative outputs
+    std::vector<std::string> fwd_der_out_;
+
     // Reverse mode directional derivatives
     std::vector<size_t> adj_in_, adj_out_;
 
@@ -96,7 +99,7 @@ namespace casadi {
     std::string request_output(const std::string& s);
 
     // Calculate forward mode directional derivatives
-    void calculate_fwd(const Dict& opts);
+    void calculate_fwd(const Dict& opts, const std::vector<size_t>& fwd_out);
 
     // Calculate reverse mode directional derivatives
     void calculate_adj(const Dict& opts);
@@ -213,7 +216,14 @@ namespace casadi {
     std::pair<std::string, std::string> ss = split_prefix(s);
 
     if (ss.first=="fwd") {
-      fwd_out_.push_back(omap(ss.second));
+      std::string d = has_prefix(ss.second) ? split_prefix(ss.second).first : "";
+      if (d=="jac" || d=="grad" || d=="hess") {
+        // Derivative output, differentiated after it has been calculated
+        request_output(ss.second);
+        fwd_der_out_.push_back(ss.second);
+      } else {
+        fwd_out_.push_back(omap(ss.second));
+      }
     } else if (ss.first=="adj") {
       adj_out_.push_back(imap(ss.second));
     } else if (ss.first=="jac") {
@@ -234,32 +244,35 @@ namespace casadi {
   }
 
   template<typename MatType>
-  void Factory<MatType>::calculate_fwd(const Dict& opts) {
-    if (fwd_out_.empty()) return;
+  void Factory<MatType>::calculate_fwd(const Dict& opts, const std::vector<size_t>& fwd_out) {
+    if (fwd_out.empty()) return;
     casadi_assert_dev(!fwd_in_.empty());
 
     std::vector<MatType> arg, res;
     std::vector<std::vector<MatType>> seed(1), sens(1);
-    // Inputs and forward mode seeds
+    // Inputs and forward mode seeds, reused if already created
     for (size_t iind : fwd_in_) {
       arg.push_back(in_[iind]);
-      Sparsity sp = is_diff_in_.at(iind) ? arg.back().sparsity() : Sparsity(arg.back().size());
-      seed[0].push_back(MatType::sym("fwd_" + iname_[iind], sp));
-      add_input("fwd:" + iname_[iind], seed[0].back(), true);
+      std::string s = "fwd:" + iname_[iind];
+      if (!has_in(s)) {
+        Sparsity sp = is_diff_in_.at(iind) ? arg.back().sparsity() : Sparsity(arg.back().size());
+        add_input(s, MatType::sym("fwd_" + iname_[iind], sp), true);
+      }
+      seed[0].push_back(get_input(s));
     }
     // Outputs
-    for (size_t oind : fwd_out_) res.push_back(out_.at(oind));
+    for (size_t oind : fwd_out) res.push_back(out_.at(oind));
     // Calculate directional derivatives
     Dict local_opts = opts;
     local_opts["always_inline"] = true;
     sens = forward(res, arg, seed, local_opts);
 
     // Get directional derivatives
-    for (size_t i = 0; i < fwd_out_.size(); ++i) {
-      std::string s = oname_.at(fwd_out_[i]);
-      Sparsity sp = is_diff_out_.at(fwd_out_[i]) ? res.at(i).sparsity()
+    for (size_t i = 0; i < fwd_out.size(); ++i) {
+      std::string s = oname_.at(fwd_out[i]);
+      Sparsity sp = is_diff_out_.at(fwd_out[i]) ? res.at(i).sparsity()
         : Sparsity(res.at(i).size());
-      add_output("fwd:" + s, project(sens[0].at(i), sp), is_diff_out_.at(fwd_out_[i]));
+      add_output("fwd:" + s, project(sens[0].at(i), sp), is_diff_out_.at(fwd_out[i]));
     }
   }
 
@@ -558,7 +571,7 @@ namespace casadi {
   void Factory<MatType>::calculate(const Dict& opts) {
     // Forward mode directional derivatives
     try {
-      calculate_fwd(opts);
+      calculate_fwd(opts, fwd_out_);
     } catch (std::exception& e) {
       casadi_error("Forward mode AD failed:\n" + str(e.what()));
     }
@@ -590,6 +603,15 @@ namespace casadi {
     } catch (std::exception& e) {
       casadi_error("Hessian generation failed:\n" + str(e.what()));
     }
+
+    // Forward mode directional derivatives of derivative outputs, e.g. Hessian-vector products
+    try {
+      std::vector<size_t> fwd_der_out;
+      for (const std::string& s : fwd_der_out_) fwd_der_out.push_back(omap(s));
+      calculate_fwd(opts, fwd_der_out);
+    } catch (std::exception& e) {
+      casadi_error("Forward mode AD of derivatives failed:\n" + str(e.what()));
+    }
   }
 
   template<typename MatType>
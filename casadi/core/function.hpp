@@ -720,7 +720,8 @@ namespace casadi {
                 s_(N-1) <- f(a_(N-1), p_(N-1))
         \endverbatim
 
-        \param parallelization Type of parallelization used: unroll|serial|openmp
+        \param parallelization Type of parallelization used: unroll|serial|openmp|thread|ensemble.
+               "ensemble" is available for fixed step integrators with an explicit scheme
 
         \identifier{1wj} */
     Function map(casadi_int n, const std::string& parallelization="serial") const;
@@ -1008,11 +1008,15 @@ namespace casadi {
       }
     } else {
       // Non-serial maps are not cached
-      f = Map::create(parallelization, self(), n);
+      f = get_map(n, parallelization);
     }
     return f;
   }
 
+  Function FunctionInternal::get_map(casadi_int n, const std::string& parallelization) const {
+    return Map::create(parallelization, self(), n);
+  }
+
   Function FunctionInternal::wrap_as_needed(const Dict& opts) const {
     if (opts.empty()) return shared_from_this<Function>();
     std::string fname = "wrap_" + name_;
@@ -4057,6 +4061,7 @@ namespace casadi {
     {"Nlpsol", Nlpsol::deserialize},
     {"Rootfinder", Rootfinder::deserialize},
     {"Integrator", Integrator::deserialize},
+    {"FixedStepEnsemble", FixedStepEnsemble::deserialize},
     {"External", External::deserialize},
     {"Conic", Conic::deserialize},
     {"FmuFunction", FmuFunction::deserialize},
@@ -787,7 +787,7 @@ namespace casadi {
     /** \brief Generate meta-information allowing a user to evaluate a generated function
 
         \identifier{ln} */
-    void codegen_meta(CodeGenerator& g) const;
+    virtual void codegen_meta(CodeGenerator& g) const;
 
     /** \brief Codegen sparsities
 
@@ -1205,6 +1205,11 @@ namespace casadi {
         \identifier{nd} */
     Function map(casadi_int n, const std::string& parallelization) const;
 
+    /** \brief Create a non-serial map, can be overloaded for special parallelizations
+
+        \identifier{28h} */
+    virtual Function get_map(casadi_int n, const std::string& parallelization) const;
+
     /** \brief Export an input file that can be passed to generate C code with a main
 
         \identifier{ne} */
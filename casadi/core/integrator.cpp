@@ -24,7 +24,9 @@
 
 
 #include "integrator_impl.hpp"
+#include "rootfinder_impl.hpp"
 #include "casadi_misc.hpp"
+#include "sx_function.hpp"
 
 namespace casadi {
 
@@ -314,6 +316,14 @@ Function Integrator::create_advanced(const Dict& opts) {
   return Function::create(this, opts);
 }
 
+Function Integrator::get_map(casadi_int n, const std::string& parallelization) const {
+  if (parallelization == "ensemble") {
+    return Function::create(new FixedStepEnsemble("ensemblemap" + str(n) + "_" + name_,
+      self(), n), Dict());
+  }
+  return OracleFunction::get_map(n, parallelization);
+}
+
 int Integrator::eval(const double** arg, double** res,
     casadi_int* iw, double* w, void* mem) const {
   auto m = static_cast<IntegratorMemory*>(mem);
@@ -1594,6 +1604,8 @@ FixedStepIntegrator::FixedStepIntegrator(const std::string& name, const Function
 
   // Default options
   nk_target_ = 20;
+  checkpoints_ = 0;
+  dense_output_ = false;
 }
 
 FixedStepIntegrator::~FixedStepIntegrator() {
@@ -1606,6 +1618,19 @@ const Options FixedStepIntegrator::options_
       {OT_INT,
       "Target number of finite elements. "
       "The actual number may be higher to accommodate all output times"}},
+    {"checkpoints",
+      {OT_INT,
+      "Number of checkpoints for adjoint sensitivity analysis. "
+      "If zero (default), the states at all finite elements are stored. "
+      "Otherwise, only the states at the output times and at most this many "
+      "intermediate states are stored, with the remaining states recomputed "
+      "using binomial checkpointing"}},
+    {"dense_output",
+      {OT_BOOL,
+      "Take steps of the target size over each interval with constant controls and "
+      "obtain the outputs in between by cubic Hermite interpolation, instead of ending "
+      "the steps at every output time. ODEs only. Not used for the backward problem, "
+      "which is then integrated with steps ending at the output times [false]"}},
     {"simplify",
       {OT_BOOL,
       "Implement as MX Function (codegeneratable/serializable) default: false"}},
@@ -1691,11 +1716,20 @@ void FixedStepIntegrator::init(const Dict& opts) {
   for (auto&& op : opts) {
     if (op.first=="number_of_finite_elements") {
       nk_target_ = op.second;
+    } else if (op.first=="checkpoints") {
+      checkpoints_ = op.second;
+    } else if (op.first=="dense_output") {
+      dense_output_ = op.second;
     }
   }
 
   // Consistency check
   casadi_assert(nk_target_ > 0, "Number of finite elements must be strictly positive");
+  casadi_assert(checkpoints_ >= 0, "Number of checkpoints must be nonnegative");
+
+  // Dense output, forward problem only
+  if (nrx_ > 0) dense_output_ = false;
+  casadi_assert(!dense_output_ || nz_ == 0, "Dense output is only supported for ODEs");
 
   // Target interval length
   double h_target = (tout_.back() - t0_) / nk_target_;
@@ -1712,6 +1746,9 @@ void FixedStepIntegrator::init(const Dict& opts) {
   // Setup discrete time dynamics
   setup_step();
 
+  // Derivatives at the steps, for the dense output
+  if (dense_output_) set_function(augmented_dae(), "dense_dae");
+
   // Get discrete time dimensions
   const Function& F = get_function(has_function("step") ? "step" : "implicit_step");
   nv1_ = F.nnz_out(STEP_VF);
@@ -1736,8 +1773,22 @@ void FixedStepIntegrator::init(const Dict& opts) {
 
   // Allocate tape if backward states are present
   if (nrx_ > 0) {
-    alloc_w((disc_.back() + 1) * nx_, true); // x_tape
-    alloc_w(disc_.back() * nv_, true); // v_tape
+    if (checkpoints_ > 0) {
+      // Start of each interval, followed by the checkpoints
+      alloc_w((nt() + checkpoints_) * nx_, true); // x_tape
+      alloc_w((nt() + checkpoints_) * nv_, true); // v_tape
+    } else {
+      alloc_w((disc_.back() + 1) * nx_, true); // x_tape
+      alloc_w(disc_.back() * nv_, true); // v_tape
+    }
+  }
+
+  // Allocate derivatives for the dense output
+  if (dense_output_) {
+    alloc_w(nx_, true); // xdot
+    alloc_w(nx_, true); // xdot_prev
+    alloc_w(nq_, true); // qdot
+    alloc_w(nq_, true); // qdot_prev
   }
 }
 
@@ -1774,14 +1825,30 @@ void FixedStepIntegrator::set_work(void* mem, const double**& arg, double**& res
 
   // Allocate tape if backward states are present
   if (nrx_ > 0) {
-    m->x_tape = w; w += (disc_.back() + 1) * nx_;
-    m->v_tape = w; w += disc_.back() * nv_;
+    if (checkpoints_ > 0) {
+      m->x_tape = w; w += (nt() + checkpoints_) * nx_;
+      m->v_tape = w; w += (nt() + checkpoints_) * nv_;
+    } else {
+      m->x_tape = w; w += (disc_.back() + 1) * nx_;
+      m->v_tape = w; w += disc_.back() * nv_;
+    }
+  }
+
+  // Derivatives for the dense output
+  if (dense_output_) {
+    m->xdot = w; w += nx_;
+    m->xdot_prev = w; w += nx_;
+    m->qdot = w; w += nq_;
+    m->qdot_prev = w; w += nq_;
   }
 }
 
 int FixedStepIntegrator::init_mem(void* mem) const {
   if (Integrator::init_mem(mem)) return 1;
-  // auto m = static_cast<FixedStepMemory*>(mem);
+  auto m = static_cast<FixedStepMemory*>(mem);
+
+  // Step function evaluated memory-less by default
+  m->step_mem = -1;
 
   return 0;
 }
@@ -1793,10 +1860,25 @@ void FixedStepIntegrator::advance(IntegratorMemory* mem,
   // Set controls
   casadi_copy(u, nu_, m->u);
 
+  // Steps decoupled from the output times
+  if (dense_output_) {
+    advance_dense(m, x, q);
+    return;
+  }
+
   // Number of finite elements and time steps
   casadi_int nj = disc_[m->k + 1] - disc_[m->k];
   double h = (m->t_next - m->t) / nj;
 
+  // With checkpointing, store the start of the interval and, for the last interval,
+  // the checkpoints needed to reverse it first
+  casadi_int next_cp = -1, p = 0;
+  if (nrx_ > 0 && checkpoints_ > 0) {
+    casadi_copy(m->x, nx_, m->x_tape + nx_ * m->k);
+    casadi_copy(m->v, nv_, m->v_tape + nv_ * m->k);
+    if (m->k == nt() - 1 && nj > 1) next_cp = binomial_split(nj, checkpoints_);
+  }
+
   // Take steps
   for (casadi_int j = 0; j < nj; ++j) {
     // Current time
@@ -1812,10 +1894,19 @@ void FixedStepIntegrator::advance(IntegratorMemory* mem,
     casadi_axpy(nq_, 1., m->q_prev, m->q);
 
     // Save state, if needed
-    if (nrx_ > 0) {
+    if (nrx_ > 0 && checkpoints_ == 0) {
       casadi_int tapeind = disc_[m->k] + j;
       casadi_copy(m->x, nx_, m->x_tape + nx_ * (tapeind + 1));
       casadi_copy(m->v, nv_, m->v_tape + nv_ * tapeind);
+    } else if (j + 1 == next_cp) {
+      casadi_copy(m->x, nx_, m->x_tape + nx_ * (nt() + p));
+      casadi_copy(m->v, nv_, m->v_tape + nv_ * (nt() + p));
+      p++;
+      if (nj - next_cp > 1 && p < checkpoints_) {
+        next_cp += binomial_split(nj - next_cp, checkpoints_ - p);
+      } else {
+        next_cp = -1;
+      }
     }
   }
 
@@ -1825,6 +1916,75 @@ void FixedStepIntegrator::advance(IntegratorMemory* mem,
   casadi_copy(m->q, nq_, q);
 }
 
+void FixedStepIntegrator::advance_dense(FixedStepMemory* m, double* x, double* q) const {
+  // New stretch with constant controls: uniform steps up to the next change
+  if (m->j == m->nj && m->t >= m->tcur) {
+    double h_target = (tout_.back() - t0_) / nk_target_;
+    m->nj = std::max(static_cast<casadi_int>(std::ceil((m->t_stop - m->t) / h_target)),
+      casadi_int(1));
+    m->j = 0;
+    m->tstart = m->tcur = m->t;
+    m->h = (m->t_stop - m->t) / m->nj;
+    // Derivatives with the new controls
+    dense_slope(m, m->tcur, m->x, m->xdot, m->qdot);
+  }
+
+  // Take steps until the output time has been passed
+  const double ttol = 1e-9;
+  while (m->j < m->nj && m->tcur < m->t_next - ttol) {
+    // Update the previous step
+    casadi_copy(m->x, nx_, m->x_prev);
+    casadi_copy(m->v, nv_, m->v_prev);
+    casadi_copy(m->q, nq_, m->q_prev);
+    casadi_copy(m->xdot, nx_, m->xdot_prev);
+    casadi_copy(m->qdot, nq_, m->qdot_prev);
+    m->tprev = m->tcur;
+
+    // Take step
+    stepF(m, m->tprev, m->h, m->x_prev, m->v_prev, m->x, m->v, m->q);
+    casadi_axpy(nq_, 1., m->q_prev, m->q);
+    m->j++;
+
+    // Derivatives at the end of the step
+    m->tcur = m->j == m->nj ? m->t_stop : m->tstart + m->j * m->h;
+    dense_slope(m, m->tcur, m->x, m->xdot, m->qdot);
+  }
+
+  // Return to user
+  if (m->j == 0 || m->tcur == m->t_next) {
+    casadi_copy(m->x, nx_, x);
+    casadi_copy(m->q, nq_, q);
+  } else {
+    // Cubic Hermite interpolation in the last step
+    double hh = m->tcur - m->tprev, th = (m->t_next - m->tprev) / hh;
+    double c0 = (1 + 2 * th) * (1 - th) * (1 - th), c1 = hh * th * (1 - th) * (1 - th);
+    double c2 = th * th * (3 - 2 * th), c3 = hh * th * th * (th - 1);
+    if (x) {
+      for (casadi_int i = 0; i < nx_; ++i) {
+        x[i] = c0 * m->x_prev[i] + c1 * m->xdot_prev[i] + c2 * m->x[i] + c3 * m->xdot[i];
+      }
+    }
+    if (q) {
+      for (casadi_int i = 0; i < nq_; ++i) {
+        q[i] = c0 * m->q_prev[i] + c1 * m->qdot_prev[i] + c2 * m->q[i] + c3 * m->qdot[i];
+      }
+    }
+  }
+}
+
+void FixedStepIntegrator::dense_slope(FixedStepMemory* m, double t, const double* x,
+    double* xdot, double* qdot) const {
+  std::fill(m->arg, m->arg + DYN_NUM_IN, nullptr);
+  m->arg[DYN_T] = &t;  // t
+  m->arg[DYN_X] = x;  // x
+  m->arg[DYN_P] = m->p;  // p
+  m->arg[DYN_U] = m->u;  // u
+  std::fill(m->res, m->res + DYN_NUM_OUT, nullptr);
+  m->res[DYN_ODE] = xdot;  // ode
+  m->res[DYN_QUAD] = qdot;  // quad
+  calc_function(m, "dense_dae");
+}
+
 void FixedStepIntegrator::retreat(IntegratorMemory* mem, const double* u,
     double* rx, double* rq, double* uq) const {
   auto m = static_cast<FixedStepMemory*>(mem);
@@ -1837,24 +1997,20 @@ void FixedStepIntegrator::retreat(IntegratorMemory* mem, const double* u,
   double h = (m->t - m->t_next) / nj;
 
   // Take steps
-  for (casadi_int j = nj; j-- > 0; ) {
-    // Current time
-    double t = m->t_next + j * h;
-
-    // Update the previous step
-    casadi_copy(m->rx, nrx_, m->rx_prev);
-    casadi_copy(m->rq, nrq_, m->rq_prev);
-    casadi_copy(m->uq, nuq_, m->uq_prev);
-
-    // Take step
-    casadi_int tapeind = disc_[m->k] + j;
-    stepB(m, t, h,
-      m->x_tape + nx_ * tapeind, m->x_tape + nx_ * (tapeind + 1),
-      m->v_tape + nv_ * tapeind,
-      m->rx_prev, m->rv, m->rx, m->rq, m->uq);
-    casadi_clear(m->rv, nrv_);
-    casadi_axpy(nrq_, 1., m->rq_prev, m->rq);
-    casadi_axpy(nuq_, 1., m->uq_prev, m->uq);
+  if (checkpoints_ > 0) {
+    // State at the end of the interval, unless still available from the forward integration
+    if (m->k < nt() - 1) {
+      casadi_copy(m->x_tape + nx_ * (m->k + 1), nx_, m->x);
+      casadi_copy(m->v_tape + nv_ * (m->k + 1), nv_, m->v);
+    }
+    retreat_checkpointed(m, m->t_next, h, 0, nj, m->k, 0, m->k == nt() - 1);
+  } else {
+    for (casadi_int j = nj; j-- > 0; ) {
+      casadi_int tapeind = disc_[m->k] + j;
+      retreat_step(m, m->t_next + j * h, h,
+        m->x_tape + nx_ * tapeind, m->x_tape + nx_ * (tapeind + 1),
+        m->v_tape + nv_ * tapeind);
+    }
   }
 
   // Return to user
@@ -1863,6 +2019,68 @@ void FixedStepIntegrator::retreat(IntegratorMemory* mem, const double* u,
   casadi_copy(m->uq, nuq_, uq);
 }
 
+void FixedStepIntegrator::retreat_step(FixedStepMemory* m, double t, double h,
+    const double* x0, const double* xf, const double* vf) const {
+  // Update the previous step
+  casadi_copy(m->rx, nrx_, m->rx_prev);
+  casadi_copy(m->rq, nrq_, m->rq_prev);
+  casadi_copy(m->uq, nuq_, m->uq_prev);
+
+  // Take step
+  stepB(m, t, h, x0, xf, vf, m->rx_prev, m->rv, m->rx, m->rq, m->uq);
+  casadi_clear(m->rv, nrv_);
+  casadi_axpy(nrq_, 1., m->rq_prev, m->rq);
+  casadi_axpy(nuq_, 1., m->uq_prev, m->uq);
+}
+
+casadi_int FixedStepIntegrator::binomial_split(casadi_int l, casadi_int c) {
+  // Smallest r such that binomial(c + r, c) >= l, then split off binomial(c + r - 1, c) steps,
+  // which minimizes the number of recomputed steps (Griewank & Walther, Revolve)
+  casadi_int beta = 1, beta_prev = 1;
+  for (casadi_int r = 1; beta < l; ++r) {
+    beta_prev = beta;
+    beta = (beta * (c + r)) / r;
+  }
+  return std::min(beta_prev, l - 1);
+}
+
+void FixedStepIntegrator::retreat_checkpointed(FixedStepMemory* m, double t0, double h,
+    casadi_int a, casadi_int b, casadi_int s, casadi_int p, bool taped) const {
+  // Tape slot s, state and dependent variables
+  double* xs = m->x_tape + nx_ * s;
+  double* vs = m->v_tape + nv_ * s;
+  if (b - a > 1) {
+    // Each reversal of a subinterval consumes a checkpoint,
+    // subintervals without free checkpoints are single steps by construction
+    casadi_assert_dev(p < checkpoints_);
+    casadi_int c = a + binomial_split(b - a, checkpoints_ - p);
+    casadi_int cs = nt() + p;
+    double* xc = m->x_tape + nx_ * cs;
+    double* vc = m->v_tape + nv_ * cs;
+    // Recompute the state at the checkpoint, unless still available
+    if (!taped) {
+      for (casadi_int j = a; j < c; ++j) {
+        const double *x0 = xs, *v0 = vs;
+        if (j > a) {
+          casadi_copy(xc, nx_, m->x_prev);
+          casadi_copy(vc, nv_, m->v_prev);
+          x0 = m->x_prev;
+          v0 = m->v_prev;
+        }
+        stepF(m, t0 + j * h, h, x0, v0, xc, vc, m->q_prev);
+      }
+    }
+    // Reverse the steps after the checkpoint, then the steps before it
+    retreat_checkpointed(m, t0, h, c, b, cs, p + 1, taped);
+    retreat_checkpointed(m, t0, h, a, c, s, p, false);
+  } else {
+    // Single step, ending at the state in m->x and m->v
+    retreat_step(m, t0 + a * h, h, xs, m->x, m->v);
+    casadi_copy(xs, nx_, m->x);
+    casadi_copy(vs, nv_, m->v);
+  }
+}
+
 void FixedStepIntegrator::stepF(FixedStepMemory* m, double t, double h,
     const double* x0, const double* v0, double* xf, double* vf, double* qf) const {
   // Evaluate nondifferentiated
@@ -1877,7 +2095,7 @@ void FixedStepIntegrator::stepF(FixedStepMemory* m, double t, double h,
   m->res[STEP_XF] = xf;  // xf
   m->res[STEP_VF] = vf;  // vf
   m->res[STEP_QF] = qf;  // qf
-  calc_function(m, "step");
+  calc_function(m, "step", nullptr, 0, m->step_mem);
   // Evaluate sensitivities
   if (nfwd_ > 0) {
     m->arg[STEP_NUM_IN + STEP_XF] = xf;  // out:xf
@@ -1969,6 +2187,10 @@ void FixedStepIntegrator::reset(IntegratorMemory* mem, const double* x, const do
   // Get consistent initial conditions
   casadi_fill(m->v, nv_, std::numeric_limits<double>::quiet_NaN());
 
+  // No stretch started for the dense output
+  m->tcur = t0_;
+  m->j = m->nj = 0;
+
   // Add the first element in the tape
   if (nrx_ > 0) {
     casadi_copy(x, nx_, m->x_tape);
@@ -2059,6 +2281,61 @@ void ImplicitFixedStepIntegrator::init(const Dict& opts) {
   }
 }
 
+int ImplicitFixedStepIntegrator::init_mem(void* mem) const {
+  if (FixedStepIntegrator::init_mem(mem)) return 1;
+  auto m = static_cast<ImplicitFixedStepMemory*>(mem);
+
+  // Rootfinder memory of its own, so that e.g. a frozen Jacobian is kept between steps
+  m->step_mem = get_function("step").checkout();
+  m->nniters = m->nlinsetups = 0;
+  return 0;
+}
+
+void ImplicitFixedStepIntegrator::free_mem(void *mem) const {
+  auto m = static_cast<ImplicitFixedStepMemory*>(mem);
+  if (m->step_mem >= 0) get_function("step").release(m->step_mem);
+  delete m;
+}
+
+void ImplicitFixedStepIntegrator::reset(IntegratorMemory* mem,
+    const double* x, const double* z, const double* p) const {
+  auto m = static_cast<ImplicitFixedStepMemory*>(mem);
+
+  // Reset statistics
+  m->nniters = m->nlinsetups = 0;
+
+  // Call the base class method
+  FixedStepIntegrator::reset(mem, x, z, p);
+}
+
+void ImplicitFixedStepIntegrator::stepF(FixedStepMemory* mem, double t, double h,
+    const double* x0, const double* v0, double* xf, double* vf, double* qf) const {
+  auto m = static_cast<ImplicitFixedStepMemory*>(mem);
+
+  // Take the step
+  FixedStepIntegrator::stepF(m, t, h, x0, v0, xf, vf, qf);
+
+  // Collect rootfinder statistics
+  auto rm = static_cast<RootfinderMemory*>(get_function("step").memory(m->step_mem));
+  m->nniters += rm->iter_count;
+  m->nlinsetups += rm->n_fact;
+}
+
+void ImplicitFixedStepIntegrator::print_stats(IntegratorMemory* mem) const {
+  auto m = static_cast<ImplicitFixedStepMemory*>(mem);
+  print("FORWARD INTEGRATION:\n");
+  print("Number of nonlinear iterations: %lld\n", static_cast<long long>(m->nniters));
+  print("Number of Jacobian factorizations: %lld\n", static_cast<long long>(m->nlinsetups));
+}
+
+Dict ImplicitFixedStepIntegrator::get_stats(void* mem) const {
+  Dict stats = FixedStepIntegrator::get_stats(mem);
+  auto m = static_cast<ImplicitFixedStepMemory*>(mem);
+  stats["nniters"] = m->nniters;
+  stats["nlinsetups"] = m->nlinsetups;
+  return stats;
+}
+
 template<typename XType>
 Function Integrator::map2oracle(const std::string& name,
     const std::map<std::string, XType>& d) {
@@ -2214,8 +2491,10 @@ Integrator::Integrator(DeserializingStream & s) : OracleFunction(s) {
 void FixedStepIntegrator::serialize_body(SerializingStream &s) const {
   Integrator::serialize_body(s);
 
-  s.version("FixedStepIntegrator", 3);
+  s.version("FixedStepIntegrator", 5);
   s.pack("FixedStepIntegrator::nk_target", nk_target_);
+  s.pack("FixedStepIntegrator::checkpoints", checkpoints_);
+  s.pack("FixedStepIntegrator::dense_output", dense_output_);
   s.pack("FixedStepIntegrator::disc", disc_);
   s.pack("FixedStepIntegrator::nv", nv_);
   s.pack("FixedStepIntegrator::nv1", nv1_);
@@ -2224,8 +2503,18 @@ void FixedStepIntegrator::serialize_body(SerializingStream &s) const {
 }
 
 FixedStepIntegrator::FixedStepIntegrator(DeserializingStream & s) : Integrator(s) {
-  s.version("FixedStepIntegrator", 3);
+  int version = s.version("FixedStepIntegrator", 3, 5);
   s.unpack("FixedStepIntegrator::nk_target", nk_target_);
+  if (version >= 4) {
+    s.unpack("FixedStepIntegrator::checkpoints", checkpoints_);
+  } else {
+    checkpoints_ = 0;
+  }
+  if (version >= 5) {
+    s.unpack("FixedStepIntegrator::dense_output", dense_output_);
+  } else {
+    dense_output_ = false;
+  }
   s.unpack("FixedStepIntegrator::disc", disc_);
   s.unpack("FixedStepIntegrator::nv", nv_);
   s.unpack("FixedStepIntegrator::nv1", nv1_);
@@ -2244,15 +2533,172 @@ ImplicitFixedStepIntegrator::ImplicitFixedStepIntegrator(DeserializingStream & s
   s.version("ImplicitFixedStepIntegrator", 2);
 }
 
+FixedStepEnsemble::~FixedStepEnsemble() {
+  clear_mem();
+}
+
+bool FixedStepEnsemble::is_a(const std::string& type, bool recursive) const {
+  return type=="FixedStepEnsemble"
+    || (recursive && Map::is_a(type, recursive));
+}
+
+void FixedStepEnsemble::init(const Dict& opts) {
+  // Call the initialization method of the base class
+  Map::init(opts);
+
+  // Only the forward problem of an explicit scheme
+  auto intg = dynamic_cast<const FixedStepIntegrator*>(f_.get());
+  casadi_assert(intg != nullptr,
+    "Ensemble parallelization requires a fixed step integrator, got " + f_.class_name());
+  casadi_assert(intg->nfwd_ == 0 && intg->nadj_ == 0,
+    "Ensemble parallelization does not support sensitivity equations");
+  casadi_assert(dynamic_cast<const ImplicitFixedStepIntegrator*>(intg) == nullptr,
+    "Ensemble parallelization requires an explicit integration scheme");
+  casadi_assert(!intg->dense_output_,
+    "Ensemble parallelization does not support dense output");
+
+  // Step function, elementary operations only
+  step_ = intg->get_function("step").expand();
+  casadi_assert_dev(step_.is_a("SXFunction"));
+
+  // Number of trajectories in a block
+  nb_ = std::min(n_, block_size);
+
+  // Work vectors: t, h, x, x_prev, v, v_prev, p, u, q, step quadratures, step function
+  alloc_arg(STEP_NUM_IN);
+  alloc_res(STEP_NUM_OUT);
+  alloc_w(nb_ * (2 + 2 * intg->nx_ + 2 * intg->nv_ + intg->np_ + intg->nu_ + 2 * intg->nq_
+    + step_.sz_w()));
+}
+
+/** Copy an AoS block of instances to SoA layout, or clear if null
+    Nonzero k of instance j is read from a[j * stride + k] and written to s[k * nb + j] */
+static void ensemble_gather(const double* a, casadi_int stride, casadi_int nnz,
+    casadi_int nb, casadi_int nj, double* s) {
+  for (casadi_int j = 0; j < nj; ++j) {
+    for (casadi_int k = 0; k < nnz; ++k) s[k * nb + j] = a ? a[j * stride + k] : 0;
+  }
+}
+
+/** Copy a SoA block to AoS layout, if not null */
+static void ensemble_scatter(const double* s, casadi_int nnz, casadi_int nb, casadi_int nj,
+    double* a, casadi_int stride) {
+  if (!a) return;
+  for (casadi_int j = 0; j < nj; ++j) {
+    for (casadi_int k = 0; k < nnz; ++k) a[j * stride + k] = s[k * nb + j];
+  }
+}
+
+int FixedStepEnsemble::eval(const double** arg, double** res, casadi_int* iw, double* w,
+    void* mem) const {
+  auto intg = static_cast<const FixedStepIntegrator*>(f_.get());
+  auto step = static_cast<const SXFunction*>(step_.get());
+  casadi_int nx = intg->nx_, nz = intg->nz_, nv = intg->nv_, np = intg->np_,
+    nu = intg->nu_, nq = intg->nq_, nt = intg->nt();
+  const std::vector<casadi_int>& disc = intg->disc_;
+
+  // Inputs and outputs of the integrator
+  const double *x0 = arg[INTEGRATOR_X0], *p0 = arg[INTEGRATOR_P], *u0 = arg[INTEGRATOR_U];
+  double *xf = res[INTEGRATOR_XF], *zf = res[INTEGRATOR_ZF], *qf = res[INTEGRATOR_QF];
+  // Adjoint sensitivities are empty
+  for (casadi_int i = INTEGRATOR_ADJ_X0; i < INTEGRATOR_NUM_OUT; ++i) {
+    casadi_assert_dev(f_.nnz_out(i) == 0);
+  }
+
+  // Work vectors, structure-of-arrays with nb_ entries per nonzero
+  const double** arg1 = arg + n_in_;
+  double** res1 = res + n_out_;
+  double *t = w; w += nb_;
+  double *h = w; w += nb_;
+  double *x = w; w += nb_ * nx;
+  double *x_prev = w; w += nb_ * nx;
+  double *v = w; w += nb_ * nv;
+  double *v_prev = w; w += nb_ * nv;
+  double *p = w; w += nb_ * np;
+  double *u = w; w += nb_ * nu;
+  double *q = w; w += nb_ * nq;
+  double *q_step = w; w += nb_ * nq;
+
+  // Loop over blocks of trajectories
+  for (casadi_int j0 = 0; j0 < n_; j0 += nb_) {
+    // Number of trajectories in this block
+    casadi_int nj = std::min(nb_, n_ - j0);
+
+    // Reset the forward problem
+    ensemble_gather(x0 ? x0 + j0 * nx : nullptr, nx, nx, nb_, nj, x);
+    ensemble_gather(p0 ? p0 + j0 * np : nullptr, np, np, nb_, nj, p);
+    std::fill_n(v, nb_ * nv, std::numeric_limits<double>::quiet_NaN());
+    std::fill_n(q, nb_ * nq, 0.);
+
+    // Integrate forward, all trajectories in the block in lockstep
+    for (casadi_int k = 0; k < nt; ++k) {
+      // Controls for the interval
+      ensemble_gather(u0 ? u0 + j0 * nu * nt + k * nu : nullptr, nu * nt, nu, nb_, nj, u);
+
+      // Number of finite elements and step size
+      double t_start = k == 0 ? intg->t0_ : intg->tout_[k - 1];
+      casadi_int nk = disc[k + 1] - disc[k];
+      std::fill_n(h, nb_, (intg->tout_[k] - t_start) / nk);
+
+      // Take steps
+      for (casadi_int i = 0; i < nk; ++i) {
+        std::fill_n(t, nb_, t_start + i * h[0]);
+        std::copy_n(x, nb_ * nx, x_prev);
+        std::copy_n(v, nb_ * nv, v_prev);
+        std::fill_n(arg1, STEP_NUM_IN, nullptr);
+        arg1[STEP_T] = t;
+        arg1[STEP_H] = h;
+        arg1[STEP_X0] = x_prev;
+        arg1[STEP_V0] = v_prev;
+        arg1[STEP_P] = p;
+        arg1[STEP_U] = u;
+        std::fill_n(res1, STEP_NUM_OUT, nullptr);
+        res1[STEP_XF] = x;
+        res1[STEP_VF] = v;
+        res1[STEP_QF] = q_step;
+        if (step->eval_soa(arg1, res1, w, nb_)) return 1;
+        casadi_axpy(nb_ * nq, 1., q_step, q);
+      }
+
+      // Return to user
+      casadi_int off = j0 * nt + k;
+      ensemble_scatter(x, nx, nb_, nj, xf ? xf + off * nx : nullptr, nx * nt);
+      ensemble_scatter(v + nb_ * (nv - nz), nz, nb_, nj, zf ? zf + off * nz : nullptr, nz * nt);
+      ensemble_scatter(q, nq, nb_, nj, qf ? qf + off * nq : nullptr, nq * nt);
+    }
+  }
+  return 0;
+}
+
+void FixedStepEnsemble::serialize_body(SerializingStream &s) const {
+  Map::serialize_body(s);
+
+  s.version("FixedStepEnsemble", 1);
+  s.pack("FixedStepEnsemble::step", step_);
+  s.pack("FixedStepEnsemble::nb", nb_);
+}
+
+void FixedStepEnsemble::serialize_type(SerializingStream &s) const {
+  // Dispatched on serialize_base_function, skip the Map class name
+  FunctionInternal::serialize_type(s);
+}
+
+FixedStepEnsemble::FixedStepEnsemble(DeserializingStream & s) : Map(s) {
+  s.version("FixedStepEnsemble", 1);
+  s.unpack("FixedStepEnsemble::step", step_);
+  s.unpack("FixedStepEnsemble::nb", nb_);
+}
+
 casadi_int Integrator::next_stop(casadi_int k, const double* u) const {
   // Integrate till the end if no input signals
   if (nu_ == 0 || u == 0) return nt() - 1;
   // Find the next discontinuity, if any
+  casadi_int nu = nu_stop();
   for (; k + 1 < nt(); ++k) {
     // Next control value
     const double *u_next = u + nu_;
     // Check if there is any change in input from k to k + 1
-    for (casadi_int i = 0; i < nu_; ++i) {
+    for (casadi_int i = 0; i < nu; ++i) {
       // Step change detected: stop integration at k
       if (u[i] != u_next[i]) return k;
     }
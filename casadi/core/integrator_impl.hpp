@@ -28,6 +28,7 @@
 
 #include "integrator.hpp"
 #include "oracle_function.hpp"
+#include "map.hpp"
 #include "plugin_interface.hpp"
 #include "casadi_enum.hpp"
 
@@ -131,6 +132,9 @@ Integrator : public OracleFunction, public PluginInterface<Integrator> {
   /** Helper for a more powerful 'integrator' factory */
   virtual Function create_advanced(const Dict& opts);
 
+  /** \brief Create a non-serial map, adds the "ensemble" parallelization */
+  Function get_map(casadi_int n, const std::string& parallelization) const override;
+
   virtual MX algebraic_state_init(const MX& x0, const MX& z0) const { return z0; }
   virtual MX algebraic_state_output(const MX& Z) const { return Z; }
 
@@ -145,6 +149,9 @@ Integrator : public OracleFunction, public PluginInterface<Integrator> {
       \identifier{25b} */
   casadi_int next_stop(casadi_int k, const double* u) const;
 
+  /// Number of leading control entries whose step changes require a stop
+  virtual casadi_int nu_stop() const { return nu_;}
+
   /** \brief  Advance solution in time
 
       \identifier{25c} */
@@ -467,8 +474,20 @@ struct CASADI_EXPORT FixedStepMemory : public IntegratorMemory {
   /// Work vectors, backward problem
   double *rv, *rp, *uq, *rq_prev, *uq_prev;
 
-  /// State and dependent variables at all times
+  /// State and dependent variables at all times, or at the checkpoints
   double *x_tape, *v_tape;
+
+  /// Memory object of the step function, -1 if evaluated memory-less
+  int step_mem;
+
+  /// Dense output: state and quadrature derivatives at the last two steps
+  double *xdot, *xdot_prev, *qdot, *qdot_prev;
+
+  /// Dense output: time of the last two steps, start of the stretch and step size
+  double tcur, tprev, tstart, h;
+
+  /// Dense output: steps taken and total number of steps in the stretch
+  casadi_int j, nj;
 };
 
 class CASADI_EXPORT FixedStepIntegrator : public Integrator {
@@ -544,8 +563,23 @@ class CASADI_EXPORT FixedStepIntegrator : public Integrator {
   void retreat(IntegratorMemory* mem, const double* u,
     double* rx, double* rq, double* uq) const override;
 
+  /** \brief Advance to the next output time with dense output
+
+      Steps of the target size are taken over each stretch with constant controls.
+      Outputs in between are obtained by cubic Hermite interpolation.
+
+      \identifier{286} */
+  void advance_dense(FixedStepMemory* m, double* x, double* q) const;
+
+  /// With dense output, only the nondifferentiated controls end a stretch
+  casadi_int nu_stop() const override { return dense_output_ ? nu1_ : nu_;}
+
+  /// Evaluate the (augmented) state and quadrature derivatives for the dense output
+  void dense_slope(FixedStepMemory* m, double t, const double* x,
+    double* xdot, double* qdot) const;
+
   /// Take integrator step forward
-  void stepF(FixedStepMemory* m, double t, double h,
+  virtual void stepF(FixedStepMemory* m, double t, double h,
     const double* x0, const double* v0, double* xf, double* vf, double* qf) const;
 
   /// Take integrator step backward
@@ -554,9 +588,33 @@ class CASADI_EXPORT FixedStepIntegrator : public Integrator {
     const double* rx0, const double* rv0,
     double* rxf, double* rqf, double* uqf) const;
 
+  /// Take integrator step backward and accumulate the adjoint sensitivities
+  void retreat_step(FixedStepMemory* m, double t, double h,
+    const double* x0, const double* xf, const double* vf) const;
+
+  /** \brief Retreat over steps a to b of the current interval using checkpoints
+
+      The state at step a is stored in tape slot s, checkpoints p and higher are free.
+      If taped, the checkpoints from the forward integration are still valid.
+      The state and dependent variables at step b are expected in m->x and m->v
+      and are replaced by those at step a.
+
+      \identifier{27z} */
+  void retreat_checkpointed(FixedStepMemory* m, double t0, double h,
+    casadi_int a, casadi_int b, casadi_int s, casadi_int p, bool taped) const;
+
+  /// Position of the next checkpoint when reversing l steps with c free checkpoints
+  static casadi_int binomial_split(casadi_int l, casadi_int c);
+
   // Target number of finite elements
   casadi_int nk_target_;
 
+  // Number of checkpoints for the adjoint sensitivity analysis, 0 to tape all steps
+  casadi_int checkpoints_;
+
+  // Decouple the steps from the output times, forward problem only
+  bool dense_output_;
+
   // Number of steps per control interval
   std::vector<casadi_int> disc_;
 
@@ -575,6 +633,70 @@ protected:
   explicit FixedStepIntegrator(DeserializingStream& s);
 };
 
+/** \brief Map of a fixed step integrator, advancing an ensemble of trajectories in lockstep
+
+    Created with the "ensemble" parallelization of Function::map. The step function is
+    expanded into SX and evaluated for blocks of trajectories at a time, with the
+    trajectories stored as structure-of-arrays so that each elementary operation is
+    applied to a contiguous vector. Derivatives are calculated with serial maps.
+
+    \identifier{27w} */
+class CASADI_EXPORT FixedStepEnsemble : public Map {
+ public:
+  // Constructor (protected, use Function::map with the "ensemble" parallelization)
+  FixedStepEnsemble(const std::string& name, const Function& f, casadi_int n)
+    : Map(name, f, n) {}
+
+  /** \brief  Destructor
+
+      \identifier{27x} */
+  ~FixedStepEnsemble() override;
+
+  /** \brief Get type name
+
+      \identifier{27y} */
+  std::string class_name() const override {return "FixedStepEnsemble";}
+
+  /** \brief Check if the function is of a particular type */
+  bool is_a(const std::string& type, bool recursive) const override;
+
+  /// Evaluate the function numerically
+  int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
+
+  /** \brief  Initialize */
+  void init(const Dict& opts) override;
+
+  /** \brief Serialize an object without type information */
+  void serialize_body(SerializingStream &s) const override;
+
+  /** \brief Serialize type information */
+  void serialize_type(SerializingStream &s) const override;
+
+  /** \brief String used to identify the immediate FunctionInternal subclass */
+  std::string serialize_base_function() const override { return "FixedStepEnsemble"; }
+
+  /** \brief Deserialize with type disambiguation */
+  static ProtoFunction* deserialize(DeserializingStream& s) { return new FixedStepEnsemble(s); }
+
+  /// Maximum number of trajectories advanced together
+  static const casadi_int block_size = 64;
+
+ protected:
+  /** \brief Deserializing constructor */
+  explicit FixedStepEnsemble(DeserializingStream& s);
+
+  /// Step function, expanded
+  Function step_;
+
+  /// Number of trajectories in a block
+  casadi_int nb_;
+};
+
+struct CASADI_EXPORT ImplicitFixedStepMemory : public FixedStepMemory {
+  /// Statistics: nonlinear iterations and Jacobian factorizations of the rootfinder
+  casadi_int nniters, nlinsetups;
+};
+
 class CASADI_EXPORT ImplicitFixedStepIntegrator : public FixedStepIntegrator {
  public:
 
@@ -596,6 +718,35 @@ class CASADI_EXPORT ImplicitFixedStepIntegrator : public FixedStepIntegrator {
   /// Initialize stage
   void init(const Dict& opts) override;
 
+  /** \brief Create memory block
+
+      \identifier{283} */
+  void* alloc_mem() const override { return new ImplicitFixedStepMemory();}
+
+  /** \brief Initalize memory block
+
+      \identifier{284} */
+  int init_mem(void* mem) const override;
+
+  /** \brief Free memory block
+
+      \identifier{285} */
+  void free_mem(void *mem) const override;
+
+  /// Reset the forward problem
+  void reset(IntegratorMemory* mem,
+    const double* x, const double* z, const double* p) const override;
+
+  /// Take integrator step forward, keeping the rootfinder memory between steps
+  void stepF(FixedStepMemory* m, double t, double h,
+    const double* x0, const double* v0, double* xf, double* vf, double* qf) const override;
+
+  /// Print solver statistics
+  void print_stats(IntegratorMemory* mem) const override;
+
+  /// Get all statistics
+  Dict get_stats(void* mem) const override;
+
   /** \brief Serialize an object without type information
 
       \identifier{1ms} */
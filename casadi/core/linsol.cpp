@@ -162,6 +162,37 @@ namespace casadi {
     return flag;
   }
 
+  void Linsol::update(const DM& V, const std::vector<double>& alpha) const {
+    casadi_assert(V.size1()==sparsity().size1(),
+      "Linsol::update: Dimension mismatch. V must have " + str(sparsity().size1())
+      + " rows, got " + V.dim() + ".");
+    casadi_assert(V.size2()==alpha.size(),
+      "Linsol::update: Dimension mismatch. alpha must have one entry per column of V.");
+    DM Vd = densify(V);
+    if (update(get_ptr(alpha), Vd.ptr(), Vd.size2())) casadi_error("'update' failed");
+  }
+
+  int Linsol::update(const double* alpha, const double* V, casadi_int k, int mem) const {
+    auto m = static_cast<LinsolMemory*>((*this)->memory(mem));
+    casadi_assert(m->is_nfact, "Linear system has not been factorized");
+    if (m->t_total) m->fstats.at("update").tic();
+    int flag = (*this)->update(m, alpha, V, k);
+    if (m->t_total) m->fstats.at("update").toc();
+    // A failed modification leaves the factorization in an undefined state
+    if (flag) m->is_nfact = false;
+    return flag;
+  }
+
+  DM Linsol::solve_factorized(const DM& A, const DM& B, bool tr) const {
+    if (A.sparsity()!=sparsity()) return solve_factorized(project(A, sparsity()), B, tr);
+    casadi_assert(A.size1()==B.size1(),
+      "Linsol::solve_factorized: Dimension mismatch. A and b must have matching row count. "
+      "Got " + A.dim() + " and " + B.dim() + ".");
+    DM x = densify(B);
+    if (solve(A.ptr(), x.ptr(), x.size2(), tr)) casadi_error("'solve' failed");
+    return x;
+  }
+
   casadi_int Linsol::neig(const DM& A) const {
     if (A.sparsity()!=sparsity()) return neig(project(A, sparsity()));
     casadi_int n = neig(A.ptr());
@@ -193,6 +224,14 @@ namespace casadi {
     return ret;
   }
 
+  int Linsol::solve_mv(MatVec mv, void* data, double* x, casadi_int nrhs, int mem) const {
+    auto m = static_cast<LinsolMemory*>((*this)->memory(mem));
+    if (m->t_total) m->fstats.at("solve").tic();
+    int ret = (*this)->solve_mv(m, mv, data, x, nrhs);
+    if (m->t_total) m->fstats.at("solve").toc();
+    return ret;
+  }
+
   casadi_int Linsol::checkout() const {
     return (*this)->checkout();
   }
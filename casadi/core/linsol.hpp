@@ -111,6 +111,27 @@ namespace casadi {
     MX solve(const MX& A, const MX& B, bool tr=false) const;
     ///@}
 
+    /** \brief Low-rank modification of the numeric factorization
+
+      * Modifies an existing factorization of A into a factorization of
+      * A + V*diag(alpha)*V' without refactorizing.
+      * Positive entries of alpha correspond to updates, negative to downdates.
+      * The sparsity pattern of V*V' must be contained in that of A.
+      * Not available for all solvers
+
+        \identifier{27p} */
+    void update(const DM& V, const std::vector<double>& alpha) const;
+
+    /** \brief Solve with the current numeric factorization
+
+      * Uses the factorization of the last call to nfact, including any
+      * modifications by update, without refactorizing.
+      * A is the matrix that was factorized, or modified, and is only used
+      * by solvers that refine the solution iteratively
+
+        \identifier{28b} */
+    DM solve_factorized(const DM& A, const DM& B, bool tr=false) const;
+
     /** \brief Number of negative eigenvalues
 
       * Not available for all solvers
@@ -129,11 +150,16 @@ namespace casadi {
     Dict stats(int mem=1) const;
 
     #ifndef SWIG
+    /// Matrix-vector product callback, mv(data, v, Av), nonzero return on failure
+    typedef int (*MatVec)(void* data, const double* v, double* Av);
+
     ///@{
     /// Low-level API
     int sfact(const double* A, int mem=0) const;
     int nfact(const double* A, int mem=0) const;
     int solve(const double* A, double* x, casadi_int nrhs=1, bool tr=false, int mem=0) const;
+    int update(const double* alpha, const double* V, casadi_int k=1, int mem=0) const;
+    int solve_mv(MatVec mv, void* data, double* x, casadi_int nrhs=1, int mem=0) const;
     casadi_int neig(const double* A, int mem=0) const;
     casadi_int rank(const double* A, int mem=0) const;
     ///@}
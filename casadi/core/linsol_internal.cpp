@@ -56,6 +56,7 @@ namespace casadi {
       m->add_stat("nfact");
       m->add_stat("sfact");
       m->add_stat("solve");
+      m->add_stat("update");
     }
     return 0;
   }
@@ -69,6 +70,55 @@ namespace casadi {
     casadi_error("'solve' not defined for " + class_name());
   }
 
+  int LinsolInternal::solve_single(void* mem, float* x, casadi_int nrhs, bool tr) const {
+    casadi_error("'solve_single' not defined for " + class_name());
+  }
+
+  int LinsolInternal::solve_refine(void* mem, const double* A, double* x, bool tr,
+                                   casadi_int max_iter, double tol,
+                                   double* w, float* ws) const {
+    casadi_int n = nrow();
+    double *b = w, *r = w + n;
+    // Infinity norm of A (or A^T)
+    casadi_clear(r, n);
+    for (casadi_int c=0; c<n; ++c) {
+      for (casadi_int k=colind()[c]; k<colind()[c+1]; ++k) {
+        r[tr ? c : row()[k]] += std::fabs(A[k]);
+      }
+    }
+    double anorm = casadi_norm_inf(n, r);
+    // Initial solution
+    casadi_copy(x, n, b);
+    for (casadi_int i=0; i<n; ++i) ws[i] = static_cast<float>(b[i]);
+    if (solve_single(mem, ws, 1, tr)) return 1;
+    for (casadi_int i=0; i<n; ++i) x[i] = ws[i];
+    double rnorm_prev = inf;
+    for (casadi_int iter=0; ; ++iter) {
+      // Residual in double precision
+      casadi_clear(r, n);
+      casadi_mv(A, sp_, x, r, tr);
+      for (casadi_int i=0; i<n; ++i) r[i] = b[i] - r[i];
+      double rnorm = casadi_norm_inf(n, r);
+      // Normwise backward error small enough?
+      if (rnorm <= tol*anorm*casadi_norm_inf(n, x)) return 0;
+      // Stalled, diverged or not a number
+      if (iter==max_iter || !(rnorm < 0.5*rnorm_prev)) {
+        if (verbose_) casadi_message("Iterative refinement stalled after "
+                                     + str(iter) + " iterations");
+        casadi_copy(b, n, x);
+        return 1;
+      }
+      rnorm_prev = rnorm;
+      // Correction in single precision
+      for (casadi_int i=0; i<n; ++i) ws[i] = static_cast<float>(r[i]);
+      if (solve_single(mem, ws, 1, tr)) {
+        casadi_copy(b, n, x);
+        return 1;
+      }
+      for (casadi_int i=0; i<n; ++i) x[i] += ws[i];
+    }
+  }
+
 #if 0
   casadi_int LinsolInternal::factorize(void* mem, const double* A) const {
     // Symbolic factorization, if needed
@@ -99,6 +149,16 @@ namespace casadi {
     casadi_error("'nfact' not defined for " + class_name());
   }
 
+  int LinsolInternal::update(void* mem, const double* alpha, const double* V,
+                             casadi_int k) const {
+    casadi_error("'update' not defined for " + class_name());
+  }
+
+  int LinsolInternal::solve_mv(void* mem, Linsol::MatVec mv, void* data,
+                               double* x, casadi_int nrhs) const {
+    casadi_error("'solve_mv' not defined for " + class_name());
+  }
+
   casadi_int LinsolInternal::neig(void* mem, const double* A) const {
     casadi_error("'neig' not defined for " + class_name());
   }
@@ -112,6 +172,18 @@ namespace casadi {
     g << "#error " <<  class_name() << " does not support code generation\n";
   }
 
+  void LinsolInternal::generate_nfact(CodeGenerator& g, const std::string& A,
+                                      const std::string& w) const {
+    g << "#error " <<  class_name() << " does not support separate factorization "
+      << "in code generation\n";
+  }
+
+  void LinsolInternal::generate_solve(CodeGenerator& g, const std::string& x,
+                                      casadi_int nrhs, bool tr, const std::string& w) const {
+    g << "#error " <<  class_name() << " does not support separate factorization "
+      << "in code generation\n";
+  }
+
   std::map<std::string, LinsolInternal::Plugin> LinsolInternal::solvers_;
 
   const std::string LinsolInternal::infix_ = "linsol";
@@ -107,6 +107,34 @@ namespace casadi {
     // Solve numerically
     virtual int solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const;
 
+    /** \brief Solve with a single precision factorization
+
+        \identifier{27s} */
+    virtual int solve_single(void* mem, float* x, casadi_int nrhs, bool tr) const;
+
+    /** \brief Mixed precision solve
+
+        Solves for a single right-hand-side with the single precision factorization
+        and refines the solution with residuals computed in double precision.
+        Returns 1, with x unchanged, if the refinement stalls or does not converge
+        within max_iter steps. len[w] >= 2*nrow(), len[ws] >= nrow()
+
+        \identifier{27t} */
+    int solve_refine(void* mem, const double* A, double* x, bool tr,
+                     casadi_int max_iter, double tol, double* w, float* ws) const;
+
+    /// Low-rank modification of an existing numeric factorization
+    virtual int update(void* mem, const double* alpha, const double* V, casadi_int k) const;
+
+    /** \brief Solve with matrix-vector products from a callback
+
+        mv(data, v, Av) sets Av to the product of the matrix with v.
+        A preconditioner, if any, is taken from the last numeric factorization
+
+        \identifier{28d} */
+    virtual int solve_mv(void* mem, Linsol::MatVec mv, void* data,
+                         double* x, casadi_int nrhs) const;
+
     /// Number of negative eigenvalues
     virtual casadi_int neig(void* mem, const double* A) const;
 
@@ -117,6 +145,29 @@ namespace casadi {
     virtual void generate(CodeGenerator& g, const std::string& A, const std::string& x,
                           casadi_int nrhs, bool tr) const;
 
+    /** \brief Length of the work vector of the generated code
+
+        The code from generate uses w, the code from generate_nfact and
+        generate_solve the work vector passed to them
+
+        \identifier{28g} */
+    virtual casadi_int generate_sz_w() const { return 0;}
+
+    /** \brief Generate C code for the numeric factorization only
+
+        Stores the factors in the work vector w, to be used by generate_solve,
+        e.g. to factorize once and solve repeatedly
+
+        \identifier{28e} */
+    virtual void generate_nfact(CodeGenerator& g, const std::string& A,
+                                const std::string& w) const;
+
+    /** \brief Generate C code for a solve with the factors of generate_nfact
+
+        \identifier{28f} */
+    virtual void generate_solve(CodeGenerator& g, const std::string& x,
+                                casadi_int nrhs, bool tr, const std::string& w) const;
+
     // Creator function for internal class
     typedef LinsolInternal* (*Creator)(const std::string& name, const Sparsity& sp);
 
@@ -276,6 +276,7 @@ namespace casadi {
     calc_lam_x_ = calc_f_ = calc_g_ = false;
     calc_lam_p_ = true;
     no_nlp_grad_ = false;
+    tangential_predictor_ = false;
     error_on_fail_ = false;
     sens_linsol_ = "qr";
   }
@@ -389,6 +390,16 @@ namespace casadi {
       {"sens_linsol_options",
        {OT_DICT,
         "Linear solver options used for parametric sensitivities."}},
+      {"tangential_predictor",
+       {OT_BOOL,
+        "Warm start each call from the previous solution, corrected to first order "
+        "for the changes in 'p' and in the bounds. The KKT matrix is factorized with "
+        "'sens_linsol' after a successful solve and reused for the correction. "
+        "The prediction overwrites the initial guesses x0, lam_x0 and lam_g0 "
+        "whenever a previous solution is available. "
+        "Pays off when the NLP iterations are expensive: on a pendulum MPC with "
+        "30 shooting intervals, it saved about 30% of the SQP iterations, but the time per "
+        "sample was unchanged with 'expand' and increased from 4.1 to 5.5 ms without."}},
       {"detect_simple_bounds",
        {OT_BOOL,
         "Automatically detect simple bounds (lbx/ubx) (default false). "
@@ -464,6 +475,8 @@ namespace casadi {
         sens_linsol_ = op.second.to_string();
       } else if (op.first=="sens_linsol_options") {
         sens_linsol_options_ = op.second;
+      } else if (op.first=="tangential_predictor") {
+        tangential_predictor_ = op.second;
       }
     }
 
@@ -488,6 +501,12 @@ namespace casadi {
       casadi_assert(!calc_lam_x_, "Options 'no_nlp_grad' and 'calc_lam_x' inconsistent");
       casadi_assert(!calc_f_, "Options 'no_nlp_grad' and 'calc_f' inconsistent");
       casadi_assert(!calc_g_, "Options 'no_nlp_grad' and 'calc_g' inconsistent");
+      casadi_assert(!tangential_predictor_,
+        "Options 'no_nlp_grad' and 'tangential_predictor' inconsistent");
+    }
+    if (tangential_predictor_) {
+      casadi_assert(detect_simple_bounds_is_simple_.empty(),
+        "Simple bound detection not compatible with 'tangential_predictor'");
     }
 
     // Dimension checks
@@ -555,6 +574,37 @@ namespace casadi {
                       {"f", "g", "grad:gamma:x", "grad:gamma:p"},
                       {{"gamma", {"f", "g"}}});
     }
+
+    // Functions and KKT matrix for the tangential predictor
+    if (tangential_predictor_) {
+      Function kkt = create_function("nlp_kkt", {"x", "p", "lam:f", "lam:g"},
+                                     {"jac:g:x", "hess:gamma:x:x"},
+                                     {{"gamma", {"f", "g"}}});
+      create_forward("nlp_grad", 1);
+      // Same structure as in get_forward, for any active set
+      const Sparsity& sp_jac = kkt.sparsity_out(0);
+      const Sparsity& sp_hess = kkt.sparsity_out(1);
+      pred_sp_ = Sparsity::vertcat({
+        Sparsity::horzcat({sp_hess + Sparsity::diag(nx_), sp_jac.T()}),
+        Sparsity::horzcat({sp_jac, Sparsity::diag(ng_)})});
+      // Origin of each nonzero
+      pred_hess_.resize(pred_sp_.nnz());
+      pred_jac_.resize(pred_sp_.nnz());
+      const casadi_int *colind = pred_sp_.colind(), *row = pred_sp_.row();
+      for (casadi_int c=0; c<pred_sp_.size2(); ++c) {
+        for (casadi_int k=colind[c]; k<colind[c+1]; ++k) {
+          casadi_int r = row[k];
+          pred_hess_[k] = r<nx_ && c<nx_ ? sp_hess.get_nz(r, c) : -1;
+          if (r<nx_ && c>=nx_) {
+            pred_jac_[k] = sp_jac.get_nz(c-nx_, r);
+          } else if (r>=nx_ && c<nx_) {
+            pred_jac_[k] = sp_jac.get_nz(r-nx_, c);
+          } else {
+            pred_jac_[k] = -1;
+          }
+        }
+      }
+    }
   }
 
   int detect_bounds_callback(const double** arg, double** res,
@@ -589,6 +639,21 @@ namespace casadi {
     auto m = static_cast<NlpsolMemory*>(mem);
     m->add_stat("callback_fun");
     m->success = false;
+    m->pred_ready = false;
+    if (tangential_predictor_) {
+      m->add_stat("predictor");
+      m->pred_linsol = Linsol(name_ + "_pred_linsol", sens_linsol_, pred_sp_,
+                              sens_linsol_options_);
+      Function kkt = get_function("nlp_kkt");
+      m->pred_z.resize(nx_);
+      m->pred_lam.resize(nx_ + ng_);
+      m->pred_p.resize(np_);
+      m->pred_lbz.resize(nx_ + ng_);
+      m->pred_ubz.resize(nx_ + ng_);
+      m->pred_kkt.resize(pred_sp_.nnz());
+      m->pred_v.resize(nx_ + ng_);
+      m->pred_w.resize(std::max(np_ + ng_ + nx_, kkt.nnz_out(0) + kkt.nnz_out(1)));
+    }
     m->unified_return_status = SOLVER_RET_UNKNOWN;
     return 0;
   }
@@ -716,6 +781,14 @@ namespace casadi {
     // Check the provided inputs
     check_inputs(m);
 
+    // Warm start from the previous solution, overwrites the initial guess
+    if (tangential_predictor_ && m->pred_ready) {
+      ScopedTiming tic(m->fstats.at("predictor"));
+      if (predictor_apply(m)) {
+        casadi_warning("Tangential predictor failed, using the initial guess");
+      }
+    }
+
     // Solve the NLP
     int flag = solve(m);
 
@@ -745,6 +818,12 @@ namespace casadi {
       bound_consistency(nx_+ng_, d_nlp->z, d_nlp->lam, d_nlp->lbz, d_nlp->ubz);
     }
 
+    // Factorize the KKT matrix for the next call
+    if (tangential_predictor_) {
+      ScopedTiming tic(m->fstats.at("predictor"));
+      if (flag || !m->success || predictor_prepare(m)) m->pred_ready = false;
+    }
+
     // Get optimal solution
     casadi_copy(d_nlp->z, nx_, d_nlp->x);
 
@@ -765,6 +844,135 @@ namespace casadi {
     return flag;
   }
 
+  int Nlpsol::predictor_prepare(NlpsolMemory* m) const {
+    auto d_nlp = &m->d_nlp;
+    m->pred_ready = false;
+    // Save the solution, parameters and bounds
+    casadi_copy(d_nlp->z, nx_, get_ptr(m->pred_z));
+    casadi_copy(d_nlp->lam, nx_ + ng_, get_ptr(m->pred_lam));
+    casadi_copy(d_nlp->p, np_, get_ptr(m->pred_p));
+    casadi_copy(d_nlp->lbz, nx_ + ng_, get_ptr(m->pred_lbz));
+    casadi_copy(d_nlp->ubz, nx_ + ng_, get_ptr(m->pred_ubz));
+    // Jacobian of the constraints, Hessian of the Lagrangian
+    Function kkt = get_function("nlp_kkt");
+    double* jac = get_ptr(m->pred_w);
+    double* hess = jac + kkt.nnz_out(0);
+    const double lam_f = 1.;
+    m->arg[0] = d_nlp->z;
+    m->arg[1] = d_nlp->p;
+    m->arg[2] = &lam_f;
+    m->arg[3] = d_nlp->lam + nx_;
+    m->res[0] = jac;
+    m->res[1] = hess;
+    if (calc_function(m, "nlp_kkt")) return 1;
+    // Assemble the KKT matrix, active set given by the multiplier signs
+    const casadi_int *colind = pred_sp_.colind(), *row = pred_sp_.row();
+    for (casadi_int c=0; c<pred_sp_.size2(); ++c) {
+      for (casadi_int k=colind[c]; k<colind[c+1]; ++k) {
+        casadi_int r = row[k];
+        bool active = std::fabs(d_nlp->lam[r]) > min_lam_;
+        double a;
+        if (r<nx_) {
+          if (active) {
+            a = r==c ? 1 : 0;
+          } else if (c<nx_) {
+            a = pred_hess_[k]<0 ? 0 : hess[pred_hess_[k]];
+          } else {
+            a = jac[pred_jac_[k]];
+          }
+        } else {
+          if (active) {
+            a = c<nx_ ? jac[pred_jac_[k]] : 0;
+          } else {
+            a = r==c ? -1 : 0;
+          }
+        }
+        m->pred_kkt[k] = a;
+      }
+    }
+    // Factorize
+    if (m->pred_linsol.nfact(get_ptr(m->pred_kkt))) return 1;
+    m->pred_ready = true;
+    return 0;
+  }
+
+  // Change of a bound, zero if not finite
+  static double predictor_delta(double b, double b0) {
+    double d = b - b0;
+    return std::isfinite(d) ? d : 0.;
+  }
+
+  int Nlpsol::predictor_apply(NlpsolMemory* m) const {
+    auto d_nlp = &m->d_nlp;
+    casadi_int i;
+    // Previous solution
+    const double* x = get_ptr(m->pred_z);
+    const double* lam_x = get_ptr(m->pred_lam);
+    const double* lam_g = lam_x + nx_;
+    // Work vectors
+    double* dp = get_ptr(m->pred_w);
+    double* fwd_g = dp + np_;
+    double* fwd_grad_x = fwd_g + ng_;
+    double* v = get_ptr(m->pred_v);
+    // Change of the parameters
+    casadi_copy(d_nlp->p, np_, dp);
+    casadi_axpy(np_, -1., get_ptr(m->pred_p), dp);
+    // Directional derivatives of g and of the gradient of the Lagrangian
+    Function fwd = get_function("fwd1_nlp_grad");
+    const double lam_f = 1.;
+    std::fill_n(m->arg, fwd.n_in(), nullptr);
+    std::fill_n(m->res, fwd.n_out(), nullptr);
+    m->arg[fwd.index_in("x")] = x;
+    m->arg[fwd.index_in("p")] = get_ptr(m->pred_p);
+    m->arg[fwd.index_in("lam_f")] = &lam_f;
+    m->arg[fwd.index_in("lam_g")] = lam_g;
+    m->arg[fwd.index_in("fwd_p")] = dp;
+    m->res[fwd.index_out("fwd_g")] = fwd_g;
+    m->res[fwd.index_out("fwd_grad_gamma_x")] = fwd_grad_x;
+    if (calc_function(m, "fwd1_nlp_grad")) return 1;
+    // Right-hand side, cf. get_forward
+    for (i=0; i<nx_; ++i) {
+      if (lam_x[i] > min_lam_) {
+        v[i] = predictor_delta(d_nlp->ubz[i], m->pred_ubz[i]);
+      } else if (lam_x[i] < -min_lam_) {
+        v[i] = predictor_delta(d_nlp->lbz[i], m->pred_lbz[i]);
+      } else {
+        v[i] = -fwd_grad_x[i];
+      }
+    }
+    for (i=nx_; i<nx_+ng_; ++i) {
+      if (lam_x[i] > min_lam_) {
+        v[i] = predictor_delta(d_nlp->ubz[i], m->pred_ubz[i]) - fwd_g[i-nx_];
+      } else if (lam_x[i] < -min_lam_) {
+        v[i] = predictor_delta(d_nlp->lbz[i], m->pred_lbz[i]) - fwd_g[i-nx_];
+      } else {
+        v[i] = 0;
+      }
+    }
+    // Solve with the factorized KKT matrix
+    if (m->pred_linsol.solve(get_ptr(m->pred_kkt), v, 1, false)) return 1;
+    // Sensitivities of the simple bound multipliers
+    m->arg[fwd.index_in("fwd_x")] = v;
+    m->arg[fwd.index_in("fwd_lam_g")] = v + nx_;
+    m->res[fwd.index_out("fwd_g")] = nullptr;
+    if (calc_function(m, "fwd1_nlp_grad")) return 1;
+    // Predicted primal-dual solution, keeping the active set
+    for (i=0; i<nx_+ng_; ++i) {
+      if (i<nx_) {
+        d_nlp->z[i] = std::fmin(std::fmax(x[i] + v[i], d_nlp->lbz[i]), d_nlp->ubz[i]);
+      }
+      double lam = lam_x[i] + (i<nx_ ? -fwd_grad_x[i] : v[i]);
+      if (lam_x[i] > min_lam_) {
+        d_nlp->lam[i] = std::fmax(lam, 0.);
+      } else if (lam_x[i] < -min_lam_) {
+        d_nlp->lam[i] = std::fmin(lam, 0.);
+      } else {
+        d_nlp->lam[i] = 0;
+      }
+    }
+    return 0;
+  }
+
   void Nlpsol::set_work(void* mem, const double**& arg, double**& res,
                         casadi_int*& iw, double*& w) const {
     auto m = static_cast<NlpsolMemory*>(mem);
@@ -1202,6 +1410,8 @@ namespace casadi {
   }
 
   void Nlpsol::codegen_declarations(CodeGenerator& g) const {
+    casadi_assert(!tangential_predictor_,
+      "Option 'tangential_predictor' not supported in generated code");
     g.add_auxiliary(CodeGenerator::AUX_FILL);
     g.add_auxiliary(CodeGenerator::AUX_FABS);
     if (calc_f_ || calc_g_ || calc_lam_x_ || calc_lam_p_)
@@ -1259,7 +1469,7 @@ namespace casadi {
   void Nlpsol::serialize_body(SerializingStream &s) const {
     OracleFunction::serialize_body(s);
 
-    s.version("Nlpsol", 3);
+    s.version("Nlpsol", 4);
     s.pack("Nlpsol::nx", nx_);
     s.pack("Nlpsol::ng", ng_);
     s.pack("Nlpsol::np", np_);
@@ -1283,6 +1493,10 @@ namespace casadi {
     s.pack("Nlpsol::detect_simple_bounds_is_simple", detect_simple_bounds_is_simple_);
     s.pack("Nlpsol::detect_simple_bounds_parts", detect_simple_bounds_parts_);
     s.pack("Nlpsol::detect_simple_bounds_target_x", detect_simple_bounds_target_x_);
+    s.pack("Nlpsol::tangential_predictor", tangential_predictor_);
+    s.pack("Nlpsol::pred_sp", pred_sp_);
+    s.pack("Nlpsol::pred_hess", pred_hess_);
+    s.pack("Nlpsol::pred_jac", pred_jac_);
   }
 
   void Nlpsol::serialize_type(SerializingStream &s) const {
@@ -1295,7 +1509,7 @@ namespace casadi {
   }
 
   Nlpsol::Nlpsol(DeserializingStream & s) : OracleFunction(s) {
-    int version = s.version("Nlpsol", 1, 3);
+    int version = s.version("Nlpsol", 1, 4);
     s.unpack("Nlpsol::nx", nx_);
     s.unpack("Nlpsol::ng", ng_);
     s.unpack("Nlpsol::np", np_);
@@ -1329,6 +1543,14 @@ namespace casadi {
       s.unpack("Nlpsol::detect_simple_bounds_parts", detect_simple_bounds_parts_);
       s.unpack("Nlpsol::detect_simple_bounds_target_x", detect_simple_bounds_target_x_);
     }
+    if (version>=4) {
+      s.unpack("Nlpsol::tangential_predictor", tangential_predictor_);
+      s.unpack("Nlpsol::pred_sp", pred_sp_);
+      s.unpack("Nlpsol::pred_hess", pred_hess_);
+      s.unpack("Nlpsol::pred_jac", pred_jac_);
+    } else {
+      tangential_predictor_ = false;
+    }
     for (casadi_int i=0;i<detect_simple_bounds_is_simple_.size();++i) {
       if (detect_simple_bounds_is_simple_[i]) {
         detect_simple_bounds_target_g_.push_back(i);
@@ -29,6 +29,7 @@
 #include "nlpsol.hpp"
 #include "oracle_function.hpp"
 #include "plugin_interface.hpp"
+#include "linsol.hpp"
 
 
 /// \cond INTERNAL
@@ -46,6 +47,14 @@ namespace casadi {
     bool success;
     // Return status
     UnifiedReturnStatus unified_return_status;
+    // Tangential predictor: previous solution, parameters and bounds
+    std::vector<double> pred_z, pred_lam, pred_p, pred_lbz, pred_ubz;
+    // Tangential predictor: KKT nonzeros and work vectors
+    std::vector<double> pred_kkt, pred_v, pred_w;
+    // Tangential predictor: linear solver with the factorized KKT matrix
+    Linsol pred_linsol;
+    // Tangential predictor: factorization is valid
+    bool pred_ready;
   };
 
   /** \brief NLP solver storage class
@@ -98,9 +107,16 @@ namespace casadi {
     bool bound_consistency_;
     double min_lam_;
     bool no_nlp_grad_;
+    bool tangential_predictor_;
     std::vector<bool> discrete_;
     ///@}
 
+    /// Sparsity pattern of the KKT matrix used by the tangential predictor
+    Sparsity pred_sp_;
+
+    /// For each nonzero of pred_sp_, the nonzero of the Hessian or the Jacobian, or -1
+    std::vector<casadi_int> pred_hess_, pred_jac_;
+
     // Mixed integer problem?
     bool mi_;
 
@@ -263,6 +279,12 @@ namespace casadi {
     // Get KKT function
     Function kkt() const;
 
+    // Factorize the KKT matrix at the current solution
+    int predictor_prepare(NlpsolMemory* m) const;
+
+    // Warm start from the first order prediction of the previous solution
+    int predictor_apply(NlpsolMemory* m) const;
+
     // Make sure primal-dual solution is consistent with bounds
     static void bound_consistency(casadi_int n, double* z, double* lam,
                                   const double* lbz, const double* ubz);
@@ -26,17 +26,67 @@
 #include "oracle_function.hpp"
 #include "external.hpp"
 #include "serializing_stream.hpp"
+#include "mx_function.hpp"
+#include "map.hpp"
 
 #include <iomanip>
 #include <iostream>
 
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.thread.h>
+#include <mingw.mutex.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <thread>
+#include <mutex>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif // CASADI_WITH_THREAD
+
 namespace casadi {
 
+// Function derived from an oracle, shared between OracleFunction instances
+struct DerivedEntry {
+  // Serialized oracle, compared on a hit since the key only contains its hash
+  std::shared_ptr<const std::string> oracle_str;
+  // The derived function
+  WeakRef f;
+  // Number of instances using the entry
+  casadi_int users;
+};
+
+struct DerivedCache {
+  std::map<std::pair<std::size_t, std::string>, DerivedEntry> entries;
+#ifdef CASADI_WITH_THREAD
+  std::mutex mtx;
+#endif // CASADI_WITH_THREAD
+};
+
+// Never destroyed, instances can still be released during static destruction
+static DerivedCache& derived_cache() {
+  static DerivedCache* cache = new DerivedCache();
+  return *cache;
+}
+
 OracleFunction::OracleFunction(const std::string& name, const Function& oracle)
 : FunctionInternal(name), oracle_(oracle) {
 }
 
 OracleFunction::~OracleFunction() {
+  // Drop the shared derived functions when the last instance using them is released
+  if (!derived_keys_.empty()) {
+    DerivedCache& cache = derived_cache();
+#ifdef CASADI_WITH_THREAD
+    std::lock_guard<std::mutex> lock(cache.mtx);
+#endif // CASADI_WITH_THREAD
+    for (auto&& key : derived_keys_) {
+      auto it = cache.entries.find(key);
+      if (it!=cache.entries.end() && --it->second.users==0) cache.entries.erase(it);
+    }
+  }
+}
+
+bool OracleFunction::same_oracle(const std::shared_ptr<const std::string>& oracle_str) const {
+  return oracle_str==oracle_str_ || *oracle_str==*oracle_str_;
 }
 
 const Options OracleFunction::options_
@@ -50,6 +100,26 @@ const Options OracleFunction::options_
     {"show_eval_warnings",
       {OT_BOOL,
       "Show warnings generated from function evaluations [true]"}},
+    {"max_num_threads",
+      {OT_INT,
+      "Maximum number of threads used to evaluate oracle functions concurrently [1]. "
+      "Requires CasADi to be compiled with WITH_THREAD=ON."}},
+    {"detect_map",
+      {OT_BOOL,
+      "Exploit the stage structure of a Map call in an MX oracle: Jacobian and "
+      "Hessian blocks are calculated per stage from derivatives of the mapped function "
+      "and added directly to the nonzeros of the result [false]"}},
+    {"split_functions",
+      {OT_STRINGVECTOR,
+      "Functions whose (first) Jacobian or Hessian output is evaluated in parallel, "
+      "split over groups of structurally orthogonal columns, one group per thread, "
+      "e.g. nlp_hess_l. Only used if max_num_threads>1."}},
+    {"cache_derived",
+      {OT_BOOL,
+      "Reuse the auto-generated functions, e.g. nlp_jac_fg, of other instances with an "
+      "identical oracle, requested inputs, outputs and options, identified by a hash of the "
+      "serialized oracle. Saves the setup time when re-creating a solver for the same "
+      "problem [true]"}},
     {"common_options",
       {OT_DICT,
       "Options for auto-generated functions"}},
@@ -70,6 +140,8 @@ void OracleFunction::init(const Dict& opts) {
   show_eval_warnings_ = true;
 
   max_num_threads_ = 1;
+  detect_map_ = false;
+  cache_derived_ = true;
 
   // Read options
   for (auto&& op : opts) {
@@ -89,9 +161,26 @@ void OracleFunction::init(const Dict& opts) {
       monitor_ = op.second;
     } else if (op.first=="show_eval_warnings") {
       show_eval_warnings_ = op.second;
+    } else if (op.first=="max_num_threads") {
+      max_num_threads_ = op.second;
+    } else if (op.first=="split_functions") {
+      split_ = op.second;
+    } else if (op.first=="detect_map") {
+      detect_map_ = op.second;
+    } else if (op.first=="cache_derived") {
+      cache_derived_ = op.second;
     }
   }
 
+  casadi_assert(max_num_threads_>=1, "Option 'max_num_threads' must be positive");
+#ifndef CASADI_WITH_THREAD
+  if (max_num_threads_>1) {
+    casadi_warning("CasADi was not compiled with WITH_THREAD=ON. "
+                   "Falling back to serial evaluation.");
+    max_num_threads_ = 1;
+  }
+#endif // CASADI_WITH_THREAD
+
   // Replace MX oracle with SX oracle?
   if (expand) oracle_ = oracle_.expand();
 
@@ -99,7 +188,7 @@ void OracleFunction::init(const Dict& opts) {
   stride_res_ = 0;
   stride_iw_ = 0;
   stride_w_ = 0;
-
+  sz_split_buf_ = 0;
 }
 
 void OracleFunction::finalize() {
@@ -131,6 +220,14 @@ void OracleFunction::finalize() {
     }
   }
 
+  // Check functions to be split
+  for (const std::string& fname : split_) {
+    if (max_num_threads_>1 && split_functions_.find(fname)==split_functions_.end()) {
+      casadi_warning("Ignoring split_functions entry '" + fname + "'."
+                      " Available functions: " + join(get_function()) + ".");
+    }
+  }
+
   // Check specific options
   for (auto&& i : specific_options_) {
     if (all_functions_.find(i.first)==all_functions_.end())
@@ -145,10 +242,14 @@ void OracleFunction::finalize() {
 void OracleFunction::join_results(OracleMemory* m) const {
   // Combine runtime statistics
   // Note: probably not correct to simply add wall times
+  m->thread_stats.resize(max_num_threads_);
   for (int i = 0; i < max_num_threads_; ++i) {
     auto* ml = m->thread_local_mem[i];
+    // Keep the statistics per thread, then reset for the next call
+    m->thread_stats[i] = ml->fstats;
     for (auto&& s : ml->fstats) {
       m->fstats.at(s.first).join(s.second);
+      s.second.reset();
     }
   }
 }
@@ -235,12 +336,57 @@ Function OracleFunction::create_function(const Function& oracle, const std::stri
     Dict opt = combine(specific_options, common_options_);
     opt = combine(opts, opt);
 
-    // Generate the function
-    ret = oracle.factory(fname, s_in, s_out, aux, opt);
+    // Reuse the function of another instance with an identical oracle
+    DerivedKey key;
+    bool shared = derived_key(oracle, fname, s_in, s_out, aux, opt, key);
+    if (shared) {
+      DerivedCache& cache = derived_cache();
+#ifdef CASADI_WITH_THREAD
+      std::lock_guard<std::mutex> lock(cache.mtx);
+#endif // CASADI_WITH_THREAD
+      auto it = cache.entries.find(key);
+      if (it!=cache.entries.end() && same_oracle(it->second.oracle_str)) {
+        ret = shared_cast<Function>(it->second.f.shared());
+      }
+      if (!ret.is_null()) {
+        // Keep a single copy of the serialized oracle
+        oracle_str_ = it->second.oracle_str;
+        it->second.users++;
+        derived_keys_.push_back(key);
+        if (verbose_) casadi_message(name_ + "::create_function reused " + fname);
+        shared = false;
+      }
+    }
 
-    // Make sure that it's sound
-    if (ret.has_free()) {
-      casadi_error("Cannot create '" + fname + "' since " + str(ret.get_free()) + " are free.");
+    if (ret.is_null()) {
+      // Generate the function, exploiting the stage structure if possible
+      if (detect_map_ && oracle.get()==oracle_.get()) {
+        ret = create_map_structured(fname, s_in, s_out, aux, opt);
+      }
+      if (ret.is_null()) ret = oracle.factory(fname, s_in, s_out, aux, opt);
+
+      // Make sure that it's sound
+      if (ret.has_free()) {
+        casadi_error("Cannot create '" + fname + "' since " + str(ret.get_free()) + " are free.");
+      }
+
+      // Share with other instances
+      if (shared) {
+        DerivedCache& cache = derived_cache();
+#ifdef CASADI_WITH_THREAD
+        std::lock_guard<std::mutex> lock(cache.mtx);
+#endif // CASADI_WITH_THREAD
+        auto it = cache.entries.find(key);
+        if (it==cache.entries.end()) {
+          cache.entries[key] = DerivedEntry{oracle_str_, WeakRef(ret), 1};
+          derived_keys_.push_back(key);
+        } else if (same_oracle(it->second.oracle_str)) {
+          // Entry added concurrently, or its function no longer alive
+          if (!it->second.f.alive()) it->second.f = WeakRef(ret);
+          it->second.users++;
+          derived_keys_.push_back(key);
+        }
+      }
     }
 
     // Add to cache
@@ -249,9 +395,563 @@ Function OracleFunction::create_function(const Function& oracle, const std::stri
 
   // Save and return
   set_function(ret, fname, true);
+  if (max_num_threads_>1 && std::find(split_.begin(), split_.end(), fname)!=split_.end()) {
+    split_function(oracle, fname, s_in, s_out, aux);
+  }
   return ret;
 }
 
+bool OracleFunction::derived_key(const Function& oracle, const std::string& fname,
+    const std::vector<std::string>& s_in,
+    const std::vector<std::string>& s_out,
+    const Function::AuxOut& aux, const Dict& opts, DerivedKey& key) {
+  if (!cache_derived_) return false;
+  // Options that cannot be compared by their serialization
+  for (auto&& op : opts) {
+    if (op.second.is_function()) return false;
+  }
+  // Serialize the oracle, once
+  if (serialized_oracle_.get()!=oracle.get()) {
+    serialized_oracle_ = oracle;
+    oracle_str_.reset();
+    try {
+      oracle_str_ = std::make_shared<const std::string>(oracle.serialize());
+      oracle_hash_ = std::hash<std::string>()(*oracle_str_);
+    } catch (std::exception&) {
+      // Not serializable, e.g. containing callbacks
+    }
+  }
+  if (!oracle_str_) return false;
+  // Exact serialization of the remaining arguments of the factory call
+  std::stringstream ss;
+  try {
+    SerializingStream s(ss);
+    s.pack(fname);
+    s.pack(s_in);
+    s.pack(s_out);
+    s.pack(aux);
+    s.pack(opts);
+    s.pack(detect_map_);
+  } catch (std::exception&) {
+    return false;
+  }
+  key = DerivedKey(oracle_hash_, ss.str());
+  return true;
+}
+
+void OracleFunction::split_function(const Function& oracle, const std::string& fname,
+    const std::vector<std::string>& s_in,
+    const std::vector<std::string>& s_out,
+    const Function::AuxOut& aux) {
+  SplitFun sf;
+  // Locate the first Jacobian or Hessian output, jac:f:x or hess:f:x:x,
+  // and the function whose Jacobian it is, f or grad:f:x
+  std::string base_out, wrt;
+  sf.oind = -1;
+  for (casadi_int i=0; i<s_out.size() && sf.oind<0; ++i) {
+    std::string s = s_out[i];
+    if (s.rfind("triu:", 0)==0 || s.rfind("tril:", 0)==0) s = s.substr(5);
+    std::vector<std::string> tok;
+    std::stringstream ss(s);
+    std::string t;
+    while (std::getline(ss, t, ':')) tok.push_back(t);
+    if (tok.size()==3 && tok[0]=="jac") {
+      base_out = tok[1];
+      wrt = tok[2];
+      sf.oind = i;
+    } else if (tok.size()==4 && tok[0]=="hess") {
+      base_out = "grad:" + tok[1] + ":" + tok[2];
+      wrt = tok[3];
+      sf.oind = i;
+    }
+  }
+  casadi_assert(sf.oind>=0, "Cannot split " + fname + ": No Jacobian or Hessian output in "
+    + str(s_out) + ".");
+  auto it = std::find(s_in.begin(), s_in.end(), wrt);
+  casadi_assert(it!=s_in.end(), "Cannot split " + fname + ": No input " + wrt + ".");
+  casadi_int iind = it - s_in.begin();
+
+  // Function whose Jacobian is to be calculated
+  Function base = oracle.factory(fname + "_split_base", s_in, {base_out}, aux);
+  casadi_int nr = base.numel_out(0);
+  Sparsity sp_jac = base.jac_sparsity(0, iind);
+
+  // Colour the columns
+  Sparsity coloring = sp_jac.uni_coloring(sp_jac.T());
+  casadi_int n_color = coloring.size2();
+  std::vector<casadi_int> color(sp_jac.size2(), -1);
+  for (casadi_int c=0; c<n_color; ++c) {
+    for (casadi_int el=coloring.colind(c); el<coloring.colind(c+1); ++el) {
+      color[coloring.row(el)] = c;
+    }
+  }
+
+  // Requested pattern, possibly only the upper triangular part
+  const Sparsity& sp = get_function(fname).sparsity_out(sf.oind);
+  const casadi_int *colind = sp.colind(), *row = sp.row();
+
+  // Group the colours, balancing the number of nonzeros per group
+  std::vector<casadi_int> nnz_color(n_color, 0);
+  for (casadi_int c=0; c<sp.size2(); ++c) {
+    if (color[c]>=0) nnz_color[color[c]] += colind[c+1] - colind[c];
+  }
+  casadi_int n_group = std::min<casadi_int>(max_num_threads_, n_color);
+  std::vector<casadi_int> group_offset(1, 0);
+  casadi_int nnz_sum = 0;
+  for (casadi_int c=0; c+1<n_color && group_offset.size()<n_group; ++c) {
+    nnz_sum += nnz_color[c];
+    if (nnz_sum * n_group >= sp.nnz() * group_offset.size()) group_offset.push_back(c + 1);
+  }
+  group_offset.push_back(n_color);
+  n_group = group_offset.size() - 1;
+
+  // Nondifferentiated arguments of the forward derivatives
+  std::vector<MX> arg = base.mx_in();
+  std::vector<MX> fwd_arg = arg;
+  for (const MX& r : base(arg)) fwd_arg.push_back(r);
+
+  // Create a function for each group of colours
+  sf.buf_offset = sz_split_buf_;
+  for (casadi_int g=0; g<n_group; ++g) {
+    casadi_int c0 = group_offset[g], nc = group_offset[g+1] - c0;
+    // Forward seeds, one direction per colour
+    std::vector<casadi_int> seed_row, seed_col;
+    for (casadi_int c=c0; c<c0+nc; ++c) {
+      for (casadi_int el=coloring.colind(c); el<coloring.colind(c+1); ++el) {
+        seed_row.push_back(coloring.row(el));
+        seed_col.push_back(c - c0);
+      }
+    }
+    std::vector<MX> fwd_arg_g = fwd_arg;
+    for (casadi_int i=0; i<base.n_in(); ++i) {
+      if (i==iind) {
+        Sparsity sp_seed = Sparsity::triplet(base.numel_in(i), nc, seed_row, seed_col);
+        fwd_arg_g.push_back(DM(sp_seed, 1.));
+      } else {
+        fwd_arg_g.push_back(MX(base.size1_in(i), nc * base.size2_in(i)));
+      }
+    }
+    MX jac_c = base.forward(nc)(fwd_arg_g).at(0);
+    // Requested nonzeros in the compressed Jacobian
+    std::vector<casadi_int> ind, nz;
+    for (casadi_int c=0; c<sp.size2(); ++c) {
+      if (color[c]<c0 || color[c]>=c0+nc) continue;
+      for (casadi_int el=colind[c]; el<colind[c+1]; ++el) {
+        ind.push_back(row[el] + nr * (color[c] - c0));
+        nz.push_back(el);
+      }
+    }
+    jac_c.sparsity().get_nz(ind);
+    // Drop structural zeros
+    casadi_int n_nz = 0;
+    for (casadi_int k=0; k<ind.size(); ++k) {
+      if (ind[k]<0) continue;
+      ind[n_nz] = ind[k];
+      nz[n_nz++] = nz[k];
+    }
+    ind.resize(n_nz);
+    nz.resize(n_nz);
+    MX part;
+    jac_c.get_nz(part, false, Matrix<casadi_int>(ind));
+    Function f(fname + "_split_" + str(g), arg, {part}, s_in, {"nz"});
+    if (oracle.is_a("SXFunction")) f = f.expand();
+    set_function(f, f.name(), true);
+    sf.parts.push_back(f.name());
+    sf.nz.push_back(nz);
+    sz_split_buf_ += n_nz;
+  }
+
+  // Function for the remaining outputs
+  std::vector<std::string> s_rem;
+  for (casadi_int i=0; i<s_out.size(); ++i) {
+    if (i==sf.oind) continue;
+    s_rem.push_back(s_out[i]);
+    sf.rem_out.push_back(i);
+  }
+  if (!s_rem.empty()) {
+    Function f = oracle.factory(fname + "_split_rem", s_in, s_rem, aux);
+    set_function(f, f.name(), true);
+    sf.rem = f.name();
+  }
+  split_functions_[fname] = sf;
+}
+
+// Is an expression independent of all the symbols?
+static bool is_constant(const MX& e, const std::vector<MX>& sym) {
+  for (const MX& s : sym) if (MX::depends_on(e, s)) return false;
+  return true;
+}
+
+// Map a stage derivative function over the stages
+static Function map_stages(const Function& f, bool expand, casadi_int n,
+    const std::string& par, casadi_int max_num_threads) {
+  Function ret = expand ? f.expand() : f;
+  if (par=="serial" && max_num_threads>1) return ret.map(n, "thread", max_num_threads);
+  return ret.map(n, par);
+}
+
+Function OracleFunction::create_map_structured(const std::string& fname,
+    const std::vector<std::string>& s_in,
+    const std::vector<std::string>& s_out,
+    const Function::AuxOut& aux, const Dict& opts) const {
+  // Only MX oracles can contain a Map call
+  if (!oracle_.is_a("MXFunction")) return Function();
+  const MXFunction* of = oracle_.get<MXFunction>();
+
+  // Locate the Map call with the most stages
+  MX call;
+  Function fmap, fs;
+  casadi_int n_stage = 0;
+  for (casadi_int k=0; k<oracle_.n_instructions(); ++k) {
+    if (oracle_.instruction_id(k)!=OP_CALL) continue;
+    MX c = oracle_.instruction_MX(k);
+    Function fc = c.which_function();
+    if (!fc.is_a("Map", true)) continue;
+    const Function& f = fc.get_function("f");
+    casadi_int n = 0;
+    for (casadi_int i=0; i<f.n_in() && n==0; ++i) {
+      if (f.size2_in(i)>0) n = fc.size2_in(i) / f.size2_in(i);
+    }
+    if (n>n_stage) {
+      call = c;
+      fmap = fc;
+      fs = f;
+      n_stage = n;
+    }
+  }
+  if (n_stage==0) {
+    if (verbose_) casadi_message(fname + ": No Map call detected in oracle");
+    return Function();
+  }
+
+  // Jacobian and Hessian outputs, jac:o:w or [triu:]hess:o:w:w
+  std::vector<casadi_int> target;
+  std::vector<std::string> target_o, s_std;
+  std::vector<bool> target_hess, target_triu;
+  std::string wrt;
+  for (casadi_int i=0; i<s_out.size(); ++i) {
+    std::string s = s_out[i];
+    bool triu = s.rfind("triu:", 0)==0;
+    if (triu) s = s.substr(5);
+    std::vector<std::string> tok;
+    std::stringstream ss(s);
+    std::string t;
+    while (std::getline(ss, t, ':')) tok.push_back(t);
+    if ((tok.size()==3 && tok[0]=="jac" && !triu)
+        || (tok.size()==4 && tok[0]=="hess" && tok[2]==tok[3])) {
+      if (!wrt.empty() && wrt!=tok[2]) return Function();
+      wrt = tok[2];
+      target.push_back(i);
+      target_o.push_back(tok[1]);
+      target_hess.push_back(tok[0]=="hess");
+      target_triu.push_back(triu);
+    } else {
+      s_std.push_back(s_out[i]);
+    }
+  }
+  if (target.empty()) return Function();
+  const std::vector<std::string>& oracle_in = oracle_.name_in();
+  const std::vector<std::string>& oracle_out = oracle_.name_out();
+  std::set<std::string> has_out(oracle_out.begin(), oracle_out.end());
+  auto wrt_it = std::find(oracle_in.begin(), oracle_in.end(), wrt);
+  if (wrt_it==oracle_in.end()) return Function();
+  const MX& w = of->in_.at(wrt_it - oracle_in.begin());
+
+  // Symbolic inputs: oracle inputs and multipliers
+  std::vector<MX> arg;
+  std::map<std::string, MX> lam;
+  for (const std::string& n : s_in) {
+    auto it = std::find(oracle_in.begin(), oracle_in.end(), n);
+    if (it!=oracle_in.end()) {
+      arg.push_back(of->in_.at(it - oracle_in.begin()));
+    } else if (n.rfind("lam:", 0)==0 && has_out.count(n.substr(4))) {
+      arg.push_back(MX::sym(n, oracle_.sparsity_out(n.substr(4))));
+      lam[n.substr(4)] = arg.back();
+    } else {
+      return Function();
+    }
+  }
+
+  // Only dense stage inputs and outputs are supported
+  for (casadi_int i=0; i<fs.n_in(); ++i) if (!fs.sparsity_in(i).is_dense()) return Function();
+  for (casadi_int i=0; i<fs.n_out(); ++i) if (!fs.sparsity_out(i).is_dense()) return Function();
+
+  // Replace the outputs of the Map call with a symbolic vector y
+  std::vector<casadi_int> y_offset(1, 0);
+  for (casadi_int j=0; j<fmap.n_out(); ++j) y_offset.push_back(y_offset.back() + fmap.nnz_out(j));
+  MX y = MX::sym("y", y_offset.back());
+  std::vector<MX> y_split = vertsplit(y, y_offset);
+  std::vector<MX> out(of->out_.size());
+  {
+    // Walk through the algorithm, cf. MXFunction::eval_mx
+    std::vector<MX> swork(of->workloc_.size()-1), arg1, res1;
+    std::vector<bool> tainted(swork.size(), false);
+    std::vector<std::vector<MX>> res_split(out.size());
+    for (casadi_int i=0; i<out.size(); ++i) res_split[i].resize(of->out_[i].n_primitives());
+    for (auto&& e : of->algorithm_) {
+      if (e.op==OP_INPUT || e.op==OP_PARAMETER) {
+        swork[e.res.front()] = e.data;
+      } else if (e.op==OP_OUTPUT) {
+        res_split.at(e.data->ind()).at(e.data->segment()) = swork[e.arg.front()];
+      } else if (e.data.get()==call.get()) {
+        for (casadi_int j=0; j<e.res.size(); ++j) {
+          if (e.res[j]<0) continue;
+          swork[e.res[j]] = reshape(y_split[j], fmap.size_out(j));
+          tainted[e.res[j]] = true;
+        }
+      } else {
+        bool node_tainted = false;
+        arg1.resize(e.arg.size());
+        for (casadi_int i=0; i<arg1.size(); ++i) {
+          casadi_int el = e.arg[i];
+          if (el>=0) node_tainted = node_tainted || tainted[el];
+          arg1[i] = el<0 ? MX(e.data->dep(i).size()) : swork[el];
+        }
+        res1.resize(e.res.size());
+        if (e.res.size()==1 && !node_tainted) {
+          res1[0] = e.data;
+        } else {
+          e.data->eval_mx(arg1, res1);
+        }
+        for (casadi_int i=0; i<res1.size(); ++i) {
+          if (e.res[i]<0) continue;
+          swork[e.res[i]] = res1[i];
+          tainted[e.res[i]] = node_tainted;
+        }
+      }
+    }
+    for (casadi_int i=0; i<out.size(); ++i) out[i] = of->out_[i].join_primitives(res_split[i]);
+  }
+
+  // All symbols, for checking that an expression is constant
+  std::vector<MX> all_sym = of->in_;
+  all_sym.push_back(y);
+
+  // The oracle outputs must be linear in y, with constant coefficients
+  std::map<std::string, DM> jac_y;
+  for (casadi_int i=0; i<target.size(); ++i) {
+    std::vector<std::string> o = {target_o[i]};
+    if (target_hess[i] && aux.find(target_o[i])!=aux.end()) o = aux.at(target_o[i]);
+    for (const std::string& n : o) {
+      if (jac_y.find(n)!=jac_y.end()) continue;
+      if (!has_out.count(n)) return Function();
+      MX J = MX::jacobian(out.at(oracle_.index_out(n)), y);
+      if (!is_constant(J, all_sym)) return Function();
+      jac_y[n] = MX::evalf(J);
+    }
+  }
+
+  // The arguments of the Map call must be affine in w: each element
+  // a multiple of at most one element of w
+  std::vector<casadi_int> stage_in, z_offset(1, 0);
+  std::vector<std::vector<casadi_int>> w_ind(fmap.n_in());
+  std::vector<std::vector<double>> w_scale(fmap.n_in());
+  for (casadi_int i=0; i<fmap.n_in(); ++i) {
+    MX J = MX::jacobian(call.dep(i), w);
+    if (J.nnz()==0) continue;
+    if (!is_constant(J, all_sym)) return Function();
+    DM Jv = MX::evalf(J);
+    w_ind[i].resize(J.size1(), -1);
+    w_scale[i].resize(J.size1(), 0);
+    const casadi_int *colind = Jv.colind(), *row = Jv.row();
+    for (casadi_int c=0; c<Jv.size2(); ++c) {
+      for (casadi_int el=colind[c]; el<colind[c+1]; ++el) {
+        if (w_ind[i][row[el]]>=0) return Function();
+        w_ind[i][row[el]] = c;
+        w_scale[i][row[el]] = Jv.nonzeros()[el];
+      }
+    }
+    stage_in.push_back(i);
+    z_offset.push_back(z_offset.back() + fs.nnz_in(i));
+  }
+  if (stage_in.empty()) return Function();
+
+  // Stage function with the differentiated inputs stacked in z
+  MX z = MX::sym("z", z_offset.back());
+  std::vector<MX> z_split = vertsplit(z, z_offset);
+  std::vector<MX> fs_arg = fs.mx_in();
+  std::vector<MX> g_arg = {z};
+  for (casadi_int i=0; i<fs.n_in(); ++i) {
+    auto it = std::find(stage_in.begin(), stage_in.end(), i);
+    if (it==stage_in.end()) {
+      g_arg.push_back(fs_arg[i]);
+    } else {
+      fs_arg[i] = reshape(z_split[it - stage_in.begin()], fs.size_in(i));
+    }
+  }
+  std::vector<MX> fs_res = fs(fs_arg);
+  // Outer stage functions have the inputs of the stage function, followed by
+  // the multipliers of its outputs for the Hessian
+  std::vector<MX> outer_arg = fs.mx_in();
+  MX outer_z;
+  for (casadi_int i : stage_in) outer_z = vertcat(outer_z, vec(outer_arg[i]));
+  std::vector<MX> outer_g_arg = {outer_z};
+  for (casadi_int i=0; i<fs.n_in(); ++i) {
+    if (std::find(stage_in.begin(), stage_in.end(), i)==stage_in.end()) {
+      outer_g_arg.push_back(outer_arg[i]);
+    }
+  }
+  // Map one of the stage derivative functions over the stages
+  std::string par = fmap.get<Map>()->parallelization();
+  bool expand_stages = fs.is_a("SXFunction");
+  // Map arguments
+  std::vector<MX> map_arg;
+  for (casadi_int i=0; i<fmap.n_in(); ++i) map_arg.push_back(call.dep(i));
+
+  // Location in w of element a of z in stage k, at z_ind[k*nz + a], and its scaling
+  casadi_int nz = z_offset.back();
+  std::vector<casadi_int> z_ind(n_stage * nz);
+  std::vector<double> z_scale(n_stage * nz);
+  for (casadi_int i=0; i<stage_in.size(); ++i) {
+    casadi_int n_i = fs.nnz_in(stage_in[i]);
+    for (casadi_int k=0; k<n_stage; ++k) {
+      for (casadi_int a=0; a<n_i; ++a) {
+        z_ind[k * nz + z_offset[i] + a] = w_ind[stage_in[i]][k * n_i + a];
+        z_scale[k * nz + z_offset[i] + a] = w_scale[stage_in[i]][k * n_i + a];
+      }
+    }
+  }
+
+  // Assemble the outputs
+  std::vector<MX> res(s_out.size());
+  for (casadi_int t=0; t<target.size(); ++t) {
+    // Oracle outputs and their multipliers
+    std::vector<std::string> o = {target_o[t]};
+    std::vector<MX> o_lam = {MX(1)};
+    if (target_hess[t] && aux.find(target_o[t])!=aux.end()) {
+      o = aux.at(target_o[t]);
+      o_lam.clear();
+      for (const std::string& n : o) {
+        if (lam.find(n)==lam.end()) return Function();
+        o_lam.push_back(lam[n]);
+      }
+    }
+    // Contribution without the Map call, with y = 0
+    MX r, blocks;
+    std::vector<casadi_int> src, dst_row, dst_col;
+    std::vector<double> scale;
+    if (target_hess[t]) {
+      MX l = 0;
+      for (casadi_int i=0; i<o.size(); ++i) l += dot(o_lam[i], out.at(oracle_.index_out(o[i])));
+      r = MX::hessian(l, w);
+      if (target_triu[t]) r = triu(r);
+      // Multipliers of the outputs of the Map call
+      MX mu = 0;
+      for (casadi_int i=0; i<o.size(); ++i) mu += mtimes(jac_y.at(o[i]).T(), vec(o_lam[i]));
+      mu = densify(mu);
+      std::vector<MX> mu_split = vertsplit(mu, y_offset);
+      for (casadi_int j=0; j<fmap.n_out(); ++j) {
+        map_arg.push_back(reshape(mu_split[j], fmap.size_out(j)));
+      }
+      // Stage Hessian of the Lagrangian
+      std::vector<MX> g_mu;
+      MX ls = 0;
+      for (casadi_int j=0; j<fs.n_out(); ++j) {
+        g_mu.push_back(MX::sym("mu" + str(j), fs.sparsity_out(j)));
+        ls += dot(g_mu.back(), fs_res[j]);
+      }
+      std::vector<MX> g_arg_h = g_arg;
+      g_arg_h.insert(g_arg_h.end(), g_mu.begin(), g_mu.end());
+      Function g(fname + "_stage_hess", g_arg_h, {MX::hessian(ls, z)});
+      std::vector<MX> outer_arg_h = outer_arg, outer_g_arg_h = outer_g_arg;
+      for (casadi_int j=0; j<fs.n_out(); ++j) {
+        outer_arg_h.push_back(MX::sym("mu" + str(j), fs.sparsity_out(j)));
+        outer_g_arg_h.push_back(outer_arg_h.back());
+      }
+      Function outer(fname + "_stage", outer_arg_h, g(outer_g_arg_h));
+      blocks = map_stages(outer, expand_stages, n_stage, par, max_num_threads_)(map_arg).at(0);
+      map_arg.resize(fmap.n_in());
+      // Nonzeros of the blocks in the result
+      const Sparsity& sp = g.sparsity_out(0);
+      const casadi_int *colind = sp.colind(), *row = sp.row();
+      for (casadi_int k=0; k<n_stage; ++k) {
+        for (casadi_int b=0; b<sp.size2(); ++b) {
+          casadi_int cb = z_ind[k * nz + b];
+          double sb = z_scale[k * nz + b];
+          if (cb<0) continue;
+          for (casadi_int el=colind[b]; el<colind[b+1]; ++el) {
+            casadi_int ca = z_ind[k * nz + row[el]];
+            double sa = z_scale[k * nz + row[el]];
+            if (ca<0 || (target_triu[t] && ca>cb)) continue;
+            src.push_back(k * sp.nnz() + el);
+            dst_row.push_back(ca);
+            dst_col.push_back(cb);
+            scale.push_back(sa * sb);
+          }
+        }
+      }
+    } else {
+      const MX& e = out.at(oracle_.index_out(o[0]));
+      r = MX::jacobian(e, w);
+      // Stage Jacobian of all outputs
+      MX e_s;
+      std::vector<casadi_int> fs_offset(1, 0);
+      for (casadi_int j=0; j<fs.n_out(); ++j) {
+        e_s = vertcat(e_s, vec(fs_res[j]));
+        fs_offset.push_back(fs_offset.back() + fs.nnz_out(j));
+      }
+      Function g(fname + "_stage_jac", g_arg, {MX::jacobian(e_s, z)});
+      Function outer(fname + "_stage", outer_arg, g(outer_g_arg));
+      blocks = map_stages(outer, expand_stages, n_stage, par, max_num_threads_)(map_arg).at(0);
+      // Rows of the stage Jacobian
+      const Sparsity& sp = g.sparsity_out(0);
+      std::vector<casadi_int> sp_col = sp.get_col();
+      std::vector<std::vector<casadi_int>> sp_row(sp.size1());
+      for (casadi_int c=0; c<sp.size2(); ++c) {
+        for (casadi_int el=sp.colind(c); el<sp.colind(c+1); ++el) sp_row[sp.row(el)].push_back(el);
+      }
+      // Chain rule through the linear dependency on y
+      const DM& Jy = jac_y.at(o[0]);
+      const casadi_int *colind = Jy.colind(), *row = Jy.row();
+      for (casadi_int c=0; c<Jy.size2(); ++c) {
+        // Output, stage and element corresponding to y[c]
+        casadi_int j = std::upper_bound(y_offset.begin(), y_offset.end(), c)
+          - y_offset.begin() - 1;
+        casadi_int k = (c - y_offset[j]) / fs.nnz_out(j);
+        casadi_int os = fs_offset[j] + (c - y_offset[j]) % fs.nnz_out(j);
+        for (casadi_int el=colind[c]; el<colind[c+1]; ++el) {
+          for (casadi_int el_s : sp_row[os]) {
+            casadi_int ca = z_ind[k * nz + sp_col[el_s]];
+            double sa = z_scale[k * nz + sp_col[el_s]];
+            if (ca<0) continue;
+            src.push_back(k * sp.nnz() + el_s);
+            dst_row.push_back(row[el]);
+            dst_col.push_back(ca);
+            scale.push_back(Jy.nonzeros()[el] * sa);
+          }
+        }
+      }
+    }
+    // Substitute y = 0, the result does not depend on y
+    r = MX::substitute(r, y, MX::zeros(y.sparsity()));
+    // Sparsity pattern of the result
+    Sparsity sp = r.sparsity() + Sparsity::triplet(r.size1(), r.size2(), dst_row, dst_col);
+    r = project(r, sp);
+    // Add the block nonzeros
+    std::vector<casadi_int> dst(dst_row.size());
+    for (casadi_int k=0; k<dst.size(); ++k) dst[k] = dst_row[k] + dst_col[k] * sp.size1();
+    sp.get_nz(dst);
+    MX vals = blocks->get_nzref(Sparsity::dense(src.size()), src);
+    if (!std::all_of(scale.begin(), scale.end(), [](double s) { return s==1;})) {
+      vals = vals * DM(scale);
+    }
+    res[target[t]] = vals->get_nzadd(r, dst);
+  }
+
+  // Remaining outputs
+  if (!s_std.empty()) {
+    Function f_std = oracle_.factory(fname + "_std", s_in, s_std, aux);
+    std::vector<MX> res_std = f_std(arg);
+    for (casadi_int i=0, k=0; i<s_out.size(); ++i) {
+      if (std::find(target.begin(), target.end(), i)==target.end()) res[i] = res_std[k++];
+    }
+  }
+  if (verbose_) {
+    casadi_message(fname + ": Exploiting " + str(n_stage) + " stages of " + fmap.name());
+  }
+  return Function(fname, arg, res, s_in, s_out, opts);
+}
+
 Function OracleFunction::create_forward(const std::string& fname, casadi_int nfwd) {
   // Create derivative
   Function ret = get_function(fname).forward(nfwd);
@@ -270,7 +970,7 @@ set_function(const Function& fcn, const std::string& fname, bool jit) {
 
 int OracleFunction::
 calc_function(OracleMemory* m, const std::string& fcn,
-              const double* const* arg, int thread_id) const {
+              const double* const* arg, int thread_id, int fcn_mem) const {
   auto ml = m->thread_local_mem.at(thread_id);
   // Is the function monitored?
   bool monitored = this->monitored(fcn);
@@ -324,9 +1024,20 @@ calc_function(OracleMemory* m, const std::string& fcn,
     casadi_message(s.str());
   }
 
-  // Evaluate memory-less
+  // Evaluate split over the threads?
+  bool split = thread_id==0 && !m->in_parallel
+    && split_functions_.find(fcn)!=split_functions_.end();
+
+  // Evaluate memory-less, unless a memory object was provided
   try {
-    if (f(ml->arg, ml->res, ml->iw, ml->w)) {
+    if (split) {
+      int flag = calc_split(m, fcn, ml->arg, ml->res);
+      if (flag) {
+        if (monitored) casadi_message(name_ + ":" + fcn + " failed");
+        return flag;
+      }
+    } else if (fcn_mem >= 0 ? f(ml->arg, ml->res, ml->iw, ml->w, fcn_mem)
+                            : f(ml->arg, ml->res, ml->iw, ml->w)) {
       // Recoverable error
       if (monitored) casadi_message(name_ + ":" + fcn + " failed");
       return 1;
@@ -384,6 +1095,112 @@ calc_function(OracleMemory* m, const std::string& fcn,
   return 0;
 }
 
+void OracleFunction::calc_functions_thread(OracleMemory* m,
+    const std::vector<OracleCall>& calls, casadi_int t, casadi_int n_thread,
+    int* flag, double* t_call, std::string* err) const {
+  auto ml = m->thread_local_mem[t];
+  try {
+    for (casadi_int i=t; i<calls.size(); i+=n_thread) {
+      const OracleCall& c = calls[i];
+      std::copy(c.arg.begin(), c.arg.end(), ml->arg);
+      std::copy(c.res.begin(), c.res.end(), ml->res);
+      // Timing of the call, from the statistics updated by calc_function
+      const FStats& fstats = ml->fstats.at(c.fcn);
+      double t_wall = fstats.t_wall;
+      flag[i] = calc_function(m, c.fcn, nullptr, t);
+      t_call[i] = fstats.t_wall - t_wall;
+    }
+  } catch (std::exception& e) {
+    // Pass on to the calling thread, if requested
+    if (err == nullptr) throw;
+    *err = e.what();
+  }
+}
+
+const double OracleFunction::min_thread_time = 1e-4;
+
+int OracleFunction::calc_functions(OracleMemory* m,
+    const std::vector<OracleCall>& calls) const {
+  // Number of threads to be used
+  casadi_int n_thread = m->in_parallel ? 1
+    : std::min<casadi_int>(max_num_threads_, calls.size());
+  if (n_thread>1) {
+    // Only spawn threads if the calls they take over are expensive enough,
+    // as estimated from the last evaluation of each function
+    double t_moved = 0;
+    for (casadi_int i=0; i<calls.size(); ++i) {
+      if (i % n_thread == 0) continue;
+      auto it = m->t_call.find(calls[i].fcn);
+      if (it!=m->t_call.end()) t_moved += it->second;
+    }
+    if (t_moved < min_thread_time) n_thread = 1;
+  }
+  // Return flags and timings
+  std::vector<int> flag(calls.size(), 0);
+  std::vector<double> t_call(calls.size(), 0);
+  if (n_thread<=1) {
+    calc_functions_thread(m, calls, 0, 1, get_ptr(flag), get_ptr(t_call), nullptr);
+  } else {
+#ifdef CASADI_WITH_THREAD
+    // Error messages from the threads
+    std::vector<std::string> err(n_thread);
+    // Spawn threads, the calling thread takes the first share
+    m->in_parallel = true;
+    std::vector<std::thread> threads;
+    for (casadi_int t=1; t<n_thread; ++t) {
+      threads.emplace_back(&OracleFunction::calc_functions_thread, this, m, std::cref(calls),
+        t, n_thread, get_ptr(flag), get_ptr(t_call), &err[t]);
+    }
+    calc_functions_thread(m, calls, 0, n_thread, get_ptr(flag), get_ptr(t_call), &err[0]);
+    // Join threads
+    for (auto&& th : threads) th.join();
+    m->in_parallel = false;
+    for (const std::string& e : err) {
+      if (!e.empty()) casadi_error(e);
+    }
+#endif // CASADI_WITH_THREAD
+  }
+  // Keep the timings for the next call
+  for (casadi_int i=0; i<calls.size(); ++i) m->t_call[calls[i].fcn] = t_call[i];
+  // First failure, if any
+  for (int e : flag) if (e) return e;
+  return 0;
+}
+
+int OracleFunction::calc_split(OracleMemory* m, const std::string& fcn,
+    const double** arg, double** res) const {
+  const SplitFun& sf = split_functions_.at(fcn);
+  casadi_int n_in = get_function(fcn).n_in();
+  double* r = res[sf.oind];
+  // One call per group of colours, followed by the remaining outputs
+  double* buf = get_ptr(m->split_buf) + sf.buf_offset;
+  std::vector<OracleCall> calls(sf.parts.size());
+  for (casadi_int g=0; g<sf.parts.size(); ++g) {
+    calls[g].fcn = sf.parts[g];
+    calls[g].arg.assign(arg, arg + n_in);
+    calls[g].res = {r ? buf : nullptr};
+    buf += sf.nz[g].size();
+  }
+  if (!sf.rem.empty()) {
+    OracleCall c;
+    c.fcn = sf.rem;
+    c.arg.assign(arg, arg + n_in);
+    for (casadi_int i : sf.rem_out) c.res.push_back(res[i]);
+    calls.push_back(c);
+  }
+  int flag = calc_functions(m, calls);
+  if (flag) return flag;
+  // Scatter the nonzeros
+  if (r) {
+    casadi_clear(r, get_function(fcn).nnz_out(sf.oind));
+    buf = get_ptr(m->split_buf) + sf.buf_offset;
+    for (const std::vector<casadi_int>& nz : sf.nz) {
+      for (casadi_int k : nz) r[k] = *buf++;
+    }
+  }
+  return 0;
+}
+
 int OracleFunction::calc_sp_forward(const std::string& fcn, const bvec_t** arg, bvec_t** res,
     casadi_int* iw, bvec_t* w) const {
   return get_function(fcn)(arg, res, iw, w);
@@ -427,7 +1244,22 @@ void OracleFunction::expand() {
 
 Dict OracleFunction::get_stats(void *mem) const {
   Dict stats = FunctionInternal::get_stats(mem);
-  //auto m = static_cast<OracleMemory*>(mem);
+  auto m = static_cast<OracleMemory*>(mem);
+  // Timings per thread
+  if (max_num_threads_>1) {
+    std::vector<Dict> thread_stats;
+    for (auto&& fstats : m->thread_stats) {
+      Dict s;
+      for (auto&& e : fstats) {
+        if (e.second.n_call==0) continue;
+        s["n_call_" + e.first] = e.second.n_call;
+        s["t_wall_" + e.first] = e.second.t_wall;
+        s["t_proc_" + e.first] = e.second.t_proc;
+      }
+      thread_stats.push_back(s);
+    }
+    stats["thread_stats"] = thread_stats;
+  }
   return stats;
 }
 
@@ -456,6 +1288,9 @@ int OracleFunction::init_mem(void* mem) const {
 
   casadi_assert_dev(m->thread_local_mem.empty());
 
+  // Buffer for split function evaluations
+  m->split_buf.resize(sz_split_buf_);
+
   // Allocate and initialize local memory for threads
   for (int i = 0; i < max_num_threads_; ++i) {
     m->thread_local_mem.push_back(new LocalOracleMemory());
@@ -525,7 +1360,7 @@ bool OracleFunction::has_function(const std::string& fname) const {
 void OracleFunction::serialize_body(SerializingStream &s) const {
   FunctionInternal::serialize_body(s);
 
-  s.version("OracleFunction", 3);
+  s.version("OracleFunction", 4);
   s.pack("OracleFunction::oracle", oracle_);
   s.pack("OracleFunction::common_options", common_options_);
   s.pack("OracleFunction::specific_options", specific_options_);
@@ -555,12 +1390,24 @@ void OracleFunction::serialize_body(SerializingStream &s) const {
   s.pack("OracleFunction::stride_res", stride_res_);
   s.pack("OracleFunction::stride_iw", stride_iw_);
   s.pack("OracleFunction::stride_w", stride_w_);
+  s.pack("OracleFunction::split", split_);
+  s.pack("OracleFunction::split_functions::size", split_functions_.size());
+  for (auto &e : split_functions_) {
+    s.pack("OracleFunction::split_functions::key", e.first);
+    s.pack("OracleFunction::split_functions::value::oind", e.second.oind);
+    s.pack("OracleFunction::split_functions::value::rem", e.second.rem);
+    s.pack("OracleFunction::split_functions::value::rem_out", e.second.rem_out);
+    s.pack("OracleFunction::split_functions::value::parts", e.second.parts);
+    s.pack("OracleFunction::split_functions::value::nz", e.second.nz);
+    s.pack("OracleFunction::split_functions::value::buf_offset", e.second.buf_offset);
+  }
+  s.pack("OracleFunction::sz_split_buf", sz_split_buf_);
 
 }
 
 OracleFunction::OracleFunction(DeserializingStream& s) : FunctionInternal(s) {
 
-  int version = s.version("OracleFunction", 1, 3);
+  int version = s.version("OracleFunction", 1, 4);
   s.unpack("OracleFunction::oracle", oracle_);
   s.unpack("OracleFunction::common_options", common_options_);
   s.unpack("OracleFunction::specific_options", specific_options_);
@@ -612,6 +1459,25 @@ OracleFunction::OracleFunction(DeserializingStream& s) : FunctionInternal(s) {
     stride_iw_ = 0;
     stride_w_ = 0;
   }
+  sz_split_buf_ = 0;
+  detect_map_ = false;
+  cache_derived_ = false;
+  if (version>=4) {
+    s.unpack("OracleFunction::split", split_);
+    s.unpack("OracleFunction::split_functions::size", size);
+    for (casadi_int i=0;i<size;++i) {
+      std::string key;
+      s.unpack("OracleFunction::split_functions::key", key);
+      SplitFun& sf = split_functions_[key];
+      s.unpack("OracleFunction::split_functions::value::oind", sf.oind);
+      s.unpack("OracleFunction::split_functions::value::rem", sf.rem);
+      s.unpack("OracleFunction::split_functions::value::rem_out", sf.rem_out);
+      s.unpack("OracleFunction::split_functions::value::parts", sf.parts);
+      s.unpack("OracleFunction::split_functions::value::nz", sf.nz);
+      s.unpack("OracleFunction::split_functions::value::buf_offset", sf.buf_offset);
+    }
+    s.unpack("OracleFunction::sz_split_buf", sz_split_buf_);
+  }
 }
 
 } // namespace casadi
@@ -28,6 +28,8 @@
 
 #include "function_internal.hpp"
 
+#include <memory>
+
 /// \cond INTERNAL
 namespace casadi {
 
@@ -53,6 +55,19 @@ namespace casadi {
     double* w;
 
     std::vector<LocalOracleMemory*> thread_local_mem;
+
+    // Timing statistics of the threads, collected by join_results
+    std::vector<std::map<std::string, FStats>> thread_stats;
+
+    // Buffer for the parts of split function evaluations
+    std::vector<double> split_buf;
+
+    // Set while the threads are busy, disables nested parallel evaluation
+    bool in_parallel = false;
+
+    // Wall time [s] of the last call of each function in calc_functions
+    std::map<std::string, double> t_call;
+
     ~OracleMemory();
   };
 
@@ -64,6 +79,10 @@ namespace casadi {
       \identifier{d} */
   class CASADI_EXPORT OracleFunction : public FunctionInternal {
   protected:
+    // Key in the shared cache of derived functions: hash of the serialized oracle
+    // and serialization of the other arguments of the factory call
+    typedef std::pair<std::size_t, std::string> DerivedKey;
+
     /// Oracle: Used to generate other functions
     Function oracle_;
 
@@ -94,6 +113,51 @@ namespace casadi {
     // Memory stride in case of multipel threads
     size_t stride_arg_, stride_res_, stride_iw_, stride_w_;
 
+    // Functions to be evaluated split over the threads
+    std::vector<std::string> split_;
+
+    // Evaluation of a Jacobian or Hessian output by column colour groups
+    struct SplitFun {
+      // Output that is split
+      casadi_int oind;
+      // Function for the remaining outputs, if any, and their indices
+      std::string rem;
+      std::vector<casadi_int> rem_out;
+      // One function per group of colours, returning part of the nonzeros
+      std::vector<std::string> parts;
+      // Nonzero of the split output corresponding to each returned entry
+      std::vector<std::vector<casadi_int>> nz;
+      // Location in OracleMemory::split_buf
+      casadi_int buf_offset;
+    };
+    std::map<std::string, SplitFun> split_functions_;
+
+    // Total size of OracleMemory::split_buf
+    casadi_int sz_split_buf_;
+
+    // Exploit the stage structure of a Map call in the oracle
+    bool detect_map_;
+
+    // Share derived functions between instances with identical oracles
+    bool cache_derived_;
+
+    // Serialized oracle, null if it cannot be serialized, its hash and the oracle serialized
+    std::shared_ptr<const std::string> oracle_str_;
+    std::size_t oracle_hash_;
+    Function serialized_oracle_;
+
+    // Entries of the shared cache used by this instance
+    std::vector<DerivedKey> derived_keys_;
+
+    // Key of a derived function in the shared cache, false if not to be cached
+    bool derived_key(const Function& oracle, const std::string& fname,
+      const std::vector<std::string>& s_in,
+      const std::vector<std::string>& s_out,
+      const Function::AuxOut& aux, const Dict& opts, DerivedKey& key);
+
+    // Is a serialized oracle in the shared cache identical to the one of this instance?
+    bool same_oracle(const std::shared_ptr<const std::string>& oracle_str) const;
+
   public:
     /** \brief  Constructor
 
@@ -154,6 +218,17 @@ namespace casadi {
       const std::vector<std::string>& s_out,
       const Dict& opts=Dict());
 
+    /** \brief Create an oracle function exploiting a Map call in the oracle
+
+     * Jacobian and Hessian outputs are assembled from derivatives of the mapped
+     * function, evaluated once per stage. Returns a null Function if the structure
+     * cannot be exploited.
+     */
+    Function create_map_structured(const std::string& fname,
+      const std::vector<std::string>& s_in,
+      const std::vector<std::string>& s_out,
+      const Function::AuxOut& aux, const Dict& opts) const;
+
     /** Create an oracle function as a forward derivative of a different function */
     Function create_forward(const std::string& fname, casadi_int nfwd);
 
@@ -163,9 +238,45 @@ namespace casadi {
     /** Register the function for evaluation and statistics gathering */
     void set_function(const Function& fcn) { set_function(fcn, fcn.name()); }
 
-    // Calculate an oracle function
+    // Calculate an oracle function, optionally with a memory object of its own
     int calc_function(OracleMemory* m, const std::string& fcn,
-      const double* const* arg=nullptr, int thread_id=0) const;
+      const double* const* arg=nullptr, int thread_id=0, int fcn_mem=-1) const;
+
+    /// Oracle function call, for concurrent evaluation
+    struct OracleCall {
+      std::string fcn;
+      std::vector<const double*> arg;
+      std::vector<double*> res;
+    };
+
+    /** \brief Calculate independent oracle functions, concurrently if possible
+
+     * Call i is evaluated by thread i modulo max_num_threads. The evaluation is serial
+     * when the calls of the other threads took less than min_thread_time the last time.
+     * Returns the first nonzero return flag of calc_function, if any.
+     */
+    int calc_functions(OracleMemory* m, const std::vector<OracleCall>& calls) const;
+
+    // Evaluate the share of calc_functions of thread t
+    void calc_functions_thread(OracleMemory* m, const std::vector<OracleCall>& calls,
+      casadi_int t, casadi_int n_thread, int* flag, double* t_call, std::string* err) const;
+
+    /// Minimum time [s] of the calls taken over by other threads for calc_functions to spawn them
+    static const double min_thread_time;
+
+    /** \brief Prepare the evaluation of a function split over the threads
+
+     * The first Jacobian or Hessian output is calculated by forward derivatives
+     * of groups of structurally orthogonal columns, one group per thread.
+     */
+    void split_function(const Function& oracle, const std::string& fname,
+      const std::vector<std::string>& s_in,
+      const std::vector<std::string>& s_out,
+      const Function::AuxOut& aux);
+
+    // Evaluate a function that has been split over the threads
+    int calc_split(OracleMemory* m, const std::string& fcn,
+      const double** arg, double** res) const;
 
     // Forward sparsity propagation through a function
     int calc_sp_forward(const std::string& fcn, const bvec_t** arg, bvec_t** res,
@@ -261,6 +261,8 @@ namespace casadi {
     // Problem has not been solved at this point
     m->success = false;
     m->unified_return_status = SOLVER_RET_UNKNOWN;
+    m->iter_count = 0;
+    m->n_fact = 0;
 
     return 0;
   }
@@ -287,6 +289,8 @@ namespace casadi {
     // Problem has not been solved at this point
     m->success = false;
     m->unified_return_status = SOLVER_RET_UNKNOWN;
+    m->iter_count = 0;
+    m->n_fact = 0;
 
     // Get input pointers
     m->iarg = arg;
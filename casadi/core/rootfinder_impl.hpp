@@ -48,6 +48,9 @@ namespace casadi {
 
     // Return status
     UnifiedReturnStatus unified_return_status;
+
+    // Number of iterations and Jacobian factorizations, if counted by the plugin
+    casadi_int iter_count, n_fact;
   };
 
   /// Internal class
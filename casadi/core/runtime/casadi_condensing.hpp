@@ -0,0 +1,263 @@
+//
+//    MIT No Attribution
+//
+//    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+//    software and associated documentation files (the "Software"), to deal in the Software
+//    without restriction, including without limitation the rights to use, copy, modify,
+//    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+// C-REPLACE "std::numeric_limits<T1>::infinity()" "casadi_inf"
+// SYMBOL "condensing_prob"
+template<typename T1>
+struct casadi_condensing_prob {
+  // Number of variables, constraints, eliminated variables and remaining constraints
+  casadi_int nx, na, ne, nr;
+  // Sparsity patterns of H, A and A'
+  const casadi_int *sp_h, *sp_a, *sp_at;
+  // Sparsity patterns of the elimination matrix T, T', H*T and A*T
+  const casadi_int *sp_t, *sp_tt, *sp_ht, *sp_atm;
+  // Sparsity patterns of the condensed H and A
+  const casadi_int *sp_hc, *sp_ac;
+  // For each variable: position among the remaining variables, or -1-e if eliminated by e
+  const casadi_int* ivar;
+  // Remaining variables, length nx-ne
+  const casadi_int* free_var;
+  // Eliminated constraints, their pivot variables and pivot nonzeros in A', length ne
+  const casadi_int *elim_row, *elim_var, *piv_nz;
+  // Remaining constraints, length nr
+  const casadi_int* keep_row;
+  // Nonzeros of the condensed A: nonzero k of A*T if k>=0, nonzero -1-k of T otherwise
+  const casadi_int* ac_map;
+  // Pivots are rejected below piv_tol times the largest entry of their constraint
+  T1 piv_tol;
+};
+// C-REPLACE "casadi_condensing_prob<T1>" "struct casadi_condensing_prob"
+
+// SYMBOL "condensing_data"
+template<typename T1>
+struct casadi_condensing_data {
+  // Problem structure
+  const casadi_condensing_prob<T1>* prob;
+  // A', T, T', H*T, A*T and A*t
+  T1 *at, *tm, *tt, *ht, *atm, *av;
+  // Offset t, such that x = T*y + t
+  T1* t;
+  // Condensed QP
+  T1 *hc, *gc, *ac, *lbx, *ubx, *lba, *uba, *x0, *lam_x0, *lam_a0;
+  // Solution of the condensed QP
+  T1 *x, *lam_x, *lam_a;
+  // Expanded solution
+  T1 *z, *lam_z, *lam_g;
+  // Work vectors
+  T1* w;
+  casadi_int* iw;
+};
+// C-REPLACE "casadi_condensing_data<T1>" "struct casadi_condensing_data"
+
+// SYMBOL "condensing_work"
+template<typename T1>
+void casadi_condensing_work(const casadi_condensing_prob<T1>* p,
+    casadi_int* sz_iw, casadi_int* sz_w) {
+  // Local variables
+  casadi_int nf, nc;
+  nf = p->nx - p->ne;
+  nc = p->nr + p->ne;
+  // Temporary memory for the transposes
+  *sz_iw = p->na > nf ? p->na : nf;
+  // Elimination matrices
+  *sz_w = casadi_sp_nnz(p->sp_at) + casadi_sp_nnz(p->sp_t) + casadi_sp_nnz(p->sp_tt)
+    + casadi_sp_nnz(p->sp_ht) + casadi_sp_nnz(p->sp_atm) + p->na + p->nx;
+  // Condensed QP and its solution
+  *sz_w += casadi_sp_nnz(p->sp_hc) + casadi_sp_nnz(p->sp_ac) + 6*nf + 4*nc;
+  // Expanded solution
+  *sz_w += 2*p->nx + p->na;
+  // Dense work vector
+  *sz_w += p->na > p->nx ? p->na : p->nx;
+}
+
+// SYMBOL "condensing_init"
+template<typename T1>
+void casadi_condensing_init(casadi_condensing_data<T1>* d, casadi_int** iw, T1** w) {
+  // Local variables
+  casadi_int nf, nc;
+  const casadi_condensing_prob<T1>* p = d->prob;
+  nf = p->nx - p->ne;
+  nc = p->nr + p->ne;
+  // Assign memory
+  d->at = *w; *w += casadi_sp_nnz(p->sp_at);
+  d->tm = *w; *w += casadi_sp_nnz(p->sp_t);
+  d->tt = *w; *w += casadi_sp_nnz(p->sp_tt);
+  d->ht = *w; *w += casadi_sp_nnz(p->sp_ht);
+  d->atm = *w; *w += casadi_sp_nnz(p->sp_atm);
+  d->av = *w; *w += p->na;
+  d->t = *w; *w += p->nx;
+  d->hc = *w; *w += casadi_sp_nnz(p->sp_hc);
+  d->ac = *w; *w += casadi_sp_nnz(p->sp_ac);
+  d->gc = *w; *w += nf;
+  d->lbx = *w; *w += nf;
+  d->ubx = *w; *w += nf;
+  d->x0 = *w; *w += nf;
+  d->lam_x0 = *w; *w += nf;
+  d->lba = *w; *w += nc;
+  d->uba = *w; *w += nc;
+  d->lam_a0 = *w; *w += nc;
+  d->x = *w; *w += nf;
+  d->lam_x = *w; *w += nf;
+  d->lam_a = *w; *w += nc;
+  d->z = *w; *w += p->nx;
+  d->lam_z = *w; *w += p->nx;
+  d->lam_g = *w; *w += p->na;
+  d->w = *w; *w += p->na > p->nx ? p->na : p->nx;
+  d->iw = *iw; *iw += p->na > nf ? p->na : nf;
+}
+
+// SYMBOL "condensing_form"
+// Eliminate variables with the equality constraints and form the condensed QP
+// Returns 1 if an eliminated constraint is not an equality, 2 if a pivot is too small
+template<typename T1>
+int casadi_condensing_form(casadi_condensing_data<T1>* d, const T1* h, const T1* g,
+    const T1* a, const T1* lba, const T1* uba, const T1* lbx, const T1* ubx,
+    const T1* x0, const T1* lam_x0, const T1* lam_a0) {
+  // Local variables
+  casadi_int nf, j, e, i, k, k1, c, r;
+  const casadi_int *colind_tt, *row_tt, *colind_at, *row_at;
+  T1 b, piv, amax;
+  const casadi_condensing_prob<T1>* p = d->prob;
+  nf = p->nx - p->ne;
+  colind_tt = p->sp_tt + 2;
+  row_tt = colind_tt + p->nx + 1;
+  colind_at = p->sp_at + 2;
+  row_at = colind_at + p->na + 1;
+  // Constraints row-wise
+  casadi_trans(a, p->sp_a, d->at, p->sp_at, d->iw);
+  // Rows of T and t, in the order of the variables
+  for (j = 0; j < p->nx; ++j) {
+    e = p->ivar[j];
+    if (e >= 0) {
+      // Remaining variable
+      d->tt[colind_tt[j]] = 1;
+      d->t[j] = 0;
+      continue;
+    }
+    // Eliminated variable
+    e = -1 - e;
+    i = p->elim_row[e];
+    b = lba ? lba[i] : -std::numeric_limits<T1>::infinity();
+    if (b != (uba ? uba[i] : std::numeric_limits<T1>::infinity())) return 1;
+    piv = d->at[p->piv_nz[e]];
+    amax = 0;
+    for (k = colind_at[i]; k < colind_at[i + 1]; ++k) {
+      if (fabs(d->at[k]) > amax) amax = fabs(d->at[k]);
+    }
+    if (fabs(piv) <= p->piv_tol * amax) return 2;
+    for (k = colind_tt[j]; k < colind_tt[j + 1]; ++k) d->w[row_tt[k]] = 0;
+    for (k = colind_at[i]; k < colind_at[i + 1]; ++k) {
+      c = row_at[k];
+      if (c == j) continue;
+      b -= d->at[k] * d->t[c];
+      for (k1 = colind_tt[c]; k1 < colind_tt[c + 1]; ++k1) {
+        d->w[row_tt[k1]] += d->at[k] * d->tt[k1];
+      }
+    }
+    for (k = colind_tt[j]; k < colind_tt[j + 1]; ++k) d->tt[k] = -d->w[row_tt[k]] / piv;
+    d->t[j] = b / piv;
+  }
+  casadi_trans(d->tt, p->sp_tt, d->tm, p->sp_t, d->iw);
+  // Condensed Hessian T'*H*T
+  casadi_clear(d->ht, casadi_sp_nnz(p->sp_ht));
+  casadi_mtimes(h, p->sp_h, d->tm, p->sp_t, d->ht, p->sp_ht, d->w, 0);
+  casadi_clear(d->hc, casadi_sp_nnz(p->sp_hc));
+  casadi_mtimes(d->tt, p->sp_tt, d->ht, p->sp_ht, d->hc, p->sp_hc, d->w, 0);
+  // Condensed gradient T'*(g + H*t)
+  casadi_copy(g, p->nx, d->z);
+  casadi_mv(h, p->sp_h, d->t, d->z, 0);
+  casadi_clear(d->gc, nf);
+  casadi_mv(d->tt, p->sp_tt, d->z, d->gc, 0);
+  // Condensed constraints: remaining constraints, then bounds on eliminated variables
+  casadi_clear(d->atm, casadi_sp_nnz(p->sp_atm));
+  casadi_mtimes(a, p->sp_a, d->tm, p->sp_t, d->atm, p->sp_atm, d->w, 0);
+  for (k = 0; k < casadi_sp_nnz(p->sp_ac); ++k) {
+    d->ac[k] = p->ac_map[k] >= 0 ? d->atm[p->ac_map[k]] : d->tm[-1 - p->ac_map[k]];
+  }
+  casadi_clear(d->av, p->na);
+  casadi_mv(a, p->sp_a, d->t, d->av, 0);
+  for (r = 0; r < p->nr; ++r) {
+    i = p->keep_row[r];
+    d->lba[r] = (lba ? lba[i] : -std::numeric_limits<T1>::infinity()) - d->av[i];
+    d->uba[r] = (uba ? uba[i] : std::numeric_limits<T1>::infinity()) - d->av[i];
+    d->lam_a0[r] = lam_a0 ? lam_a0[i] : 0;
+  }
+  for (e = 0; e < p->ne; ++e) {
+    j = p->elim_var[e];
+    d->lba[p->nr + e] = (lbx ? lbx[j] : -std::numeric_limits<T1>::infinity()) - d->t[j];
+    d->uba[p->nr + e] = (ubx ? ubx[j] : std::numeric_limits<T1>::infinity()) - d->t[j];
+    d->lam_a0[p->nr + e] = lam_x0 ? lam_x0[j] : 0;
+  }
+  // Bounds and initial guess for the remaining variables
+  for (k = 0; k < nf; ++k) {
+    j = p->free_var[k];
+    d->lbx[k] = lbx ? lbx[j] : -std::numeric_limits<T1>::infinity();
+    d->ubx[k] = ubx ? ubx[j] : std::numeric_limits<T1>::infinity();
+    d->x0[k] = x0 ? x0[j] : 0;
+    d->lam_x0[k] = lam_x0 ? lam_x0[j] : 0;
+  }
+  return 0;
+}
+
+// SYMBOL "condensing_expand"
+// Recover the solution of the original QP from the solution of the condensed QP
+template<typename T1>
+void casadi_condensing_expand(casadi_condensing_data<T1>* d, const T1* h, const T1* g,
+    T1* f, T1* x, T1* lam_x, T1* lam_a) {
+  // Local variables
+  casadi_int nf, j, e, i, k, r;
+  const casadi_int *colind_at, *row_at;
+  T1 l;
+  const casadi_condensing_prob<T1>* p = d->prob;
+  nf = p->nx - p->ne;
+  colind_at = p->sp_at + 2;
+  row_at = colind_at + p->na + 1;
+  // Primal solution x = T*y + t
+  casadi_copy(d->t, p->nx, d->z);
+  casadi_mv(d->tm, p->sp_t, d->x, d->z, 0);
+  // Multipliers of the bounds and of the remaining constraints
+  for (k = 0; k < nf; ++k) d->lam_z[p->free_var[k]] = d->lam_x[k];
+  for (e = 0; e < p->ne; ++e) d->lam_z[p->elim_var[e]] = d->lam_a[p->nr + e];
+  casadi_clear(d->lam_g, p->na);
+  for (r = 0; r < p->nr; ++r) d->lam_g[p->keep_row[r]] = d->lam_a[r];
+  // Gradient of the Lagrangian, w = H*x + g + A'*lam_a + lam_x
+  casadi_copy(g, p->nx, d->w);
+  casadi_mv(h, p->sp_h, d->z, d->w, 0);
+  for (i = 0; i < p->na; ++i) {
+    for (k = colind_at[i]; k < colind_at[i + 1]; ++k) d->w[row_at[k]] += d->at[k] * d->lam_g[i];
+  }
+  for (j = 0; j < p->nx; ++j) d->w[j] += d->lam_z[j];
+  // Multipliers of the eliminated constraints, by backward substitution
+  for (e = p->ne - 1; e >= 0; --e) {
+    i = p->elim_row[e];
+    l = -d->w[p->elim_var[e]] / d->at[p->piv_nz[e]];
+    d->lam_g[i] = l;
+    for (k = colind_at[i]; k < colind_at[i + 1]; ++k) d->w[row_at[k]] += d->at[k] * l;
+  }
+  // Objective value
+  if (f) {
+    *f = 0.5 * casadi_bilin(h, p->sp_h, d->z, d->z);
+    if (g) *f += casadi_dot(p->nx, d->z, g);
+  }
+  // Get solution
+  casadi_copy(d->z, p->nx, x);
+  casadi_copy(d->lam_z, p->nx, lam_x);
+  casadi_copy(d->lam_g, p->na, lam_a);
+}
@@ -0,0 +1,90 @@
+//
+//    MIT No Attribution
+//
+//    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+//    software and associated documentation files (the "Software"), to deal in the Software
+//    without restriction, including without limitation the rights to use, copy, modify,
+//    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+// C-REPLACE "fabs" "casadi_fabs"
+// C-REPLACE "fmax" "casadi_fmax"
+// C-REPLACE "fmin" "casadi_fmin"
+
+// SYMBOL "dopri_err"
+// Scaled RMS norm of the local error estimate of a Dormand-Prince 5(4) step
+// The seven stages are stored with stride nk in k
+template<typename T1>
+T1 casadi_dopri_err(casadi_int n, casadi_int nk, T1 h, const T1* x0, const T1* xf,
+    const T1* k, T1 abstol, T1 reltol) {
+  // Local variables
+  casadi_int i;
+  T1 e, sc, r;
+  r = 0;
+  for (i = 0; i < n; ++i) {
+    // Difference between the 5th and 4th order solutions
+    e = 71./57600 * k[i] - 71./16695 * k[i + 2 * nk] + 71./1920 * k[i + 3 * nk]
+      - 17253./339200 * k[i + 4 * nk] + 22./525 * k[i + 5 * nk] - 1./40 * k[i + 6 * nk];
+    sc = abstol + reltol * fmax(fabs(x0[i]), fabs(xf[i]));
+    e *= h / sc;
+    r += e * e;
+  }
+  return n == 0 ? 0 : sqrt(r / n);
+}
+
+// SYMBOL "dopri_h0"
+// Initial step size guess from the state and its time derivative
+template<typename T1>
+T1 casadi_dopri_h0(casadi_int n, const T1* x0, const T1* k1, T1 abstol, T1 reltol) {
+  // Local variables
+  casadi_int i;
+  T1 sc, d0, d1;
+  d0 = d1 = 0;
+  for (i = 0; i < n; ++i) {
+    sc = abstol + reltol * fabs(x0[i]);
+    d0 += (x0[i] / sc) * (x0[i] / sc);
+    d1 += (k1[i] / sc) * (k1[i] / sc);
+  }
+  if (d0 < 1e-10 || d1 < 1e-10) return 1e-6;
+  return 0.01 * sqrt(d0 / d1);
+}
+
+// SYMBOL "dopri_fac"
+// Step size factor from the error estimate of the last step
+template<typename T1>
+T1 casadi_dopri_fac(T1 err, T1 facmax) {
+  if (err == 0) return facmax;
+  return fmin(facmax, fmax(0.2, 0.9 * pow(err, -0.2)));
+}
+
+// SYMBOL "dopri_interp"
+// Continuous extension of a Dormand-Prince step (Shampine), 4th order
+// Evaluates y(t0 + theta*h) given y0 = y(t0), y1 = y(t0 + h) and the stages
+template<typename T1>
+void casadi_dopri_interp(casadi_int n, casadi_int nk, T1 theta, T1 h, const T1* y0,
+    const T1* y1, const T1* k, T1* y) {
+  // Local variables
+  casadi_int i;
+  T1 theta1, dy, bspl, d;
+  theta1 = 1 - theta;
+  for (i = 0; i < n; ++i) {
+    dy = y1[i] - y0[i];
+    bspl = h * k[i] - dy;
+    d = -12715105075./11282082432 * k[i] + 87487479700./32700410799 * k[i + 2 * nk]
+      - 10690763975./1880347072 * k[i + 3 * nk] + 701980252875./199316789632 * k[i + 4 * nk]
+      - 1453857185./822651844 * k[i + 5 * nk] + 69997945./29380423 * k[i + 6 * nk];
+    y[i] = y0[i] + theta * (dy + theta1 * (bspl + theta * (dy - h * k[i + 6 * nk] - bspl
+      + theta1 * h * d)));
+  }
+}
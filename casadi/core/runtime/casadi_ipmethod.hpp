@@ -0,0 +1,933 @@
+//
+//    MIT No Attribution
+//
+//    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+//    software and associated documentation files (the "Software"), to deal in the Software
+//    without restriction, including without limitation the rights to use, copy, modify,
+//    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+// C-REPLACE "casadi_nlpsol_prob<T1>" "struct casadi_nlpsol_prob"
+// C-REPLACE "casadi_nlpsol_data<T1>" "struct casadi_nlpsol_data"
+// C-REPLACE "fmin" "casadi_fmin"
+// C-REPLACE "fmax" "casadi_fmax"
+// C-REPLACE "fabs" "casadi_fabs"
+// C-REPLACE "std::numeric_limits<T1>::infinity()" "casadi_inf"
+// C-REPLACE "std::log" "log"
+// C-REPLACE "std::pow" "pow"
+
+// SYMBOL "ipmethod_prob"
+template<typename T1>
+struct casadi_ipmethod_prob {
+  const casadi_nlpsol_prob<T1>* nlp;
+  // Sparsity patterns of the Hessian, the Jacobian and the KKT system
+  const casadi_int *sp_h, *sp_a, *sp_kkt;
+  // LDL^T factorization in the runtime: sparsity of the factor and permutation, or null
+  const casadi_int *sp_lt, *ldl_p;
+  // Maximum number of iterations, of line-search trials, of filter entries
+  casadi_int max_iter, max_iter_ls, max_filter;
+  // Convergence tolerance, initial barrier parameter
+  T1 tol, mu_init;
+  // Barrier parameter update
+  T1 kappa_eps, kappa_mu, theta_mu, tau_min;
+  // Initial point: minimum absolute and relative distance to the bounds
+  T1 bound_push, bound_frac;
+  // Inertia correction
+  T1 delta_w_init, delta_w_min, delta_w_max, delta_c;
+  // Filter line search
+  T1 gamma_theta, gamma_phi, gamma_alpha, eta_phi, s_phi, s_theta, delta;
+  // Scaling of the optimality error
+  T1 s_max;
+  // Safeguard of the bound multipliers
+  T1 kappa_sigma;
+  // Infinity, machine precision
+  T1 inf, eps;
+};
+// C-REPLACE "casadi_ipmethod_prob<T1>" "struct casadi_ipmethod_prob"
+
+// SYMBOL "ipmethod_setup"
+template<typename T1>
+void casadi_ipmethod_setup(casadi_ipmethod_prob<T1>* p) {
+  p->sp_lt = 0;
+  p->ldl_p = 0;
+  p->max_iter = 1000;
+  p->max_iter_ls = 40;
+  p->max_filter = 100;
+  p->tol = 1e-8;
+  p->mu_init = 0.1;
+  p->kappa_eps = 10;
+  p->kappa_mu = 0.2;
+  p->theta_mu = 1.5;
+  p->tau_min = 0.99;
+  p->bound_push = 1e-2;
+  p->bound_frac = 1e-2;
+  p->delta_w_init = 1e-4;
+  p->delta_w_min = 1e-20;
+  p->delta_w_max = 1e40;
+  p->delta_c = 1e-8;
+  p->gamma_theta = 1e-5;
+  p->gamma_phi = 1e-8;
+  p->gamma_alpha = 0.05;
+  p->eta_phi = 1e-8;
+  p->s_phi = 2.3;
+  p->s_theta = 1.1;
+  p->delta = 1;
+  p->s_max = 100;
+  p->kappa_sigma = 1e10;
+  p->inf = std::numeric_limits<T1>::infinity();
+  p->eps = 2.220446049250313e-16;
+}
+
+// SYMBOL "ipmethod_flag_t"
+typedef enum {
+  IPMETHOD_SUCCESS,
+  IPMETHOD_MAX_ITER,
+  IPMETHOD_LS_FAILED,
+  IPMETHOD_REG_FAILED,
+  IPMETHOD_EVAL_ERROR,
+  IPMETHOD_SOLVE_ERROR,
+  IPMETHOD_USER_STOP
+} casadi_ipmethod_flag_t;
+
+// SYMBOL "ipmethod_task_t"
+typedef enum {
+  IPMETHOD_EVAL_FG,
+  IPMETHOD_EVAL_JAC,
+  IPMETHOD_EVAL_HESS,
+  IPMETHOD_FACTOR,
+  IPMETHOD_SOLVE,
+  IPMETHOD_PROGRESS} casadi_ipmethod_task_t;
+
+// SYMBOL "ipmethod_next_t"
+typedef enum {
+  IPMETHOD_RESET,
+  IPMETHOD_START,
+  IPMETHOD_NEWITER,
+  IPMETHOD_CHECK,
+  IPMETHOD_KKT,
+  IPMETHOD_INERTIA,
+  IPMETHOD_STEP,
+  IPMETHOD_LINESEARCH} casadi_ipmethod_next_t;
+
+// SYMBOL "ipmethod_type_t"
+typedef enum {
+  IPMETHOD_REGULAR,
+  IPMETHOD_FIXED,
+  IPMETHOD_FREE} casadi_ipmethod_type_t;
+
+// SYMBOL "ipmethod_data"
+template<typename T1>
+struct casadi_ipmethod_data {
+  // Problem structure
+  const casadi_ipmethod_prob<T1>* prob;
+  // NLP data
+  casadi_nlpsol_data<T1>* nlp;
+  // Solver status
+  casadi_ipmethod_flag_t status;
+  // User task
+  casadi_ipmethod_task_t task;
+  // Next step
+  casadi_ipmethod_next_t next;
+  // Iteration, line-search trials in the last iteration, number of filter entries
+  casadi_int iter, ls_iter, n_filter;
+  // Number of negative eigenvalues of the KKT matrix, -1 if singular
+  casadi_int neig;
+  // Step was accepted by the Armijo condition ('f'), the filter ('h'), after a filter reset
+  char info;
+  // Barrier parameter, fraction-to-boundary parameter
+  T1 mu, tau;
+  // Constraint violation and barrier function, directional derivative of the latter
+  T1 theta, phi, dphi;
+  // Bounds on the constraint violation in the filter line search
+  T1 theta_min, theta_max;
+  // Primal and dual step size, largest and smallest primal step size
+  T1 alpha, alpha_z, alpha_max, alpha_min;
+  // Regularization of the KKT matrix, last nonzero regularization
+  T1 delta_w, delta_c, delta_w_last;
+  // Primal infeasibility, dual infeasibility, complementarity and their scaling
+  T1 pr, du, co, sd, sc;
+  // Objective in the iterate and in the trial point
+  T1 f, f_cand;
+  // Type of each primal variable and constraint
+  casadi_int* type;
+  // Primal variables and slacks, constraint values
+  T1 *z, *z_cand, *g, *g_cand;
+  // Multipliers of the constraints, of the lower and upper bounds
+  T1 *y, *zl, *zu;
+  // Search direction
+  T1 *dz, *dy, *dzl, *dzu;
+  // Gradient of the objective, Jacobian of the constraints, Hessian of the Lagrangian
+  T1 *gf, *jac, *hess;
+  // KKT matrix, its diagonal and scaling, right-hand-side and solution
+  T1 *kkt, *D, *S, *linsys;
+  // Residual and work vector
+  T1* r;
+  casadi_int* iw_kkt;
+  // Filter entries (theta, phi)
+  T1* filter;
+  // LDL^T factorization in the runtime
+  T1 *lt, *ld, *lw;
+
+  const T1** arg;
+  T1** res;
+  casadi_int* iw;
+  T1* w;
+};
+// C-REPLACE "casadi_ipmethod_data<T1>" "struct casadi_ipmethod_data"
+
+// SYMBOL "ipmethod_work"
+template<typename T1>
+void casadi_ipmethod_work(const casadi_ipmethod_prob<T1>* p,
+    casadi_int* sz_iw, casadi_int* sz_w) {
+  // Local variables
+  casadi_int nx, ng, nz;
+  nx = p->nlp->nx;
+  ng = p->nlp->ng;
+  nz = nx + ng;
+  // Reset sz_w, sz_iw
+  *sz_w = *sz_iw = 0;
+  *sz_iw += nz; // type
+  *sz_iw += ng; // iw_kkt
+  *sz_w += nz; // z
+  *sz_w += nz; // z_cand
+  *sz_w += ng; // g
+  *sz_w += ng; // g_cand
+  *sz_w += ng; // y
+  *sz_w += nz; // zl
+  *sz_w += nz; // zu
+  *sz_w += nz; // dz
+  *sz_w += ng; // dy
+  *sz_w += nz; // dzl
+  *sz_w += nz; // dzu
+  *sz_w += nx; // gf
+  *sz_w += p->sp_a[2+p->sp_a[1]]; // jac
+  *sz_w += p->sp_h[2+p->sp_h[1]]; // hess
+  *sz_w += p->sp_kkt[2+p->sp_kkt[1]]; // kkt
+  *sz_w += nz; // D
+  *sz_w += nz; // S
+  *sz_w += nz; // linsys
+  *sz_w += nz; // r
+  *sz_w += 2*p->max_filter; // filter
+  if (p->sp_lt) {
+    *sz_w += p->sp_lt[2+p->sp_lt[1]]; // lt
+    *sz_w += nz; // ld
+    *sz_w += nz; // lw
+  }
+}
+
+// SYMBOL "ipmethod_init"
+template<typename T1>
+void casadi_ipmethod_init(casadi_ipmethod_data<T1>* d,
+    const T1*** arg, T1*** res, casadi_int** iw, T1** w) {
+  // Local variables
+  casadi_int nx, ng, nz;
+  const casadi_ipmethod_prob<T1>* p = d->prob;
+  nx = p->nlp->nx;
+  ng = p->nlp->ng;
+  nz = nx + ng;
+  d->type = *iw; *iw += nz;
+  d->iw_kkt = *iw; *iw += ng;
+  d->z = *w; *w += nz;
+  d->z_cand = *w; *w += nz;
+  d->g = *w; *w += ng;
+  d->g_cand = *w; *w += ng;
+  d->y = *w; *w += ng;
+  d->zl = *w; *w += nz;
+  d->zu = *w; *w += nz;
+  d->dz = *w; *w += nz;
+  d->dy = *w; *w += ng;
+  d->dzl = *w; *w += nz;
+  d->dzu = *w; *w += nz;
+  d->gf = *w; *w += nx;
+  d->jac = *w; *w += p->sp_a[2+p->sp_a[1]];
+  d->hess = *w; *w += p->sp_h[2+p->sp_h[1]];
+  d->kkt = *w; *w += p->sp_kkt[2+p->sp_kkt[1]];
+  d->D = *w; *w += nz;
+  d->S = *w; *w += nz;
+  d->linsys = *w; *w += nz;
+  d->r = *w; *w += nz;
+  d->filter = *w; *w += 2*p->max_filter;
+  if (p->sp_lt) {
+    d->lt = *w; *w += p->sp_lt[2+p->sp_lt[1]];
+    d->ld = *w; *w += nz;
+    d->lw = *w; *w += nz;
+  }
+  d->arg = *arg;
+  d->res = *res;
+  d->iw = *iw;
+  d->w = *w;
+  // New NLP
+  d->next = IPMETHOD_RESET;
+  d->status = IPMETHOD_SUCCESS;
+}
+
+// SYMBOL "ipmethod_push"
+// Move a value strictly inside its bounds
+template<typename T1>
+T1 casadi_ipmethod_push(const casadi_ipmethod_prob<T1>* p, T1 v, T1 lb, T1 ub) {
+  // Local variables
+  T1 pl, pu;
+  if (lb > -p->inf) {
+    pl = p->bound_push * fmax(1., fabs(lb));
+    if (ub < p->inf) pl = fmin(pl, p->bound_frac * (ub - lb));
+    v = fmax(v, lb + pl);
+  }
+  if (ub < p->inf) {
+    pu = p->bound_push * fmax(1., fabs(ub));
+    if (lb > -p->inf) pu = fmin(pu, p->bound_frac * (ub - lb));
+    v = fmin(v, ub - pu);
+  }
+  return v;
+}
+
+// SYMBOL "ipmethod_reset"
+template<typename T1>
+void casadi_ipmethod_reset(casadi_ipmethod_data<T1>* d) {
+  // Local variables
+  casadi_int k, nx, nz;
+  T1 lb, ub;
+  const casadi_ipmethod_prob<T1>* p = d->prob;
+  casadi_nlpsol_data<T1>* d_nlp = d->nlp;
+  nx = p->nlp->nx;
+  nz = nx + p->nlp->ng;
+  for (k = 0; k < nz; ++k) {
+    lb = d_nlp->lbz[k];
+    ub = d_nlp->ubz[k];
+    // Classify: fixed variables and equality constraints have no barrier terms,
+    // unbounded constraints are eliminated
+    if (ub <= lb) {
+      d->type[k] = IPMETHOD_FIXED;
+    } else if (k >= nx && lb <= -p->inf && ub >= p->inf) {
+      d->type[k] = IPMETHOD_FREE;
+    } else {
+      d->type[k] = IPMETHOD_REGULAR;
+    }
+    // Initial guess for the primal variables, strictly inside the bounds
+    if (k < nx) {
+      d->z[k] = d->type[k] == IPMETHOD_FIXED ? lb : casadi_ipmethod_push(p, d_nlp->z[k], lb, ub);
+    }
+    // Initial guess for the bound multipliers
+    d->zl[k] = d->type[k] == IPMETHOD_REGULAR && lb > -p->inf ? 1. : 0.;
+    d->zu[k] = d->type[k] == IPMETHOD_REGULAR && ub < p->inf ? 1. : 0.;
+  }
+  // Initial guess for the constraint multipliers
+  for (k = nx; k < nz; ++k) {
+    d->y[k - nx] = d->type[k] == IPMETHOD_FREE ? 0. : d_nlp->lam[k];
+  }
+  // Reset iteration variables
+  d->iter = 0;
+  d->ls_iter = 0;
+  d->n_filter = 0;
+  d->info = ' ';
+  d->mu = p->mu_init;
+  d->tau = fmax(p->tau_min, 1. - d->mu);
+  d->alpha = d->alpha_z = 0;
+  d->delta_w = d->delta_w_last = 0;
+}
+
+// SYMBOL "ipmethod_merit"
+// Constraint violation and barrier function
+template<typename T1>
+void casadi_ipmethod_merit(casadi_ipmethod_data<T1>* d, const T1* z, const T1* g, T1 f,
+    T1* theta, T1* phi) {
+  // Local variables
+  casadi_int k, nx, nz;
+  const casadi_ipmethod_prob<T1>* p = d->prob;
+  casadi_nlpsol_data<T1>* d_nlp = d->nlp;
+  nx = p->nlp->nx;
+  nz = nx + p->nlp->ng;
+  *theta = 0;
+  *phi = f;
+  for (k = 0; k < nz; ++k) {
+    if (k >= nx && d->type[k] != IPMETHOD_FREE) *theta += fabs(g[k - nx] - z[k]);
+    if (d->type[k] != IPMETHOD_REGULAR) continue;
+    if (d_nlp->lbz[k] > -p->inf) *phi -= d->mu * std::log(z[k] - d_nlp->lbz[k]);
+    if (d_nlp->ubz[k] < p->inf) *phi -= d->mu * std::log(d_nlp->ubz[k] - z[k]);
+  }
+}
+
+// SYMBOL "ipmethod_start"
+template<typename T1>
+void casadi_ipmethod_start(casadi_ipmethod_data<T1>* d) {
+  // Local variables
+  casadi_int k, nx, nz;
+  const casadi_ipmethod_prob<T1>* p = d->prob;
+  casadi_nlpsol_data<T1>* d_nlp = d->nlp;
+  nx = p->nlp->nx;
+  nz = nx + p->nlp->ng;
+  // Slacks from the constraint values in the initial guess
+  for (k = nx; k < nz; ++k) {
+    if (d->type[k] == IPMETHOD_FIXED) {
+      d->z[k] = d_nlp->lbz[k];
+    } else {
+      d->z[k] = casadi_ipmethod_push(p, d->g[k - nx], d_nlp->lbz[k], d_nlp->ubz[k]);
+    }
+  }
+  // Bounds on the constraint violation
+  casadi_ipmethod_merit(d, d->z, d->g, d->f, &d->theta, &d->phi);
+  d->theta_max = 1e4 * fmax(1., d->theta);
+  d->theta_min = 1e-4 * fmax(1., d->theta);
+}
+
+// SYMBOL "ipmethod_newiter"
+// Constraint violation, barrier function and optimality error in a new iterate
+template<typename T1>
+void casadi_ipmethod_newiter(casadi_ipmethod_data<T1>* d) {
+  // Local variables
+  casadi_int k, nx, ng, nz, nb;
+  T1 sum_y, sum_z;
+  const casadi_ipmethod_prob<T1>* p = d->prob;
+  casadi_nlpsol_data<T1>* d_nlp = d->nlp;
+  nx = p->nlp->nx;
+  ng = p->nlp->ng;
+  nz = nx + ng;
+  // Unbounded constraints are equal to their slacks
+  for (k = nx; k < nz; ++k) {
+    if (d->type[k] == IPMETHOD_FREE) d->z[k] = d->g[k - nx];
+  }
+  casadi_ipmethod_merit(d, d->z, d->g, d->f, &d->theta, &d->phi);
+  // Gradient of the Lagrangian with respect to the variables and slacks
+  casadi_copy(d->gf, nx, d->r);
+  casadi_mv(d->jac, p->sp_a, d->y, d->r, 1);
+  for (k = nx; k < nz; ++k) d->r[k] = -d->y[k - nx];
+  casadi_axpy(nz, -1., d->zl, d->r);
+  casadi_axpy(nz, 1., d->zu, d->r);
+  // Dual and primal infeasibility, scaling of the optimality error
+  d->du = d->pr = sum_y = sum_z = 0;
+  nb = 0;
+  for (k = 0; k < nz; ++k) {
+    if (d->type[k] == IPMETHOD_REGULAR) d->du = fmax(d->du, fabs(d->r[k]));
+    if (k >= nx && d->type[k] != IPMETHOD_FREE) {
+      d->pr = fmax(d->pr, fabs(d->g[k - nx] - d->z[k]));
+      sum_y += fabs(d->y[k - nx]);
+      nb++;
+    }
+    if (d->type[k] == IPMETHOD_REGULAR) {
+      if (d_nlp->lbz[k] > -p->inf) {
+        sum_z += d->zl[k];
+        nb++;
+      }
+      if (d_nlp->ubz[k] < p->inf) {
+        sum_z += d->zu[k];
+        nb++;
+      }
+    }
+  }
+  d->sd = nb == 0 ? 1. : fmax(p->s_max, (sum_y + sum_z) / nb) / p->s_max;
+  d->sc = nb == 0 ? 1. : fmax(p->s_max, sum_z / nb) / p->s_max;
+}
+
+// SYMBOL "ipmethod_err"
+// Optimality error of the barrier problem
+template<typename T1>
+T1 casadi_ipmethod_err(casadi_ipmethod_data<T1>* d, T1 mu) {
+  // Local variables
+  casadi_int k, nz;
+  T1 co;
+  const casadi_ipmethod_prob<T1>* p = d->prob;
+  casadi_nlpsol_data<T1>* d_nlp = d->nlp;
+  nz = p->nlp->nx + p->nlp->ng;
+  co = 0;
+  for (k = 0; k < nz; ++k) {
+    if (d->type[k] != IPMETHOD_REGULAR) continue;
+    if (d_nlp->lbz[k] > -p->inf) co = fmax(co, fabs(d->zl[k] * (d->z[k] - d_nlp->lbz[k]) - mu));
+    if (d_nlp->ubz[k] < p->inf) co = fmax(co, fabs(d->zu[k] * (d_nlp->ubz[k] - d->z[k]) - mu));
+  }
+  if (mu == 0) d->co = co;
+  return fmax(fmax(d->du / d->sd, d->pr), co / d->sc);
+}
+
+// SYMBOL "ipmethod_barrier"
+// Monotone (Fiacco-McCormick) update of the barrier parameter
+template<typename T1>
+void casadi_ipmethod_barrier(casadi_ipmethod_data<T1>* d) {
+  // Local variables
+  T1 mu_min;
+  const casadi_ipmethod_prob<T1>* p = d->prob;
+  mu_min = p->tol / 10;
+  if (d->mu <= mu_min || casadi_ipmethod_err(d, d->mu) > p->kappa_eps * d->mu) return;
+  while (d->mu > mu_min && casadi_ipmethod_err(d, d->mu) <= p->kappa_eps * d->mu) {
+    d->mu = fmax(mu_min, fmin(p->kappa_mu * d->mu, std::pow(d->mu, p->theta_mu)));
+  }
+  d->tau = fmax(p->tau_min, 1. - d->mu);
+  // Reset the filter for the new barrier problem
+  d->n_filter = 0;
+  casadi_ipmethod_merit(d, d->z, d->g, d->f, &d->theta, &d->phi);
+}
+
+// SYMBOL "ipmethod_sigma"
+// Diagonal of the primal-dual Hessian of the barrier terms
+template<typename T1>
+T1 casadi_ipmethod_sigma(casadi_ipmethod_data<T1>* d, casadi_int k) {
+  // Local variables
+  T1 sigma;
+  const casadi_ipmethod_prob<T1>* p = d->prob;
+  casadi_nlpsol_data<T1>* d_nlp = d->nlp;
+  sigma = 0;
+  if (d_nlp->lbz[k] > -p->inf) sigma += d->zl[k] / (d->z[k] - d_nlp->lbz[k]);
+  if (d_nlp->ubz[k] < p->inf) sigma += d->zu[k] / (d_nlp->ubz[k] - d->z[k]);
+  return sigma;
+}
+
+// SYMBOL "ipmethod_gb"
+// Gradient of the barrier terms
+template<typename T1>
+T1 casadi_ipmethod_gb(casadi_ipmethod_data<T1>* d, casadi_int k) {
+  // Local variables
+  T1 gb;
+  const casadi_ipmethod_prob<T1>* p = d->prob;
+  casadi_nlpsol_data<T1>* d_nlp = d->nlp;
+  gb = 0;
+  if (d_nlp->lbz[k] > -p->inf) gb -= d->mu / (d->z[k] - d_nlp->lbz[k]);
+  if (d_nlp->ubz[k] < p->inf) gb += d->mu / (d_nlp->ubz[k] - d->z[k]);
+  return gb;
+}
+
+// SYMBOL "ipmethod_kkt"
+// Form the KKT matrix [H + Sigma_x + delta_w*I, J'; J, -D_s - delta_c*I],
+// the slacks eliminated, fixed variables and unbounded constraints eliminated by scaling
+template<typename T1>
+void casadi_ipmethod_kkt(casadi_ipmethod_data<T1>* d) {
+  // Local variables
+  casadi_int k, nx, nz;
+  const casadi_ipmethod_prob<T1>* p = d->prob;
+  nx = p->nlp->nx;
+  nz = nx + p->nlp->ng;
+  for (k = 0; k < nz; ++k) {
+    if (d->type[k] == IPMETHOD_FREE || (k < nx && d->type[k] == IPMETHOD_FIXED)) {
+      d->S[k] = 0;
+      d->D[k] = 1;
+    } else if (d->type[k] == IPMETHOD_FIXED) {
+      d->S[k] = 1;
+      d->D[k] = d->delta_c;
+    } else if (k < nx) {
+      d->S[k] = 1;
+      d->D[k] = casadi_ipmethod_sigma(d, k) + d->delta_w;
+    } else {
+      d->S[k] = 1;
+      d->D[k] = 1. / (casadi_ipmethod_sigma(d, k) + d->delta_w) + d->delta_c;
+    }
+  }
+  casadi_kkt(p->sp_kkt, d->kkt, p->sp_h, d->hess, p->sp_a, d->jac,
+    d->S, d->D, d->r, d->iw_kkt);
+}
+
+// SYMBOL "ipmethod_regularize"
+// Increase the regularization after a KKT matrix with wrong inertia
+template<typename T1>
+int casadi_ipmethod_regularize(casadi_ipmethod_data<T1>* d) {
+  const casadi_ipmethod_prob<T1>* p = d->prob;
+  if (d->delta_w == 0) {
+    d->delta_w = d->delta_w_last == 0 ? p->delta_w_init
+      : fmax(p->delta_w_min, d->delta_w_last / 3);
+  } else {
+    d->delta_w *= d->delta_w_last == 0 ? 100 : 8;
+  }
+  return d->delta_w > p->delta_w_max;
+}
+
+// SYMBOL "ipmethod_rhs"
+// Right-hand-side of the KKT system
+template<typename T1>
+void casadi_ipmethod_rhs(casadi_ipmethod_data<T1>* d) {
+  // Local variables
+  casadi_int k, nx, nz;
+  T1 rs;
+  const casadi_ipmethod_prob<T1>* p = d->prob;
+  nx = p->nlp->nx;
+  nz = nx + p->nlp->ng;
+  // Gradient of the Lagrangian of the barrier problem
+  casadi_copy(d->gf, nx, d->linsys);
+  casadi_mv(d->jac, p->sp_a, d->y, d->linsys, 1);
+  for (k = 0; k < nz; ++k) {
+    if (d->type[k] == IPMETHOD_FREE || (k < nx && d->type[k] == IPMETHOD_FIXED)) {
+      d->linsys[k] = 0;
+    } else if (k < nx) {
+      d->linsys[k] = -d->linsys[k] - casadi_ipmethod_gb(d, k);
+    } else {
+      // Constraint residual, slack equation eliminated
+      d->linsys[k] = d->z[k] - d->g[k - nx];
+      if (d->type[k] == IPMETHOD_REGULAR) {
+        rs = casadi_ipmethod_gb(d, k) - d->y[k - nx];
+        d->linsys[k] -= rs / (casadi_ipmethod_sigma(d, k) + d->delta_w);
+      }
+    }
+  }
+}
+
+// SYMBOL "ipmethod_direction"
+// Recover the full search direction, fraction-to-boundary rule, smallest step size
+template<typename T1>
+int casadi_ipmethod_direction(casadi_ipmethod_data<T1>* d) {
+  // Local variables
+  casadi_int k, nx, nz;
+  T1 dl, du, gb, a, t;
+  int tiny;
+  const casadi_ipmethod_prob<T1>* p = d->prob;
+  casadi_nlpsol_data<T1>* d_nlp = d->nlp;
+  nx = p->nlp->nx;
+  nz = nx + p->nlp->ng;
+  d->alpha_max = d->alpha_z = 1;
+  d->dphi = 0;
+  tiny = 1;
+  for (k = 0; k < nz; ++k) {
+    t = d->linsys[k];
+    if (t - t != 0) return 1;
+    if (k >= nx) d->dy[k - nx] = t;
+    d->dzl[k] = d->dzu[k] = 0;
+    if (d->type[k] != IPMETHOD_REGULAR) {
+      d->dz[k] = 0;
+      continue;
+    }
+    gb = casadi_ipmethod_gb(d, k);
+    if (k < nx) {
+      d->dz[k] = t;
+      d->dphi += (d->gf[k] + gb) * t;
+    } else {
+      d->dz[k] = (t - gb + d->y[k - nx]) / (casadi_ipmethod_sigma(d, k) + d->delta_w);
+      d->dphi += gb * d->dz[k];
+    }
+    if (fabs(d->dz[k]) > 10 * p->eps * (1 + fabs(d->z[k]))) tiny = 0;
+    // Step in the bound multipliers, fraction-to-boundary rule
+    if (d_nlp->lbz[k] > -p->inf) {
+      dl = d->z[k] - d_nlp->lbz[k];
+      d->dzl[k] = (d->mu - d->zl[k] * d->dz[k]) / dl - d->zl[k];
+      if (d->dz[k] < 0) d->alpha_max = fmin(d->alpha_max, -d->tau * dl / d->dz[k]);
+      if (d->dzl[k] < 0) d->alpha_z = fmin(d->alpha_z, -d->tau * d->zl[k] / d->dzl[k]);
+    }
+    if (d_nlp->ubz[k] < p->inf) {
+      du = d_nlp->ubz[k] - d->z[k];
+      d->dzu[k] = (d->mu + d->zu[k] * d->dz[k]) / du - d->zu[k];
+      if (d->dz[k] > 0) d->alpha_max = fmin(d->alpha_max, d->tau * du / d->dz[k]);
+      if (d->dzu[k] < 0) d->alpha_z = fmin(d->alpha_z, -d->tau * d->zu[k] / d->dzu[k]);
+    }
+  }
+  // Smallest step size before the line search fails
+  if (d->dphi < 0) {
+    a = fmin(p->gamma_theta, p->gamma_phi * d->theta / -d->dphi);
+    if (d->theta <= d->theta_min) {
+      a = fmin(a, p->delta * std::pow(d->theta, p->s_theta)
+        / std::pow(-d->dphi, p->s_phi));
+    }
+  } else {
+    a = p->gamma_theta;
+  }
+  d->alpha_min = p->gamma_alpha * a;
+  // Tiny steps are accepted without line search
+  d->alpha = d->alpha_max;
+  d->ls_iter = tiny ? -1 : 0;
+  d->info = ' ';
+  return 0;
+}
+
+// SYMBOL "ipmethod_trial"
+template<typename T1>
+void casadi_ipmethod_trial(casadi_ipmethod_data<T1>* d) {
+  // Local variables
+  casadi_int nz;
+  const casadi_ipmethod_prob<T1>* p = d->prob;
+  nz = p->nlp->nx + p->nlp->ng;
+  casadi_copy(d->z, nz, d->z_cand);
+  casadi_axpy(nz, d->alpha, d->dz, d->z_cand);
+}
+
+// SYMBOL "ipmethod_filter_add"
+template<typename T1>
+void casadi_ipmethod_filter_add(casadi_ipmethod_data<T1>* d, T1 theta, T1 phi) {
+  // Local variables
+  casadi_int j, n, jmax;
+  T1* f = d->filter;
+  // Remove entries dominated by the new one
+  n = 0;
+  for (j = 0; j < d->n_filter; ++j) {
+    if (f[2*j] < theta || f[2*j+1] < phi) {
+      f[2*n] = f[2*j];
+      f[2*n+1] = f[2*j+1];
+      n++;
+    }
+  }
+  // If full, replace the entry with the largest constraint violation
+  if (n == d->prob->max_filter) {
+    jmax = 0;
+    for (j = 1; j < n; ++j) if (f[2*j] > f[2*jmax]) jmax = j;
+    f[2*jmax] = theta;
+    f[2*jmax+1] = phi;
+  } else {
+    f[2*n] = theta;
+    f[2*n+1] = phi;
+    n++;
+  }
+  d->n_filter = n;
+}
+
+// SYMBOL "ipmethod_acceptable"
+// Filter line search acceptance test for the trial point
+template<typename T1>
+int casadi_ipmethod_acceptable(casadi_ipmethod_data<T1>* d) {
+  // Local variables
+  casadi_int j;
+  T1 theta, phi, relax;
+  const casadi_ipmethod_prob<T1>* p = d->prob;
+  // Tiny step
+  if (d->ls_iter < 0) {
+    d->ls_iter = 0;
+    return 1;
+  }
+  casadi_ipmethod_merit(d, d->z_cand, d->g_cand, d->f_cand, &theta, &phi);
+  if (theta - theta != 0 || phi - phi != 0) return 0;
+  if (theta > d->theta_max) return 0;
+  // Relaxation for rounding errors
+  relax = 10 * p->eps * fabs(d->phi);
+  // Acceptable to the filter?
+  for (j = 0; j < d->n_filter; ++j) {
+    if (theta >= d->filter[2*j] && phi >= d->filter[2*j+1]) return 0;
+  }
+  // Switching condition: Armijo condition for the barrier function
+  if (d->theta <= d->theta_min && d->dphi < 0
+      && d->alpha * std::pow(-d->dphi, p->s_phi) > p->delta * std::pow(d->theta, p->s_theta)) {
+    if (phi - d->phi - p->eta_phi * d->alpha * d->dphi > relax) return 0;
+    if (d->info == ' ') d->info = 'f';
+    return 1;
+  }
+  // Sufficient decrease of the constraint violation or the barrier function
+  if (theta > (1 - p->gamma_theta) * d->theta
+      && phi - d->phi + p->gamma_phi * d->theta > relax) return 0;
+  // Augment the filter
+  casadi_ipmethod_filter_add(d, (1 - p->gamma_theta) * d->theta,
+    d->phi - p->gamma_phi * d->theta);
+  if (d->info == ' ') d->info = 'h';
+  return 1;
+}
+
+// SYMBOL "ipmethod_backtrack"
+// Reduce the step size, reset the filter once if the smallest step size is reached
+template<typename T1>
+int casadi_ipmethod_backtrack(casadi_ipmethod_data<T1>* d) {
+  const casadi_ipmethod_prob<T1>* p = d->prob;
+  d->alpha *= 0.5;
+  d->ls_iter++;
+  if (d->alpha >= d->alpha_min && d->ls_iter < p->max_iter_ls) return 0;
+  if (d->n_filter == 0 || d->info == 'R') return 1;
+  // Retry, only requiring a decrease with respect to the current iterate
+  d->n_filter = 0;
+  d->info = 'R';
+  d->alpha = d->alpha_max;
+  d->ls_iter = 0;
+  return 0;
+}
+
+// SYMBOL "ipmethod_accept"
+template<typename T1>
+void casadi_ipmethod_accept(casadi_ipmethod_data<T1>* d) {
+  // Local variables
+  casadi_int k, nx, ng, nz;
+  T1 t;
+  const casadi_ipmethod_prob<T1>* p = d->prob;
+  casadi_nlpsol_data<T1>* d_nlp = d->nlp;
+  nx = p->nlp->nx;
+  ng = p->nlp->ng;
+  nz = nx + ng;
+  casadi_copy(d->z_cand, nz, d->z);
+  casadi_axpy(ng, d->alpha, d->dy, d->y);
+  casadi_axpy(nz, d->alpha_z, d->dzl, d->zl);
+  casadi_axpy(nz, d->alpha_z, d->dzu, d->zu);
+  // Keep the bound multipliers close to their primal estimates
+  for (k = 0; k < nz; ++k) {
+    if (d->type[k] != IPMETHOD_REGULAR) continue;
+    if (d_nlp->lbz[k] > -p->inf) {
+      t = d->z[k] - d_nlp->lbz[k];
+      d->zl[k] = fmax(fmin(d->zl[k], p->kappa_sigma * d->mu / t),
+        d->mu / (p->kappa_sigma * t));
+    }
+    if (d_nlp->ubz[k] < p->inf) {
+      t = d_nlp->ubz[k] - d->z[k];
+      d->zu[k] = fmax(fmin(d->zu[k], p->kappa_sigma * d->mu / t),
+        d->mu / (p->kappa_sigma * t));
+    }
+  }
+  d->iter++;
+}
+
+// SYMBOL "ipmethod_ldl"
+// Factorize the KKT matrix with LDL^T and get its inertia
+template<typename T1>
+void casadi_ipmethod_ldl(casadi_ipmethod_data<T1>* d) {
+  // Local variables
+  casadi_int k, nz;
+  const casadi_ipmethod_prob<T1>* p = d->prob;
+  nz = p->nlp->nx + p->nlp->ng;
+  casadi_ldl(p->sp_kkt, d->kkt, p->sp_lt, d->lt, d->ld, p->ldl_p, d->lw);
+  d->neig = 0;
+  for (k = 0; k < nz; ++k) {
+    if (d->ld[k] < 0) {
+      d->neig++;
+    } else if (!(d->ld[k] > 0)) {
+      // Singular
+      d->neig = -1;
+      return;
+    }
+  }
+}
+
+// SYMBOL "ipmethod_ldl_solve"
+template<typename T1>
+void casadi_ipmethod_ldl_solve(casadi_ipmethod_data<T1>* d) {
+  const casadi_ipmethod_prob<T1>* p = d->prob;
+  casadi_ldl_solve(d->linsys, 1, p->sp_lt, d->lt, d->ld, p->ldl_p, d->lw);
+}
+
+// SYMBOL "ipmethod"
+template<typename T1>
+int casadi_ipmethod(casadi_ipmethod_data<T1>* d) {
+  // Local variables
+  int accept;
+  const casadi_ipmethod_prob<T1>* p = d->prob;
+  switch (d->next) {
+    case IPMETHOD_RESET:
+      // Initial guess, evaluate the first-order information there
+      casadi_ipmethod_reset(d);
+      d->task = IPMETHOD_EVAL_JAC;
+      d->next = IPMETHOD_START;
+      return 1;
+    case IPMETHOD_START:
+      if (d->status == IPMETHOD_EVAL_ERROR) break;
+      casadi_ipmethod_start(d);
+      casadi_ipmethod_newiter(d);
+      casadi_ipmethod_err(d, 0.);
+      d->task = IPMETHOD_PROGRESS;
+      d->next = IPMETHOD_CHECK;
+      return 1;
+    case IPMETHOD_NEWITER:
+      // New iterate
+      if (d->status == IPMETHOD_EVAL_ERROR) break;
+      casadi_ipmethod_newiter(d);
+      casadi_ipmethod_err(d, 0.);
+      d->task = IPMETHOD_PROGRESS;
+      d->next = IPMETHOD_CHECK;
+      return 1;
+    case IPMETHOD_CHECK:
+      // Check convergence
+      if (d->status == IPMETHOD_USER_STOP) break;
+      if (casadi_ipmethod_err(d, 0.) <= p->tol) break;
+      if (d->iter >= p->max_iter) {
+        d->status = IPMETHOD_MAX_ITER;
+        break;
+      }
+      casadi_ipmethod_barrier(d);
+      d->task = IPMETHOD_EVAL_HESS;
+      d->next = IPMETHOD_KKT;
+      return 1;
+    case IPMETHOD_KKT:
+      // Form the KKT matrix without primal regularization
+      if (d->status == IPMETHOD_EVAL_ERROR) break;
+      d->delta_w = 0;
+      d->delta_c = p->delta_c * std::pow(d->mu, 0.25);
+      casadi_ipmethod_kkt(d);
+      d->task = IPMETHOD_FACTOR;
+      d->next = IPMETHOD_INERTIA;
+      return 1;
+    case IPMETHOD_INERTIA:
+      // Inertia correction
+      if (d->neig != p->nlp->ng) {
+        if (casadi_ipmethod_regularize(d)) {
+          d->status = IPMETHOD_REG_FAILED;
+          break;
+        }
+        casadi_ipmethod_kkt(d);
+        d->task = IPMETHOD_FACTOR;
+        d->next = IPMETHOD_INERTIA;
+        return 1;
+      }
+      if (d->delta_w > 0) d->delta_w_last = d->delta_w;
+      casadi_ipmethod_rhs(d);
+      d->task = IPMETHOD_SOLVE;
+      d->next = IPMETHOD_STEP;
+      return 1;
+    case IPMETHOD_STEP:
+      // Search direction, first trial point
+      if (d->status == IPMETHOD_SOLVE_ERROR) break;
+      if (casadi_ipmethod_direction(d)) {
+        d->status = IPMETHOD_SOLVE_ERROR;
+        break;
+      }
+      casadi_ipmethod_trial(d);
+      d->task = IPMETHOD_EVAL_FG;
+      d->next = IPMETHOD_LINESEARCH;
+      return 1;
+    case IPMETHOD_LINESEARCH:
+      // Filter line search, evaluation errors reduce the step size
+      accept = 0;
+      if (d->status == IPMETHOD_EVAL_ERROR) {
+        d->status = IPMETHOD_SUCCESS;
+      } else {
+        accept = casadi_ipmethod_acceptable(d);
+      }
+      if (accept) {
+        casadi_ipmethod_accept(d);
+        d->task = IPMETHOD_EVAL_JAC;
+        d->next = IPMETHOD_NEWITER;
+        return 1;
+      }
+      if (casadi_ipmethod_backtrack(d)) {
+        d->status = IPMETHOD_LS_FAILED;
+        break;
+      }
+      casadi_ipmethod_trial(d);
+      d->task = IPMETHOD_EVAL_FG;
+      d->next = IPMETHOD_LINESEARCH;
+      return 1;
+    default:
+      break;
+  }
+  // Done iterating
+  d->next = IPMETHOD_RESET;
+  return 0;
+}
+
+// SYMBOL "ipmethod_return_status"
+inline
+const char* casadi_ipmethod_return_status(casadi_ipmethod_flag_t status) {
+  switch (status) {
+    case IPMETHOD_SUCCESS: return "Solve_Succeeded";
+    case IPMETHOD_MAX_ITER: return "Maximum_Iterations_Exceeded";
+    case IPMETHOD_LS_FAILED: return "Line_Search_Failed";
+    case IPMETHOD_REG_FAILED: return "Inertia_Correction_Failed";
+    case IPMETHOD_EVAL_ERROR: return "Evaluation_Error";
+    case IPMETHOD_SOLVE_ERROR: return "Error_In_Step_Computation";
+    case IPMETHOD_USER_STOP: return "User_Requested_Stop";
+  }
+  return 0;
+}
+
+// SYMBOL "ipmethod_solution"
+// Pass the solution to the NLP data
+template<typename T1>
+void casadi_ipmethod_solution(casadi_ipmethod_data<T1>* d) {
+  // Local variables
+  casadi_int k, nx, ng;
+  const casadi_ipmethod_prob<T1>* p = d->prob;
+  casadi_nlpsol_data<T1>* d_nlp = d->nlp;
+  nx = p->nlp->nx;
+  ng = p->nlp->ng;
+  d_nlp->objective = d->f;
+  casadi_copy(d->z, nx, d_nlp->z);
+  casadi_copy(d->g, ng, d_nlp->z + nx);
+  casadi_copy(d->y, ng, d_nlp->lam + nx);
+  // Multipliers of fixed variables from the gradient of the Lagrangian
+  casadi_copy(d->gf, nx, d->r);
+  casadi_mv(d->jac, p->sp_a, d->y, d->r, 1);
+  for (k = 0; k < nx; ++k) {
+    d_nlp->lam[k] = d->type[k] == IPMETHOD_FIXED ? -d->r[k] : d->zu[k] - d->zl[k];
+  }
+}
@@ -23,6 +23,7 @@
 // C-REPLACE "std::numeric_limits<T1>::min()" "casadi_real_min"
 // C-REPLACE "std::numeric_limits<T1>::infinity()" "casadi_inf"
 // C-REPLACE "static_cast<int>" "(int) "
+// C-REPLACE "std::sqrt" "sqrt"
 // SYMBOL "ipqp_prob"
 template<typename T1>
 struct casadi_ipqp_prob {
@@ -36,6 +37,9 @@ struct casadi_ipqp_prob {
   casadi_int max_iter;
   // Error tolerance
   T1 pr_tol, du_tol, co_tol, mu_tol;
+  // Warm start from the initial guess, minimum margin to bounds
+  casadi_int warm_start;
+  T1 warm_shift;
 };
 // C-REPLACE "casadi_ipqp_prob<T1>" "struct casadi_ipqp_prob"
 
@@ -52,6 +56,8 @@ void casadi_ipqp_setup(casadi_ipqp_prob<T1>* p, casadi_int nx, casadi_int na) {
   p->du_tol = 1e-8;
   p->co_tol = 1e-8;
   p->mu_tol = 1e-8;
+  p->warm_start = 0;
+  p->warm_shift = 1e-3;
 }
 
 // SYMBOL "ipqp_flag_t"
@@ -72,9 +78,10 @@ typedef enum {
   IPQP_FACTOR,
   IPQP_SOLVE} casadi_ipqp_task_t;
 
-// SYMBOL "ipqp_task_t"
+// SYMBOL "ipqp_next_t"
 typedef enum {
   IPQP_RESET,
+  IPQP_WARM_START,
   IPQP_RESIDUAL,
   IPQP_NEWITER,
   IPQP_PREPARE,
@@ -187,6 +194,7 @@ void casadi_ipqp_init(casadi_ipqp_data<T1>* d, casadi_int** iw, T1** w) {
   d->dinv_ubz = *w; *w += p->nz;
   // New QP
   d->next = IPQP_RESET;
+  d->status = IPQP_SUCCESS;
 }
 
 // SYMBOL "ipqp_bounds"
@@ -227,11 +235,13 @@ void casadi_ipqp_reset(casadi_ipqp_data<T1>* d) {
   T1 margin, mid;
   const casadi_ipqp_prob<T1>* p = d->prob;
   // Required margin to constraints
-  margin = .1;
+  margin = p->warm_start ? p->warm_shift : .1;
   // Reset constraint count
   d->n_con = 0;
-  // Initialize constraints to zero
-  for (k = p->nx; k < p->nz; ++k) d->z[k] = 0;
+  // Initialize constraints to zero, unless warm started from A*x0
+  if (!p->warm_start) {
+    for (k = p->nx; k < p->nz; ++k) d->z[k] = 0;
+  }
   // Find interior point
   for (k = 0; k < p->nz; ++k) {
     if (d->lbz[k] > -p->inf) {
@@ -245,21 +255,21 @@ void casadi_ipqp_reset(casadi_ipqp_data<T1>* d) {
           d->z[k] = fmax(fmin(d->z[k], d->ubz[k] - margin), mid);
         }
         if (d->ubz[k] > d->lbz[k] + p->dmin) {
-          d->lam_lbz[k] = 1;
-          d->lam_ubz[k] = 1;
+          d->lam_lbz[k] = p->warm_start ? fmax(-d->lam[k], margin) : 1;
+          d->lam_ubz[k] = p->warm_start ? fmax(d->lam[k], margin) : 1;
           d->n_con += 2;
         }
       } else {
         // Only lower bound
         d->z[k] = fmax(d->z[k], d->lbz[k] + margin);
-        d->lam_lbz[k] = 1;
+        d->lam_lbz[k] = p->warm_start ? fmax(-d->lam[k], margin) : 1;
         d->n_con++;
       }
     } else {
       if (d->ubz[k] < p->inf) {
         // Only upper bound
         d->z[k] = fmin(d->z[k], d->ubz[k] - margin);
-        d->lam_ubz[k] = 1;
+        d->lam_ubz[k] = p->warm_start ? fmax(d->lam[k], margin) : 1;
         d->n_con++;
       }
     }
@@ -532,47 +542,6 @@ int casadi_ipqp_maxstep(casadi_ipqp_data<T1>* d, T1* alpha, casadi_int* ind) {
   return flag;
 }
 
-// SYMBOL "ipqp_predictor"
-template<typename T1>
-void casadi_ipqp_predictor(casadi_ipqp_data<T1>* d) {
-  // Local variables
-  casadi_int k;
-  T1 t, alpha, sigma;
-  const casadi_ipqp_prob<T1>* p = d->prob;
-  // Scale results
-  for (k=0; k<p->nz; ++k) d->dz[k] *= d->S[k];
-  // Calculate step in z(g), lam(g)
-  for (k=p->nx; k<p->nz; ++k) {
-    if (d->S[k] == 0.) {
-      // Eliminate
-      d->dlam[k] = d->dz[k] = 0;
-    } else {
-      t = d->D[k] / (d->S[k] * d->S[k]) * (d->dz[k] - d->dlam[k]);
-      d->dlam[k] = d->dz[k];
-      d->dz[k] = t;
-    }
-  }
-  // Finish calculation in dlam_lbz, dlam_ubz
-  for (k=0; k<p->nz; ++k) {
-    d->dlam_lbz[k] -= d->lam_lbz[k] * d->dz[k];
-    d->dlam_lbz[k] *= d->dinv_lbz[k];
-  }
-  for (k=0; k<p->nz; ++k) {
-    d->dlam_ubz[k] += d->lam_ubz[k] * d->dz[k];
-    d->dlam_ubz[k] *= d->dinv_ubz[k];
-  }
-  // Finish calculation of dlam(x)
-  for (k=0; k<p->nx; ++k) d->dlam[k] += d->dlam_ubz[k] - d->dlam_lbz[k];
-  // Maximum primal and dual step
-  (void)casadi_ipqp_maxstep(d, &alpha, 0);
-  // Calculate sigma
-  sigma = casadi_ipqp_sigma(d, alpha);
-  // Prepare corrector step
-  casadi_ipqp_corrector_prepare(d, -sigma * d->mu);
-  // Solve to get step
-  d->linsys = d->rz;
-}
-
 // SYMBOL "ipqp_step"
 template<typename T1>
 void casadi_ipqp_step(casadi_ipqp_data<T1>* d, T1 alpha_pr, T1 alpha_du) {
@@ -657,6 +626,47 @@ void casadi_ipqp_corrector_prepare(casadi_ipqp_data<T1>* d, T1 shift) {
   for (k=0; k<p->nz; ++k) d->rz[k] *= -d->S[k];
 }
 
+// SYMBOL "ipqp_predictor"
+template<typename T1>
+void casadi_ipqp_predictor(casadi_ipqp_data<T1>* d) {
+  // Local variables
+  casadi_int k;
+  T1 t, alpha, sigma;
+  const casadi_ipqp_prob<T1>* p = d->prob;
+  // Scale results
+  for (k=0; k<p->nz; ++k) d->dz[k] *= d->S[k];
+  // Calculate step in z(g), lam(g)
+  for (k=p->nx; k<p->nz; ++k) {
+    if (d->S[k] == 0.) {
+      // Eliminate
+      d->dlam[k] = d->dz[k] = 0;
+    } else {
+      t = d->D[k] / (d->S[k] * d->S[k]) * (d->dz[k] - d->dlam[k]);
+      d->dlam[k] = d->dz[k];
+      d->dz[k] = t;
+    }
+  }
+  // Finish calculation in dlam_lbz, dlam_ubz
+  for (k=0; k<p->nz; ++k) {
+    d->dlam_lbz[k] -= d->lam_lbz[k] * d->dz[k];
+    d->dlam_lbz[k] *= d->dinv_lbz[k];
+  }
+  for (k=0; k<p->nz; ++k) {
+    d->dlam_ubz[k] += d->lam_ubz[k] * d->dz[k];
+    d->dlam_ubz[k] *= d->dinv_ubz[k];
+  }
+  // Finish calculation of dlam(x)
+  for (k=0; k<p->nx; ++k) d->dlam[k] += d->dlam_ubz[k] - d->dlam_lbz[k];
+  // Maximum primal and dual step
+  (void)casadi_ipqp_maxstep(d, &alpha, 0);
+  // Calculate sigma
+  sigma = casadi_ipqp_sigma(d, alpha);
+  // Prepare corrector step
+  casadi_ipqp_corrector_prepare(d, -sigma * d->mu);
+  // Solve to get step
+  d->linsys = d->rz;
+}
+
 // SYMBOL "ipqp_corrector"
 template<typename T1>
 void casadi_ipqp_corrector(casadi_ipqp_data<T1>* d) {
@@ -735,6 +745,21 @@ template<typename T1>
 int casadi_ipqp(casadi_ipqp_data<T1>* d) {
   switch (d->next) {
     case IPQP_RESET:
+      if (d->prob->warm_start) {
+        // Evaluate the linear constraints at the initial guess first
+        casadi_clear(d->rz, d->prob->nz);
+        d->task = IPQP_MV;
+        d->next = IPQP_WARM_START;
+        return 1;
+      }
+      casadi_ipqp_reset(d);
+      d->task = IPQP_MV;
+      d->next = IPQP_RESIDUAL;
+      return 1;
+    case IPQP_WARM_START:
+      // Start from the constraint values at the initial guess
+      if (d->status == IPQP_MV_ERROR) break;
+      casadi_copy(d->rz + d->prob->nx, d->prob->na, d->z + d->prob->nx);
       casadi_ipqp_reset(d);
       d->task = IPQP_MV;
       d->next = IPQP_RESIDUAL;
@@ -0,0 +1,522 @@
+//
+//    MIT No Attribution
+//
+//    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+//    software and associated documentation files (the "Software"), to deal in the Software
+//    without restriction, including without limitation the rights to use, copy, modify,
+//    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+// C-REPLACE "fabs" "casadi_fabs"
+// SYMBOL "krylov_method_t"
+typedef enum {
+  KRYLOV_CG,
+  KRYLOV_MINRES,
+  KRYLOV_GMRES
+} casadi_krylov_method_t;
+
+// SYMBOL "krylov_prob"
+template<typename T1>
+struct casadi_krylov_prob {
+  // Dimension
+  casadi_int n;
+  // Method
+  casadi_krylov_method_t method;
+  // Maximum number of iterations
+  casadi_int max_iter;
+  // Restart length (GMRES)
+  casadi_int restart;
+  // Relative residual tolerance
+  T1 tol;
+};
+// C-REPLACE "casadi_krylov_prob<T1>" "struct casadi_krylov_prob"
+
+// SYMBOL "krylov_setup"
+template<typename T1>
+void casadi_krylov_setup(casadi_krylov_prob<T1>* p, casadi_int n,
+    casadi_krylov_method_t method) {
+  p->n = n;
+  p->method = method;
+  p->max_iter = 10 * n + 10;
+  p->restart = 30;
+  p->tol = 1e-10;
+}
+
+// SYMBOL "krylov_flag_t"
+typedef enum {
+  KRYLOV_SUCCESS,
+  KRYLOV_MAX_ITER,
+  KRYLOV_BREAKDOWN,
+  KRYLOV_NEG_CURVATURE,
+  KRYLOV_TR_BOUNDARY
+} casadi_krylov_flag_t;
+
+// SYMBOL "krylov_task_t"
+typedef enum {
+  KRYLOV_MV,
+  KRYLOV_PRECON
+} casadi_krylov_task_t;
+
+// SYMBOL "krylov_next_t"
+typedef enum {
+  KRYLOV_START,
+  KRYLOV_CG_INIT,
+  KRYLOV_CG_STEP,
+  KRYLOV_CG_UPDATE,
+  KRYLOV_MINRES_INIT,
+  KRYLOV_MINRES_STEP,
+  KRYLOV_MINRES_UPDATE,
+  KRYLOV_GMRES_RESTART,
+  KRYLOV_GMRES_PRECON,
+  KRYLOV_GMRES_STEP,
+  KRYLOV_GMRES_UPDATE,
+  KRYLOV_DONE
+} casadi_krylov_next_t;
+
+// SYMBOL "krylov_data"
+template<typename T1>
+struct casadi_krylov_data {
+  // Problem structure
+  const casadi_krylov_prob<T1>* prob;
+  // Solver status
+  casadi_krylov_flag_t status;
+  // User task: out := A*in or out := M^{-1}*in
+  casadi_krylov_task_t task;
+  const T1* in;
+  T1* out;
+  // Next step
+  casadi_krylov_next_t next;
+  // Iteration counter, inner iteration (GMRES)
+  casadi_int iter, j;
+  // Solution and right-hand-side
+  T1 *x, *b;
+  // Trust-region radius for truncated CG (Steihaug), zero if not truncated
+  T1 radius;
+  // Work vectors
+  T1 *r, *z, *p, *q, *v, *w, *w1, *w2;
+  // Krylov basis, Hessenberg matrix and Givens rotations (GMRES)
+  T1 *V, *H, *cs, *sn, *g;
+  // Scalars
+  T1 bnorm, rz, alpha, beta, beta1, oldb, dbar, epsln, phibar, c, s;
+};
+// C-REPLACE "casadi_krylov_data<T1>" "struct casadi_krylov_data"
+
+// SYMBOL "krylov_sz_w"
+template<typename T1>
+casadi_int casadi_krylov_sz_w(const casadi_krylov_prob<T1>* p) {
+  // Local variables
+  casadi_int sz_w, m;
+  m = p->restart;
+  sz_w = 0;
+  sz_w += p->n; // b
+  sz_w += p->n; // r
+  sz_w += p->n; // z
+  sz_w += p->n; // p
+  sz_w += p->n; // q
+  sz_w += p->n; // v
+  sz_w += p->n; // w
+  sz_w += p->n; // w1
+  sz_w += p->n; // w2
+  if (p->method == KRYLOV_GMRES) {
+    sz_w += p->n * (m + 1); // V
+    sz_w += (m + 1) * m; // H
+    sz_w += m; // cs
+    sz_w += m; // sn
+    sz_w += m + 1; // g
+  }
+  return sz_w;
+}
+
+// SYMBOL "krylov_init"
+template<typename T1>
+void casadi_krylov_init(casadi_krylov_data<T1>* d, T1** w) {
+  // Local variables
+  casadi_int m;
+  const casadi_krylov_prob<T1>* p = d->prob;
+  m = p->restart;
+  d->b = *w; *w += p->n;
+  d->r = *w; *w += p->n;
+  d->z = *w; *w += p->n;
+  d->p = *w; *w += p->n;
+  d->q = *w; *w += p->n;
+  d->v = *w; *w += p->n;
+  d->w = *w; *w += p->n;
+  d->w1 = *w; *w += p->n;
+  d->w2 = *w; *w += p->n;
+  if (p->method == KRYLOV_GMRES) {
+    d->V = *w; *w += p->n * (m + 1);
+    d->H = *w; *w += (m + 1) * m;
+    d->cs = *w; *w += m;
+    d->sn = *w; *w += m;
+    d->g = *w; *w += m + 1;
+  }
+}
+
+// SYMBOL "krylov_start"
+// Start solving A*x = b, x contains b on entry and the solution on exit
+template<typename T1>
+void casadi_krylov_start(casadi_krylov_data<T1>* d, T1* x) {
+  const casadi_krylov_prob<T1>* p = d->prob;
+  d->x = x;
+  casadi_copy(x, p->n, d->b);
+  casadi_clear(x, p->n);
+  d->bnorm = sqrt(casadi_dot(p->n, d->b, d->b));
+  d->iter = 0;
+  d->radius = 0;
+  d->status = KRYLOV_SUCCESS;
+  d->next = KRYLOV_START;
+}
+
+// SYMBOL "krylov_boundary"
+// Move x along p to the trust-region boundary, ||x + tau*p|| = radius with tau >= 0
+template<typename T1>
+void casadi_krylov_boundary(casadi_krylov_data<T1>* d) {
+  // Local variables
+  casadi_int n;
+  T1 xx, xp, pp, tau;
+  n = d->prob->n;
+  xx = casadi_dot(n, d->x, d->x);
+  xp = casadi_dot(n, d->x, d->p);
+  pp = casadi_dot(n, d->p, d->p);
+  if (pp == 0) return;
+  tau = (-xp + sqrt(xp * xp + pp * (d->radius * d->radius - xx))) / pp;
+  casadi_axpy(n, tau, d->p, d->x);
+}
+
+// SYMBOL "krylov_jacobi"
+// Jacobi preconditioner, inverse absolute diagonal, unit entries for zero diagonal
+template<typename T1>
+void casadi_krylov_jacobi(const casadi_int* sp, const T1* nz, T1* dinv) {
+  // Local variables
+  casadi_int n, c, k;
+  const casadi_int *colind, *row;
+  n = sp[1];
+  colind = sp + 2;
+  row = colind + n + 1;
+  for (c = 0; c < n; ++c) dinv[c] = 1;
+  for (c = 0; c < n; ++c) {
+    for (k = colind[c]; k < colind[c + 1]; ++k) {
+      if (row[k] == c && nz[k] != 0) dinv[c] = 1. / fabs(nz[k]);
+    }
+  }
+}
+
+// SYMBOL "krylov_gmres_step"
+// Arnoldi step with modified Gram-Schmidt and Givens rotations
+// Returns 1 if the inner iterations should be terminated
+template<typename T1>
+int casadi_krylov_gmres_step(casadi_krylov_data<T1>* d) {
+  // Local variables
+  casadi_int i, j, n, m;
+  T1 *h, hn, t, den;
+  const casadi_krylov_prob<T1>* p = d->prob;
+  n = p->n;
+  m = p->restart;
+  j = d->j;
+  h = d->H + j * (m + 1);
+  // Orthogonalize against previous basis vectors
+  for (i = 0; i <= j; ++i) {
+    h[i] = casadi_dot(n, d->w, d->V + i * n);
+    casadi_axpy(n, -h[i], d->V + i * n, d->w);
+  }
+  hn = sqrt(casadi_dot(n, d->w, d->w));
+  h[j + 1] = hn;
+  if (hn != 0) {
+    casadi_copy(d->w, n, d->V + (j + 1) * n);
+    casadi_scal(n, 1. / hn, d->V + (j + 1) * n);
+  }
+  // Apply previous rotations
+  for (i = 0; i < j; ++i) {
+    t = d->cs[i] * h[i] + d->sn[i] * h[i + 1];
+    h[i + 1] = -d->sn[i] * h[i] + d->cs[i] * h[i + 1];
+    h[i] = t;
+  }
+  // New rotation
+  den = sqrt(h[j] * h[j] + h[j + 1] * h[j + 1]);
+  if (den == 0) {
+    d->cs[j] = 1;
+    d->sn[j] = 0;
+  } else {
+    d->cs[j] = h[j] / den;
+    d->sn[j] = h[j + 1] / den;
+  }
+  h[j] = d->cs[j] * h[j] + d->sn[j] * h[j + 1];
+  h[j + 1] = 0;
+  d->g[j + 1] = -d->sn[j] * d->g[j];
+  d->g[j] = d->cs[j] * d->g[j];
+  d->iter++;
+  d->j++;
+  // Converged, restart length reached, out of iterations or lucky breakdown?
+  return fabs(d->g[j + 1]) <= p->tol * d->bnorm || d->j == m
+    || d->iter >= p->max_iter || hn == 0;
+}
+
+// SYMBOL "krylov_gmres_solution"
+// Solve the least-squares problem and form the update in d->v = V*y
+template<typename T1>
+void casadi_krylov_gmres_solution(casadi_krylov_data<T1>* d) {
+  // Local variables
+  casadi_int i, k, n, m;
+  const casadi_krylov_prob<T1>* p = d->prob;
+  n = p->n;
+  m = p->restart;
+  // Back substitution, upper triangular H, result in g
+  for (i = d->j - 1; i >= 0; --i) {
+    for (k = i + 1; k < d->j; ++k) d->g[i] -= d->H[i + k * (m + 1)] * d->g[k];
+    d->g[i] /= d->H[i + i * (m + 1)];
+  }
+  // Linear combination of basis vectors
+  casadi_clear(d->v, n);
+  for (i = 0; i < d->j; ++i) casadi_axpy(n, d->g[i], d->V + i * n, d->v);
+}
+
+// SYMBOL "krylov"
+// Reverse communication interface, returns 1 while a task needs to be performed
+template<typename T1>
+int casadi_krylov(casadi_krylov_data<T1>* d) {
+  // Local variables
+  casadi_int n;
+  T1 alpha, t, oldeps, delta, gbar, gamma, phi;
+  const casadi_krylov_prob<T1>* p = d->prob;
+  n = p->n;
+  switch (d->next) {
+    case KRYLOV_START:
+      // Trivial solution
+      if (d->bnorm == 0) break;
+      if (p->method == KRYLOV_CG) {
+        // r = b, z = M^{-1} r
+        casadi_copy(d->b, n, d->r);
+        d->task = KRYLOV_PRECON;
+        d->in = d->r;
+        d->out = d->z;
+        d->next = KRYLOV_CG_INIT;
+      } else if (p->method == KRYLOV_MINRES) {
+        // r1 = r2 = b, y = M^{-1} b
+        casadi_copy(d->b, n, d->r);
+        casadi_copy(d->b, n, d->p);
+        d->task = KRYLOV_PRECON;
+        d->in = d->b;
+        d->out = d->z;
+        d->next = KRYLOV_MINRES_INIT;
+      } else {
+        // w = A*x
+        d->task = KRYLOV_MV;
+        d->in = d->x;
+        d->out = d->w;
+        d->next = KRYLOV_GMRES_RESTART;
+      }
+      return 1;
+    // Preconditioned conjugate gradients
+    case KRYLOV_CG_INIT:
+      casadi_copy(d->z, n, d->p);
+      d->rz = casadi_dot(n, d->r, d->z);
+      d->task = KRYLOV_MV;
+      d->in = d->p;
+      d->out = d->q;
+      d->next = KRYLOV_CG_STEP;
+      return 1;
+    case KRYLOV_CG_STEP:
+      t = casadi_dot(n, d->p, d->q);
+      if (d->radius > 0 && t <= 0) {
+        // Direction of nonpositive curvature: follow it to the boundary
+        casadi_krylov_boundary(d);
+        d->iter++;
+        d->status = KRYLOV_NEG_CURVATURE;
+        break;
+      }
+      if (t == 0) {
+        d->status = KRYLOV_BREAKDOWN;
+        break;
+      }
+      alpha = d->rz / t;
+      if (d->radius > 0) {
+        // Truncate if the step leaves the trust region
+        casadi_copy(d->x, n, d->w);
+        casadi_axpy(n, alpha, d->p, d->w);
+        if (casadi_dot(n, d->w, d->w) >= d->radius * d->radius) {
+          casadi_krylov_boundary(d);
+          d->iter++;
+          d->status = KRYLOV_TR_BOUNDARY;
+          break;
+        }
+      }
+      casadi_axpy(n, alpha, d->p, d->x);
+      casadi_axpy(n, -alpha, d->q, d->r);
+      d->iter++;
+      if (sqrt(casadi_dot(n, d->r, d->r)) <= p->tol * d->bnorm) break;
+      if (d->iter >= p->max_iter) {
+        d->status = KRYLOV_MAX_ITER;
+        break;
+      }
+      d->task = KRYLOV_PRECON;
+      d->in = d->r;
+      d->out = d->z;
+      d->next = KRYLOV_CG_UPDATE;
+      return 1;
+    case KRYLOV_CG_UPDATE:
+      t = casadi_dot(n, d->r, d->z);
+      casadi_scal(n, t / d->rz, d->p);
+      casadi_axpy(n, 1., d->z, d->p);
+      d->rz = t;
+      d->task = KRYLOV_MV;
+      d->in = d->p;
+      d->out = d->q;
+      d->next = KRYLOV_CG_STEP;
+      return 1;
+    // Preconditioned MINRES, cf. Paige and Saunders (1975)
+    // r: r1, p: r2, z: y, v: v, w, w1, w2: search directions
+    case KRYLOV_MINRES_INIT:
+      t = casadi_dot(n, d->b, d->z);
+      if (t <= 0) {
+        // Preconditioner not positive definite
+        d->status = KRYLOV_BREAKDOWN;
+        break;
+      }
+      d->beta1 = d->beta = sqrt(t);
+      d->oldb = 0;
+      d->dbar = 0;
+      d->epsln = 0;
+      d->phibar = d->beta1;
+      d->c = -1;
+      d->s = 0;
+      casadi_clear(d->w, n);
+      casadi_clear(d->w2, n);
+      // v = y / beta
+      casadi_copy(d->z, n, d->v);
+      casadi_scal(n, 1. / d->beta, d->v);
+      d->task = KRYLOV_MV;
+      d->in = d->v;
+      d->out = d->z;
+      d->next = KRYLOV_MINRES_STEP;
+      return 1;
+    case KRYLOV_MINRES_STEP:
+      // Lanczos step
+      if (d->iter > 0) casadi_axpy(n, -d->beta / d->oldb, d->r, d->z);
+      alpha = casadi_dot(n, d->v, d->z);
+      casadi_axpy(n, -alpha / d->beta, d->p, d->z);
+      casadi_copy(d->p, n, d->r);
+      casadi_copy(d->z, n, d->p);
+      d->alpha = alpha;
+      d->task = KRYLOV_PRECON;
+      d->in = d->p;
+      d->out = d->z;
+      d->next = KRYLOV_MINRES_UPDATE;
+      return 1;
+    case KRYLOV_MINRES_UPDATE:
+      alpha = d->alpha;
+      d->oldb = d->beta;
+      t = casadi_dot(n, d->p, d->z);
+      if (t < 0) {
+        // Preconditioner not positive definite
+        d->status = KRYLOV_BREAKDOWN;
+        break;
+      }
+      d->beta = sqrt(t);
+      // Apply previous rotation
+      oldeps = d->epsln;
+      delta = d->c * d->dbar + d->s * alpha;
+      gbar = d->s * d->dbar - d->c * alpha;
+      d->epsln = d->s * d->beta;
+      d->dbar = -d->c * d->beta;
+      // New rotation
+      gamma = sqrt(gbar * gbar + d->beta * d->beta);
+      if (gamma == 0) {
+        d->status = KRYLOV_BREAKDOWN;
+        break;
+      }
+      d->c = gbar / gamma;
+      d->s = d->beta / gamma;
+      phi = d->c * d->phibar;
+      d->phibar *= d->s;
+      // Update search direction and solution
+      casadi_copy(d->w2, n, d->w1);
+      casadi_copy(d->w, n, d->w2);
+      casadi_copy(d->v, n, d->w);
+      casadi_axpy(n, -oldeps, d->w1, d->w);
+      casadi_axpy(n, -delta, d->w2, d->w);
+      casadi_scal(n, 1. / gamma, d->w);
+      casadi_axpy(n, phi, d->w, d->x);
+      d->iter++;
+      // Converged (residual in the norm induced by the preconditioner)?
+      if (d->phibar <= p->tol * d->beta1 || d->beta == 0) break;
+      if (d->iter >= p->max_iter) {
+        d->status = KRYLOV_MAX_ITER;
+        break;
+      }
+      // v = y / beta, y = A*v
+      casadi_copy(d->z, n, d->v);
+      casadi_scal(n, 1. / d->beta, d->v);
+      d->task = KRYLOV_MV;
+      d->in = d->v;
+      d->out = d->z;
+      d->next = KRYLOV_MINRES_STEP;
+      return 1;
+    // Right-preconditioned restarted GMRES
+    case KRYLOV_GMRES_RESTART:
+      // r = b - A*x
+      casadi_copy(d->b, n, d->r);
+      casadi_axpy(n, -1., d->w, d->r);
+      t = sqrt(casadi_dot(n, d->r, d->r));
+      if (t <= p->tol * d->bnorm) break;
+      if (d->iter >= p->max_iter) {
+        d->status = KRYLOV_MAX_ITER;
+        break;
+      }
+      casadi_copy(d->r, n, d->V);
+      casadi_scal(n, 1. / t, d->V);
+      casadi_clear(d->g, p->restart + 1);
+      d->g[0] = t;
+      d->j = 0;
+      d->task = KRYLOV_PRECON;
+      d->in = d->V;
+      d->out = d->z;
+      d->next = KRYLOV_GMRES_PRECON;
+      return 1;
+    case KRYLOV_GMRES_PRECON:
+      // w = A*M^{-1}*v_j
+      d->task = KRYLOV_MV;
+      d->in = d->z;
+      d->out = d->w;
+      d->next = KRYLOV_GMRES_STEP;
+      return 1;
+    case KRYLOV_GMRES_STEP:
+      if (casadi_krylov_gmres_step(d)) {
+        // Update solution: x += M^{-1}*V*y
+        casadi_krylov_gmres_solution(d);
+        d->task = KRYLOV_PRECON;
+        d->in = d->v;
+        d->out = d->z;
+        d->next = KRYLOV_GMRES_UPDATE;
+      } else {
+        d->task = KRYLOV_PRECON;
+        d->in = d->V + d->j * n;
+        d->out = d->z;
+        d->next = KRYLOV_GMRES_PRECON;
+      }
+      return 1;
+    case KRYLOV_GMRES_UPDATE:
+      casadi_axpy(n, 1., d->z, d->x);
+      // Recalculate residual and restart
+      d->task = KRYLOV_MV;
+      d->in = d->x;
+      d->out = d->w;
+      d->next = KRYLOV_GMRES_RESTART;
+      return 1;
+    default:
+      break;
+  }
+  // Done iterating
+  d->next = KRYLOV_DONE;
+  return 0;
+}
@@ -0,0 +1,219 @@
+//
+//    MIT No Attribution
+//
+//    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+//    software and associated documentation files (the "Software"), to deal in the Software
+//    without restriction, including without limitation the rights to use, copy, modify,
+//    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+// Compact limited-memory BFGS. The approximation B = delta*I + Q*K*Q' is built from
+// the last nm curvature pairs (s, y), with Q (nx-by-2*nm) an orthonormal basis of the
+// pairs. QP solvers see it through 2*nm lifting variables u = Q'*dx and the Hessian
+// H = [delta*I, -delta*Q; -delta*Q', delta*(Q'*Q + I) + K], which is positive definite
+// and coincides with B on u = Q'*dx.
+
+// C-REPLACE "std::numeric_limits<T1>::infinity()" "casadi_inf"
+
+// SYMBOL "lbfgs_bv"
+// r = B*v, with B = P'*H*P and P = [I; Q']
+// Work vector w of length 2*(nx+2*nm)
+template<typename T1>
+void casadi_lbfgs_bv(const casadi_int* sp_h, casadi_int nm, const T1* h, const T1* q,
+    const T1* v, T1* r, T1* w) {
+  // Local variables
+  casadi_int nx, k, i;
+  T1 *z, *hz;
+  k = 2 * nm;
+  nx = sp_h[0] - k;
+  z = w; w += nx + k;
+  hz = w; w += nx + k;
+  // z = P*v
+  casadi_copy(v, nx, z);
+  for (i = 0; i < k; ++i) z[nx + i] = casadi_dot(nx, q + i * nx, v);
+  // hz = H*z
+  casadi_clear(hz, nx + k);
+  casadi_mv(h, sp_h, z, hz, 0);
+  // r = P'*hz
+  casadi_copy(hz, nx, r);
+  for (i = 0; i < k; ++i) casadi_axpy(nx, hz[nx + i], q + i * nx, r);
+}
+
+// SYMBOL "lbfgs_update"
+// Store a curvature pair at position ind, with Powell damping against the current B
+// Work vector w of length nx+2*(nx+2*nm)
+template<typename T1>
+void casadi_lbfgs_update(const casadi_int* sp_h, casadi_int nm, casadi_int ind,
+    const T1* h, const T1* q, T1* s, T1* y, const T1* dx, const T1* glag,
+    const T1* glag_old, T1* w) {
+  // Local variables
+  casadi_int nx;
+  T1 *bs, sbs, sy, omega;
+  nx = sp_h[0] - 2 * nm;
+  bs = w; w += nx;
+  s += ind * nx;
+  y += ind * nx;
+  // s = dx, y = glag - glag_old
+  casadi_copy(dx, nx, s);
+  casadi_copy(glag, nx, y);
+  casadi_axpy(nx, -1., glag_old, y);
+  // Damping, y = omega*y + (1-omega)*B*s
+  casadi_lbfgs_bv(sp_h, nm, h, q, s, bs, w);
+  sbs = casadi_dot(nx, s, bs);
+  sy = casadi_dot(nx, s, y);
+  if (sy < 0.2 * sbs) {
+    omega = 0.8 * sbs / (sbs - sy);
+    casadi_scal(nx, omega, y);
+    casadi_axpy(nx, 1 - omega, bs, y);
+  }
+}
+
+// SYMBOL "lbfgs_hess"
+// Lifted Hessian from np pairs, the newest at position ind
+// Work vector w of length 4*nm*nm+6*nm
+template<typename T1>
+void casadi_lbfgs_hess(casadi_int nx, casadi_int nm, casadi_int np, casadi_int ind,
+    const T1* s, const T1* y, T1* q, T1* h, T1* w) {
+  // Local variables
+  casadi_int k, i, j, c, l, r, rep;
+  T1 *kk, *sig, *eta, *beta, *qc, delta, nrm0, nrm, sy, yy, sbs, qq;
+  const T1* v;
+  k = 2 * nm;
+  kk = w; w += k * k;
+  sig = w; w += k;
+  eta = w; w += k;
+  beta = w; w += k;
+  // Orthonormal basis of the pairs, modified Gram-Schmidt with reorthogonalization
+  casadi_clear(q, nx * k);
+  for (i = 0; i < np; ++i) {
+    j = (ind + nm - np + 1 + i) % nm;
+    for (c = 0; c < 2; ++c) {
+      v = c == 0 ? s + j * nx : y + j * nx;
+      qc = q + (2 * i + c) * nx;
+      casadi_copy(v, nx, qc);
+      nrm0 = casadi_norm_2(nx, v);
+      for (rep = 0; rep < 2; ++rep) {
+        for (l = 0; l < 2 * i + c; ++l) {
+          casadi_axpy(nx, -casadi_dot(nx, q + l * nx, qc), q + l * nx, qc);
+        }
+      }
+      nrm = casadi_norm_2(nx, qc);
+      if (nrm > 1e-8 * nrm0 && nrm > 0) {
+        casadi_scal(nx, 1. / nrm, qc);
+      } else {
+        casadi_clear(qc, nx);
+      }
+    }
+  }
+  // Initial scaling from the newest pair
+  delta = 1;
+  if (np > 0) {
+    sy = casadi_dot(nx, s + ind * nx, y + ind * nx);
+    yy = casadi_dot(nx, y + ind * nx, y + ind * nx);
+    if (sy > 0 && yy > 0) delta = yy / sy;
+  }
+  // BFGS updates in the coordinates of the basis, oldest pair first
+  casadi_clear(kk, k * k);
+  for (i = 0; i < np; ++i) {
+    j = (ind + nm - np + 1 + i) % nm;
+    for (l = 0; l < k; ++l) {
+      sig[l] = casadi_dot(nx, q + l * nx, s + j * nx);
+      eta[l] = casadi_dot(nx, q + l * nx, y + j * nx);
+    }
+    sy = casadi_dot(nx, s + j * nx, y + j * nx);
+    // beta = (delta*I + K)*sig, coordinates of B*s
+    for (l = 0; l < k; ++l) beta[l] = delta * sig[l];
+    for (c = 0; c < k; ++c) {
+      for (l = 0; l < k; ++l) beta[l] += kk[l + c * k] * sig[c];
+    }
+    sbs = casadi_dot(k, sig, beta);
+    if (sy <= 0 || sbs <= 0) continue;
+    for (c = 0; c < k; ++c) {
+      for (l = 0; l < k; ++l) {
+        kk[l + c * k] += eta[l] * eta[c] / sy - beta[l] * beta[c] / sbs;
+      }
+    }
+  }
+  // Columns of the lifted Hessian corresponding to dx
+  for (c = 0; c < nx; ++c) {
+    *h++ = delta;
+    for (l = 0; l < k; ++l) *h++ = -delta * q[c + l * nx];
+  }
+  // Columns corresponding to u
+  for (i = 0; i < k; ++i) {
+    qq = casadi_dot(nx, q + i * nx, q + i * nx);
+    for (r = 0; r < nx; ++r) *h++ = -delta * q[r + i * nx];
+    for (l = 0; l < k; ++l) *h++ = kk[l + i * k] + (l == i ? delta * (1 + qq) : 0);
+  }
+}
+
+// SYMBOL "lbfgs_jac"
+// Constraint Jacobian of the lifted QP, [A, 0; -Q', I]
+template<typename T1>
+void casadi_lbfgs_jac(const casadi_int* sp_a, casadi_int nm, const T1* a, const T1* q,
+    T1* a_qp) {
+  // Local variables
+  casadi_int nx, k, c, l, el;
+  const casadi_int* colind;
+  nx = sp_a[1];
+  colind = sp_a + 2;
+  k = 2 * nm;
+  for (c = 0; c < nx; ++c) {
+    for (el = colind[c]; el < colind[c + 1]; ++el) *a_qp++ = a[el];
+    for (l = 0; l < k; ++l) *a_qp++ = -q[c + l * nx];
+  }
+  for (l = 0; l < k; ++l) *a_qp++ = 1;
+}
+
+// SYMBOL "lbfgs_qp_pack"
+// Data of the lifted QP, variables [dx; u] and constraints [g; u - Q'*dx]
+template<typename T1>
+void casadi_lbfgs_qp_pack(casadi_int nx, casadi_int ng, casadi_int nm, const T1* q,
+    const T1* g, const T1* lbdz, const T1* ubdz, const T1* dx, const T1* dlam,
+    T1* g_qp, T1* lbz_qp, T1* ubz_qp, T1* x_qp, T1* lam_qp) {
+  // Local variables
+  casadi_int k, i;
+  k = 2 * nm;
+  // Gradient
+  casadi_copy(g, nx, g_qp);
+  casadi_clear(g_qp + nx, k);
+  // Bounds, lifting variables are free
+  casadi_copy(lbdz, nx, lbz_qp);
+  casadi_fill(lbz_qp + nx, k, -std::numeric_limits<T1>::infinity());
+  casadi_copy(lbdz + nx, ng, lbz_qp + nx + k);
+  casadi_clear(lbz_qp + nx + k + ng, k);
+  casadi_copy(ubdz, nx, ubz_qp);
+  casadi_fill(ubz_qp + nx, k, std::numeric_limits<T1>::infinity());
+  casadi_copy(ubdz + nx, ng, ubz_qp + nx + k);
+  casadi_clear(ubz_qp + nx + k + ng, k);
+  // Initial guess
+  casadi_copy(dx, nx, x_qp);
+  for (i = 0; i < k; ++i) x_qp[nx + i] = casadi_dot(nx, q + i * nx, dx);
+  casadi_copy(dlam, nx, lam_qp);
+  casadi_clear(lam_qp + nx, k);
+  casadi_copy(dlam + nx, ng, lam_qp + nx + k);
+  casadi_clear(lam_qp + nx + k + ng, k);
+}
+
+// SYMBOL "lbfgs_qp_unpack"
+// Step and multipliers from the solution of the lifted QP
+template<typename T1>
+void casadi_lbfgs_qp_unpack(casadi_int nx, casadi_int ng, casadi_int nm,
+    const T1* x_qp, const T1* lam_qp, T1* dx, T1* dlam) {
+  // Local variables
+  casadi_int k;
+  k = 2 * nm;
+  casadi_copy(x_qp, nx, dx);
+  casadi_copy(lam_qp, nx, dlam);
+  casadi_copy(lam_qp + nx + k, ng, dlam + nx);
+}
@@ -107,3 +107,39 @@ void casadi_ldl_solve(T1* x, casadi_int nrhs, const casadi_int* sp_lt, const T1*
     x += n;
   }
 }
+
+// SYMBOL "ldl_update"
+// Rank-1 modification of an LDL^T factorization: A + alpha*v*v' = L~ D~ L~'
+// The sparsity pattern of L is kept, i.e. v*v' must not cause fill-in
+// Returns 1 if a zero pivot is encountered, in which case A must be refactorized
+// len[w] >= 2*n
+template<typename T1>
+int casadi_ldl_update(const casadi_int* sp_lt, T1* lt, T1* d, const casadi_int* p,
+                      T1 alpha, const T1* v, T1* w) {
+  const casadi_int *lt_colind, *lt_row;
+  casadi_int n, c, k, r;
+  T1 *z, *beta, dnew;
+  // Extract sparsities
+  n=sp_lt[1];
+  lt_colind=sp_lt+2; lt_row=sp_lt+2+n+1;
+  // Work vectors
+  z = w; beta = w + n;
+  // Permute v
+  for (c=0; c<n; ++c) z[c] = v[p[c]];
+  // Loop over rows of L, i.e. columns of L'
+  for (c=0; c<n; ++c) {
+    // Apply the updates from the preceding columns of L
+    for (k=lt_colind[c]; k<lt_colind[c+1]; ++k) {
+      r = lt_row[k];
+      z[c] -= z[r] * lt[k];
+      lt[k] += beta[r] * z[c];
+    }
+    // Update d(c)
+    dnew = d[c] + alpha * z[c] * z[c];
+    if (dnew==0) return 1;
+    beta[c] = alpha * z[c] / dnew;
+    alpha *= d[c] / dnew;
+    d[c] = dnew;
+  }
+  return 0;
+}
@@ -0,0 +1,271 @@
+//
+//    MIT No Attribution
+//
+//    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+//    software and associated documentation files (the "Software"), to deal in the Software
+//    without restriction, including without limitation the rights to use, copy, modify,
+//    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+//    permit persons to whom the Software is furnished to do so.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+
+
+// C-REPLACE "fabs" "casadi_fabs"
+// SYMBOL "riccati_prob"
+template<typename T1>
+struct casadi_riccati_prob {
+  // Sparsity pattern of the (symmetric) linear system
+  const casadi_int* sp;
+  // Number of blocks
+  casadi_int nblk;
+  // Block offsets in the permuted ordering, length nblk+1
+  const casadi_int* blk;
+  // Position of each entry in the permuted ordering
+  const casadi_int* iperm;
+  // Block of each entry
+  const casadi_int* iblk;
+  // Offsets of the dense diagonal blocks, length nblk+1
+  const casadi_int* s_off;
+  // Offsets of the dense subdiagonal blocks, followed by their total size, length nblk
+  const casadi_int* c_off;
+  // Size of the largest temporary block
+  casadi_int sz_x;
+};
+// C-REPLACE "casadi_riccati_prob<T1>" "struct casadi_riccati_prob"
+
+// SYMBOL "riccati_data"
+template<typename T1>
+struct casadi_riccati_data {
+  // Problem structure
+  const casadi_riccati_prob<T1>* prob;
+  // Diagonal blocks, overwritten by the LU factors of the Schur complements
+  T1* S;
+  // Subdiagonal blocks (block row k+1, block column k)
+  T1* C;
+  // Temporary block
+  T1* X;
+  // Right-hand-side in the permuted ordering
+  T1* v;
+  // Row permutations of the LU factorizations
+  casadi_int* piv;
+};
+// C-REPLACE "casadi_riccati_data<T1>" "struct casadi_riccati_data"
+
+// SYMBOL "riccati_work"
+template<typename T1>
+void casadi_riccati_work(const casadi_riccati_prob<T1>* p, casadi_int* sz_iw, casadi_int* sz_w) {
+  // Local variables
+  casadi_int n;
+  n = p->sp[0];
+  *sz_iw = n; // piv
+  *sz_w = p->s_off[p->nblk]; // S
+  *sz_w += p->c_off[p->nblk - 1]; // C
+  *sz_w += p->sz_x; // X
+  *sz_w += n; // v
+}
+
+// SYMBOL "riccati_init"
+template<typename T1>
+void casadi_riccati_init(casadi_riccati_data<T1>* d, casadi_int** iw, T1** w) {
+  // Local variables
+  const casadi_riccati_prob<T1>* p = d->prob;
+  // Assign memory
+  d->S = *w; *w += p->s_off[p->nblk];
+  d->C = *w; *w += p->c_off[p->nblk - 1];
+  d->X = *w; *w += p->sz_x;
+  d->v = *w; *w += p->sp[0];
+  d->piv = *iw; *iw += p->sp[0];
+}
+
+// SYMBOL "riccati_lu"
+// Dense LU factorization with partial pivoting, column-major, in-place
+// Returns 1 if the matrix is singular
+template<typename T1>
+int casadi_riccati_lu(T1* a, casadi_int n, casadi_int* piv) {
+  // Local variables
+  casadi_int i, j, k, r;
+  T1 amax, t;
+  for (k = 0; k < n; ++k) {
+    // Find pivot
+    r = k;
+    amax = fabs(a[k + k * n]);
+    for (i = k + 1; i < n; ++i) {
+      if (fabs(a[i + k * n]) > amax) {
+        amax = fabs(a[i + k * n]);
+        r = i;
+      }
+    }
+    piv[k] = r;
+    if (amax == 0) return 1;
+    // Swap rows
+    if (r != k) {
+      for (j = 0; j < n; ++j) {
+        t = a[k + j * n];
+        a[k + j * n] = a[r + j * n];
+        a[r + j * n] = t;
+      }
+    }
+    // Multipliers
+    for (i = k + 1; i < n; ++i) a[i + k * n] /= a[k + k * n];
+    // Update trailing submatrix
+    for (j = k + 1; j < n; ++j) {
+      t = a[k + j * n];
+      if (t == 0) continue;
+      for (i = k + 1; i < n; ++i) a[i + j * n] -= a[i + k * n] * t;
+    }
+  }
+  return 0;
+}
+
+// SYMBOL "riccati_lu_solve"
+// Solve with factors from casadi_riccati_lu, nrhs column-major right-hand-sides
+template<typename T1>
+void casadi_riccati_lu_solve(const T1* a, casadi_int n, const casadi_int* piv,
+    T1* x, casadi_int nrhs) {
+  // Local variables
+  casadi_int i, k, r;
+  T1 t;
+  for (r = 0; r < nrhs; ++r) {
+    // Row permutation
+    for (k = 0; k < n; ++k) {
+      if (piv[k] != k) {
+        t = x[k];
+        x[k] = x[piv[k]];
+        x[piv[k]] = t;
+      }
+    }
+    // Forward substitution, unit lower triangular
+    for (k = 0; k < n; ++k) {
+      t = x[k];
+      if (t == 0) continue;
+      for (i = k + 1; i < n; ++i) x[i] -= a[i + k * n] * t;
+    }
+    // Backward substitution, upper triangular
+    for (k = n - 1; k >= 0; --k) {
+      x[k] /= a[k + k * n];
+      t = x[k];
+      if (t == 0) continue;
+      for (i = 0; i < k; ++i) x[i] -= a[i + k * n] * t;
+    }
+    // Next right-hand-side
+    x += n;
+  }
+}
+
+// SYMBOL "riccati_factor"
+// Block-tridiagonal factorization by backward Riccati recursion:
+// S~_N = S_N, S~_k = S_k - C_k' S~_{k+1}^{-1} C_k
+// Returns 1 if one of the Schur complements is singular
+template<typename T1>
+int casadi_riccati_factor(casadi_riccati_data<T1>* d, const T1* nz) {
+  // Local variables
+  casadi_int c, r, k, i, j, l, n, br, bc, n0, n1;
+  const casadi_int *colind, *row;
+  const casadi_riccati_prob<T1>* p = d->prob;
+  T1 *s, *cc, t;
+  // Extract sparsity
+  n = p->sp[1];
+  colind = p->sp + 2;
+  row = colind + n + 1;
+  // Scatter nonzeros to dense blocks
+  casadi_clear(d->S, p->s_off[p->nblk]);
+  casadi_clear(d->C, p->c_off[p->nblk - 1]);
+  for (c = 0; c < n; ++c) {
+    bc = p->iblk[c];
+    n0 = p->blk[bc + 1] - p->blk[bc];
+    for (k = colind[c]; k < colind[c + 1]; ++k) {
+      r = row[k];
+      br = p->iblk[r];
+      if (br == bc) {
+        d->S[p->s_off[bc] + (p->iperm[r] - p->blk[bc]) + (p->iperm[c] - p->blk[bc]) * n0]
+          = nz[k];
+      } else if (br == bc + 1) {
+        n1 = p->blk[br + 1] - p->blk[br];
+        d->C[p->c_off[bc] + (p->iperm[r] - p->blk[br]) + (p->iperm[c] - p->blk[bc]) * n1]
+          = nz[k];
+      }
+    }
+  }
+  // Factorize last block
+  k = p->nblk - 1;
+  if (casadi_riccati_lu(d->S + p->s_off[k], p->blk[k + 1] - p->blk[k], d->piv + p->blk[k]))
+    return 1;
+  // Backward recursion
+  for (k = p->nblk - 2; k >= 0; --k) {
+    n0 = p->blk[k + 1] - p->blk[k];
+    n1 = p->blk[k + 2] - p->blk[k + 1];
+    s = d->S + p->s_off[k];
+    cc = d->C + p->c_off[k];
+    // X := S~_{k+1}^{-1} C_k
+    casadi_copy(cc, n1 * n0, d->X);
+    casadi_riccati_lu_solve(d->S + p->s_off[k + 1], n1, d->piv + p->blk[k + 1], d->X, n0);
+    // S~_k := S_k - C_k' X
+    for (j = 0; j < n0; ++j) {
+      for (i = 0; i < n0; ++i) {
+        t = 0;
+        for (l = 0; l < n1; ++l) t += cc[l + i * n1] * d->X[l + j * n1];
+        s[i + j * n0] -= t;
+      }
+    }
+    // Factorize Schur complement
+    if (casadi_riccati_lu(s, n0, d->piv + p->blk[k])) return 1;
+  }
+  return 0;
+}
+
+// SYMBOL "riccati_solve"
+// Solve the linear system with factors from casadi_riccati_factor
+template<typename T1>
+void casadi_riccati_solve(casadi_riccati_data<T1>* d, T1* x, casadi_int nrhs) {
+  // Local variables
+  casadi_int i, j, k, r, n, n0, n1;
+  const casadi_riccati_prob<T1>* p = d->prob;
+  T1 *v0, *v1, *cc, t;
+  n = p->sp[0];
+  for (r = 0; r < nrhs; ++r) {
+    // Permute right-hand-side
+    for (i = 0; i < n; ++i) d->v[p->iperm[i]] = x[i];
+    // Backward sweep: b~_k := b_k - C_k' S~_{k+1}^{-1} b~_{k+1}
+    for (k = p->nblk - 2; k >= 0; --k) {
+      n0 = p->blk[k + 1] - p->blk[k];
+      n1 = p->blk[k + 2] - p->blk[k + 1];
+      v0 = d->v + p->blk[k];
+      cc = d->C + p->c_off[k];
+      casadi_copy(d->v + p->blk[k + 1], n1, d->X);
+      casadi_riccati_lu_solve(d->S + p->s_off[k + 1], n1, d->piv + p->blk[k + 1], d->X, 1);
+      for (i = 0; i < n0; ++i) {
+        t = 0;
+        for (j = 0; j < n1; ++j) t += cc[j + i * n1] * d->X[j];
+        v0[i] -= t;
+      }
+    }
+    // Forward sweep: x_k := S~_k^{-1} (b~_k - C_{k-1} x_{k-1})
+    for (k = 0; k < p->nblk; ++k) {
+      n1 = p->blk[k + 1] - p->blk[k];
+      v1 = d->v + p->blk[k];
+      if (k > 0) {
+        n0 = p->blk[k] - p->blk[k - 1];
+        v0 = d->v + p->blk[k - 1];
+        cc = d->C + p->c_off[k - 1];
+        for (j = 0; j < n0; ++j) {
+          t = v0[j];
+          if (t == 0) continue;
+          for (i = 0; i < n1; ++i) v1[i] -= cc[i + j * n1] * t;
+        }
+      }
+      casadi_riccati_lu_solve(d->S + p->s_off[k], n1, d->piv + p->blk[k], v1, 1);
+    }
+    // Permute back
+    for (i = 0; i < n; ++i) x[i] = d->v[p->iperm[i]];
+    // Next right-hand-side
+    x += n;
+  }
+}
@@ -292,20 +292,26 @@ namespace casadi {
   #include "casadi_qrqp.hpp"
   #include "casadi_kkt.hpp"
   #include "casadi_ipqp.hpp"
+  #include "casadi_riccati.hpp"
   #include "casadi_nlp.hpp"
   #include "casadi_sqpmethod.hpp"
   #include "casadi_feasiblesqpmethod.hpp"
+  #include "casadi_ipmethod.hpp"
   #include "casadi_bfgs.hpp"
+  #include "casadi_lbfgs.hpp"
   #include "casadi_regularize.hpp"
   #include "casadi_newton.hpp"
   #include "casadi_bound_consistency.hpp"
   #include "casadi_lsqr.hpp"
   #include "casadi_dense_lsqr.hpp"
+  #include "casadi_krylov.hpp"
+  #include "casadi_dopri.hpp"
   #include "casadi_cache.hpp"
   #include "casadi_convexify.hpp"
   #include "casadi_logsumexp.hpp"
   #include "casadi_sum.hpp"
   #include "casadi_sparsity.hpp"
+  #include "casadi_condensing.hpp"
   #include "casadi_jac.hpp"
 
 } // namespace casadi
@@ -19,6 +19,7 @@
 
 
 // C-REPLACE "casadi_nlpsol_prob<T1>" "struct casadi_nlpsol_prob"
+// C-REPLACE "casadi_nlpsol_data<T1>" "struct casadi_nlpsol_data"
 
 // SYMBOL "sqpmethod_prob"
 template<typename T1>
@@ -28,6 +29,11 @@ struct casadi_sqpmethod_prob {
   const casadi_int *sp_h, *sp_a, *sp_hr;
   casadi_int merit_memsize;
   casadi_int max_iter_ls;
+  // Number of pairs of the compact L-BFGS approximation, 0 if not used
+  casadi_int lbfgs_memory;
+  // Real-time iterations: sparsity of the parametric derivatives
+  int rti;
+  const casadi_int *sp_jp, *sp_hxp;
 };
 // C-REPLACE "casadi_sqpmethod_prob<T1>" "struct casadi_sqpmethod_prob"
 
@@ -57,6 +63,14 @@ struct casadi_sqpmethod_data {
   T1* temp_mem;
   // temp_sol
   T1* temp_sol;
+  // Compact L-BFGS: curvature pairs and their orthonormal basis
+  T1 *lbfgs_s, *lbfgs_y, *lbfgs_q;
+  // Compact L-BFGS: data of the lifted QP
+  T1 *qp_a, *qp_g, *qp_lbz, *qp_ubz, *qp_x, *qp_lam;
+  // Real-time iterations: linearization from the preparation phase, persistent
+  T1 *rti_prepared, *rti_z, *rti_lam, *rti_p, *rti_gf, *rti_jk, *rti_bk, *rti_jp, *rti_hxp;
+  // Real-time iterations: change of the parameters
+  T1* rti_dp;
 
   const T1** arg;
   T1** res;
@@ -71,7 +85,7 @@ template<typename T1>
 void casadi_sqpmethod_work(const casadi_sqpmethod_prob<T1>* p,
     casadi_int* sz_iw, casadi_int* sz_w, int elastic_mode, int so_corr) {
   // Local variables
-  casadi_int nnz_h, nnz_a, nx, ng;
+  casadi_int nnz_h, nnz_a, nx, ng, nk;
   nnz_h = p->sp_h[2+p->sp_h[1]];
   nnz_a = p->sp_a[2+p->sp_a[1]];
   nx = p->nlp->nx;
@@ -114,6 +128,19 @@ void casadi_sqpmethod_work(const casadi_sqpmethod_prob<T1>* p,
   }
 
   if (so_corr) *sz_w += nx+nx+ng; // Temp memory for failing soc
+
+  if (p->lbfgs_memory > 0) {
+    nk = 2*p->lbfgs_memory;
+    *sz_w += 2*nx*p->lbfgs_memory; // lbfgs_s, lbfgs_y
+    *sz_w += nx*nk; // lbfgs_q
+    *sz_w += nnz_a + nx*nk + nk; // qp_a
+    *sz_w += nx + nk; // qp_g
+    *sz_w += nx + ng + 2*nk; // qp_lbz
+    *sz_w += nx + ng + 2*nk; // qp_ubz
+    *sz_w += nx + nk; // qp_x
+    *sz_w += nx + ng + 2*nk; // qp_lam
+  }
+  if (p->rti) *sz_w += p->nlp->np; // rti_dp
 }
 
 // SYMBOL "sqpmethod_init"
@@ -122,7 +149,7 @@ void casadi_sqpmethod_init(casadi_sqpmethod_data<T1>* d,
     const T1*** arg, T1*** res, casadi_int** iw, T1** w,
     int elastic_mode, int so_corr) {
   // Local variables
-  casadi_int nnz_h, nnz_a, nx, ng;
+  casadi_int nnz_h, nnz_a, nx, ng, nk;
   const casadi_sqpmethod_prob<T1>* p = d->prob;
   // Get matrix number of nonzeros
   nnz_h = p->sp_h[2+p->sp_h[1]];
@@ -171,8 +198,100 @@ void casadi_sqpmethod_init(casadi_sqpmethod_data<T1>* d,
     // Jacobian
     d->Jk = *w; *w += nnz_a;
   }
+  if (p->lbfgs_memory > 0) {
+    nk = 2*p->lbfgs_memory;
+    // Curvature pairs and their orthonormal basis
+    d->lbfgs_s = *w; *w += nx*p->lbfgs_memory;
+    d->lbfgs_y = *w; *w += nx*p->lbfgs_memory;
+    d->lbfgs_q = *w; *w += nx*nk;
+    // Lifted QP
+    d->qp_a = *w; *w += nnz_a + nx*nk + nk;
+    d->qp_g = *w; *w += nx + nk;
+    d->qp_lbz = *w; *w += nx + ng + 2*nk;
+    d->qp_ubz = *w; *w += nx + ng + 2*nk;
+    d->qp_x = *w; *w += nx + nk;
+    d->qp_lam = *w; *w += nx + ng + 2*nk;
+  }
+  if (p->rti) {
+    d->rti_dp = *w; *w += p->nlp->np;
+  }
   d->arg = *arg;
   d->res = *res;
   d->iw = *iw;
   d->w = *w;
 }
+
+// SYMBOL "sqpmethod_rti_sz"
+template<typename T1>
+casadi_int casadi_sqpmethod_rti_sz(const casadi_sqpmethod_prob<T1>* p) {
+  // Local variables
+  casadi_int nx, ng;
+  nx = p->nlp->nx;
+  ng = p->nlp->ng;
+  return 1 + 2*(nx + ng) + p->nlp->np + nx + p->sp_a[2+p->sp_a[1]] + p->sp_h[2+p->sp_h[1]]
+    + p->sp_jp[2+p->sp_jp[1]] + p->sp_hxp[2+p->sp_hxp[1]];
+}
+
+// SYMBOL "sqpmethod_rti_init"
+template<typename T1>
+void casadi_sqpmethod_rti_init(casadi_sqpmethod_data<T1>* d, T1* rti) {
+  // Local variables
+  casadi_int nx, ng;
+  const casadi_sqpmethod_prob<T1>* p = d->prob;
+  nx = p->nlp->nx;
+  ng = p->nlp->ng;
+  d->rti_prepared = rti; rti += 1;
+  d->rti_z = rti; rti += nx + ng;
+  d->rti_lam = rti; rti += nx + ng;
+  d->rti_p = rti; rti += p->nlp->np;
+  d->rti_gf = rti; rti += nx;
+  d->rti_jk = rti; rti += p->sp_a[2+p->sp_a[1]];
+  d->rti_bk = rti; rti += p->sp_h[2+p->sp_h[1]];
+  d->rti_jp = rti; rti += p->sp_jp[2+p->sp_jp[1]];
+  d->rti_hxp = rti;
+}
+
+// SYMBOL "sqpmethod_rti_save"
+// Start of the preparation phase: linearize at the current iterate
+template<typename T1>
+void casadi_sqpmethod_rti_save(casadi_sqpmethod_data<T1>* d,
+    const casadi_nlpsol_data<T1>* d_nlp) {
+  // Local variables
+  casadi_int nx, ng;
+  const casadi_sqpmethod_prob<T1>* p = d->prob;
+  nx = p->nlp->nx;
+  ng = p->nlp->ng;
+  casadi_copy(d_nlp->z, nx, d->rti_z);
+  casadi_copy(d_nlp->lam, nx + ng, d->rti_lam);
+  casadi_copy(d_nlp->p, p->nlp->np, d->rti_p);
+}
+
+// SYMBOL "sqpmethod_rti_feedback"
+// Feedback phase: embed the parameters and bounds into the prepared QP
+template<typename T1>
+void casadi_sqpmethod_rti_feedback(casadi_sqpmethod_data<T1>* d,
+    casadi_nlpsol_data<T1>* d_nlp) {
+  // Local variables
+  casadi_int nx, ng, np;
+  const casadi_sqpmethod_prob<T1>* p = d->prob;
+  nx = p->nlp->nx;
+  ng = p->nlp->ng;
+  np = p->nlp->np;
+  // Change of the parameters since the preparation
+  casadi_copy(d_nlp->p, np, d->rti_dp);
+  casadi_axpy(np, -1., d->rti_p, d->rti_dp);
+  // Gradient, first order in the parameters
+  casadi_copy(d->rti_gf, nx, d->gf);
+  casadi_mv(d->rti_hxp, p->sp_hxp, d->rti_dp, d->gf, 0);
+  // Linearization point, constraints first order in the parameters
+  casadi_copy(d->rti_z, nx + ng, d_nlp->z);
+  casadi_mv(d->rti_jp, p->sp_jp, d->rti_dp, d_nlp->z + nx, 0);
+  // Bounds of the QP
+  casadi_copy(d_nlp->lbz, nx + ng, d->lbdz);
+  casadi_axpy(nx + ng, -1., d_nlp->z, d->lbdz);
+  casadi_copy(d_nlp->ubz, nx + ng, d->ubdz);
+  casadi_axpy(nx + ng, -1., d_nlp->z, d->ubdz);
+  // Initial guess
+  casadi_copy(d->rti_lam, nx + ng, d->dlam);
+  casadi_clear(d->dx, nx);
+}
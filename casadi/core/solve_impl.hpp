@@ -254,7 +254,8 @@ namespace casadi {
 
   template<bool Tr>
   size_t LinsolCall<Tr>::sz_w() const {
-    return this->sparsity().size1();
+    // Also the work vector of the generated code
+    return std::max(this->sparsity().size1(), linsol_->generate_sz_w());
   }
 
   template<bool Tr>
@@ -84,6 +84,35 @@ namespace casadi {
     return 0;
   }
 
+  int SXFunction::eval_soa(const double** arg, double** res, double* w, casadi_int n) const {
+    // Make sure no free parameters
+    casadi_assert(free_vars_.empty(), "Cannot evaluate " + name_ + " since variables "
+      + str(free_vars_) + " are free.");
+
+    // Evaluate the algorithm, each operation for all instances
+    for (auto&& e : algorithm_) {
+      switch (e.op) {
+      case OP_CONST:
+        std::fill_n(w + e.i0 * n, n, e.d);
+        break;
+      case OP_INPUT:
+        if (arg[e.i1]==nullptr) {
+          std::fill_n(w + e.i0 * n, n, 0.);
+        } else {
+          std::copy_n(arg[e.i1] + e.i2 * n, n, w + e.i0 * n);
+        }
+        break;
+      case OP_OUTPUT:
+        if (res[e.i0]!=nullptr) std::copy_n(w + e.i1 * n, n, res[e.i0] + e.i2 * n);
+        break;
+      default:
+        // Unary operations have i2 == i1, in-place operations are elementwise
+        casadi_math<double>::fun(e.op, w + e.i1 * n, w + e.i2 * n, w + e.i0 * n, n);
+      }
+    }
+    return 0;
+  }
+
   bool SXFunction::is_smooth() const {
     // Go through all nodes and check if any node is non-smooth
     for (auto&& a : algorithm_) {
@@ -72,6 +72,14 @@ class CASADI_EXPORT SXFunction :
       \identifier{ue} */
   int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
 
+  /** \brief  Evaluate numerically for a block of n instances, structure-of-arrays layout
+
+      Nonzero k of instance j is stored at position k*n + j, for inputs, outputs as
+      well as for the work vector, which must have length sz_w()*n.
+
+      \identifier{27v} */
+  int eval_soa(const double** arg, double** res, double* w, casadi_int n) const;
+
   /** \brief  evaluate symbolically while also propagating directional derivatives
 
       \identifier{uf} */
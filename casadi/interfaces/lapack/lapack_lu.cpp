@@ -51,6 +51,10 @@ namespace casadi {
     // Default options
     equilibriate_ = true;
     allow_equilibration_failure_ = false;
+    mixed_precision_ = false;
+    refinement_max_iter_ = 30;
+    refinement_tol_ = std::sqrt(static_cast<double>(sp.size1()))
+      * std::numeric_limits<double>::epsilon();
   }
 
   LapackLu::~LapackLu() {
@@ -64,7 +68,18 @@ namespace casadi {
         "Equilibrate the matrix"}},
       {"allow_equilibration_failure",
        {OT_BOOL,
-        "Non-fatal error when equilibration fails"}}
+        "Non-fatal error when equilibration fails"}},
+      {"mixed_precision",
+       {OT_BOOL,
+        "Factorize in single precision and recover double precision accuracy "
+        "by iterative refinement, falling back to a double precision "
+        "factorization if the refinement stalls [false]"}},
+      {"refinement_max_iter",
+       {OT_INT,
+        "Maximum number of refinement steps in mixed precision mode [30]"}},
+      {"refinement_tol",
+       {OT_DOUBLE,
+        "Normwise backward error tolerance in mixed precision mode [sqrt(n)*eps]"}}
      }
   };
 
@@ -78,6 +93,12 @@ namespace casadi {
         equilibriate_ = op.second;
       } else if (op.first=="allow_equilibration_failure") {
         allow_equilibration_failure_ = op.second;
+      } else if (op.first=="mixed_precision") {
+        mixed_precision_ = op.second;
+      } else if (op.first=="refinement_max_iter") {
+        refinement_max_iter_ = op.second;
+      } else if (op.first=="refinement_tol") {
+        refinement_tol_ = op.second;
       }
     }
   }
@@ -86,26 +107,83 @@ namespace casadi {
     if (LinsolInternal::init_mem(mem)) return 0;
     auto m = static_cast<LapackLuMemory*>(mem);
 
-    // Allocate matrix
-    m->mat.resize(nrow() * ncol());
+    // Allocate matrix, double precision only allocated when needed
+    if (!mixed_precision_) m->mat.resize(nrow() * ncol());
     m->ipiv.resize(ncol());
 
     // Equilibration
-    if (equilibriate_) {
+    if (equilibriate_ && !mixed_precision_) {
       m->r.resize(nrow());
       m->c.resize(ncol());
     }
     m->equed = 'N'; // No equilibration
+
+    // Single precision factorization
+    if (mixed_precision_) {
+      m->mat_s.resize(nrow() * ncol());
+      if (equilibriate_) {
+        m->r_s.resize(nrow());
+        m->c_s.resize(ncol());
+      }
+      m->x_s.resize(nrow());
+      m->w.resize(2 * nrow());
+    }
+    m->equed_s = 'N';
+    m->fallback = false;
     return 0;
   }
 
   int LapackLu::nfact(void* mem, const double* A) const {
     auto m = static_cast<LapackLuMemory*>(mem);
+    if (mixed_precision_) {
+      // Dimensions
+      int nrow = this->nrow();
+      int ncol = this->ncol();
+
+      // Get the elements of the matrix, dense format, single precision
+      casadi_densify(A, sp_, get_ptr(m->mat_s), false);
+
+      // Single precision factorization, failures are handled by the fallback
+      m->fallback = false;
+      m->equed_s = 'N';
+      int info = -100;
+      if (equilibriate_) {
+        float colcnd, rowcnd, amax;
+        sgeequ_(&ncol, &nrow, get_ptr(m->mat_s), &ncol, get_ptr(m->r_s),
+                get_ptr(m->c_s), &colcnd, &rowcnd, &amax, &info);
+        if (info != 0) {
+          m->fallback = true;
+        } else {
+          slaqge_(&ncol, &nrow, get_ptr(m->mat_s), &ncol, get_ptr(m->r_s), get_ptr(m->c_s),
+                  &colcnd, &rowcnd, &amax, &m->equed_s);
+        }
+      }
+      if (!m->fallback) {
+        sgetrf_(&ncol, &ncol, get_ptr(m->mat_s), &ncol, get_ptr(m->ipiv), &info);
+        if (info) m->fallback = true;
+        // Overflow or underflow in single precision?
+        for (casadi_int i=0; i<ncol && !m->fallback; ++i) {
+          if (!std::isfinite(m->mat_s[i + i*ncol])) m->fallback = true;
+        }
+      }
+      if (!m->fallback) return 0;
+      if (verbose_) casadi_message("Single precision LU factorization failed");
+    }
+    return nfact_double(m, A);
+  }
 
+  int LapackLu::nfact_double(LapackLuMemory* m, const double* A) const {
     // Dimensions
     int nrow = this->nrow();
     int ncol = this->ncol();
 
+    // Allocate memory, if needed
+    m->mat.resize(nrow * ncol);
+    if (equilibriate_) {
+      m->r.resize(nrow);
+      m->c.resize(ncol);
+    }
+
     // Get the elements of the matrix, dense format
     casadi_densify(A, sp_, get_ptr(m->mat), false);
 
@@ -148,6 +226,22 @@ namespace casadi {
   int LapackLu::solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const {
     auto m = static_cast<LapackLuMemory*>(mem);
 
+    if (mixed_precision_ && !m->fallback) {
+      casadi_int nrow = this->nrow();
+      for (casadi_int r=0; r<nrhs; ++r) {
+        if (solve_refine(mem, A, x + r*nrow, tr, refinement_max_iter_, refinement_tol_,
+                         get_ptr(m->w), get_ptr(m->x_s))) {
+          // Refinement stalled: solve the remaining right-hand-sides in double precision
+          m->fallback = true;
+          if (nfact_double(m, A)) return 1;
+          x += r*nrow;
+          nrhs -= r;
+          break;
+        }
+      }
+      if (!m->fallback) return 0;
+    }
+
     // Dimensions
     int nrow = this->nrow();
     int ncol = this->ncol();
@@ -188,17 +282,70 @@ namespace casadi {
     return 0;
   }
 
+  int LapackLu::solve_single(void* mem, float* x, casadi_int nrhs, bool tr) const {
+    auto m = static_cast<LapackLuMemory*>(mem);
+
+    // Dimensions
+    int nrow = this->nrow();
+    int ncol = this->ncol();
+
+    int n_rhs = nrhs;
+
+    // Scale the right hand side
+    if (tr) {
+      if (m->equed_s=='C' || m->equed_s=='B')
+        for (casadi_int rhs=0; rhs<nrhs; ++rhs)
+          for (casadi_int i=0; i<nrow; ++i)
+            x[i+rhs*nrow] *= m->c_s[i];
+    } else {
+      if (m->equed_s=='R' || m->equed_s=='B')
+        for (casadi_int rhs=0; rhs<nrhs; ++rhs)
+          for (casadi_int i=0; i<ncol; ++i)
+            x[i+rhs*nrow] *= m->r_s[i];
+    }
+
+    // Solve the system of equations
+    int info = 100;
+    char trans = tr ? 'T' : 'N';
+    sgetrs_(&trans, &ncol, &n_rhs, get_ptr(m->mat_s), &ncol, get_ptr(m->ipiv), x, &ncol, &info);
+    if (info) return 1;
+
+    // Scale the solution
+    if (tr) {
+      if (m->equed_s=='R' || m->equed_s=='B')
+        for (casadi_int rhs=0; rhs<nrhs; ++rhs)
+          for (casadi_int i=0; i<ncol; ++i)
+            x[i+rhs*nrow] *= m->r_s[i];
+    } else {
+      if (m->equed_s=='C' || m->equed_s=='B')
+        for (casadi_int rhs=0; rhs<nrhs; ++rhs)
+          for (casadi_int i=0; i<nrow; ++i)
+            x[i+rhs*nrow] *= m->c_s[i];
+    }
+    return 0;
+  }
+
   LapackLu::LapackLu(DeserializingStream& s) : LinsolInternal(s) {
-    s.version("LapackLu", 1);
+    int version = s.version("LapackLu", 1, 2);
     s.unpack("LapackLu::equilibriate", equilibriate_);
     s.unpack("LapackLu::allow_equilibration_failure", allow_equilibration_failure_);
+    if (version >= 2) {
+      s.unpack("LapackLu::mixed_precision", mixed_precision_);
+      s.unpack("LapackLu::refinement_max_iter", refinement_max_iter_);
+      s.unpack("LapackLu::refinement_tol", refinement_tol_);
+    } else {
+      mixed_precision_ = false;
+    }
   }
 
   void LapackLu::serialize_body(SerializingStream &s) const {
     LinsolInternal::serialize_body(s);
-    s.version("LapackLu", 1);
+    s.version("LapackLu", 2);
     s.pack("LapackLu::equilibriate", equilibriate_);
     s.pack("LapackLu::allow_equilibration_failure", allow_equilibration_failure_);
+    s.pack("LapackLu::mixed_precision", mixed_precision_);
+    s.pack("LapackLu::refinement_max_iter", refinement_max_iter_);
+    s.pack("LapackLu::refinement_tol", refinement_tol_);
   }
 
 } // namespace casadi
@@ -44,6 +44,15 @@ extern "C" {
   /// Equilibrate the system
   void dlaqge_(int *m, int *n, double *a, int *lda, double *r, double *c,
                double *colcnd, double *rowcnd, double *amax, char *equed);
+
+  /// Single precision versions of the above
+  void sgetrf_(int *m, int *n, float *a, int *lda, int *ipiv, int *info);
+  void sgetrs_(char* trans, int *n, int *nrhs, float *a,
+               int *lda, int *ipiv, float *b, int *ldb, int *info);
+  void sgeequ_(int *m, int *n, float *a, int *lda, float *r, float *c,
+               float *colcnd, float *rowcnd, float *amax, int *info);
+  void slaqge_(int *m, int *n, float *a, int *lda, float *r, float *c,
+               float *colcnd, float *rowcnd, float *amax, char *equed);
 }
 
 namespace casadi {
@@ -71,6 +80,16 @@ namespace casadi {
 
     /// Type of scaling during the last equilibration
     char equed;
+
+    /// Single precision factorization, mixed precision mode
+    std::vector<float> mat_s, r_s, c_s, x_s;
+    char equed_s;
+
+    /// Work vector for iterative refinement
+    std::vector<double> w;
+
+    /// Double precision factorization in use, mixed precision mode
+    bool fallback;
   };
 
   /** \brief \pluginbrief{Linsol,lapacklu}
@@ -113,9 +132,15 @@ namespace casadi {
     // Factorize the linear system
     int nfact(void* mem, const double* A) const override;
 
+    // Factorize the linear system in double precision
+    int nfact_double(LapackLuMemory* m, const double* A) const;
+
     // Solve the linear system
     int solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const override;
 
+    // Solve with the single precision factorization
+    int solve_single(void* mem, float* x, casadi_int nrhs, bool tr) const override;
+
     /// A documentation string
     static const std::string meta_doc;
 
@@ -135,6 +160,13 @@ namespace casadi {
     /// Allow the equilibration to fail
     bool allow_equilibration_failure_;
 
+    ///@{
+    /// Mixed precision mode
+    bool mixed_precision_;
+    casadi_int refinement_max_iter_;
+    double refinement_tol_;
+    ///@}
+
     // Get name of the plugin
     const char* plugin_name() const override { return "lapacklu";}
 
@@ -488,6 +488,9 @@ int CvodesInterface::psolveF(double t, N_Vector x, N_Vector xdot, N_Vector r,
     auto m = to_mem(user_data);
     auto& s = m->self;
 
+    // Time spent in the linear solver
+    ScopedTiming tic(m->fstats.at("linsol_solve"));
+
     // Get right-hand sides in m->v1
     double* v = NV_DATA_S(r);
     casadi_copy(v, s.nx_, m->v1);
@@ -529,6 +532,9 @@ int CvodesInterface::psolveB(double t, N_Vector x, N_Vector xB, N_Vector xdotB,
     auto m = to_mem(user_data);
     auto& s = m->self;
 
+    // Time spent in the linear solver
+    ScopedTiming tic(m->fstats.at("linsol_solve"));
+
     // Get right-hand sides in m->v1
     double* v = NV_DATA_S(rvecB);
     casadi_copy(v, s.nrx_, m->v1);
@@ -578,18 +584,25 @@ int CvodesInterface::psetupF(double t, N_Vector x, N_Vector xdot, booleantype jo
     const Sparsity& sp_jac_ode_x = s.get_function("jacF").sparsity_out(0);
     const Sparsity& sp_jacF = s.linsolF_.sparsity();
 
+    // Time spent in the linear solver setup
+    ScopedTiming tic(m->fstats.at("linsol_setup"));
+
     // Calculate Jacobian, if necessary
-    if (s.always_recalculate_jacobian_ || !jcurPtr || *jcurPtr == 0) {
+    if (!m->reuse_jac && (s.always_recalculate_jacobian_ || !jcurPtr || *jcurPtr == 0)) {
       // Re(calculate) Jacobian
       if (s.calc_jacF(m, t, NV_DATA_S(x), nullptr,
         m->jac_ode_x, nullptr, nullptr, nullptr)) return 1;
 
+      // Project to expected sparsity pattern (with diagonal), keep for later setups
+      casadi_project(m->jac_ode_x, sp_jac_ode_x, get_ptr(m->jac), sp_jacF, m->w);
+      m->jac_valid = true;
+      m->jac_age = 0;
+      m->njevals++;
+
       // Jacobian is now current
       if (jcurPtr) *jcurPtr = 1;
     }
-
-    // Project to expected sparsity pattern (with diagonal)
-    casadi_project(m->jac_ode_x, sp_jac_ode_x, m->jacF, sp_jacF, m->w);
+    casadi_copy(get_ptr(m->jac), sp_jacF.nnz(), m->jacF);
 
     // Scale and shift diagonal
     const casadi_int *colind = sp_jacF.colind(), *row = sp_jacF.row();
@@ -633,11 +646,20 @@ int CvodesInterface::lsetupF(CVodeMem cv_mem, int convfail, N_Vector x, N_Vector
     booleantype *jcurPtr, N_Vector vtemp1, N_Vector vtemp2, N_Vector vtemp3) {
   try {
     auto m = to_mem(cv_mem->cv_lmem);
+    auto& s = m->self;
+
+    // Reuse the last Jacobian, unless too old or after a convergence failure
+    m->reuse_jac = s.reuse_jacF(m, cv_mem->cv_nst, convfail == CV_NO_FAILURES);
 
     // Call the preconditioner setup function (which sets up the linear solver)
-    return psetupF(cv_mem->cv_tn, x, xdot, FALSE, jcurPtr,
+    int flag = psetupF(cv_mem->cv_tn, x, xdot, FALSE, jcurPtr,
       cv_mem->cv_gamma, static_cast<void*>(m), vtemp1, vtemp2, vtemp3);
 
+    // A reused Jacobian is not current, CVODES will ask for a new one if Newton fails
+    if (m->reuse_jac) *jcurPtr = FALSE;
+    m->reuse_jac = false;
+    return flag;
+
   } catch(std::exception& e) { // non-recoverable error
     uerr() << "lsetup failed: " << e.what() << std::endl;
     return -1;
@@ -310,6 +310,8 @@
 "+-------------+\n"
 "|     Id      |\n"
 "+=============+\n"
+"| njevals     |\n"
+"+-------------+\n"
 "| nlinsetups  |\n"
 "+-------------+\n"
 "| nlinsetupsB |\n"
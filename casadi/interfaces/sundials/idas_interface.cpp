@@ -235,7 +235,7 @@ int IdasInterface::init_mem(void* mem) const {
   THROWING(IDASetUserData, m->mem, m);
 
   // Allocate n-vectors for ivp
-  m->xzdot = N_VNew_Serial(nx_+nz_);
+  m->xzdot = nv_new(nx_+nz_);
 
   // Initialize Idas
   double t0 = 0;
@@ -344,7 +344,7 @@ int IdasInterface::init_mem(void* mem) const {
 
   // Adjoint sensitivity problem
   if (nadj_ > 0) {
-    m->rxzdot = N_VNew_Serial(nrx_+nrz_);
+    m->rxzdot = nv_new(nrx_+nrz_);
     N_VConst(0.0, m->rxz);
     N_VConst(0.0, m->rxzdot);
   }
@@ -653,6 +653,9 @@ int IdasInterface::psolveF(double t, N_Vector xz, N_Vector xzdot, N_Vector rr,
     auto m = to_mem(user_data);
     auto& s = m->self;
 
+    // Time spent in the linear solver
+    ScopedTiming tic(m->fstats.at("linsol_solve"));
+
     // Get right-hand sides in m->v1, ordered by sensitivity directions
     double* vx = NV_DATA_S(rvec);
     double* vz = vx + s.nx_;
@@ -783,6 +786,9 @@ int IdasInterface::psolveB(double t, N_Vector xz, N_Vector xzdot, N_Vector xzB,
   try {
     auto m = to_mem(user_data);
     auto& s = m->self;
+
+    // Time spent in the linear solver
+    ScopedTiming tic(m->fstats.at("linsol_solve"));
     return s.solve_transposed(m, t, NV_DATA_S(xz), NV_DATA_S(xzB),
       NV_DATA_S(rvecB), NV_DATA_S(zvecB));
 
@@ -837,16 +843,26 @@ int IdasInterface::psetupF(double t, N_Vector xz, N_Vector xzdot, N_Vector rr,
     const Sparsity& sp_jac_alg_z = jacF.sparsity_out(JACF_ALG_Z);
     const Sparsity& sp_jacF = s.linsolF_.sparsity();
 
-    // Calculate Jacobian blocks
-    if (s.calc_jacF(m, t, NV_DATA_S(xz), NV_DATA_S(xz) + s.nx_,
-      m->jac_ode_x, m->jac_alg_x, m->jac_ode_z, m->jac_alg_z)) return 1;
+    // Time spent in the linear solver setup
+    ScopedTiming tic(m->fstats.at("linsol_setup"));
 
-    // Copy to jacF structure
     casadi_int nx_jac = sp_jac_ode_x.size1();  // excludes sensitivity equations
-    casadi_copy_block(m->jac_ode_x, sp_jac_ode_x, m->jacF, sp_jacF, 0, 0, m->w);
-    casadi_copy_block(m->jac_alg_x, sp_jac_alg_x, m->jacF, sp_jacF, nx_jac, 0, m->w);
-    casadi_copy_block(m->jac_ode_z, sp_jac_ode_z, m->jacF, sp_jacF, 0, nx_jac, m->w);
-    casadi_copy_block(m->jac_alg_z, sp_jac_alg_z, m->jacF, sp_jacF, nx_jac, nx_jac, m->w);
+    if (!m->reuse_jac) {
+      // Calculate Jacobian blocks
+      if (s.calc_jacF(m, t, NV_DATA_S(xz), NV_DATA_S(xz) + s.nx_,
+        m->jac_ode_x, m->jac_alg_x, m->jac_ode_z, m->jac_alg_z)) return 1;
+
+      // Copy to jacF structure, keep for later setups
+      double* jac = get_ptr(m->jac);
+      casadi_copy_block(m->jac_ode_x, sp_jac_ode_x, jac, sp_jacF, 0, 0, m->w);
+      casadi_copy_block(m->jac_alg_x, sp_jac_alg_x, jac, sp_jacF, nx_jac, 0, m->w);
+      casadi_copy_block(m->jac_ode_z, sp_jac_ode_z, jac, sp_jacF, 0, nx_jac, m->w);
+      casadi_copy_block(m->jac_alg_z, sp_jac_alg_z, jac, sp_jacF, nx_jac, nx_jac, m->w);
+      m->jac_valid = true;
+      m->jac_age = 0;
+      m->njevals++;
+    }
+    casadi_copy(get_ptr(m->jac), sp_jacF.nnz(), m->jacF);
 
     // Shift diagonal corresponding to jac_ode_x
     const casadi_int *colind = sp_jacF.colind(), *row = sp_jacF.row();
@@ -887,9 +903,15 @@ int IdasInterface::lsetupF(IDAMem IDA_mem, N_Vector xz, N_Vector xzdot, N_Vector
   // Multiple of df_dydot to be added to the matrix
   double cj = IDA_mem->ida_cj;
 
+  // Reuse the last Jacobian, unless too old
+  auto m = to_mem(IDA_mem->ida_lmem);
+  m->reuse_jac = m->self.reuse_jacF(m, IDA_mem->ida_nst, true);
+
   // Call the preconditioner setup function (which sets up the linear solver)
-  return psetupF(t, xz, xzdot, nullptr, cj, IDA_mem->ida_lmem,
+  int flag = psetupF(t, xz, xzdot, nullptr, cj, IDA_mem->ida_lmem,
     vtemp1, vtemp1, vtemp3);
+  m->reuse_jac = false;
+  return flag;
 }
 
 int IdasInterface::lsetupB(IDAMem IDA_mem, N_Vector xzB, N_Vector xzdotB, N_Vector respB,
@@ -346,6 +346,8 @@
 "+-------------+\n"
 "|     Id      |\n"
 "+=============+\n"
+"| njevals     |\n"
+"+-------------+\n"
 "| nlinsetups  |\n"
 "+-------------+\n"
 "| nlinsetupsB |\n"
@@ -107,7 +107,18 @@ const Options SundialsInterface::options_
       "Coefficient in the nonlinear convergence test"}},
     {"scale_abstol",
      {OT_BOOL,
-      "Scale absolute tolerance by nominal value"}}
+      "Scale absolute tolerance by nominal value"}},
+    {"nvector",
+     {OT_STRING,
+      "N_Vector implementation used for the state and quadrature vectors: "
+      "serial|openmp. With openmp, the vector operations of SUNDIALS (linear combinations, "
+      "norms, ...) are OpenMP parallel loops [serial]"}},
+    {"max_jacobian_age",
+     {OT_INT,
+      "Direct linear solver: maximum number of steps for which a Jacobian is reused in "
+      "the Newton matrix, also across integrator calls. A reused Jacobian is evaluated "
+      "anew after a Newton convergence failure. 0 evaluates the Jacobian in every setup. "
+      "Not applied when integrating backward problems [0]"}}
     }
 };
 
@@ -135,6 +146,8 @@ void SundialsInterface::init(const Dict& opts) {
   max_order_ = 0;
   nonlin_conv_coeff_ = 0;
   scale_abstol_ = false;
+  std::string nvector = "serial";
+  max_jacobian_age_ = 0;
 
   // Read options
   for (auto&& op : opts) {
@@ -181,9 +194,27 @@ void SundialsInterface::init(const Dict& opts) {
       nonlin_conv_coeff_ = op.second;
     } else if (op.first=="scale_abstol") {
       scale_abstol_ = op.second;
+    } else if (op.first=="nvector") {
+      nvector = op.second.to_string();
+    } else if (op.first=="max_jacobian_age") {
+      max_jacobian_age_ = op.second;
     }
   }
 
+  // N_Vector implementation
+  if (nvector=="serial") {
+    nvector_openmp_ = false;
+  } else if (nvector=="openmp") {
+    nvector_openmp_ = true;
+#ifndef WITH_OPENMP
+    casadi_warning("CasADi was not compiled with WITH_OPENMP=ON. "
+                   "Falling back to serial N_Vector.");
+    nvector_openmp_ = false;
+#endif // WITH_OPENMP
+  } else {
+    casadi_error("Unknown N_Vector implementation: " + nvector);
+  }
+
   // Type of Newton scheme
   if (newton_scheme=="direct") {
     newton_scheme_ = SD_DIRECT;
@@ -306,10 +337,10 @@ int SundialsInterface::init_mem(void* mem) const {
   auto m = static_cast<SundialsMemory*>(mem);
 
   // Allocate NVectors
-  m->xz = N_VNew_Serial(nx_ + nz_);
-  m->q = N_VNew_Serial(nq_);
-  m->rxz = N_VNew_Serial(nrx_ + nrz_);
-  m->ruq = N_VNew_Serial(nrq_ + nuq_);
+  m->xz = nv_new(nx_ + nz_);
+  m->q = nv_new(nq_);
+  m->rxz = nv_new(nrx_ + nrz_);
+  m->ruq = nv_new(nrq_ + nuq_);
 
   // Absolute tolerances as NVector
   if (scale_abstol_) {
@@ -333,6 +364,15 @@ int SundialsInterface::init_mem(void* mem) const {
 
   m->mem_linsolF = linsolF_.checkout();
 
+  // Jacobian, kept between calls
+  m->jac.resize(linsolF_.sparsity().nnz());
+  m->jac_valid = false;
+  m->jac_age = 0;
+
+  // Time spent in the linear solver
+  m->add_stat("linsol_setup");
+  m->add_stat("linsol_solve");
+
   // Reset stats
   reset_stats(m);
 
@@ -355,6 +395,158 @@ void SundialsInterface::reset(IntegratorMemory* mem, const double* x,
 
   // Reset summation states
   N_VConst(0., m->q);
+
+  // Jacobian reuse, counted from the first step
+  m->reuse_jac = m->jac_reused = false;
+  m->nst_setup = 0;
+}
+
+bool SundialsInterface::reuse_jacF(SundialsMemory* m, long nst, bool jok) const {
+  // Taped forward steps must be reproducible during the backward sweep
+  if (nrx_ > 0) return m->jac_reused = false;
+  // Step counter rewound
+  if (nst < m->nst_setup) jok = false;
+  // Age of the Jacobian in steps, also from previous calls
+  bool no_progress = nst == m->nst_setup;
+  if (nst > m->nst_setup) m->jac_age += nst - m->nst_setup;
+  m->nst_setup = nst;
+  // Not after a convergence failure or a reuse without any step taken since
+  m->jac_reused = jok && m->jac_valid && m->jac_age < max_jacobian_age_
+    && !(m->jac_reused && no_progress);
+  return m->jac_reused;
+}
+
+#ifdef WITH_OPENMP
+// Vector operations of the serial N_Vector as OpenMP parallel loops
+static void nv_linearsum_omp(realtype a, N_Vector x, realtype b, N_Vector y, N_Vector z) {
+  long int n = NV_LENGTH_S(x);
+  realtype *xd = NV_DATA_S(x), *yd = NV_DATA_S(y), *zd = NV_DATA_S(z);
+  #pragma omp parallel for
+  for (long int i = 0; i < n; ++i) zd[i] = a * xd[i] + b * yd[i];
+}
+
+static void nv_const_omp(realtype c, N_Vector z) {
+  long int n = NV_LENGTH_S(z);
+  realtype *zd = NV_DATA_S(z);
+  #pragma omp parallel for
+  for (long int i = 0; i < n; ++i) zd[i] = c;
+}
+
+static void nv_prod_omp(N_Vector x, N_Vector y, N_Vector z) {
+  long int n = NV_LENGTH_S(x);
+  realtype *xd = NV_DATA_S(x), *yd = NV_DATA_S(y), *zd = NV_DATA_S(z);
+  #pragma omp parallel for
+  for (long int i = 0; i < n; ++i) zd[i] = xd[i] * yd[i];
+}
+
+static void nv_div_omp(N_Vector x, N_Vector y, N_Vector z) {
+  long int n = NV_LENGTH_S(x);
+  realtype *xd = NV_DATA_S(x), *yd = NV_DATA_S(y), *zd = NV_DATA_S(z);
+  #pragma omp parallel for
+  for (long int i = 0; i < n; ++i) zd[i] = xd[i] / yd[i];
+}
+
+static void nv_scale_omp(realtype c, N_Vector x, N_Vector z) {
+  long int n = NV_LENGTH_S(x);
+  realtype *xd = NV_DATA_S(x), *zd = NV_DATA_S(z);
+  #pragma omp parallel for
+  for (long int i = 0; i < n; ++i) zd[i] = c * xd[i];
+}
+
+static void nv_abs_omp(N_Vector x, N_Vector z) {
+  long int n = NV_LENGTH_S(x);
+  realtype *xd = NV_DATA_S(x), *zd = NV_DATA_S(z);
+  #pragma omp parallel for
+  for (long int i = 0; i < n; ++i) zd[i] = std::fabs(xd[i]);
+}
+
+static void nv_inv_omp(N_Vector x, N_Vector z) {
+  long int n = NV_LENGTH_S(x);
+  realtype *xd = NV_DATA_S(x), *zd = NV_DATA_S(z);
+  #pragma omp parallel for
+  for (long int i = 0; i < n; ++i) zd[i] = 1. / xd[i];
+}
+
+static void nv_addconst_omp(N_Vector x, realtype b, N_Vector z) {
+  long int n = NV_LENGTH_S(x);
+  realtype *xd = NV_DATA_S(x), *zd = NV_DATA_S(z);
+  #pragma omp parallel for
+  for (long int i = 0; i < n; ++i) zd[i] = xd[i] + b;
+}
+
+static realtype nv_dotprod_omp(N_Vector x, N_Vector y) {
+  long int n = NV_LENGTH_S(x);
+  realtype *xd = NV_DATA_S(x), *yd = NV_DATA_S(y), sum = 0;
+  #pragma omp parallel for reduction(+:sum)
+  for (long int i = 0; i < n; ++i) sum += xd[i] * yd[i];
+  return sum;
+}
+
+static realtype nv_maxnorm_omp(N_Vector x) {
+  long int n = NV_LENGTH_S(x);
+  realtype *xd = NV_DATA_S(x), r = 0;
+  #pragma omp parallel for reduction(max:r)
+  for (long int i = 0; i < n; ++i) r = std::fmax(r, std::fabs(xd[i]));
+  return r;
+}
+
+static realtype nv_wrmsnorm_omp(N_Vector x, N_Vector w) {
+  long int n = NV_LENGTH_S(x);
+  realtype *xd = NV_DATA_S(x), *wd = NV_DATA_S(w), sum = 0;
+  #pragma omp parallel for reduction(+:sum)
+  for (long int i = 0; i < n; ++i) sum += (xd[i] * wd[i]) * (xd[i] * wd[i]);
+  return std::sqrt(sum / n);
+}
+
+static realtype nv_wrmsnormmask_omp(N_Vector x, N_Vector w, N_Vector id) {
+  long int n = NV_LENGTH_S(x);
+  realtype *xd = NV_DATA_S(x), *wd = NV_DATA_S(w), *idd = NV_DATA_S(id), sum = 0;
+  #pragma omp parallel for reduction(+:sum)
+  for (long int i = 0; i < n; ++i) {
+    if (idd[i] > 0) sum += (xd[i] * wd[i]) * (xd[i] * wd[i]);
+  }
+  return std::sqrt(sum / n);
+}
+
+static realtype nv_wl2norm_omp(N_Vector x, N_Vector w) {
+  long int n = NV_LENGTH_S(x);
+  realtype *xd = NV_DATA_S(x), *wd = NV_DATA_S(w), sum = 0;
+  #pragma omp parallel for reduction(+:sum)
+  for (long int i = 0; i < n; ++i) sum += (xd[i] * wd[i]) * (xd[i] * wd[i]);
+  return std::sqrt(sum);
+}
+
+static realtype nv_l1norm_omp(N_Vector x) {
+  long int n = NV_LENGTH_S(x);
+  realtype *xd = NV_DATA_S(x), sum = 0;
+  #pragma omp parallel for reduction(+:sum)
+  for (long int i = 0; i < n; ++i) sum += std::fabs(xd[i]);
+  return sum;
+}
+#endif // WITH_OPENMP
+
+N_Vector SundialsInterface::nv_new(casadi_int n) const {
+  N_Vector v = N_VNew_Serial(n);
+#ifdef WITH_OPENMP
+  // Replace the vector operations, inherited by clones made inside SUNDIALS
+  if (nvector_openmp_) {
+    v->ops->nvlinearsum = nv_linearsum_omp;
+    v->ops->nvconst = nv_const_omp;
+    v->ops->nvprod = nv_prod_omp;
+    v->ops->nvdiv = nv_div_omp;
+    v->ops->nvscale = nv_scale_omp;
+    v->ops->nvabs = nv_abs_omp;
+    v->ops->nvinv = nv_inv_omp;
+    v->ops->nvaddconst = nv_addconst_omp;
+    v->ops->nvdotprod = nv_dotprod_omp;
+    v->ops->nvmaxnorm = nv_maxnorm_omp;
+    v->ops->nvwrmsnorm = nv_wrmsnorm_omp;
+    v->ops->nvwrmsnormmask = nv_wrmsnormmask_omp;
+    v->ops->nvwl2norm = nv_wl2norm_omp;
+    v->ops->nvl1norm = nv_l1norm_omp;
+  }
+#endif // WITH_OPENMP
+  return v;
 }
 
 void SundialsInterface::reset_stats(SundialsMemory* m) const {
@@ -363,6 +555,7 @@ void SundialsInterface::reset_stats(SundialsMemory* m) const {
   m->qlast = m->qcur = -1;
   m->hinused = m->hlast = m->hcur = m->tcur = casadi::nan;
   m->nniters = m->nncfails = 0;
+  m->njevals = 0;
 
   // Reset stats, backward problem
   m->nstepsB = m->nfevalsB = m->nlinsetupsB = m->netfailsB = 0;
@@ -457,6 +650,7 @@ Dict SundialsInterface::get_stats(void* mem) const {
   stats["tcur"] = m->tcur;
   stats["nniters"] = static_cast<casadi_int>(m->nniters);
   stats["nncfails"] = static_cast<casadi_int>(m->nncfails);
+  stats["njevals"] = static_cast<casadi_int>(m->njevals);
 
   // Counters, backward problem
   stats["nstepsB"] = static_cast<casadi_int>(m->nstepsB);
@@ -489,6 +683,7 @@ void SundialsInterface::print_stats(IntegratorMemory* mem) const {
   print("Current internal time reached: %g\n", m->tcur);
   print("Number of nonlinear iterations performed: %ld\n", m->nniters);
   print("Number of nonlinear convergence failures: %ld\n", m->nncfails);
+  print("Number of Jacobian evaluations for the linear solver: %ld\n", m->njevals);
   if (nrx_>0) {
     print("BACKWARD INTEGRATION:\n");
     print("Number of steps taken by SUNDIALS: %ld\n", m->nstepsB);
@@ -508,7 +703,7 @@ void SundialsInterface::print_stats(IntegratorMemory* mem) const {
 }
 
 SundialsInterface::SundialsInterface(DeserializingStream& s) : Integrator(s) {
-  int version = s.version("SundialsInterface", 1, 2);
+  int version = s.version("SundialsInterface", 1, 4);
   s.unpack("SundialsInterface::abstol", abstol_);
   s.unpack("SundialsInterface::reltol", reltol_);
   s.unpack("SundialsInterface::max_num_steps", max_num_steps_);
@@ -534,6 +729,16 @@ SundialsInterface::SundialsInterface(DeserializingStream& s) : Integrator(s) {
   s.unpack("SundialsInterface::nonlin_conv_coeff", nonlin_conv_coeff_);
   s.unpack("SundialsInterface::max_order", max_order_);
   s.unpack("SundialsInterface::scale_abstol", scale_abstol_);
+  if (version>=3) {
+    s.unpack("SundialsInterface::nvector_openmp", nvector_openmp_);
+  } else {
+    nvector_openmp_ = false;
+  }
+  if (version>=4) {
+    s.unpack("SundialsInterface::max_jacobian_age", max_jacobian_age_);
+  } else {
+    max_jacobian_age_ = 0;
+  }
 
   s.unpack("SundialsInterface::linsolF", linsolF_);
 
@@ -549,7 +754,7 @@ SundialsInterface::SundialsInterface(DeserializingStream& s) : Integrator(s) {
 
 void SundialsInterface::serialize_body(SerializingStream &s) const {
   Integrator::serialize_body(s);
-  s.version("SundialsInterface", 2);
+  s.version("SundialsInterface", 4);
   s.pack("SundialsInterface::abstol", abstol_);
   s.pack("SundialsInterface::reltol", reltol_);
   s.pack("SundialsInterface::max_num_steps", max_num_steps_);
@@ -571,6 +776,8 @@ void SundialsInterface::serialize_body(SerializingStream &s) const {
   s.pack("SundialsInterface::nonlin_conv_coeff", nonlin_conv_coeff_);
   s.pack("SundialsInterface::max_order", max_order_);
   s.pack("SundialsInterface::scale_abstol", scale_abstol_);
+  s.pack("SundialsInterface::nvector_openmp", nvector_openmp_);
+  s.pack("SundialsInterface::max_jacobian_age", max_jacobian_age_);
 
   s.pack("SundialsInterface::linsolF", linsolF_);
 
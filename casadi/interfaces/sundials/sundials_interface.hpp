@@ -62,6 +62,22 @@ namespace casadi {
     // Jacobian
     double *jacF;
 
+    /// Last evaluated Jacobian in the sparsity pattern of jacF, kept between calls
+    std::vector<double> jac;
+
+    /// Is jac set, number of steps since its evaluation
+    bool jac_valid;
+    casadi_int jac_age;
+
+    /// Reuse jac in the current linear solver setup, was it reused in the last one
+    bool reuse_jac, jac_reused;
+
+    /// Number of steps at the last linear solver setup
+    long nst_setup;
+
+    /// Number of Jacobian evaluations for the linear solver, forward and backward
+    long njevals;
+
     /// Stats, forward integration
     long nsteps, nfevals, nlinsetups, netfails;
     int qlast, qcur;
@@ -169,6 +185,12 @@ namespace casadi {
     void impulseB(IntegratorMemory* mem,
       const double* rx, const double* rz, const double* rp) const override;
 
+    /** \brief Decide if the last Jacobian can be reused in a linear solver setup */
+    bool reuse_jacF(SundialsMemory* m, long nst, bool jok) const;
+
+    /** \brief Allocate an N_Vector with the selected implementation */
+    N_Vector nv_new(casadi_int n) const;
+
     /** \brief Reset stats */
     void reset_stats(SundialsMemory* m) const;
 
@@ -212,6 +234,8 @@ namespace casadi {
     double nonlin_conv_coeff_;
     casadi_int max_order_;
     bool scale_abstol_;
+    bool nvector_openmp_;
+    casadi_int max_jacobian_age_;
     ///@}
 
     /// Linear solver
@@ -61,7 +61,18 @@ namespace casadi {
         "Order of the interpolating polynomials"}},
       {"collocation_scheme",
        {OT_STRING,
-        "Collocation scheme: radau|legendre"}}
+        "Collocation scheme: radau|legendre"}},
+      {"elements_per_step",
+       {OT_INT,
+        "Number of consecutive finite elements whose collocation equations are solved "
+        "as one block-structured system, with a Jacobian that is block triangular due to "
+        "the continuity coupling between neighbouring elements. Unless specified in "
+        "'rootfinder_options', the Jacobian is factorized block by block using the 'btf' "
+        "linear solver. Must divide the number of finite elements [1]"}},
+      {"parallelization",
+       {OT_STRING,
+        "Evaluation of the DAE at the collocation points of a step and of its derivatives, "
+        "cf. Function::map: serial|openmp|thread [serial]"}}
      }
   };
 
@@ -69,6 +80,9 @@ namespace casadi {
     // Default options
     deg_ = 3;
     collocation_scheme_ = "radau";
+    elements_per_step_ = 1;
+    parallelization_ = "serial";
+    casadi_int nfe = 20;
 
     // Read options
     for (auto&& op : opts) {
@@ -76,16 +90,40 @@ namespace casadi {
         deg_ = op.second;
       } else if (op.first=="collocation_scheme") {
         collocation_scheme_ = op.second.to_string();
+      } else if (op.first=="elements_per_step") {
+        elements_per_step_ = op.second;
+      } else if (op.first=="parallelization") {
+        parallelization_ = op.second.to_string();
+      } else if (op.first=="number_of_finite_elements") {
+        nfe = op.second;
+      }
+    }
+    casadi_assert(elements_per_step_ > 0, "Number of elements per step must be positive");
+    casadi_assert(nfe % elements_per_step_ == 0,
+      "Number of finite elements (" + str(nfe) + ") must be a multiple of "
+      "elements_per_step (" + str(elements_per_step_) + ")");
+
+    // Each step of the base class covers elements_per_step_ finite elements
+    Dict step_opts = opts;
+    if (elements_per_step_ > 1) {
+      step_opts["number_of_finite_elements"] = nfe / elements_per_step_;
+      // Factorize the block triangular Jacobian block by block
+      Dict rootfinder_options;
+      auto it = opts.find("rootfinder_options");
+      if (it != opts.end()) rootfinder_options = it->second;
+      if (rootfinder_options.find("linear_solver") == rootfinder_options.end()) {
+        rootfinder_options["linear_solver"] = "btf";
       }
+      step_opts["rootfinder_options"] = rootfinder_options;
     }
 
     // Call the base class init
-    ImplicitFixedStepIntegrator::init(opts);
+    ImplicitFixedStepIntegrator::init(step_opts);
   }
 
   MX Collocation::algebraic_state_init(const MX& x0, const MX& z0) const {
     MX ret = vertcat(x0, z0);
-    return repmat(ret, deg_);
+    return repmat(ret, deg_ * elements_per_step_);
   }
   MX Collocation::algebraic_state_output(const MX& Z) const {
     return Z(Slice(Z.size1()-nz_, Z.size1()));
@@ -146,28 +184,75 @@ namespace casadi {
     MX p = MX::sym("p", f.sparsity_in(DYN_P));
     MX u = MX::sym("u", f.sparsity_in(DYN_U));
 
-    // Implicitly defined variables (z and x)
-    MX v = MX::sym("v", deg_ * (nx1_ + nz1_));
+    // Number of finite elements in the step and their length
+    casadi_int ne = elements_per_step_;
+    MX he = h / ne;
+
+    // Implicitly defined variables (z and x), element by element
+    MX v = MX::sym("v", ne * deg_ * (nx1_ + nz1_));
     std::vector<casadi_int> v_offset(1, 0);
-    for (casadi_int d = 0; d < deg_; ++d) {
+    for (casadi_int d = 0; d < ne * deg_; ++d) {
       v_offset.push_back(v_offset.back() + nx1_);
       v_offset.push_back(v_offset.back() + nz1_);
     }
     std::vector<MX> vv = vertsplit(v, v_offset);
     std::vector<MX>::const_iterator vv_it = vv.begin();
 
-    // Collocated states
-    std::vector<MX> x(deg_ + 1), z(deg_ + 1);
-    for (casadi_int d = 1; d <= deg_; ++d) {
-      x[d] = *vv_it++;
-      z[d] = *vv_it++;
+    // Collocated states and state at the start of each element
+    std::vector<std::vector<MX> > x(ne, std::vector<MX>(deg_ + 1)), z = x;
+    for (casadi_int e = 0; e < ne; ++e) {
+      for (casadi_int d = 1; d <= deg_; ++d) {
+        x[e][d] = *vv_it++;
+        z[e][d] = *vv_it++;
+      }
+      // Continuity with the previous element
+      if (e == 0) {
+        x[e][0] = x0;
+      } else {
+        x[e][0] = D[0] * x[e - 1][0];
+        for (casadi_int d = 1; d <= deg_; ++d) x[e][0] += D[d] * x[e - 1][d];
+      }
     }
     casadi_assert_dev(vv_it == vv.end());
 
-    // Collocation time points
-    std::vector<MX> tt(deg_ + 1);
-    for (casadi_int d = 0; d <= deg_; ++d) {
-      tt[d] = t0 + h * tau_root[d];
+    // DAE evaluated at all collocation points of the step
+    std::vector<std::vector<MX> > f_res(ne * deg_);
+    if (parallelization_ == "serial") {
+      for (casadi_int e = 0; e < ne; ++e) {
+        for (casadi_int j = 1; j <= deg_; ++j) {
+          std::vector<MX> f_arg(DYN_NUM_IN);
+          f_arg[DYN_T] = t0 + he * (e + tau_root[j]);
+          f_arg[DYN_P] = p;
+          f_arg[DYN_U] = u;
+          f_arg[DYN_X] = x[e][j];
+          f_arg[DYN_Z] = z[e][j];
+          f_res[e * deg_ + j - 1] = f(f_arg);
+        }
+      }
+    } else {
+      // One mapped call, time and states stacked horizontally
+      std::vector<std::vector<MX> > f_arg(DYN_NUM_IN);
+      for (casadi_int e = 0; e < ne; ++e) {
+        for (casadi_int j = 1; j <= deg_; ++j) {
+          f_arg[DYN_T].push_back(f.nnz_in(DYN_T) ? t0 + he * (e + tau_root[j]) : t0);
+          f_arg[DYN_X].push_back(x[e][j]);
+          f_arg[DYN_Z].push_back(z[e][j]);
+        }
+      }
+      std::vector<MX> fm_arg(DYN_NUM_IN);
+      for (casadi_int i : {DYN_T, DYN_X, DYN_Z}) fm_arg[i] = horzcat(f_arg[i]);
+      fm_arg[DYN_P] = p;
+      fm_arg[DYN_U] = u;
+      Function fm = f.map(f.name() + "_map", parallelization_, ne * deg_,
+        std::vector<casadi_int>{DYN_P, DYN_U}, std::vector<casadi_int>{});
+      std::vector<MX> fm_res = fm(fm_arg);
+      for (casadi_int i = 0; i < DYN_NUM_OUT; ++i) {
+        std::vector<MX> r = horzsplit(fm_res[i], f.size2_out(i));
+        for (casadi_int k = 0; k < ne * deg_; ++k) {
+          f_res[k].resize(DYN_NUM_OUT);
+          f_res[k][i] = r[k];
+        }
+      }
     }
 
     // Equations that implicitly define v
@@ -177,37 +262,34 @@ namespace casadi {
     MX qf = MX::zeros(nq1_);
 
     // End state
-    MX xf = D[0] * x0;
-
-    // For all collocation points
-    for (casadi_int j = 1; j < deg_ + 1; ++j) {
-
-      // Evaluate the DAE
-      std::vector<MX> f_arg(DYN_NUM_IN);
-      f_arg[DYN_T] = tt[j];
-      f_arg[DYN_P] = p;
-      f_arg[DYN_U] = u;
-      f_arg[DYN_X] = x[j];
-      f_arg[DYN_Z] = z[j];
-      std::vector<MX> f_res = f(f_arg);
-
-      // Get an expression for the state derivative at the collocation point
-      MX xp_j = C[0][j] * x0;
-      for (casadi_int r = 1; r < deg_ + 1; ++r) {
-        xp_j += C[r][j] * x[r];
-      }
+    MX xf = D[0] * x[ne - 1][0];
+
+    // For all finite elements
+    for (casadi_int e = 0; e < ne; ++e) {
+      // For all collocation points
+      for (casadi_int j = 1; j < deg_ + 1; ++j) {
+        const std::vector<MX>& r = f_res[e * deg_ + j - 1];
+
+        // Get an expression for the state derivative at the collocation point
+        MX xp_j = C[0][j] * x[e][0];
+        for (casadi_int k = 1; k < deg_ + 1; ++k) {
+          xp_j += C[k][j] * x[e][k];
+        }
 
-      // Add collocation equation
-      eq.push_back(vec(h * f_res[DYN_ODE] - xp_j));
+        // Add collocation equation
+        eq.push_back(vec(he * r[DYN_ODE] - xp_j));
 
-      // Add the algebraic conditions
-      eq.push_back(vec(f_res[DYN_ALG]));
+        // Add the algebraic conditions
+        eq.push_back(vec(r[DYN_ALG]));
 
-      // Add contribution to the final state
-      xf += D[j] * x[j];
+        // Add contribution to quadratures
+        qf += (B[j] * he) * r[DYN_QUAD];
+      }
+    }
 
-      // Add contribution to quadratures
-      qf += (B[j] * h) * f_res[DYN_QUAD];
+    // Add contributions to the final state
+    for (casadi_int j = 1; j < deg_ + 1; ++j) {
+      xf += D[j] * x[ne - 1][j];
     }
 
     // Form forward discrete time dynamics
@@ -236,7 +318,7 @@ namespace casadi {
 
     // Initial guess for v (only non-augmented system part)
     double* v = m->v;
-    for (casadi_int d = 0; d < deg_; ++d) {
+    for (casadi_int d = 0; d < deg_ * elements_per_step_; ++d) {
       casadi_copy(x, nx1_, v);
       v += nx1_;
       casadi_copy(z, nz1_, v);
@@ -245,16 +327,25 @@ namespace casadi {
   }
 
   Collocation::Collocation(DeserializingStream& s) : ImplicitFixedStepIntegrator(s) {
-    s.version("Collocation", 2);
+    int version = s.version("Collocation", 2, 3);
     s.unpack("Collocation::deg", deg_);
     s.unpack("Collocation::collocation_scheme", collocation_scheme_);
+    if (version >= 3) {
+      s.unpack("Collocation::elements_per_step", elements_per_step_);
+      s.unpack("Collocation::parallelization", parallelization_);
+    } else {
+      elements_per_step_ = 1;
+      parallelization_ = "serial";
+    }
   }
 
   void Collocation::serialize_body(SerializingStream &s) const {
     ImplicitFixedStepIntegrator::serialize_body(s);
-    s.version("Collocation", 2);
+    s.version("Collocation", 3);
     s.pack("Collocation::deg", deg_);
     s.pack("Collocation::collocation_scheme", collocation_scheme_);
+    s.pack("Collocation::elements_per_step", elements_per_step_);
+    s.pack("Collocation::parallelization", parallelization_);
   }
 
 } // namespace casadi
@@ -104,6 +104,12 @@ namespace casadi {
     // Collocation scheme
     std::string collocation_scheme_;
 
+    // Number of finite elements per step
+    casadi_int elements_per_step_;
+
+    // Parallelization of the DAE evaluations in a step
+    std::string parallelization_;
+
     /// A documentation string
     static const std::string meta_doc;
 
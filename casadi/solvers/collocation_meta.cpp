@@ -43,6 +43,14 @@
 "| eme             |                 |                 | scheme (radau|l |\n"
 "|                 |                 |                 | egendre)        |\n"
 "+-----------------+-----------------+-----------------+-----------------+\n"
+"| elements_per_st | OT_INT          | 1               | Number of       |\n"
+"| ep              |                 |                 | consecutive     |\n"
+"|                 |                 |                 | finite elements |\n"
+"|                 |                 |                 | solved as one   |\n"
+"|                 |                 |                 | block-          |\n"
+"|                 |                 |                 | structured      |\n"
+"|                 |                 |                 | system          |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
 "| implicit_solver | OT_STRING       | GenericType()   | An implicit     |\n"
 "|                 |                 |                 | function solver |\n"
 "+-----------------+-----------------+-----------------+-----------------+\n"
@@ -57,6 +65,13 @@
 "| number_of_finit | OT_INT      | 20              | Number of       |\n"
 "| e_elements      |                 |                 | finite elements |\n"
 "+-----------------+-----------------+-----------------+-----------------+\n"
+"| parallelization | OT_STRING       | \"serial\"        | Evaluation of   |\n"
+"|                 |                 |                 | the DAE at the  |\n"
+"|                 |                 |                 | collocation     |\n"
+"|                 |                 |                 | points of a     |\n"
+"|                 |                 |                 | step (serial|op |\n"
+"|                 |                 |                 | enmp|thread)    |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
 "\n"
 "\n"
 "\n"
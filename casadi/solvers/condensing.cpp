@@ -0,0 +1,454 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "condensing.hpp"
+
+namespace casadi {
+
+  extern "C"
+  int CASADI_CONIC_CONDENSING_EXPORT
+  casadi_register_conic_condensing(Conic::Plugin* plugin) {
+    plugin->creator = Condensing::creator;
+    plugin->name = "condensing";
+    plugin->doc = Condensing::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Condensing::options_;
+    plugin->deserialize = &Condensing::deserialize;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_CONIC_CONDENSING_EXPORT casadi_load_conic_condensing() {
+    Conic::registerPlugin(casadi_register_conic_condensing);
+  }
+
+  Condensing::Condensing(const std::string& name, const std::map<std::string, Sparsity> &st)
+    : Conic(name, st) {
+  }
+
+  Condensing::~Condensing() {
+    clear_mem();
+  }
+
+  void* Condensing::alloc_mem() const {
+    auto m = new CondensingMemory();
+    m->qpsol_mem = qpsol_.checkout();
+    m->qpsol_full_mem = qpsol_full_.checkout();
+    return m;
+  }
+
+  void Condensing::free_mem(void *mem) const {
+    auto m = static_cast<CondensingMemory*>(mem);
+    qpsol_.release(m->qpsol_mem);
+    qpsol_full_.release(m->qpsol_full_mem);
+    delete m;
+  }
+
+  const Options Condensing::options_
+  = {{&Conic::options_},
+     {{"qpsol",
+       {OT_STRING,
+        "The QP solver to be used for the condensed QP."}},
+      {"qpsol_options",
+       {OT_DICT,
+        "Options to be passed to the QP solver."}},
+      {"block_size",
+       {OT_INT,
+        "Number of stages condensed into one block. "
+        "0 means full condensing [default: 0]."}},
+      {"pivot_tol",
+       {OT_DOUBLE,
+        "Pivots of the elimination below pivot_tol times the largest entry of "
+        "their constraint are rejected, the QP is then solved without condensing "
+        "[default: 1e-12]."}}
+     }
+  };
+
+  void Condensing::init(const Dict& opts) {
+    // Initialize the base classes
+    Conic::init(opts);
+
+    // Default options
+    std::string qpsol_plugin;
+    Dict qpsol_options;
+    block_size_ = 0;
+    pivot_tol_ = 1e-12;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="qpsol") {
+        qpsol_plugin = op.second.to_string();
+      } else if (op.first=="qpsol_options") {
+        qpsol_options = op.second;
+      } else if (op.first=="block_size") {
+        block_size_ = op.second;
+      } else if (op.first=="pivot_tol") {
+        pivot_tol_ = op.second;
+      }
+    }
+    casadi_assert(np_==0, "Conic constraints not supported");
+    casadi_assert(block_size_>=0, "'block_size' must be nonnegative");
+
+    // Detect the dynamics constraints
+    detect_elimination();
+
+    // Failures are handled by the condensing solver
+    if (qpsol_options.find("error_on_fail")==qpsol_options.end()) {
+      qpsol_options["error_on_fail"] = false;
+    }
+
+    // QP solver for the condensed QP
+    casadi_assert(!qpsol_plugin.empty(), "'qpsol' option has not been set");
+    qpsol_ = conic("qpsol", qpsol_plugin, {{"h", Hc_}, {"a", Ac_}}, qpsol_options);
+    alloc(qpsol_);
+
+    // QP solver without condensing, for constraints that cannot be used for the elimination
+    qpsol_full_ = conic("qpsol_full", qpsol_plugin, {{"h", H_}, {"a", A_}}, qpsol_options);
+    alloc(qpsol_full_);
+
+    // Setup memory structures
+    set_condensing_prob();
+    casadi_int sz_iw, sz_w;
+    casadi_condensing_work(&p_, &sz_iw, &sz_w);
+    alloc_iw(sz_iw, true);
+    alloc_w(sz_w, true);
+
+    if (verbose_) {
+      casadi_message("Eliminated " + str(elim_var_.size()) + " of " + str(nx_)
+        + " variables, condensed QP has " + str(free_var_.size()) + " variables and "
+        + str(Ac_.size1()) + " constraints.");
+    }
+  }
+
+  void Condensing::detect_elimination() {
+    // Constraints row-wise
+    At_ = A_.T();
+    const casadi_int *at_colind = At_.colind(), *at_row = At_.row();
+    // A constraint whose right-most variable is beyond the right-most variables
+    // of all preceding constraints can eliminate that variable
+    std::vector<casadi_int> cand, depth(nx_, -1);
+    casadi_int reach = -1;
+    for (casadi_int i = 0; i < na_; ++i) {
+      if (at_colind[i + 1] == at_colind[i]) continue;
+      casadi_int j = at_row[at_colind[i + 1] - 1];
+      if (j <= reach) continue;
+      reach = j;
+      cand.push_back(i);
+      // Number of preceding dynamics constraints in the chain, i.e. the stage
+      depth[j] = 0;
+      for (casadi_int k = at_colind[i]; k < at_colind[i + 1] - 1; ++k) {
+        casadi_int c = at_row[k];
+        if (depth[c] >= 0) depth[j] = std::max(depth[j], depth[c] + 1);
+      }
+    }
+    // Eliminated variables, with partial condensing the first state of each block is kept
+    elim_row_.clear();
+    elim_var_.clear();
+    piv_nz_.clear();
+    for (casadi_int i : cand) {
+      casadi_int j = at_row[at_colind[i + 1] - 1];
+      if (block_size_ > 0 && depth[j] % block_size_ == 0) continue;
+      elim_row_.push_back(i);
+      elim_var_.push_back(j);
+      piv_nz_.push_back(at_colind[i + 1] - 1);
+    }
+    casadi_int ne = elim_var_.size();
+    // Remaining variables and constraints
+    ivar_.assign(nx_, 0);
+    free_var_.clear();
+    for (casadi_int e = 0; e < ne; ++e) ivar_[elim_var_[e]] = -1 - e;
+    for (casadi_int j = 0; j < nx_; ++j) {
+      if (ivar_[j] == 0) {
+        ivar_[j] = free_var_.size();
+        free_var_.push_back(j);
+      }
+    }
+    std::vector<bool> is_elim_row(na_, false);
+    for (casadi_int i : elim_row_) is_elim_row[i] = true;
+    keep_row_.clear();
+    for (casadi_int i = 0; i < na_; ++i) {
+      if (!is_elim_row[i]) keep_row_.push_back(i);
+    }
+    casadi_int nf = free_var_.size();
+    // Sparsity pattern of T', column by column in the order of the variables
+    std::vector<casadi_int> tt_colind(nx_ + 1, 0), tt_row, mark(nf, -1);
+    for (casadi_int j = 0; j < nx_; ++j) {
+      if (ivar_[j] >= 0) {
+        tt_row.push_back(ivar_[j]);
+      } else {
+        casadi_int i = elim_row_[-1 - ivar_[j]];
+        casadi_int start = tt_row.size();
+        for (casadi_int k = at_colind[i]; k < at_colind[i + 1]; ++k) {
+          casadi_int c = at_row[k];
+          if (c == j) continue;
+          for (casadi_int k1 = tt_colind[c]; k1 < tt_colind[c + 1]; ++k1) {
+            casadi_int r = tt_row[k1];
+            if (mark[r] != j) {
+              mark[r] = j;
+              tt_row.push_back(r);
+            }
+          }
+        }
+        std::sort(tt_row.begin() + start, tt_row.end());
+      }
+      tt_colind[j + 1] = tt_row.size();
+    }
+    Tt_ = Sparsity(nf, nx_, tt_colind, tt_row);
+    T_ = Tt_.T();
+    // Sparsity patterns of the products
+    HT_ = Sparsity::mtimes(H_, T_);
+    Hc_ = Sparsity::mtimes(Tt_, HT_);
+    AT_ = Sparsity::mtimes(A_, T_);
+    // Condensed constraints: remaining constraints, then bounds on eliminated variables
+    std::vector<casadi_int> map_r, map_e;
+    Sparsity Ar = AT_.sub(keep_row_, range(nf), map_r);
+    Sparsity Te = T_.sub(elim_var_, range(nf), map_e);
+    Ac_ = Sparsity::vertcat({Ar, Te});
+    ac_map_.clear();
+    for (casadi_int c = 0; c < nf; ++c) {
+      for (casadi_int k = Ar.colind()[c]; k < Ar.colind()[c + 1]; ++k) {
+        ac_map_.push_back(map_r[k]);
+      }
+      for (casadi_int k = Te.colind()[c]; k < Te.colind()[c + 1]; ++k) {
+        ac_map_.push_back(-1 - map_e[k]);
+      }
+    }
+  }
+
+  void Condensing::set_condensing_prob() {
+    p_.nx = nx_;
+    p_.na = na_;
+    p_.ne = elim_var_.size();
+    p_.nr = keep_row_.size();
+    p_.sp_h = H_;
+    p_.sp_a = A_;
+    p_.sp_at = At_;
+    p_.sp_t = T_;
+    p_.sp_tt = Tt_;
+    p_.sp_ht = HT_;
+    p_.sp_atm = AT_;
+    p_.sp_hc = Hc_;
+    p_.sp_ac = Ac_;
+    p_.ivar = get_ptr(ivar_);
+    p_.free_var = get_ptr(free_var_);
+    p_.elim_row = get_ptr(elim_row_);
+    p_.elim_var = get_ptr(elim_var_);
+    p_.piv_nz = get_ptr(piv_nz_);
+    p_.keep_row = get_ptr(keep_row_);
+    p_.ac_map = get_ptr(ac_map_);
+    p_.piv_tol = pivot_tol_;
+  }
+
+  int Condensing::
+  solve(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
+    auto m = static_cast<CondensingMemory*>(mem);
+    // Form the condensed QP
+    casadi_condensing_data<double> d;
+    d.prob = &p_;
+    casadi_condensing_init(&d, &iw, &w);
+    int flag = casadi_condensing_form(&d, arg[CONIC_H], arg[CONIC_G], arg[CONIC_A],
+      arg[CONIC_LBA], arg[CONIC_UBA], arg[CONIC_LBX], arg[CONIC_UBX],
+      arg[CONIC_X0], arg[CONIC_LAM_X0], arg[CONIC_LAM_A0]);
+    m->condensed = flag == 0;
+    if (!m->condensed) {
+      // Not an equality or a small pivot: solve without condensing
+      if (verbose_) {
+        casadi_message(std::string(flag == 1 ? "Eliminating constraint is not an equality"
+          : "Small pivot in the elimination") + ", solving without condensing");
+      }
+      int ret = qpsol_full_(arg, res, iw, w, m->qpsol_full_mem);
+      auto m_qpsol = static_cast<ConicMemory*>(qpsol_full_.memory(m->qpsol_full_mem));
+      m->d_qp.success = m_qpsol->d_qp.success;
+      m->d_qp.unified_return_status = m_qpsol->d_qp.unified_return_status;
+      m->d_qp.iter_count = m_qpsol->d_qp.iter_count;
+      return ret;
+    }
+    // Solve the condensed QP
+    const double** arg1 = arg + n_in_;
+    double** res1 = res + n_out_;
+    std::fill_n(arg1, static_cast<casadi_int>(CONIC_NUM_IN), nullptr);
+    std::fill_n(res1, static_cast<casadi_int>(CONIC_NUM_OUT), nullptr);
+    arg1[CONIC_H] = d.hc;
+    arg1[CONIC_G] = d.gc;
+    arg1[CONIC_A] = d.ac;
+    arg1[CONIC_LBA] = d.lba;
+    arg1[CONIC_UBA] = d.uba;
+    arg1[CONIC_LBX] = d.lbx;
+    arg1[CONIC_UBX] = d.ubx;
+    arg1[CONIC_X0] = d.x0;
+    arg1[CONIC_LAM_X0] = d.lam_x0;
+    arg1[CONIC_LAM_A0] = d.lam_a0;
+    res1[CONIC_X] = d.x;
+    res1[CONIC_LAM_X] = d.lam_x;
+    res1[CONIC_LAM_A] = d.lam_a;
+    int ret = qpsol_(arg1, res1, iw, w, m->qpsol_mem);
+    auto m_qpsol = static_cast<ConicMemory*>(qpsol_.memory(m->qpsol_mem));
+    m->d_qp.success = m_qpsol->d_qp.success;
+    m->d_qp.unified_return_status = m_qpsol->d_qp.unified_return_status;
+    m->d_qp.iter_count = m_qpsol->d_qp.iter_count;
+    // Expand the solution
+    casadi_condensing_expand(&d, arg[CONIC_H], arg[CONIC_G], res[CONIC_COST],
+      res[CONIC_X], res[CONIC_LAM_X], res[CONIC_LAM_A]);
+    return ret;
+  }
+
+  void Condensing::codegen_declarations(CodeGenerator& g) const {
+    g.add_dependency(qpsol_);
+    g.add_dependency(qpsol_full_);
+  }
+
+  void Condensing::codegen_body(CodeGenerator& g) const {
+    g.add_auxiliary(CodeGenerator::AUX_CONDENSING);
+    g.local("d", "struct casadi_condensing_data");
+    g.local("p", "struct casadi_condensing_prob");
+    g.local("arg1", "const casadi_real*", "*");
+    g.local("res1", "casadi_real*", "*");
+    g.local("flag", "int");
+
+    // Setup memory structures
+    g << "p.nx = " << p_.nx << ";\n";
+    g << "p.na = " << p_.na << ";\n";
+    g << "p.ne = " << p_.ne << ";\n";
+    g << "p.nr = " << p_.nr << ";\n";
+    g << "p.sp_h = " << g.sparsity(H_) << ";\n";
+    g << "p.sp_a = " << g.sparsity(A_) << ";\n";
+    g << "p.sp_at = " << g.sparsity(At_) << ";\n";
+    g << "p.sp_t = " << g.sparsity(T_) << ";\n";
+    g << "p.sp_tt = " << g.sparsity(Tt_) << ";\n";
+    g << "p.sp_ht = " << g.sparsity(HT_) << ";\n";
+    g << "p.sp_atm = " << g.sparsity(AT_) << ";\n";
+    g << "p.sp_hc = " << g.sparsity(Hc_) << ";\n";
+    g << "p.sp_ac = " << g.sparsity(Ac_) << ";\n";
+    g << "p.ivar = " << g.constant(ivar_) << ";\n";
+    g << "p.free_var = " << g.constant(free_var_) << ";\n";
+    g << "p.elim_row = " << g.constant(elim_row_) << ";\n";
+    g << "p.elim_var = " << g.constant(elim_var_) << ";\n";
+    g << "p.piv_nz = " << g.constant(piv_nz_) << ";\n";
+    g << "p.keep_row = " << g.constant(keep_row_) << ";\n";
+    g << "p.ac_map = " << g.constant(ac_map_) << ";\n";
+    g << "p.piv_tol = " << g.constant(pivot_tol_) << ";\n";
+    g << "d.prob = &p;\n";
+    g << "casadi_condensing_init(&d, &iw, &w);\n";
+
+    g.comment("Form the condensed QP");
+    g << "if (casadi_condensing_form(&d, " << g.arg(CONIC_H) << ", " << g.arg(CONIC_G) << ", "
+      << g.arg(CONIC_A) << ", " << g.arg(CONIC_LBA) << ", " << g.arg(CONIC_UBA) << ", "
+      << g.arg(CONIC_LBX) << ", " << g.arg(CONIC_UBX) << ", " << g.arg(CONIC_X0) << ", "
+      << g.arg(CONIC_LAM_X0) << ", " << g.arg(CONIC_LAM_A0) << ")) {\n";
+    g.comment("Not an equality or a small pivot: solve without condensing");
+    g << "flag = " << g(qpsol_full_, "arg", "res", "iw", "w") << ";\n";
+    if (error_on_fail_) {
+      g << "if (flag) return -1000;\n";
+    }
+    g << "return flag;\n";
+    g << "}\n";
+
+    g.comment("Solve the condensed QP");
+    g << "arg1 = arg+" << n_in_ << ";\n";
+    for (casadi_int i=0; i<qpsol_.n_in(); ++i) g << "arg1[" << i << "] = 0;\n";
+    g << "arg1[" << CONIC_H << "] = d.hc;\n";
+    g << "arg1[" << CONIC_G << "] = d.gc;\n";
+    g << "arg1[" << CONIC_A << "] = d.ac;\n";
+    g << "arg1[" << CONIC_LBA << "] = d.lba;\n";
+    g << "arg1[" << CONIC_UBA << "] = d.uba;\n";
+    g << "arg1[" << CONIC_LBX << "] = d.lbx;\n";
+    g << "arg1[" << CONIC_UBX << "] = d.ubx;\n";
+    g << "arg1[" << CONIC_X0 << "] = d.x0;\n";
+    g << "arg1[" << CONIC_LAM_X0 << "] = d.lam_x0;\n";
+    g << "arg1[" << CONIC_LAM_A0 << "] = d.lam_a0;\n";
+    g << "res1 = res+" << n_out_ << ";\n";
+    for (casadi_int i=0; i<qpsol_.n_out(); ++i) g << "res1[" << i << "] = 0;\n";
+    g << "res1[" << CONIC_X << "] = d.x;\n";
+    g << "res1[" << CONIC_LAM_X << "] = d.lam_x;\n";
+    g << "res1[" << CONIC_LAM_A << "] = d.lam_a;\n";
+    g << "flag = " << g(qpsol_, "arg1", "res1", "iw", "w") << ";\n";
+
+    g.comment("Expand the solution");
+    g << "casadi_condensing_expand(&d, " << g.arg(CONIC_H) << ", " << g.arg(CONIC_G) << ", "
+      << g.res(CONIC_COST) << ", " << g.res(CONIC_X) << ", " << g.res(CONIC_LAM_X) << ", "
+      << g.res(CONIC_LAM_A) << ");\n";
+    if (error_on_fail_) {
+      g << "if (flag) return -1000;\n";
+    }
+    g << "return flag;\n";
+  }
+
+  Dict Condensing::get_stats(void* mem) const {
+    Dict stats = Conic::get_stats(mem);
+    auto m = static_cast<CondensingMemory*>(mem);
+    stats["condensed"] = m->condensed;
+    stats["qpsol_stats"] = m->condensed ? qpsol_.stats(m->qpsol_mem)
+      : qpsol_full_.stats(m->qpsol_full_mem);
+    return stats;
+  }
+
+  Condensing::Condensing(DeserializingStream& s) : Conic(s) {
+    s.version("Condensing", 1);
+    s.unpack("Condensing::qpsol", qpsol_);
+    s.unpack("Condensing::qpsol_full", qpsol_full_);
+    s.unpack("Condensing::pivot_tol", pivot_tol_);
+    s.unpack("Condensing::block_size", block_size_);
+    s.unpack("Condensing::At", At_);
+    s.unpack("Condensing::T", T_);
+    s.unpack("Condensing::Tt", Tt_);
+    s.unpack("Condensing::HT", HT_);
+    s.unpack("Condensing::AT", AT_);
+    s.unpack("Condensing::Hc", Hc_);
+    s.unpack("Condensing::Ac", Ac_);
+    s.unpack("Condensing::ivar", ivar_);
+    s.unpack("Condensing::free_var", free_var_);
+    s.unpack("Condensing::elim_row", elim_row_);
+    s.unpack("Condensing::elim_var", elim_var_);
+    s.unpack("Condensing::piv_nz", piv_nz_);
+    s.unpack("Condensing::keep_row", keep_row_);
+    s.unpack("Condensing::ac_map", ac_map_);
+    set_condensing_prob();
+  }
+
+  void Condensing::serialize_body(SerializingStream &s) const {
+    Conic::serialize_body(s);
+
+    s.version("Condensing", 1);
+    s.pack("Condensing::qpsol", qpsol_);
+    s.pack("Condensing::qpsol_full", qpsol_full_);
+    s.pack("Condensing::pivot_tol", pivot_tol_);
+    s.pack("Condensing::block_size", block_size_);
+    s.pack("Condensing::At", At_);
+    s.pack("Condensing::T", T_);
+    s.pack("Condensing::Tt", Tt_);
+    s.pack("Condensing::HT", HT_);
+    s.pack("Condensing::AT", AT_);
+    s.pack("Condensing::Hc", Hc_);
+    s.pack("Condensing::Ac", Ac_);
+    s.pack("Condensing::ivar", ivar_);
+    s.pack("Condensing::free_var", free_var_);
+    s.pack("Condensing::elim_row", elim_row_);
+    s.pack("Condensing::elim_var", elim_var_);
+    s.pack("Condensing::piv_nz", piv_nz_);
+    s.pack("Condensing::keep_row", keep_row_);
+    s.pack("Condensing::ac_map", ac_map_);
+  }
+
+} // namespace casadi
@@ -0,0 +1,161 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_CONDENSING_HPP
+#define CASADI_CONDENSING_HPP
+
+#include "casadi/core/conic_impl.hpp"
+#include <casadi/solvers/casadi_conic_condensing_export.h>
+
+/** \defgroup plugin_Conic_condensing Title
+    \par
+
+ Condenses QPs with optimal control structure and solves the condensed QP
+ with another QP solver (option 'qpsol').
+
+ The dynamics constraints are detected from the sparsity pattern of A:
+ a constraint whose right-most variable lies beyond the right-most variables
+ of all preceding constraints is used to eliminate that variable. For a
+ multiple-shooting discretization ordered as [x0, u0, x1, u1, ..., xN],
+ with the constraints of each stage ordered after its dynamics, these are
+ the continuity constraints and the eliminated variables are the states.
+ If at runtime a detected constraint is not an equality (lba!=uba), or its
+ pivot is below 'pivot_tol' relative to the largest entry of the constraint,
+ the QP is solved without condensing, by the same QP solver.
+
+ With full condensing (block_size 0), the condensed QP only contains the
+ controls (and the initial state when it is not fixed by a constraint).
+ With partial condensing, the states at the start of each block of
+ block_size stages are kept, preserving a sparse block structure.
+
+ Bounds on eliminated variables become general constraints in the
+ condensed QP.
+
+    \identifier{287} */
+
+/** \pluginsection{Conic,condensing} */
+
+/// \cond INTERNAL
+namespace casadi {
+  struct CASADI_CONIC_CONDENSING_EXPORT CondensingMemory : public ConicMemory {
+    // Memory of the QP solver
+    int qpsol_mem;
+    // Memory of the QP solver without condensing
+    int qpsol_full_mem;
+    // Was the last QP condensed?
+    bool condensed = true;
+  };
+
+  /** \brief \pluginbrief{Conic,condensing}
+
+      @copydoc Conic_doc
+      @copydoc plugin_Conic_condensing
+  */
+  class CASADI_CONIC_CONDENSING_EXPORT Condensing : public Conic {
+  public:
+    /** \brief  Create a new Solver */
+    explicit Condensing(const std::string& name,
+                        const std::map<std::string, Sparsity> &st);
+
+    /** \brief  Create a new QP Solver */
+    static Conic* creator(const std::string& name,
+                          const std::map<std::string, Sparsity>& st) {
+      return new Condensing(name, st);
+    }
+
+    /** \brief  Destructor */
+    ~Condensing() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "condensing";}
+
+    // Get name of the class
+    std::string class_name() const override { return "Condensing";}
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override;
+
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /** \brief Initialize */
+    void init(const Dict& opts) override;
+
+    /** \brief Solve the QP */
+    int solve(const double** arg, double** res,
+             casadi_int* iw, double* w, void* mem) const override;
+
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
+
+    /** \brief Generate code for the declarations of the C function */
+    void codegen_declarations(CodeGenerator& g) const override;
+
+    /** \brief Generate code for the function body */
+    void codegen_body(CodeGenerator& g) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+    // Memory structure
+    casadi_condensing_prob<double> p_;
+    // Solver for the condensed QP
+    Function qpsol_;
+    // Solver for the QP without condensing, when the elimination fails
+    Function qpsol_full_;
+    // Number of stages per block, 0 for full condensing
+    casadi_int block_size_;
+    // Relative pivot tolerance
+    double pivot_tol_;
+    // Sparsity patterns
+    Sparsity At_, T_, Tt_, HT_, AT_, Hc_, Ac_;
+    // Elimination
+    std::vector<casadi_int> ivar_, free_var_, elim_row_, elim_var_, piv_nz_, keep_row_, ac_map_;
+
+    void serialize_body(SerializingStream &s) const override;
+
+    /** \brief Deserialize with type disambiguation */
+    static ProtoFunction* deserialize(DeserializingStream& s) { return new Condensing(s); }
+
+  protected:
+     /** \brief Deserializing constructor */
+    explicit Condensing(DeserializingStream& s);
+
+  private:
+    // Detect the dynamics constraints and the eliminated variables
+    void detect_elimination();
+
+    // Set up memory structures
+    void set_condensing_prob();
+  };
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_CONDENSING_HPP
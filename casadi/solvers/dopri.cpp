@@ -0,0 +1,821 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "dopri.hpp"
+#include "casadi/core/casadi_misc.hpp"
+#include <cmath>
+
+namespace casadi {
+
+  extern "C"
+  int CASADI_INTEGRATOR_DOPRI_EXPORT
+      casadi_register_integrator_dopri(Integrator::Plugin* plugin) {
+    plugin->creator = Dopri::creator;
+    plugin->name = "dopri";
+    plugin->doc = Dopri::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Dopri::options_;
+    plugin->deserialize = &Dopri::deserialize;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_INTEGRATOR_DOPRI_EXPORT casadi_load_integrator_dopri() {
+    Integrator::registerPlugin(casadi_register_integrator_dopri);
+  }
+
+  // Butcher tableau of the Dormand-Prince 5(4) pair, the last row holds the weights
+  static const double dopri_c[7] = {0., 1./5, 3./10, 4./5, 8./9, 1., 1.};
+  static const double dopri_a[7][6] = {
+    {0., 0., 0., 0., 0., 0.},
+    {1./5, 0., 0., 0., 0., 0.},
+    {3./40, 9./40, 0., 0., 0., 0.},
+    {44./45, -56./15, 32./9, 0., 0., 0.},
+    {19372./6561, -25360./2187, 64448./6561, -212./729, 0., 0.},
+    {9017./3168, -355./33, 46732./5247, 49./176, -5103./18656, 0.},
+    {35./384, 0., 500./1113, 125./192, -2187./6784, 11./84}};
+
+  Dopri::Dopri(const std::string& name, const Function& dae, double t0,
+      const std::vector<double>& tout)
+      : Integrator(name, dae, t0, tout) {
+  }
+
+  Dopri::~Dopri() {
+    clear_mem();
+  }
+
+  const Options Dopri::options_
+  = {{&Integrator::options_},
+     {{"abstol",
+       {OT_DOUBLE,
+        "Absolute tolerance for the local error test [1e-8]"}},
+      {"reltol",
+       {OT_DOUBLE,
+        "Relative tolerance for the local error test [1e-6]"}},
+      {"step0",
+       {OT_DOUBLE,
+        "Initial step size [default: estimated from the initial state and its derivative]"}},
+      {"min_step_size",
+       {OT_DOUBLE,
+        "Minimum step size [0]"}},
+      {"max_step_size",
+       {OT_DOUBLE,
+        "Maximum step size [inf]"}},
+      {"max_num_steps",
+       {OT_INT,
+        "Maximum number of steps, over the whole time horizon [10000]"}}
+     }
+  };
+
+  void Dopri::init(const Dict& opts) {
+    // Call the base class init
+    Integrator::init(opts);
+
+    // Algebraic variables not supported
+    casadi_assert(nz_==0 && nrz_==0,
+      "Explicit Runge-Kutta integrators do not support algebraic variables");
+
+    // Default options
+    abstol_ = 1e-8;
+    reltol_ = 1e-6;
+    step0_ = 0;
+    min_step_size_ = 0;
+    max_step_size_ = inf;
+    max_num_steps_ = 10000;
+
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="abstol") {
+        abstol_ = op.second;
+      } else if (op.first=="reltol") {
+        reltol_ = op.second;
+      } else if (op.first=="step0") {
+        step0_ = op.second;
+      } else if (op.first=="min_step_size") {
+        min_step_size_ = op.second;
+      } else if (op.first=="max_step_size") {
+        max_step_size_ = op.second;
+      } else if (op.first=="max_num_steps") {
+        max_num_steps_ = op.second;
+      }
+    }
+
+    // Consistency checks
+    casadi_assert(abstol_ > 0 && reltol_ >= 0, "Tolerances must be positive");
+    casadi_assert(step0_ >= 0, "Initial step size must be non-negative");
+    casadi_assert(max_step_size_ > min_step_size_, "Inconsistent step size bounds");
+
+    // Instantiate functions, forward problem
+    set_function(oracle_, "dae");
+
+    // Get discrete time dimensions: all seven stages, ODE and quadratures
+    nk1_ = nx1_ + nq1_;
+    nv1_ = 7 * nk1_;
+    nrv1_ = nv1_ * nadj_;
+    nv_ = nv1_ * (1 + nfwd_);
+    nrv_ = nrv1_ * (1 + nfwd_);
+
+    // Setup discrete time dynamics
+    setup_step();
+
+    // Work vectors, forward problem
+    alloc_w(nv_, true); // v
+    alloc_w(np_, true); // p
+    alloc_w(nu_, true); // u
+    alloc_w(nq_, true); // q
+    alloc_w(nv_, true); // v_prev
+    alloc_w(nq_, true); // q_prev
+
+    // Work vectors, backward problem
+    alloc_w(nrv_, true); // rv
+    alloc_w(nrp_, true); // rp
+    alloc_w(nuq_, true); // uq
+    alloc_w(nrv_, true); // rv_prev
+    alloc_w(nrq_, true); // rq_prev
+    alloc_w(nuq_, true); // uq_prev
+  }
+
+  void Dopri::setup_step() {
+    // Continuous-time dynamics, forward problem
+    Function f = get_function("dae");
+
+    // Symbolic inputs
+    MX t0 = MX::sym("t0", f.sparsity_in(DYN_T));
+    MX h = MX::sym("h");
+    MX x0 = MX::sym("x0", f.sparsity_in(DYN_X));
+    MX v0 = MX::sym("v0", nv1_);
+    MX p = MX::sym("p", f.sparsity_in(DYN_P));
+    MX u = MX::sym("u", f.sparsity_in(DYN_U));
+
+    // Arguments when calling f
+    std::vector<MX> f_arg(DYN_NUM_IN);
+    std::vector<MX> f_res;
+    f_arg[DYN_P] = p;
+    f_arg[DYN_U] = u;
+
+    // Stage derivatives, ODE and quadratures
+    std::vector<MX> k(7), kq(7);
+
+    // First stage is the last stage of the previous step
+    k[0] = v0(Slice(6 * nk1_, 6 * nk1_ + nx1_));
+    kq[0] = v0(Slice(6 * nk1_ + nx1_, 7 * nk1_));
+
+    // Remaining stages, the argument of the last one is the new state
+    MX xf;
+    for (casadi_int s = 1; s < 7; ++s) {
+      MX dx = 0;
+      for (casadi_int j = 0; j < s; ++j) {
+        if (dopri_a[s][j] != 0) dx += dopri_a[s][j] * k[j];
+      }
+      f_arg[DYN_T] = t0 + dopri_c[s] * h;
+      f_arg[DYN_X] = x0 + h * dx;
+      if (s == 6) xf = f_arg[DYN_X];
+      f_res = f(f_arg);
+      k[s] = f_res[DYN_ODE];
+      kq[s] = f_res[DYN_QUAD];
+    }
+
+    // Quadratures, same weights
+    MX qf = MX::zeros(f.sparsity_out(DYN_QUAD));
+    for (casadi_int j = 0; j < 6; ++j) {
+      if (dopri_a[6][j] != 0) qf += dopri_a[6][j] * kq[j];
+    }
+    qf = h * qf;
+
+    // All stages, needed for error control and dense output
+    std::vector<MX> vf;
+    for (casadi_int s = 0; s < 7; ++s) {
+      vf.push_back(k[s]);
+      vf.push_back(kq[s]);
+    }
+
+    // Define discrete time dynamics
+    f_arg.resize(STEP_NUM_IN);
+    f_arg[STEP_T] = t0;
+    f_arg[STEP_H] = h;
+    f_arg[STEP_X0] = x0;
+    f_arg[STEP_V0] = v0;
+    f_arg[STEP_P] = p;
+    f_arg[STEP_U] = u;
+    f_res.resize(STEP_NUM_OUT);
+    f_res[STEP_XF] = xf;
+    f_res[STEP_VF] = vertcat(vf);
+    f_res[STEP_QF] = qf;
+    Function F("step", f_arg, f_res,
+      {"t", "h", "x0", "v0", "p", "u"}, {"xf", "vf", "qf"});
+    set_function(F, F.name(), true);
+    if (nfwd_ > 0) create_forward("step", nfwd_);
+
+    // First stage at the beginning and after a change in the controls
+    std::vector<MX> dae_arg(DYN_NUM_IN);
+    dae_arg[DYN_T] = t0;
+    dae_arg[DYN_X] = x0;
+    dae_arg[DYN_P] = p;
+    dae_arg[DYN_U] = u;
+    std::vector<MX> dae_res = f(dae_arg);
+    f_res[STEP_XF] = x0;
+    f_res[STEP_VF] = vertcat(MX::zeros(6 * nk1_, 1), dae_res[DYN_ODE], dae_res[DYN_QUAD]);
+    f_res[STEP_QF] = MX::zeros(f.sparsity_out(DYN_QUAD));
+    Function F0("init", f_arg, f_res,
+      {"t", "h", "x0", "v0", "p", "u"}, {"xf", "vf", "qf"});
+    set_function(F0, F0.name(), true);
+    if (nfwd_ > 0) create_forward("init", nfwd_);
+
+    // Backward integration
+    if (nadj_ > 0) {
+      for (const Function& G : {F, F0}) {
+        Function adj_G = G.reverse(nadj_);
+        set_function(adj_G, adj_G.name(), true);
+        if (nfwd_ > 0) {
+          create_forward(adj_G.name(), nfwd_);
+        }
+      }
+    }
+  }
+
+  void Dopri::set_work(void* mem, const double**& arg, double**& res,
+      casadi_int*& iw, double*& w) const {
+    auto m = static_cast<DopriMemory*>(mem);
+
+    // Set work in base classes
+    Integrator::set_work(mem, arg, res, iw, w);
+
+    // Work vectors, allocated in base class
+    m->x = w; w += nx_;
+    m->z = w; w += nz_;
+    m->x_prev = w; w += nx_;
+    m->rx = w; w += nrx_;
+    m->rz = w; w += nrz_;
+    m->rx_prev = w; w += nrx_;
+    m->rq = w; w += nrq_;
+
+    // Work vectors, forward problem
+    m->v = w; w += nv_;
+    m->p = w; w += np_;
+    m->u = w; w += nu_;
+    m->q = w; w += nq_;
+    m->v_prev = w; w += nv_;
+    m->q_prev = w; w += nq_;
+
+    // Work vectors, backward problem
+    m->rv = w; w += nrv_;
+    m->rp = w; w += nrp_;
+    m->uq = w; w += nuq_;
+    m->rv_prev = w; w += nrv_;
+    m->rq_prev = w; w += nrq_;
+    m->uq_prev = w; w += nuq_;
+  }
+
+  int Dopri::init_mem(void* mem) const {
+    if (Integrator::init_mem(mem)) return 1;
+    auto m = static_cast<DopriMemory*>(mem);
+    m->nsteps = m->netfails = 0;
+    return 0;
+  }
+
+  void Dopri::reset(IntegratorMemory* mem, const double* x, const double* z,
+      const double* p) const {
+    auto m = static_cast<DopriMemory*>(mem);
+
+    // Set parameters
+    casadi_copy(p, np_, m->p);
+
+    // Update the state
+    casadi_copy(x, nx_, m->x);
+
+    // Reset summation states
+    casadi_clear(m->q, nq_);
+
+    // Stages are calculated when the integration starts
+    casadi_clear(m->v, nv_);
+
+    // Reset time and step size
+    m->tcur = m->tprev = m->t;
+    m->h = 0;
+
+    // Reset statistics
+    m->nsteps = m->netfails = 0;
+
+    // Clear the tape
+    if (nrx_ > 0) {
+      m->tape_t.clear();
+      m->tape_h.clear();
+      m->tape_x.clear();
+      m->tape_v.clear();
+      m->tape_k.assign(1, 0);
+    }
+  }
+
+  void Dopri::advance(IntegratorMemory* mem,
+      const double* u, double* x, double* z, double* q) const {
+    auto m = static_cast<DopriMemory*>(mem);
+
+    // (Re)calculate the first stage at the beginning or after a change in the controls.
+    // With adjoints, each interval has its own controls, even if the values coincide
+    bool init = m->k == 0 || (nrx_ > 0 && nu_ > 0);
+    for (casadi_int i = 0; i < nu_ && !init; ++i) init = (u ? u[i] : 0) != m->u[i];
+    if (init) {
+      casadi_copy(u, nu_, m->u);
+      stepF(m, true, m->tcur, 0, m->x, nullptr, nullptr, m->v, nullptr);
+      if (nfwd_ > 0) fstepF(m, true, m->tcur, 0, m->x, nullptr, nullptr, m->v, nullptr);
+      if (nrx_ > 0) tape_step(m, m->tcur, 0, m->x, m->v);
+    }
+
+    // Initial step size
+    if (m->h == 0) {
+      m->h = step0_ > 0 ? step0_
+        : casadi_dopri_h0(nx1_, m->x, m->v + 6 * nk1_, abstol_, reltol_);
+    }
+
+    // Steps may not pass the next stop time, or the next output time if the steps are taped
+    double t_lim = nrx_ > 0 ? m->t_next : m->t_stop;
+
+    // Take steps until the output time has been reached or passed
+    bool rejected = false;
+    while (m->tcur < m->t_next) {
+      // Step size, stretched by at most 1% to reach the limit
+      double h = std::fmin(m->h, max_step_size_);
+      bool last = m->tcur + 1.01 * h >= t_lim;
+      if (last) h = t_lim - m->tcur;
+      casadi_assert(h >= min_step_size_ && m->tcur + h > m->tcur,
+        "Step size too small at t = " + str(m->tcur));
+      casadi_assert(m->nsteps < max_num_steps_,
+        "Maximum number of steps reached at t = " + str(m->tcur));
+
+      // Trial step, nondifferentiated
+      casadi_copy(m->x, nx_, m->x_prev);
+      casadi_copy(m->v, nv_, m->v_prev);
+      casadi_copy(m->q, nq_, m->q_prev);
+      stepF(m, false, m->tcur, h, m->x_prev, m->v_prev, m->x, m->v, m->q);
+
+      // Local error test
+      double err = casadi_dopri_err(nx1_, nk1_, h, m->x_prev, m->x, m->v, abstol_, reltol_);
+      if (verbose_) casadi_message("t = " + str(m->tcur) + ", h = " + str(h)
+        + ", err = " + str(err));
+      if (err > 1) {
+        // Reject the step and retry with a smaller step size
+        casadi_copy(m->x_prev, nx_, m->x);
+        casadi_copy(m->v_prev, nv_, m->v);
+        casadi_copy(m->q_prev, nq_, m->q);
+        m->h = h * casadi_dopri_fac(err, 1.);
+        m->netfails++;
+        rejected = true;
+        continue;
+      }
+
+      // Accept the step
+      if (nfwd_ > 0) fstepF(m, false, m->tcur, h, m->x_prev, m->v_prev, m->x, m->v, m->q);
+      casadi_axpy(nq_, 1., m->q_prev, m->q);
+      if (nrx_ > 0) tape_step(m, m->tcur, h, m->x_prev, m->v_prev);
+      m->tprev = m->tcur;
+      m->tcur = last ? t_lim : m->tcur + h;
+      m->nsteps++;
+
+      // Size of the next step, no increase directly after a rejection
+      double h_next = h * casadi_dopri_fac(err, rejected ? 1. : 10.);
+      m->h = last ? std::fmax(m->h, h_next) : h_next;
+      rejected = false;
+    }
+
+    // Return to user
+    if (m->tcur == m->t_next) {
+      casadi_copy(m->x, nx_, x);
+      casadi_copy(m->q, nq_, q);
+    } else {
+      // Dense output from the last step, also for the sensitivities
+      double h = m->tcur - m->tprev;
+      double theta = (m->t_next - m->tprev) / h;
+      for (casadi_int d = 0; d <= nfwd_; ++d) {
+        if (x) casadi_dopri_interp(nx1_, nk1_, theta, h, m->x_prev + d * nx1_,
+          m->x + d * nx1_, m->v + d * nv1_, x + d * nx1_);
+        if (q) casadi_dopri_interp(nq1_, nk1_, theta, h, m->q_prev + d * nq1_,
+          m->q + d * nq1_, m->v + d * nv1_ + nx1_, q + d * nq1_);
+      }
+    }
+
+    // Mark the end of the interval on the tape
+    if (nrx_ > 0) m->tape_k.push_back(m->tape_t.size());
+  }
+
+  void Dopri::tape_step(DopriMemory* m, double t, double h,
+      const double* x0, const double* v0) const {
+    m->tape_t.push_back(t);
+    m->tape_h.push_back(h);
+    m->tape_x.insert(m->tape_x.end(), x0, x0 + nx_);
+    m->tape_v.insert(m->tape_v.end(), v0, v0 + nv_);
+  }
+
+  void Dopri::resetB(IntegratorMemory* mem) const {
+    auto m = static_cast<DopriMemory*>(mem);
+
+    // Clear adjoint seeds
+    casadi_clear(m->rp, nrp_);
+    casadi_clear(m->rx, nrx_);
+
+    // Reset summation states
+    casadi_clear(m->rq, nrq_);
+    casadi_clear(m->uq, nuq_);
+
+    // Update backwards dependent variables
+    casadi_clear(m->rv, nrv_);
+  }
+
+  void Dopri::impulseB(IntegratorMemory* mem,
+      const double* rx, const double* rz, const double* rp) const {
+    auto m = static_cast<DopriMemory*>(mem);
+
+    // Add impulse to backward parameters
+    casadi_axpy(nrp_, 1., rp, m->rp);
+
+    // Add impulse to state
+    casadi_axpy(nrx_, 1., rx, m->rx);
+  }
+
+  void Dopri::retreat(IntegratorMemory* mem, const double* u,
+      double* rx, double* rq, double* uq) const {
+    auto m = static_cast<DopriMemory*>(mem);
+
+    // Set controls
+    casadi_copy(u, nu_, m->u);
+
+    // Take the steps of the interval in reverse order, a zero step size marks the first stage
+    for (casadi_int j = m->tape_k.at(m->k + 1); j-- > m->tape_k.at(m->k); ) {
+      // Update the previous step
+      casadi_copy(m->rx, nrx_, m->rx_prev);
+      casadi_copy(m->rv, nrv_, m->rv_prev);
+      casadi_copy(m->rq, nrq_, m->rq_prev);
+      casadi_copy(m->uq, nuq_, m->uq_prev);
+
+      // Take step
+      bool init = m->tape_h[j] == 0;
+      stepB(m, init, m->tape_t[j], m->tape_h[j],
+        get_ptr(m->tape_x) + nx_ * j, get_ptr(m->tape_v) + nv_ * j,
+        m->rx_prev, m->rv_prev, m->rx, m->rv, m->rq, m->uq);
+      // The first stage does not depend on the stages of the previous step
+      if (init) casadi_clear(m->rv, nrv_);
+      casadi_axpy(nrq_, 1., m->rq_prev, m->rq);
+      casadi_axpy(nuq_, 1., m->uq_prev, m->uq);
+    }
+
+    // Return to user
+    casadi_copy(m->rx, nrx_, rx);
+    casadi_copy(m->rq, nrq_, rq);
+    casadi_copy(m->uq, nuq_, uq);
+  }
+
+  void Dopri::stepF(DopriMemory* m, bool init, double t, double h,
+      const double* x0, const double* v0, double* xf, double* vf, double* qf) const {
+    std::fill(m->arg, m->arg + STEP_NUM_IN, nullptr);
+    m->arg[STEP_T] = &t;  // t
+    m->arg[STEP_H] = &h;  // h
+    m->arg[STEP_X0] = x0;  // x0
+    m->arg[STEP_V0] = v0;  // v0
+    m->arg[STEP_P] = m->p;  // p
+    m->arg[STEP_U] = m->u;  // u
+    std::fill(m->res, m->res + STEP_NUM_OUT, nullptr);
+    m->res[STEP_XF] = xf;  // xf
+    m->res[STEP_VF] = vf;  // vf
+    m->res[STEP_QF] = qf;  // qf
+    calc_function(m, init ? "init" : "step");
+  }
+
+  void Dopri::fstepF(DopriMemory* m, bool init, double t, double h,
+      const double* x0, const double* v0, double* xf, double* vf, double* qf) const {
+    std::fill(m->arg, m->arg + STEP_NUM_IN + STEP_NUM_OUT + STEP_NUM_IN, nullptr);
+    m->arg[STEP_T] = &t;  // t
+    m->arg[STEP_H] = &h;  // h
+    m->arg[STEP_X0] = x0;  // x0
+    m->arg[STEP_V0] = v0;  // v0
+    m->arg[STEP_P] = m->p;  // p
+    m->arg[STEP_U] = m->u;  // u
+    m->arg[STEP_NUM_IN + STEP_XF] = xf;  // out:xf
+    m->arg[STEP_NUM_IN + STEP_VF] = vf;  // out:vf
+    m->arg[STEP_NUM_IN + STEP_QF] = qf;  // out:qf
+    m->arg[STEP_NUM_IN + STEP_NUM_OUT + STEP_X0] = x0 + nx1_;  // fwd:x0
+    if (v0) m->arg[STEP_NUM_IN + STEP_NUM_OUT + STEP_V0] = v0 + nv1_;  // fwd:v0
+    m->arg[STEP_NUM_IN + STEP_NUM_OUT + STEP_P] = m->p + np1_;  // fwd:p
+    m->arg[STEP_NUM_IN + STEP_NUM_OUT + STEP_U] = m->u + nu1_;  // fwd:u
+    std::fill(m->res, m->res + STEP_NUM_OUT, nullptr);
+    if (xf) m->res[STEP_XF] = xf + nx1_;  // fwd:xf
+    m->res[STEP_VF] = vf + nv1_;  // fwd:vf
+    if (qf) m->res[STEP_QF] = qf + nq1_;  // fwd:qf
+    calc_function(m, forward_name(init ? "init" : "step", nfwd_));
+  }
+
+  void Dopri::stepB(DopriMemory* m, bool init, double t, double h,
+      const double* x0, const double* v0, const double* rx0, const double* rv0,
+      double* rxf, double* rvf, double* rqf, double* uqf) const {
+    // Step function
+    std::string fcn = reverse_name(init ? "init" : "step", nadj_);
+    // Evaluate nondifferentiated
+    std::fill(m->arg, m->arg + BSTEP_NUM_IN, nullptr);
+    m->arg[BSTEP_T] = &t;  // t
+    m->arg[BSTEP_H] = &h;  // h
+    m->arg[BSTEP_X0] = x0;  // x0
+    m->arg[BSTEP_V0] = v0;  // v0
+    m->arg[BSTEP_P] = m->p;  // p
+    m->arg[BSTEP_U] = m->u;  // u
+    m->arg[BSTEP_ADJ_XF] = rx0;  // adj:xf
+    m->arg[BSTEP_ADJ_VF] = rv0;  // adj:vf
+    m->arg[BSTEP_ADJ_QF] = m->rp;  // adj:qf
+    std::fill(m->res, m->res + BSTEP_NUM_OUT, nullptr);
+    m->res[BSTEP_ADJ_X0] = rxf;  // adj:x0
+    m->res[BSTEP_ADJ_V0] = rvf;  // adj:v0
+    m->res[BSTEP_ADJ_P] = rqf;  // adj:p
+    m->res[BSTEP_ADJ_U] = uqf;  // adj:u
+    calc_function(m, fcn);
+    // Evaluate sensitivities
+    if (nfwd_ > 0) {
+      std::fill(m->arg + BSTEP_NUM_IN, m->arg + BSTEP_NUM_IN + BSTEP_NUM_OUT + BSTEP_NUM_IN,
+        nullptr);
+      m->arg[BSTEP_NUM_IN + BSTEP_ADJ_X0] = rxf;  // out:adj:x0
+      m->arg[BSTEP_NUM_IN + BSTEP_ADJ_V0] = rvf;  // out:adj:v0
+      m->arg[BSTEP_NUM_IN + BSTEP_ADJ_P] = rqf;  // out:adj:p
+      m->arg[BSTEP_NUM_IN + BSTEP_ADJ_U] = uqf;  // out:adj:u
+      m->arg[BSTEP_NUM_IN + BSTEP_NUM_OUT + BSTEP_X0] = x0 + nx1_;  // fwd:x0
+      m->arg[BSTEP_NUM_IN + BSTEP_NUM_OUT + BSTEP_V0] = v0 + nv1_;  // fwd:v0
+      m->arg[BSTEP_NUM_IN + BSTEP_NUM_OUT + BSTEP_P] = m->p + np1_;  // fwd:p
+      m->arg[BSTEP_NUM_IN + BSTEP_NUM_OUT + BSTEP_U] = m->u + nu1_;  // fwd:u
+      m->arg[BSTEP_NUM_IN + BSTEP_NUM_OUT + BSTEP_ADJ_XF] = rx0 + nrx1_ * nadj_;  // fwd:adj:xf
+      m->arg[BSTEP_NUM_IN + BSTEP_NUM_OUT + BSTEP_ADJ_VF] = rv0 + nrv1_;  // fwd:adj:vf
+      m->arg[BSTEP_NUM_IN + BSTEP_NUM_OUT + BSTEP_ADJ_QF] = m->rp + nrp1_ * nadj_;  // fwd:adj:qf
+      m->res[BSTEP_ADJ_X0] = rxf + nrx1_ * nadj_;  // fwd:adj:x0
+      m->res[BSTEP_ADJ_V0] = rvf + nrv1_;  // fwd:adj:v0
+      m->res[BSTEP_ADJ_P] = rqf + nrq1_ * nadj_;  // fwd:adj:p
+      m->res[BSTEP_ADJ_U] = uqf + nuq1_ * nadj_;  // fwd:adj:u
+      calc_function(m, forward_name(fcn, nfwd_));
+    }
+  }
+
+  void Dopri::print_stats(IntegratorMemory* mem) const {
+    auto m = static_cast<DopriMemory*>(mem);
+    print("FORWARD INTEGRATION:\n");
+    print("Number of steps taken: %lld\n", static_cast<long long>(m->nsteps));
+    print("Number of error test failures: %lld\n", static_cast<long long>(m->netfails));
+    print("Step size to be attempted on the next step: %g\n", m->h);
+    print("Current internal time reached: %g\n", m->tcur);
+  }
+
+  Dict Dopri::get_stats(void* mem) const {
+    Dict stats = Integrator::get_stats(mem);
+    auto m = static_cast<DopriMemory*>(mem);
+    stats["nsteps"] = m->nsteps;
+    stats["netfails"] = m->netfails;
+    stats["hcur"] = m->h;
+    return stats;
+  }
+
+  void Dopri::codegen_declarations(CodeGenerator& g) const {
+    g.add_dependency(get_function("init"));
+    g.add_dependency(get_function("step"));
+    if (nfwd_ > 0) {
+      g.add_dependency(get_function(forward_name("init", nfwd_)));
+      g.add_dependency(get_function(forward_name("step", nfwd_)));
+    }
+  }
+
+  void Dopri::codegen_body(CodeGenerator& g) const {
+    g.add_auxiliary(CodeGenerator::AUX_DOPRI);
+    g.local("arg1", "const casadi_real*", "*");
+    g.local("res1", "casadi_real*", "*");
+    g.local("u", "const casadi_real", "*");
+    for (const char* v : {"x", "x_prev", "v", "v_prev", "pv", "uv", "q", "q_prev", "xk", "qk"}) {
+      g.local(v, "casadi_real", "*");
+    }
+    for (const char* v : {"k", "k_stop", "d", "nsteps"}) {
+      g.local(v, "casadi_int");
+    }
+    if (nu_ > 0) g.local("i", "casadi_int");
+    for (const char* v : {"tcur", "tprev", "t_lim", "t_next", "h", "hk", "err", "fac", "theta"}) {
+      g.local(v, "casadi_real");
+    }
+    for (const char* v : {"init", "last", "rejected"}) {
+      g.local(v, "int");
+    }
+    // Persistent work vectors, cf. set_work
+    g.comment("Work vectors");
+    g << "x = w; w += " << nx_ << ";\n";
+    g << "x_prev = w; w += " << nx_ << ";\n";
+    g << "v = w; w += " << nv_ << ";\n";
+    g << "pv = w; w += " << np_ << ";\n";
+    g << "uv = w; w += " << nu_ << ";\n";
+    g << "q = w; w += " << nq_ << ";\n";
+    g << "v_prev = w; w += " << nv_ << ";\n";
+    g << "q_prev = w; w += " << nq_ << ";\n";
+    g << "arg1 = arg + " << INTEGRATOR_NUM_IN << ";\n";
+    g << "res1 = res + " << INTEGRATOR_NUM_OUT << ";\n";
+    // Reset the forward problem
+    g.comment("Reset the forward problem");
+    g << g.copy("arg[" + str(INTEGRATOR_P) + "]", np_, "pv") << "\n";
+    g << g.copy("arg[" + str(INTEGRATOR_X0) + "]", nx_, "x") << "\n";
+    g << g.clear("q", nq_) << "\n";
+    g << g.clear("v", nv_) << "\n";
+    g << "u = arg[" << INTEGRATOR_U << "];\n";
+    g << "xk = res[" << INTEGRATOR_XF << "];\n";
+    g << "qk = res[" << INTEGRATOR_QF << "];\n";
+    g << "tcur = tprev = " << g.constant(t0_) << ";\n";
+    g << "h = 0;\n";
+    g << "nsteps = 0;\n";
+    g << "k_stop = -1;\n";
+    g << "rejected = 0;\n";
+    // Loop over output times
+    std::string tout = g.constant(tout_);
+    g << "for (k = 0; k < " << nt() << "; ++k) {\n";
+    g << "t_next = " << tout << "[k];\n";
+    // Next stop time due to step change in input, cf. next_stop
+    g.comment("Next stop time due to step change in input");
+    if (nu_ == 0) {
+      g << "k_stop = " << nt() - 1 << ";\n";
+    } else {
+      g << "if (k > k_stop) {\n";
+      g << "if (u) {\n";
+      g << "for (k_stop = k; k_stop + 1 < " << nt() << "; ++k_stop) {\n";
+      g << "for (i = 0; i < " << nu_ << "; ++i) {\n";
+      g << "if (u[(k_stop - k) * " << nu_ << " + i] != u[(k_stop - k + 1) * " << nu_
+        << " + i]) break;\n";
+      g << "}\n";
+      g << "if (i < " << nu_ << ") break;\n";
+      g << "}\n";
+      g << "} else {\n";
+      g << "k_stop = " << nt() - 1 << ";\n";
+      g << "}\n";
+      g << "}\n";
+    }
+    g << "t_lim = " << tout << "[k_stop];\n";
+    // First stage
+    g.comment("(Re)calculate the first stage at the beginning or after a change in the controls");
+    g << "init = k == 0;\n";
+    if (nu_ > 0) {
+      g << "for (i = 0; i < " << nu_ << " && !init; ++i) init = (u ? u[i] : 0) != uv[i];\n";
+    }
+    g << "if (init) {\n";
+    g << g.copy("u", nu_, "uv") << "\n";
+    g << "hk = 0;\n";
+    codegen_step(g, "init", "tcur", "x", "0", "0", "v", "0");
+    if (nfwd_ > 0) {
+      codegen_step(g, forward_name("init", nfwd_), "tcur", "x", "0", "0", "v", "0", true);
+    }
+    g << "}\n";
+    // Initial step size
+    g << "if (h == 0) h = ";
+    if (step0_ > 0) {
+      g << g.constant(step0_) << ";\n";
+    } else {
+      g << "casadi_dopri_h0(" << nx1_ << ", x, v + " << 6 * nk1_ << ", "
+        << g.constant(abstol_) << ", " << g.constant(reltol_) << ");\n";
+    }
+    // Take steps until the output time has been reached or passed
+    g.comment("Take steps until the output time has been reached or passed");
+    g << "while (tcur < t_next) {\n";
+    if (std::isinf(max_step_size_)) {
+      g << "hk = h;\n";
+    } else {
+      g << "hk = casadi_fmin(h, " << g.constant(max_step_size_) << ");\n";
+    }
+    g << "last = tcur + 1.01 * hk >= t_lim;\n";
+    g << "if (last) hk = t_lim - tcur;\n";
+    g << "if (hk < " << g.constant(min_step_size_) << " || tcur + hk <= tcur) return 1;\n";
+    g << "if (nsteps >= " << max_num_steps_ << ") return 1;\n";
+    g << g.copy("x", nx_, "x_prev") << "\n";
+    g << g.copy("v", nv_, "v_prev") << "\n";
+    g << g.copy("q", nq_, "q_prev") << "\n";
+    codegen_step(g, "step", "tcur", "x_prev", "v_prev", "x", "v", "q", false);
+    g << "err = casadi_dopri_err(" << nx1_ << ", " << nk1_ << ", hk, x_prev, x, v, "
+      << g.constant(abstol_) << ", " << g.constant(reltol_) << ");\n";
+    g << "if (err > 1) {\n";
+    g << g.copy("x_prev", nx_, "x") << "\n";
+    g << g.copy("v_prev", nv_, "v") << "\n";
+    g << g.copy("q_prev", nq_, "q") << "\n";
+    g << "h = hk * casadi_dopri_fac(err, 1.);\n";
+    g << "rejected = 1;\n";
+    g << "continue;\n";
+    g << "}\n";
+    if (nfwd_ > 0) {
+      codegen_step(g, forward_name("step", nfwd_), "tcur", "x_prev", "v_prev", "x", "v", "q",
+        true);
+    }
+    g << g.axpy(nq_, "1.", "q_prev", "q") << "\n";
+    g << "tprev = tcur;\n";
+    g << "tcur = last ? t_lim : tcur + hk;\n";
+    g << "nsteps++;\n";
+    g << "fac = casadi_dopri_fac(err, rejected ? 1. : 10.);\n";
+    g << "h = last ? casadi_fmax(h, hk * fac) : hk * fac;\n";
+    g << "rejected = 0;\n";
+    g << "}\n";
+    // Return to user
+    g.comment("Dense output");
+    g << "if (tcur == t_next) {\n";
+    g << g.copy("x", nx_, "xk") << "\n";
+    g << g.copy("q", nq_, "qk") << "\n";
+    g << "} else {\n";
+    g << "hk = tcur - tprev;\n";
+    g << "theta = (t_next - tprev) / hk;\n";
+    g << "for (d = 0; d <= " << nfwd_ << "; ++d) {\n";
+    g << "if (xk) casadi_dopri_interp(" << nx1_ << ", " << nk1_ << ", theta, hk, "
+      << "x_prev + d * " << nx1_ << ", x + d * " << nx1_ << ", v + d * " << nv1_
+      << ", xk + d * " << nx1_ << ");\n";
+    if (nq1_ > 0) {
+      g << "if (qk) casadi_dopri_interp(" << nq1_ << ", " << nk1_ << ", theta, hk, "
+        << "q_prev + d * " << nq1_ << ", q + d * " << nq1_ << ", v + d * " << nv1_
+        << " + " << nx1_ << ", qk + d * " << nq1_ << ");\n";
+    }
+    g << "}\n";
+    g << "}\n";
+    g << "if (xk) xk += " << nx_ << ";\n";
+    if (nq_ > 0) g << "if (qk) qk += " << nq_ << ";\n";
+    if (nu_ > 0) g << "if (u) u += " << nu_ << ";\n";
+    g << "}\n";
+  }
+
+  void Dopri::codegen_step(CodeGenerator& g, const std::string& fcn, const std::string& t,
+      const std::string& x0, const std::string& v0, const std::string& xf,
+      const std::string& vf, const std::string& qf, bool fwd) const {
+    // Nondifferentiated inputs
+    g << "arg1[" << STEP_T << "] = &" << t << ";\n";
+    g << "arg1[" << STEP_H << "] = &hk;\n";
+    g << "arg1[" << STEP_X0 << "] = " << x0 << ";\n";
+    g << "arg1[" << STEP_V0 << "] = " << v0 << ";\n";
+    g << "arg1[" << STEP_P << "] = pv;\n";
+    g << "arg1[" << STEP_U << "] = uv;\n";
+    if (fwd) {
+      // Nondifferentiated outputs
+      g << "arg1[" << STEP_NUM_IN + STEP_XF << "] = " << xf << ";\n";
+      g << "arg1[" << STEP_NUM_IN + STEP_VF << "] = " << vf << ";\n";
+      g << "arg1[" << STEP_NUM_IN + STEP_QF << "] = " << qf << ";\n";
+      // Forward seeds
+      casadi_int off = STEP_NUM_IN + STEP_NUM_OUT;
+      g << "arg1[" << off + STEP_T << "] = 0;\n";
+      g << "arg1[" << off + STEP_H << "] = 0;\n";
+      g << "arg1[" << off + STEP_X0 << "] = " << x0 << " + " << nx1_ << ";\n";
+      g << "arg1[" << off + STEP_V0 << "] = "
+        << (v0 == "0" ? "0" : v0 + " + " + str(nv1_)) << ";\n";
+      g << "arg1[" << off + STEP_P << "] = pv + " << np1_ << ";\n";
+      g << "arg1[" << off + STEP_U << "] = uv + " << nu1_ << ";\n";
+      // Forward sensitivities
+      g << "res1[" << STEP_XF << "] = "
+        << (xf == "0" ? "0" : xf + " + " + str(nx1_)) << ";\n";
+      g << "res1[" << STEP_VF << "] = " << vf << " + " << nv1_ << ";\n";
+      g << "res1[" << STEP_QF << "] = "
+        << (qf == "0" ? "0" : qf + " + " + str(nq1_)) << ";\n";
+    } else {
+      g << "res1[" << STEP_XF << "] = " << xf << ";\n";
+      g << "res1[" << STEP_VF << "] = " << vf << ";\n";
+      g << "res1[" << STEP_QF << "] = " << qf << ";\n";
+    }
+    g << "if (" << g(get_function(fcn), "arg1", "res1", "iw", "w") << ") return 1;\n";
+  }
+
+  Dopri::Dopri(DeserializingStream& s) : Integrator(s) {
+    s.version("Dopri", 1);
+    s.unpack("Dopri::abstol", abstol_);
+    s.unpack("Dopri::reltol", reltol_);
+    s.unpack("Dopri::step0", step0_);
+    s.unpack("Dopri::min_step_size", min_step_size_);
+    s.unpack("Dopri::max_step_size", max_step_size_);
+    s.unpack("Dopri::max_num_steps", max_num_steps_);
+    s.unpack("Dopri::nk1", nk1_);
+    s.unpack("Dopri::nv", nv_);
+    s.unpack("Dopri::nv1", nv1_);
+    s.unpack("Dopri::nrv", nrv_);
+    s.unpack("Dopri::nrv1", nrv1_);
+  }
+
+  void Dopri::serialize_body(SerializingStream &s) const {
+    Integrator::serialize_body(s);
+    s.version("Dopri", 1);
+    s.pack("Dopri::abstol", abstol_);
+    s.pack("Dopri::reltol", reltol_);
+    s.pack("Dopri::step0", step0_);
+    s.pack("Dopri::min_step_size", min_step_size_);
+    s.pack("Dopri::max_step_size", max_step_size_);
+    s.pack("Dopri::max_num_steps", max_num_steps_);
+    s.pack("Dopri::nk1", nk1_);
+    s.pack("Dopri::nv", nv_);
+    s.pack("Dopri::nv1", nv1_);
+    s.pack("Dopri::nrv", nrv_);
+    s.pack("Dopri::nrv1", nrv1_);
+  }
+
+} // namespace casadi
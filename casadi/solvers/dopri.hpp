@@ -0,0 +1,216 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_DOPRI_HPP
+#define CASADI_DOPRI_HPP
+
+#include "casadi/core/integrator_impl.hpp"
+#include <casadi/solvers/casadi_integrator_dopri_export.h>
+
+/** \defgroup plugin_Integrator_dopri Title
+    \par
+
+      Adaptive explicit Runge-Kutta integrator for ODEs, using the
+      Dormand-Prince 5(4) pair with error control on the differential states.
+      The last stage of a step is reused as the first stage of the next.
+      Output times are reached by dense output (4th order continuous
+      extension) without restricting the step size, unless adjoint
+      sensitivities are requested, in which case the steps are taped and
+      end exactly at the output times.
+
+      Forward and adjoint sensitivities are those of the discrete scheme for
+      the step sizes chosen by the nondifferentiated integration. Without
+      adjoint sensitivities, the integrator can be code generated.
+
+    \identifier{27u} */
+/** \pluginsection{Integrator,dopri} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  struct CASADI_INTEGRATOR_DOPRI_EXPORT DopriMemory : public IntegratorMemory {
+    // Work vectors, allocated in base class
+    double *x, *z, *x_prev, *rx, *rz, *rx_prev, *rq;
+
+    /// Work vectors, forward problem
+    double *v, *p, *u, *q, *v_prev, *q_prev;
+
+    /// Work vectors, backward problem
+    double *rv, *rp, *uq, *rv_prev, *rq_prev, *uq_prev;
+
+    /// Current time of the integrator and start of the last accepted step
+    double tcur, tprev;
+
+    /// Size of the next step, zero if not yet determined
+    double h;
+
+    /// Tape: time, step size, state and dependent variables at the start of each step
+    std::vector<double> tape_t, tape_h, tape_x, tape_v;
+
+    /// Tape position at each output time
+    std::vector<casadi_int> tape_k;
+
+    /// Statistics
+    casadi_int nsteps, netfails;
+  };
+
+  /** \brief \pluginbrief{Integrator,dopri}
+
+      @copydoc plugin_Integrator_dopri
+  */
+  class CASADI_INTEGRATOR_DOPRI_EXPORT Dopri : public Integrator {
+   public:
+
+    /// Constructor
+    Dopri(const std::string& name, const Function& dae, double t0,
+      const std::vector<double>& tout);
+
+    /** \brief  Create a new integrator */
+    static Integrator* creator(const std::string& name, const Function& dae,
+        double t0, const std::vector<double>& tout) {
+      return new Dopri(name, dae, t0, tout);
+    }
+
+    /// Destructor
+    ~Dopri() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "dopri";}
+
+    // Get name of the class
+    std::string class_name() const override { return "Dopri";}
+
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /// Initialize stage
+    void init(const Dict& opts) override;
+
+    /** \brief Set the (persistent) work vectors */
+    void set_work(void* mem, const double**& arg, double**& res,
+      casadi_int*& iw, double*& w) const override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new DopriMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<DopriMemory*>(mem);}
+
+    /// Setup step functions
+    void setup_step();
+
+    /// Reset the forward problem
+    void reset(IntegratorMemory* mem,
+      const double* x, const double* z, const double* p) const override;
+
+    /// Advance solution in time
+    void advance(IntegratorMemory* mem,
+      const double* u, double* x, double* z, double* q) const override;
+
+    /// Reset the backward problem
+    void resetB(IntegratorMemory* mem) const override;
+
+    /// Introduce an impulse into the backwards integration at the current time
+    void impulseB(IntegratorMemory* mem,
+      const double* rx, const double* rz, const double* rp) const override;
+
+    /// Retreat solution in time
+    void retreat(IntegratorMemory* mem, const double* u,
+      double* rx, double* rq, double* uq) const override;
+
+    /// Evaluate the step (or initialization) function, nondifferentiated
+    void stepF(DopriMemory* m, bool init, double t, double h,
+      const double* x0, const double* v0, double* xf, double* vf, double* qf) const;
+
+    /// Evaluate the step (or initialization) function, forward sensitivities
+    void fstepF(DopriMemory* m, bool init, double t, double h,
+      const double* x0, const double* v0, double* xf, double* vf, double* qf) const;
+
+    /// Take the step (or initialization) backward
+    void stepB(DopriMemory* m, bool init, double t, double h,
+      const double* x0, const double* v0, const double* rx0, const double* rv0,
+      double* rxf, double* rvf, double* rqf, double* uqf) const;
+
+    /// Add the current step to the tape
+    void tape_step(DopriMemory* m, double t, double h,
+      const double* x0, const double* v0) const;
+
+    /// Print solver statistics
+    void print_stats(IntegratorMemory* mem) const override;
+
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
+
+    /** \brief Is codegen supported? */
+    bool has_codegen() const override { return nrx_ == 0;}
+
+    /** \brief Generate code for the declarations of the C function */
+    void codegen_declarations(CodeGenerator& g) const override;
+
+    /** \brief Generate code for the function body */
+    void codegen_body(CodeGenerator& g) const override;
+
+    /// Generate code for a call to a step function or its forward derivative
+    void codegen_step(CodeGenerator& g, const std::string& fcn, const std::string& t,
+      const std::string& x0, const std::string& v0, const std::string& xf,
+      const std::string& vf, const std::string& qf, bool fwd=false) const;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    ///@{
+    /// Options
+    double abstol_, reltol_, step0_, min_step_size_, max_step_size_;
+    casadi_int max_num_steps_;
+    ///@}
+
+    /// Number of stage derivatives (ODE and quadratures) per stage
+    casadi_int nk1_;
+
+    /// Number of dependent variables in the discrete time integration
+    casadi_int nv_, nv1_, nrv_, nrv1_;
+
+    /** \brief Serialize an object without type information */
+    void serialize_body(SerializingStream &s) const override;
+
+    /** \brief Deserialize into MX */
+    static ProtoFunction* deserialize(DeserializingStream& s) { return new Dopri(s); }
+
+   protected:
+
+    /** \brief Deserializing constructor */
+    explicit Dopri(DeserializingStream& s);
+  };
+
+} // namespace casadi
+
+/// \endcond
+#endif // CASADI_DOPRI_HPP
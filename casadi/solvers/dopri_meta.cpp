@@ -0,0 +1,70 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+      #include "dopri.hpp"
+      #include <string>
+
+      const std::string casadi::Dopri::meta_doc=
+      "\n"
+"Adaptive explicit Runge-Kutta integrator for ODEs, using the Dormand-\n"
+"Prince 5(4) pair with error control on the differential states. The\n"
+"last stage of a step is reused as the first stage of the next. Output\n"
+"times are reached by dense output (4th order continuous extension)\n"
+"without restricting the step size, unless adjoint sensitivities are\n"
+"requested, in which case the steps are taped and end exactly at the\n"
+"output times.\n"
+"\n"
+"Forward and adjoint sensitivities are those of the discrete scheme for\n"
+"the step sizes chosen by the nondifferentiated integration. Without\n"
+"adjoint sensitivities, the integrator can be code generated.\n"
+"\n"
+"\n"
+">List of available options\n"
+"\n"
+"+-----------------+-----------+-------------------------------------------+\n"
+"|       Id        |   Type    |                Description                |\n"
+"+=================+===========+===========================================+\n"
+"| abstol          | OT_DOUBLE | Absolute tolerance for the local error    |\n"
+"|                 |           | test [1e-8]                               |\n"
+"+-----------------+-----------+-------------------------------------------+\n"
+"| max_num_steps   | OT_INT    | Maximum number of steps, over the whole   |\n"
+"|                 |           | time horizon [10000]                      |\n"
+"+-----------------+-----------+-------------------------------------------+\n"
+"| max_step_size   | OT_DOUBLE | Maximum step size [inf]                   |\n"
+"+-----------------+-----------+-------------------------------------------+\n"
+"| min_step_size   | OT_DOUBLE | Minimum step size [0]                     |\n"
+"+-----------------+-----------+-------------------------------------------+\n"
+"| reltol          | OT_DOUBLE | Relative tolerance for the local error    |\n"
+"|                 |           | test [1e-6]                               |\n"
+"+-----------------+-----------+-------------------------------------------+\n"
+"| step0           | OT_DOUBLE | Initial step size [default: estimated     |\n"
+"|                 |           | from the initial state and its            |\n"
+"|                 |           | derivative]                               |\n"
+"+-----------------+-----------+-------------------------------------------+\n"
+"\n"
+"\n"
+"\n"
+"\n"
+;
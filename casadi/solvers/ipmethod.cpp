@@ -0,0 +1,482 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "ipmethod.hpp"
+
+#include "casadi/core/casadi_misc.hpp"
+
+#include <cmath>
+
+namespace casadi {
+
+  extern "C"
+  int CASADI_NLPSOL_IPMETHOD_EXPORT
+      casadi_register_nlpsol_ipmethod(Nlpsol::Plugin* plugin) {
+    plugin->creator = Ipmethod::creator;
+    plugin->name = "ipmethod";
+    plugin->doc = Ipmethod::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Ipmethod::options_;
+    plugin->deserialize = &Ipmethod::deserialize;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_NLPSOL_IPMETHOD_EXPORT casadi_load_nlpsol_ipmethod() {
+    Nlpsol::registerPlugin(casadi_register_nlpsol_ipmethod);
+  }
+
+  Ipmethod::Ipmethod(const std::string& name, const Function& nlp)
+    : Nlpsol(name, nlp) {
+  }
+
+  Ipmethod::~Ipmethod() {
+    clear_mem();
+  }
+
+  const Options Ipmethod::options_
+  = {{&Nlpsol::options_},
+     {{"max_iter",
+       {OT_INT,
+        "Maximum number of iterations [1000]"}},
+      {"max_iter_ls",
+       {OT_INT,
+        "Maximum number of trial points in the line search [40]"}},
+      {"tol",
+       {OT_DOUBLE,
+        "Stopping criterion for the scaled optimality error [1e-8]"}},
+      {"mu_init",
+       {OT_DOUBLE,
+        "Initial barrier parameter [0.1]"}},
+      {"bound_push",
+       {OT_DOUBLE,
+        "Minimum absolute distance of the initial point to the bounds [1e-2]"}},
+      {"bound_frac",
+       {OT_DOUBLE,
+        "Minimum distance of the initial point to the bounds, "
+        "relative to the distance between the bounds [1e-2]"}},
+      {"filter_size",
+       {OT_INT,
+        "Maximum number of entries in the filter [100]"}},
+      {"linear_solver",
+       {OT_STRING,
+        "Linear solver for the KKT systems, must provide the inertia [ldl]"}},
+      {"linear_solver_options",
+       {OT_DICT,
+        "Options to be passed to the linear solver"}},
+      {"print_header",
+       {OT_BOOL,
+        "Print the header with problem statistics"}},
+      {"print_iteration",
+       {OT_BOOL,
+        "Print the iterations"}},
+      {"print_status",
+       {OT_BOOL,
+        "Print a status message after solving"}}
+     }
+  };
+
+  void Ipmethod::init(const Dict& opts) {
+    // Call the init method of the base class
+    Nlpsol::init(opts);
+
+    // Default options
+    casadi_ipmethod_setup(&p_);
+    linear_solver_ = "ldl";
+    print_header_ = true;
+    print_iteration_ = true;
+    print_status_ = true;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="max_iter") {
+        p_.max_iter = op.second;
+      } else if (op.first=="max_iter_ls") {
+        p_.max_iter_ls = op.second;
+      } else if (op.first=="tol") {
+        p_.tol = op.second;
+      } else if (op.first=="mu_init") {
+        p_.mu_init = op.second;
+      } else if (op.first=="bound_push") {
+        p_.bound_push = op.second;
+      } else if (op.first=="bound_frac") {
+        p_.bound_frac = op.second;
+      } else if (op.first=="filter_size") {
+        p_.max_filter = op.second;
+      } else if (op.first=="linear_solver") {
+        linear_solver_ = op.second.to_string();
+      } else if (op.first=="linear_solver_options") {
+        linear_solver_options_ = op.second;
+      } else if (op.first=="print_header") {
+        print_header_ = op.second;
+      } else if (op.first=="print_iteration") {
+        print_iteration_ = op.second;
+      } else if (op.first=="print_status") {
+        print_status_ = op.second;
+      }
+    }
+    casadi_assert(p_.tol > 0, "'tol' must be positive");
+    casadi_assert(p_.mu_init > 0, "'mu_init' must be positive");
+    casadi_assert(p_.bound_push > 0 && p_.bound_frac > 0 && p_.bound_frac < 0.5,
+      "'bound_push' must be positive and 'bound_frac' in (0, 0.5)");
+    casadi_assert(p_.max_filter > 0, "'filter_size' must be positive");
+
+    // Function and constraint values
+    create_function("nlp_fg", {"x", "p"}, {"f", "g"});
+    // First order derivative information
+    create_function("nlp_jac_fg", {"x", "p"},
+                    {"f", "grad:f:x", "g", "jac:g:x"});
+    Asp_ = get_function("nlp_jac_fg").sparsity_out(3);
+    // Hessian of the Lagrangian
+    create_function("nlp_hess_l", {"x", "p", "lam:f", "lam:g"},
+                    {"hess:gamma:x:x"}, {{"gamma", {"f", "g"}}});
+    Hsp_ = get_function("nlp_hess_l").sparsity_out(0);
+    casadi_assert(Hsp_.is_symmetric(), "Hessian must be symmetric");
+
+    // KKT system
+    kkt_ = Sparsity::kkt(Hsp_, Asp_, true, true);
+    linsol_ = Linsol("linsol", linear_solver_, kkt_, linear_solver_options_);
+
+    // Sparse LDL^T for generated code
+    if (linear_solver_ == "ldl") Ltsp_ = kkt_.ldl(ldl_p_);
+
+    // Setup the problem structure
+    set_ipmethod_prob();
+
+    // Header
+    if (print_header_) {
+      print("-------------------------------------------\n");
+      print("This is casadi::Ipmethod.\n");
+      print("Linear solver:                         %13s\n", linear_solver_.c_str());
+      print("Number of variables:                       %9d\n", nx_);
+      print("Number of constraints:                     %9d\n", ng_);
+      print("Number of nonzeros in constraint Jacobian: %9d\n", Asp_.nnz());
+      print("Number of nonzeros in Lagrangian Hessian:  %9d\n", Hsp_.nnz());
+      print("Number of nonzeros in KKT matrix:          %9d\n", kkt_.nnz());
+      print("\n");
+    }
+
+    // Allocate memory
+    casadi_int sz_w, sz_iw;
+    casadi_ipmethod_work(&p_, &sz_iw, &sz_w);
+    alloc_iw(sz_iw, true);
+    alloc_w(sz_w, true);
+  }
+
+  void Ipmethod::set_ipmethod_prob() {
+    p_.nlp = &p_nlp_;
+    p_.sp_h = Hsp_;
+    p_.sp_a = Asp_;
+    p_.sp_kkt = kkt_;
+    if (linear_solver_ == "ldl") {
+      p_.sp_lt = Ltsp_;
+      p_.ldl_p = get_ptr(ldl_p_);
+    }
+  }
+
+  int Ipmethod::init_mem(void* mem) const {
+    if (Nlpsol::init_mem(mem)) return 1;
+    auto m = static_cast<IpmethodMemory*>(mem);
+    m->return_status = "";
+    m->linsol_mem = linsol_.checkout();
+    return 0;
+  }
+
+  void Ipmethod::free_mem(void *mem) const {
+    auto m = static_cast<IpmethodMemory*>(mem);
+    linsol_.release(m->linsol_mem);
+    delete m;
+  }
+
+  void Ipmethod::set_work(void* mem, const double**& arg, double**& res,
+                          casadi_int*& iw, double*& w) const {
+    auto m = static_cast<IpmethodMemory*>(mem);
+
+    // Set work in base classes
+    Nlpsol::set_work(mem, arg, res, iw, w);
+
+    m->d.prob = &p_;
+    m->d.nlp = &m->d_nlp;
+    casadi_ipmethod_init(&m->d, &arg, &res, &iw, &w);
+  }
+
+  int Ipmethod::solve(void* mem) const {
+    auto m = static_cast<IpmethodMemory*>(mem);
+    auto d_nlp = &m->d_nlp;
+    auto d = &m->d;
+    const double one = 1;
+    m->n_fact = 0;
+
+    // Reverse communication loop
+    while (casadi_ipmethod(d)) {
+      switch (d->task) {
+      case IPMETHOD_EVAL_FG:
+        // Objective and constraints in the trial point
+        m->arg[0] = d->z_cand;
+        m->arg[1] = d_nlp->p;
+        m->res[0] = &d->f_cand;
+        m->res[1] = d->g_cand;
+        if (calc_function(m, "nlp_fg")) d->status = IPMETHOD_EVAL_ERROR;
+        break;
+      case IPMETHOD_EVAL_JAC:
+        // First order derivative information in the iterate
+        m->arg[0] = d->z;
+        m->arg[1] = d_nlp->p;
+        m->res[0] = &d->f;
+        m->res[1] = d->gf;
+        m->res[2] = d->g;
+        m->res[3] = d->jac;
+        if (calc_function(m, "nlp_jac_fg")) d->status = IPMETHOD_EVAL_ERROR;
+        break;
+      case IPMETHOD_EVAL_HESS:
+        // Hessian of the Lagrangian in the iterate
+        m->arg[0] = d->z;
+        m->arg[1] = d_nlp->p;
+        m->arg[2] = &one;
+        m->arg[3] = d->y;
+        m->res[0] = d->hess;
+        if (calc_function(m, "nlp_hess_l")) d->status = IPMETHOD_EVAL_ERROR;
+        break;
+      case IPMETHOD_FACTOR:
+        // Factorize the KKT matrix and get its inertia, -1 if singular
+        m->n_fact++;
+        if (linsol_.nfact(d->kkt, m->linsol_mem)
+            || linsol_.rank(d->kkt, m->linsol_mem) < nx_ + ng_) {
+          d->neig = -1;
+        } else {
+          d->neig = linsol_.neig(d->kkt, m->linsol_mem);
+        }
+        break;
+      case IPMETHOD_SOLVE:
+        // Solve the KKT system
+        if (linsol_.solve(d->kkt, d->linsys, 1, false, m->linsol_mem))
+          d->status = IPMETHOD_SOLVE_ERROR;
+        break;
+      case IPMETHOD_PROGRESS:
+        // Print progress
+        if (print_iteration_) {
+          if (d->iter % 10 == 0) print_iteration();
+          print_iteration(d);
+        }
+        // Callback function
+        if (callback(m)) d->status = IPMETHOD_USER_STOP;
+        break;
+      }
+    }
+
+    // Get the solution
+    casadi_ipmethod_solution(d);
+    m->iter_count = d->iter;
+    m->return_status = casadi_ipmethod_return_status(d->status);
+    m->success = d->status == IPMETHOD_SUCCESS;
+    if (m->success) {
+      m->unified_return_status = SOLVER_RET_SUCCESS;
+    } else if (d->status == IPMETHOD_MAX_ITER) {
+      m->unified_return_status = SOLVER_RET_LIMITED;
+    }
+    if (print_status_) {
+      if (m->success) {
+        print("MESSAGE(ipmethod): Convergence achieved after %d iterations\n", d->iter);
+      } else {
+        print("MESSAGE(ipmethod): %s after %d iterations\n", m->return_status, d->iter);
+      }
+    }
+    return 0;
+  }
+
+  void Ipmethod::print_iteration() const {
+    print("%4s %14s %9s %9s %5s %9s %5s %9s %9s %3s\n", "iter", "objective", "inf_pr",
+          "inf_du", "lg(mu)", "||d||", "lg(rg)", "alpha_du", "alpha_pr", "ls");
+  }
+
+  void Ipmethod::print_iteration(const casadi_ipmethod_data<double>* d) const {
+    print("%4d %14.7e %9.2e %9.2e %5.1f %9.2e ", d->iter, d->f, d->pr, d->du,
+          std::log10(d->mu), d->iter == 0 ? 0. : casadi_norm_inf(nx_, d->dz));
+    if (d->iter == 0 || d->delta_w == 0) {
+      print("%5s ", "-");
+    } else {
+      print("%5.1f ", std::log10(d->delta_w));
+    }
+    print("%9.2e %9.2e %3d%c\n", d->alpha_z, d->alpha, d->ls_iter, d->info);
+  }
+
+  void Ipmethod::codegen_declarations(CodeGenerator& g) const {
+    casadi_assert(linear_solver_ == "ldl",
+      "Code generation of 'ipmethod' requires 'linear_solver' 'ldl'");
+    Nlpsol::codegen_declarations(g);
+    g.add_dependency(get_function("nlp_fg"));
+    g.add_dependency(get_function("nlp_jac_fg"));
+    g.add_dependency(get_function("nlp_hess_l"));
+  }
+
+  void Ipmethod::codegen_body(CodeGenerator& g) const {
+    g.add_auxiliary(CodeGenerator::AUX_IPMETHOD);
+    codegen_body_enter(g);
+    g.local("d", "struct casadi_ipmethod_data*");
+    g.init_local("d", "&" + codegen_mem(g));
+    g.local("p", "struct casadi_ipmethod_prob");
+    g.local("one", "const casadi_real");
+    g.init_local("one", "1");
+
+    // Problem structure
+    g << "d->prob = &p;\n";
+    g << "d->nlp = &d_nlp;\n";
+    g << "p.nlp = &p_nlp;\n";
+    g << "p.sp_h = " << g.sparsity(Hsp_) << ";\n";
+    g << "p.sp_a = " << g.sparsity(Asp_) << ";\n";
+    g << "p.sp_kkt = " << g.sparsity(kkt_) << ";\n";
+    g << "p.sp_lt = " << g.sparsity(Ltsp_) << ";\n";
+    g << "p.ldl_p = " << g.constant(ldl_p_) << ";\n";
+    g << "p.max_iter = " << p_.max_iter << ";\n";
+    g << "p.max_iter_ls = " << p_.max_iter_ls << ";\n";
+    g << "p.max_filter = " << p_.max_filter << ";\n";
+    g << "p.tol = " << g.constant(p_.tol) << ";\n";
+    g << "p.mu_init = " << g.constant(p_.mu_init) << ";\n";
+    g << "p.kappa_eps = " << g.constant(p_.kappa_eps) << ";\n";
+    g << "p.kappa_mu = " << g.constant(p_.kappa_mu) << ";\n";
+    g << "p.theta_mu = " << g.constant(p_.theta_mu) << ";\n";
+    g << "p.tau_min = " << g.constant(p_.tau_min) << ";\n";
+    g << "p.bound_push = " << g.constant(p_.bound_push) << ";\n";
+    g << "p.bound_frac = " << g.constant(p_.bound_frac) << ";\n";
+    g << "p.delta_w_init = " << g.constant(p_.delta_w_init) << ";\n";
+    g << "p.delta_w_min = " << g.constant(p_.delta_w_min) << ";\n";
+    g << "p.delta_w_max = " << g.constant(p_.delta_w_max) << ";\n";
+    g << "p.delta_c = " << g.constant(p_.delta_c) << ";\n";
+    g << "p.gamma_theta = " << g.constant(p_.gamma_theta) << ";\n";
+    g << "p.gamma_phi = " << g.constant(p_.gamma_phi) << ";\n";
+    g << "p.gamma_alpha = " << g.constant(p_.gamma_alpha) << ";\n";
+    g << "p.eta_phi = " << g.constant(p_.eta_phi) << ";\n";
+    g << "p.s_phi = " << g.constant(p_.s_phi) << ";\n";
+    g << "p.s_theta = " << g.constant(p_.s_theta) << ";\n";
+    g << "p.delta = " << g.constant(p_.delta) << ";\n";
+    g << "p.s_max = " << g.constant(p_.s_max) << ";\n";
+    g << "p.kappa_sigma = " << g.constant(p_.kappa_sigma) << ";\n";
+    g << "p.inf = casadi_inf;\n";
+    g << "p.eps = " << g.constant(p_.eps) << ";\n";
+    g << "casadi_ipmethod_init(d, &arg, &res, &iw, &w);\n";
+
+    g.comment("Reverse communication loop");
+    g << "while (casadi_ipmethod(d)) {\n";
+    g << "switch (d->task) {\n";
+    g << "case IPMETHOD_EVAL_FG:\n";
+    g.comment("Objective and constraints in the trial point");
+    g << "d->arg[0] = d->z_cand;\n";
+    g << "d->arg[1] = d_nlp.p;\n";
+    g << "d->res[0] = &d->f_cand;\n";
+    g << "d->res[1] = d->g_cand;\n";
+    std::string nlp_fg = g(get_function("nlp_fg"), "d->arg", "d->res", "d->iw", "d->w");
+    g << "if (" + nlp_fg + ") d->status = IPMETHOD_EVAL_ERROR;\n";
+    g << "break;\n";
+    g << "case IPMETHOD_EVAL_JAC:\n";
+    g.comment("First order derivative information in the iterate");
+    g << "d->arg[0] = d->z;\n";
+    g << "d->arg[1] = d_nlp.p;\n";
+    g << "d->res[0] = &d->f;\n";
+    g << "d->res[1] = d->gf;\n";
+    g << "d->res[2] = d->g;\n";
+    g << "d->res[3] = d->jac;\n";
+    std::string nlp_jac_fg = g(get_function("nlp_jac_fg"), "d->arg", "d->res", "d->iw", "d->w");
+    g << "if (" + nlp_jac_fg + ") d->status = IPMETHOD_EVAL_ERROR;\n";
+    g << "break;\n";
+    g << "case IPMETHOD_EVAL_HESS:\n";
+    g.comment("Hessian of the Lagrangian in the iterate");
+    g << "d->arg[0] = d->z;\n";
+    g << "d->arg[1] = d_nlp.p;\n";
+    g << "d->arg[2] = &one;\n";
+    g << "d->arg[3] = d->y;\n";
+    g << "d->res[0] = d->hess;\n";
+    std::string nlp_hess_l = g(get_function("nlp_hess_l"), "d->arg", "d->res", "d->iw", "d->w");
+    g << "if (" + nlp_hess_l + ") d->status = IPMETHOD_EVAL_ERROR;\n";
+    g << "break;\n";
+    g << "case IPMETHOD_FACTOR:\n";
+    g << "casadi_ipmethod_ldl(d);\n";
+    g << "break;\n";
+    g << "case IPMETHOD_SOLVE:\n";
+    g << "casadi_ipmethod_ldl_solve(d);\n";
+    g << "break;\n";
+    g << "default:\n";
+    g << "break;\n";
+    g << "}\n";
+    g << "}\n";
+    g << "casadi_ipmethod_solution(d);\n";
+    codegen_body_exit(g);
+  }
+
+  Dict Ipmethod::get_stats(void* mem) const {
+    Dict stats = Nlpsol::get_stats(mem);
+    auto m = static_cast<IpmethodMemory*>(mem);
+    stats["return_status"] = m->return_status;
+    stats["iter_count"] = m->iter_count;
+    stats["n_fact"] = m->n_fact;
+    return stats;
+  }
+
+  Ipmethod::Ipmethod(DeserializingStream& s) : Nlpsol(s) {
+    s.version("Ipmethod", 1);
+    casadi_ipmethod_setup(&p_);
+    s.unpack("Ipmethod::Hsp", Hsp_);
+    s.unpack("Ipmethod::Asp", Asp_);
+    s.unpack("Ipmethod::kkt", kkt_);
+    s.unpack("Ipmethod::Ltsp", Ltsp_);
+    s.unpack("Ipmethod::ldl_p", ldl_p_);
+    s.unpack("Ipmethod::linear_solver", linear_solver_);
+    s.unpack("Ipmethod::linear_solver_options", linear_solver_options_);
+    s.unpack("Ipmethod::linsol", linsol_);
+    s.unpack("Ipmethod::max_iter", p_.max_iter);
+    s.unpack("Ipmethod::max_iter_ls", p_.max_iter_ls);
+    s.unpack("Ipmethod::max_filter", p_.max_filter);
+    s.unpack("Ipmethod::tol", p_.tol);
+    s.unpack("Ipmethod::mu_init", p_.mu_init);
+    s.unpack("Ipmethod::bound_push", p_.bound_push);
+    s.unpack("Ipmethod::bound_frac", p_.bound_frac);
+    s.unpack("Ipmethod::print_header", print_header_);
+    s.unpack("Ipmethod::print_iteration", print_iteration_);
+    s.unpack("Ipmethod::print_status", print_status_);
+    set_ipmethod_prob();
+  }
+
+  void Ipmethod::serialize_body(SerializingStream &s) const {
+    Nlpsol::serialize_body(s);
+    s.version("Ipmethod", 1);
+    s.pack("Ipmethod::Hsp", Hsp_);
+    s.pack("Ipmethod::Asp", Asp_);
+    s.pack("Ipmethod::kkt", kkt_);
+    s.pack("Ipmethod::Ltsp", Ltsp_);
+    s.pack("Ipmethod::ldl_p", ldl_p_);
+    s.pack("Ipmethod::linear_solver", linear_solver_);
+    s.pack("Ipmethod::linear_solver_options", linear_solver_options_);
+    s.pack("Ipmethod::linsol", linsol_);
+    s.pack("Ipmethod::max_iter", p_.max_iter);
+    s.pack("Ipmethod::max_iter_ls", p_.max_iter_ls);
+    s.pack("Ipmethod::max_filter", p_.max_filter);
+    s.pack("Ipmethod::tol", p_.tol);
+    s.pack("Ipmethod::mu_init", p_.mu_init);
+    s.pack("Ipmethod::bound_push", p_.bound_push);
+    s.pack("Ipmethod::bound_frac", p_.bound_frac);
+    s.pack("Ipmethod::print_header", print_header_);
+    s.pack("Ipmethod::print_iteration", print_iteration_);
+    s.pack("Ipmethod::print_status", print_status_);
+  }
+
+} // namespace casadi
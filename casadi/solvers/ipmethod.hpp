@@ -0,0 +1,172 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef CASADI_IPMETHOD_HPP
+#define CASADI_IPMETHOD_HPP
+
+#include "casadi/core/nlpsol_impl.hpp"
+#include "casadi/core/linsol.hpp"
+#include <casadi/solvers/casadi_nlpsol_ipmethod_export.h>
+
+/** \defgroup plugin_Nlpsol_ipmethod Title
+    \par
+
+ Primal-dual interior point method with a filter line search, following
+ the algorithm of IPOPT (Waechter and Biegler, 2006) without its
+ feasibility restoration phase. Inequality constraints get slack
+ variables, all bounds are handled by logarithmic barrier terms and the
+ barrier parameter is decreased monotonically. The KKT systems are
+ solved with a Linsol plugin ('linear_solver'), whose inertia is used to
+ regularize the Hessian of the Lagrangian until the search direction is a
+ descent direction.
+
+ The algorithm lives in the CasADi runtime, so that the solver can be
+ code generated. Generated code factorizes the KKT systems with the
+ sparse LDL^T of the 'ldl' linear solver.
+
+    \identifier{28a} */
+
+/** \pluginsection{Nlpsol,ipmethod} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  struct CASADI_NLPSOL_IPMETHOD_EXPORT IpmethodMemory : public NlpsolMemory {
+    // Problem data structure
+    casadi_ipmethod_data<double> d;
+
+    // Memory object of the linear solver
+    int linsol_mem;
+
+    /// Last return status
+    const char* return_status;
+
+    /// Iteration count
+    casadi_int iter_count;
+
+    /// Number of factorizations of the KKT matrix
+    casadi_int n_fact;
+  };
+
+  /** \brief  \pluginbrief{Nlpsol,ipmethod}
+  *  @copydoc NLPSolver_doc
+  *  @copydoc plugin_Nlpsol_ipmethod
+  */
+  class CASADI_NLPSOL_IPMETHOD_EXPORT Ipmethod : public Nlpsol {
+  public:
+    explicit Ipmethod(const std::string& name, const Function& nlp);
+    ~Ipmethod() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "ipmethod";}
+
+    // Name of the class
+    std::string class_name() const override { return "Ipmethod";}
+
+    /** \brief  Create a new NLP Solver */
+    static Nlpsol* creator(const std::string& name, const Function& nlp) {
+      return new Ipmethod(name, nlp);
+    }
+
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
+
+    // Initialize the solver
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new IpmethodMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override;
+
+    /** \brief Set the (persistent) work vectors */
+    void set_work(void* mem, const double**& arg, double**& res,
+                          casadi_int*& iw, double*& w) const override;
+
+    // Solve the NLP
+    int solve(void* mem) const override;
+
+    // Problem structure
+    casadi_ipmethod_prob<double> p_;
+
+    // Set the problem structure
+    void set_ipmethod_prob();
+
+    /// Sparsity of the Hessian of the Lagrangian, the Jacobian and the KKT matrix
+    Sparsity Hsp_, Asp_, kkt_;
+
+    /// Sparsity of the LDL^T factor and permutation of the KKT matrix, for code generation
+    Sparsity Ltsp_;
+    std::vector<casadi_int> ldl_p_;
+
+    /// Linear solver for the KKT systems
+    std::string linear_solver_;
+    Dict linear_solver_options_;
+    Linsol linsol_;
+
+    // Print options
+    bool print_header_, print_iteration_, print_status_;
+
+    /// Print iteration header
+    void print_iteration() const;
+
+    /// Print iteration
+    void print_iteration(const casadi_ipmethod_data<double>* d) const;
+
+    /** \brief Generate code for the function body */
+    void codegen_body(CodeGenerator& g) const override;
+
+    /** \brief Generate code for the declarations of the C function */
+    void codegen_declarations(CodeGenerator& g) const override;
+
+    /** \brief Thread-local memory object type */
+    std::string codegen_mem_type() const override { return "struct casadi_ipmethod_data"; }
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    /** \brief Serialize an object without type information */
+    void serialize_body(SerializingStream &s) const override;
+
+    /** \brief Deserialize into MX */
+    static ProtoFunction* deserialize(DeserializingStream& s) { return new Ipmethod(s); }
+
+  protected:
+    /** \brief Deserializing constructor */
+    explicit Ipmethod(DeserializingStream& s);
+  };
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_IPMETHOD_HPP
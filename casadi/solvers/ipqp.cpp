@@ -23,6 +23,7 @@
  */
 
 
+#include "casadi/core/linsol_internal.hpp"
 #include "ipqp.hpp"
 #include "casadi/core/nlpsol.hpp"
 
@@ -70,6 +71,18 @@ namespace casadi {
       {"dual_inf_tol",
        {OT_DOUBLE,
         "Dual feasibility violation tolerance [1e-8]"}},
+      {"pr_tol",
+       {OT_DOUBLE,
+        "Primal feasibility tolerance [1e-8]."}},
+      {"du_tol",
+       {OT_DOUBLE,
+        "Dual feasibility tolerance [1e-8]."}},
+      {"co_tol",
+       {OT_DOUBLE,
+        "Complementarity tolerance [1e-8]."}},
+      {"mu_tol",
+       {OT_DOUBLE,
+        "Barrier parameter tolerance [1e-8]."}},
       {"print_header",
        {OT_BOOL,
         "Print header [true]."}},
@@ -87,7 +100,14 @@ namespace casadi {
         "Options to be passed to the linear solver"}},
       {"min_lam",
        {OT_DOUBLE,
-        "Smallest multiplier treated as inactive for the initial active set [0]."}}
+        "Smallest multiplier treated as inactive for the initial active set [0]."}},
+      {"warm_start",
+       {OT_BOOL,
+        "Start from the initial guess x0, lam_x0, lam_a0 instead of a default interior "
+        "point, e.g. the solution of the previous QP in an SQP or MPC loop [false]."}},
+      {"warm_start_shift",
+       {OT_DOUBLE,
+        "Minimum distance to the bounds and minimum multiplier for a warm start [1e-3]."}}
      }
   };
 
@@ -125,27 +145,61 @@ namespace casadi {
         linear_solver_ = op.second.to_string();
       } else if (op.first=="linear_solver_options") {
         linear_solver_options_ = op.second;
+      } else if (op.first=="warm_start") {
+        p_.warm_start = op.second.to_bool();
+      } else if (op.first=="warm_start_shift") {
+        p_.warm_shift = op.second;
       }
     }
     // Memory for IP solver
     alloc_w(casadi_ipqp_sz_w(&p_), true);
     // Memory for KKT formation
     alloc_w(kkt_.nnz(), true);
-    alloc_iw(A_.size2());
+    alloc_iw(na_);
     alloc_w(nx_ + na_);
-    // KKT solver
-    linsol_ = Linsol("linsol", linear_solver_, kkt_, linear_solver_options_);
     // Print summary
     if (print_header_) {
       print("-------------------------------------------\n");
-      print("This is casadi::Ipqp\n");
-      print("Linear solver:                   %12s\n", linear_solver_.c_str());
+      print("This is casadi::%s\n", class_name().c_str());
       print("Number of variables:             %12d\n", nx_);
       print("Number of constraints:           %12d\n", na_);
       print("Number of nonzeros in H:         %12d\n", H_.nnz());
       print("Number of nonzeros in A:         %12d\n", A_.nnz());
       print("Number of nonzeros in KKT:       %12d\n", kkt_.nnz());
     }
+    // KKT solver
+    init_kkt();
+  }
+
+  void Ipqp::init_kkt() {
+    linsol_ = Linsol("linsol", linear_solver_, kkt_, linear_solver_options_);
+    // Factors in generated code
+    alloc_w(linsol_->generate_sz_w(), true);
+    if (print_header_) {
+      print("Linear solver:                   %12s\n", linear_solver_.c_str());
+    }
+  }
+
+  int Ipqp::kkt_factor(IpqpMemory* m, const double* nz_kkt) const {
+    return linsol_.nfact(nz_kkt, m->linsol_mem);
+  }
+
+  int Ipqp::kkt_solve(IpqpMemory* m, const double* nz_kkt, double* x) const {
+    return linsol_.solve(nz_kkt, x, 1, false, m->linsol_mem);
+  }
+
+  void Ipqp::codegen_kkt_setup(CodeGenerator& g) const {
+    // The factors are kept between the factorization and the solves
+    g.local("linsol_w", "casadi_real", "*");
+    g << "linsol_w = w; w += " << linsol_->generate_sz_w() << ";\n";
+  }
+
+  void Ipqp::codegen_kkt_factor(CodeGenerator& g) const {
+    linsol_->generate_nfact(g, "nz_kkt", "linsol_w");
+  }
+
+  void Ipqp::codegen_kkt_solve(CodeGenerator& g) const {
+    linsol_->generate_solve(g, "d.linsys", 1, false, "linsol_w");
   }
 
   void Ipqp::set_qp_prob() {
@@ -156,9 +210,16 @@ namespace casadi {
     if (Conic::init_mem(mem)) return 1;
     auto m = static_cast<IpqpMemory*>(mem);
     m->return_status = "";
+    m->linsol_mem = linsol_.is_null() ? -1 : linsol_.checkout();
     return 0;
   }
 
+  void Ipqp::free_mem(void *mem) const {
+    auto m = static_cast<IpqpMemory*>(mem);
+    if (m->linsol_mem >= 0) linsol_.release(m->linsol_mem);
+    delete m;
+  }
+
   int Ipqp::
   solve(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const {
     auto m = static_cast<IpqpMemory*>(mem);
@@ -166,8 +227,6 @@ namespace casadi {
     char buf[121];
     // Setup KKT system
     double* nz_kkt = w; w += kkt_.nnz();
-    // Checkout a linear solver instance
-    int linsol_mem = linsol_.checkout();
     // Setup IP solver
     casadi_ipqp_data<double> d;
     d.prob = &p_;
@@ -175,6 +234,8 @@ namespace casadi {
     casadi_ipqp_bounds(&d, arg[CONIC_G],
       arg[CONIC_LBX], arg[CONIC_UBX], arg[CONIC_LBA], arg[CONIC_UBA]);
     casadi_ipqp_guess(&d, arg[CONIC_X0], arg[CONIC_LAM_X0], arg[CONIC_LAM_A0]);
+    // Setup KKT solver
+    kkt_setup(m, iw, w);
     // Reverse communication loop
     while (casadi_ipqp(&d)) {
       switch (d.task) {
@@ -204,20 +265,19 @@ namespace casadi {
         casadi_kkt(kkt_, nz_kkt, H_, arg[CONIC_H], A_, arg[CONIC_A],
           d.S, d.D, w, iw);
         // Factorize KKT
-        if (linsol_.nfact(nz_kkt, linsol_mem))
+        if (kkt_factor(m, nz_kkt))
           d.status = IPQP_FACTOR_ERROR;
         break;
       case IPQP_SOLVE:
         // Solve KKT
-        if (linsol_.solve(nz_kkt, d.linsys, 1, false, linsol_mem))
+        if (kkt_solve(m, nz_kkt, d.linsys))
           d.status = IPQP_SOLVE_ERROR;
         break;
       }
     }
-    // Release linear solver instance
-    linsol_.release(linsol_mem);
     // Read return status
     m->return_status = casadi_ipqp_return_status(d.status);
+    m->d_qp.iter_count = d.iter;
     if (d.status == IPQP_MAX_ITER)
       m->d_qp.unified_return_status = SOLVER_RET_LIMITED;
     // Get solution
@@ -232,6 +292,101 @@ namespace casadi {
     return 0;
   }
 
+  void Ipqp::codegen_body(CodeGenerator& g) const {
+    g.add_auxiliary(CodeGenerator::AUX_IPQP);
+    g.add_auxiliary(CodeGenerator::AUX_KKT);
+    g.add_auxiliary(CodeGenerator::AUX_MV);
+    g.add_auxiliary(CodeGenerator::AUX_BILIN);
+    g.add_auxiliary(CodeGenerator::AUX_DOT);
+    if (print_iter_) g.add_auxiliary(CodeGenerator::AUX_PRINTF);
+    g.local("d", "struct casadi_ipqp_data");
+    g.local("p", "struct casadi_ipqp_prob");
+    g.local("nz_kkt", "casadi_real", "*");
+    if (print_iter_) g.local("buf[121]", "char");
+
+    // Setup memory structures
+    g << "casadi_ipqp_setup(&p, " << nx_ << ", " << na_ << ");\n";
+    g << "p.max_iter = " << p_.max_iter << ";\n";
+    g << "p.pr_tol = " << p_.pr_tol << ";\n";
+    g << "p.du_tol = " << p_.du_tol << ";\n";
+    g << "p.co_tol = " << p_.co_tol << ";\n";
+    g << "p.mu_tol = " << p_.mu_tol << ";\n";
+    g << "p.warm_start = " << p_.warm_start << ";\n";
+    g << "p.warm_shift = " << p_.warm_shift << ";\n";
+
+    // Setup data structures
+    g << "nz_kkt = w; w += " << kkt_.nnz() << ";\n";
+    g << "d.prob = &p;\n";
+    g << "casadi_ipqp_init(&d, &iw, &w);\n";
+    codegen_kkt_setup(g);
+
+    g.comment("Pass bounds on z");
+    g << "d.g = " << g.arg(CONIC_G) << ";\n";
+    g.copy_default(g.arg(CONIC_LBX), nx_, "d.lbz", "-casadi_inf", false);
+    g.copy_default(g.arg(CONIC_LBA), na_, "d.lbz+" + str(nx_), "-casadi_inf", false);
+    g.copy_default(g.arg(CONIC_UBX), nx_, "d.ubz", "casadi_inf", false);
+    g.copy_default(g.arg(CONIC_UBA), na_, "d.ubz+" + str(nx_), "casadi_inf", false);
+
+    g.comment("Pass initial guess");
+    g.copy_default(g.arg(CONIC_X0), nx_, "d.z", "0", false);
+    g << g.fill("d.z+" + str(nx_), na_, "0") << "\n";
+    g.copy_default(g.arg(CONIC_LAM_X0), nx_, "d.lam", "0", false);
+    g.copy_default(g.arg(CONIC_LAM_A0), na_, "d.lam+" + str(nx_), "0", false);
+    g << g.fill("d.lam_lbz", nx_ + na_, "0") << "\n";
+    g << g.fill("d.lam_ubz", nx_ + na_, "0") << "\n";
+
+    g.comment("Solve QP");
+    g << "while (casadi_ipqp(&d)) {\n";
+    g << "switch (d.task) {\n";
+    g << "case IPQP_MV:\n";
+    g << g.mv(g.arg(CONIC_H), H_, "d.z", "d.rz", false) << "\n";
+    g << g.mv(g.arg(CONIC_A), A_, "d.lam+" + str(nx_), "d.rz", true) << "\n";
+    g << g.mv(g.arg(CONIC_A), A_, "d.z", "d.rz+" + str(nx_), false) << "\n";
+    g << "break;\n";
+    g << "case IPQP_PROGRESS:\n";
+    if (print_iter_) {
+      g << "if (d.iter % 10 == 0) {\n";
+      g << "if (casadi_ipqp_print_header(&d, buf, sizeof(buf))) break;\n";
+      g << g.printf("%s\\n", "buf") << "\n";
+      g << "}\n";
+      g << "if (casadi_ipqp_print_iteration(&d, buf, sizeof(buf))) break;\n";
+      g << g.printf("%s\\n", "buf") << "\n";
+    }
+    g << "break;\n";
+    g << "case IPQP_FACTOR:\n";
+    g << "casadi_kkt(" << g.sparsity(kkt_) << ", nz_kkt, " << g.sparsity(H_) << ", "
+      << g.arg(CONIC_H) << ", " << g.sparsity(A_) << ", " << g.arg(CONIC_A)
+      << ", d.S, d.D, w, iw);\n";
+    codegen_kkt_factor(g);
+    g << "break;\n";
+    g << "case IPQP_SOLVE:\n";
+    codegen_kkt_solve(g);
+    g << "break;\n";
+    g << "}\n";
+    g << "}\n";
+
+    g.comment("Get solution");
+    g << "if (" << g.res(CONIC_COST) << ") {\n";
+    g << g.res(CONIC_COST) << "[0] = 0.5*"
+      << g.bilin(g.arg(CONIC_H), H_, "d.z", "d.z") << ";\n";
+    g << "if (d.g) " << g.res(CONIC_COST) << "[0] += "
+      << g.dot(nx_, "d.z", "d.g") << ";\n";
+    g << "}\n";
+    g.copy_check("d.z", nx_, g.res(CONIC_X), false, true);
+    g.copy_check("d.lam", nx_, g.res(CONIC_LAM_X), false, true);
+    g.copy_check("d.lam+" + str(nx_), na_, g.res(CONIC_LAM_A), false, true);
+
+    g << "if (d.status == IPQP_SUCCESS) {\n";
+    g << "return 0;\n";
+    g << "} else {\n";
+    if (error_on_fail_) {
+      g << "return -1000;\n";
+    } else {
+      g << "return -1;\n";
+    }
+    g << "}\n";
+  }
+
   Dict Ipqp::get_stats(void* mem) const {
     Dict stats = Conic::get_stats(mem);
     auto m = static_cast<IpqpMemory*>(mem);
@@ -240,7 +395,7 @@ namespace casadi {
   }
 
   Ipqp::Ipqp(DeserializingStream& s) : Conic(s) {
-    s.version("Ipqp", 1);
+    int version = s.version("Ipqp", 1, 2);
     s.unpack("Ipqp::kkt", kkt_);
     s.unpack("Ipqp::print_iter", print_iter_);
     s.unpack("Ipqp::print_header", print_header_);
@@ -253,12 +408,16 @@ namespace casadi {
     s.unpack("Ipqp::du_tol", p_.du_tol);
     s.unpack("Ipqp::co_tol", p_.co_tol);
     s.unpack("Ipqp::mu_tol", p_.mu_tol);
+    if (version >= 2) {
+      s.unpack("Ipqp::warm_start", p_.warm_start);
+      s.unpack("Ipqp::warm_shift", p_.warm_shift);
+    }
   }
 
   void Ipqp::serialize_body(SerializingStream &s) const {
     Conic::serialize_body(s);
 
-    s.version("Ipqp", 1);
+    s.version("Ipqp", 2);
     s.pack("Ipqp::kkt", kkt_);
     s.pack("Ipqp::print_iter", print_iter_);
     s.pack("Ipqp::print_header", print_header_);
@@ -270,6 +429,8 @@ namespace casadi {
     s.pack("Ipqp::du_tol", p_.du_tol);
     s.pack("Ipqp::co_tol", p_.co_tol);
     s.pack("Ipqp::mu_tol", p_.mu_tol);
+    s.pack("Ipqp::warm_start", p_.warm_start);
+    s.pack("Ipqp::warm_shift", p_.warm_shift);
   }
 
 } // namespace casadi
@@ -0,0 +1,322 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "linsol_btf.hpp"
+
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.thread.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <thread>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif // CASADI_WITH_THREAD
+
+namespace casadi {
+
+  extern "C"
+  int CASADI_LINSOL_BTF_EXPORT
+  casadi_register_linsol_btf(LinsolInternal::Plugin* plugin) {
+    plugin->creator = LinsolBtf::creator;
+    plugin->name = "btf";
+    plugin->doc = LinsolBtf::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &LinsolBtf::options_;
+    plugin->deserialize = &LinsolBtf::deserialize;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_LINSOL_BTF_EXPORT casadi_load_linsol_btf() {
+    LinsolInternal::registerPlugin(casadi_register_linsol_btf);
+  }
+
+  LinsolBtf::LinsolBtf(const std::string& name, const Sparsity& sp)
+    : LinsolInternal(name, sp) {
+  }
+
+  LinsolBtf::~LinsolBtf() {
+    clear_mem();
+  }
+
+  const Options LinsolBtf::options_
+  = {{&ProtoFunction::options_},
+     {{"linear_solver",
+       {OT_STRING,
+        "Linsol plugin for the diagonal blocks [qr]"}},
+      {"linear_solver_options",
+       {OT_DICT,
+        "Options to be passed to the linear solver"}},
+      {"max_num_threads",
+       {OT_INT,
+        "Maximum number of threads used to factorize the diagonal blocks [1]. "
+        "Requires CasADi to be compiled with WITH_THREAD=ON."}}
+     }
+  };
+
+  void LinsolBtf::init(const Dict& opts) {
+    // Call the init method of the base class
+    LinsolInternal::init(opts);
+
+    // Default options
+    std::string linear_solver = "qr";
+    Dict linear_solver_options;
+    max_num_threads_ = 1;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="linear_solver") {
+        linear_solver = op.second.to_string();
+      } else if (op.first=="linear_solver_options") {
+        linear_solver_options = op.second;
+      } else if (op.first=="max_num_threads") {
+        max_num_threads_ = op.second;
+      }
+    }
+    casadi_assert(sp_.is_square(), "Block triangular form requires a square matrix");
+    casadi_assert(max_num_threads_>=1, "Option 'max_num_threads' must be positive");
+#ifndef CASADI_WITH_THREAD
+    if (max_num_threads_>1) {
+      casadi_warning("CasADi was not compiled with WITH_THREAD=ON. "
+                     "Falling back to serial factorization.");
+      max_num_threads_ = 1;
+    }
+#endif // CASADI_WITH_THREAD
+
+    // Dulmage-Mendelsohn decomposition
+    std::vector<casadi_int> rowblock, colblock, coarse_rowblock, coarse_colblock;
+    sp_.btf(rowperm_, colperm_, rowblock, colblock, coarse_rowblock, coarse_colblock);
+    casadi_assert(rowblock==colblock, "Matrix is structurally singular");
+    block_ = rowblock;
+    set_blocks();
+    if (verbose_) {
+      casadi_int max_rows = 0;
+      for (casadi_int b=0; b<nblocks(); ++b) max_rows = std::max(max_rows, nrow(b));
+      casadi_message("Block triangular form: " + str(nblocks())
+        + " blocks of up to " + str(max_rows) + " rows");
+    }
+
+    // One solver for each distinct block sparsity pattern
+    linsol_.clear();
+    for (casadi_int b=0; b<nblocks(); ++b) {
+      if (block_solver_[b]==linsol_.size()) {
+        linsol_.push_back(Linsol(name_ + "_block" + str(linsol_.size()), linear_solver,
+          sp_block_[b], linear_solver_options));
+      }
+    }
+  }
+
+  void LinsolBtf::set_blocks() {
+    casadi_int n = nrow(), nblocks = this->nblocks();
+    // Position of the rows and columns after permutation, block of a permuted index
+    std::vector<casadi_int> inv_rowperm(n), inv_colperm(n), which(n);
+    for (casadi_int k=0; k<n; ++k) {
+      inv_rowperm[rowperm_[k]] = k;
+      inv_colperm[colperm_[k]] = k;
+    }
+    for (casadi_int b=0; b<nblocks; ++b) {
+      for (casadi_int k=block_[b]; k<block_[b+1]; ++k) which[k] = b;
+    }
+    // Sparsity patterns of the diagonal blocks and their nonzeros in A
+    sp_block_.resize(nblocks);
+    block_solver_.resize(nblocks);
+    nz_off_.resize(nblocks + 1);
+    nz_off_[0] = 0;
+    a_nz_.clear();
+    std::vector<Sparsity> distinct;
+    for (casadi_int b=0; b<nblocks; ++b) {
+      std::vector<casadi_int> rows(rowperm_.begin() + block_[b], rowperm_.begin() + block_[b+1]);
+      std::vector<casadi_int> cols(colperm_.begin() + block_[b], colperm_.begin() + block_[b+1]);
+      std::vector<casadi_int> mapping;
+      sp_block_[b] = sp_.sub(rows, cols, mapping);
+      a_nz_.insert(a_nz_.end(), mapping.begin(), mapping.end());
+      nz_off_[b+1] = a_nz_.size();
+      auto it = std::find(distinct.begin(), distinct.end(), sp_block_[b]);
+      block_solver_[b] = it - distinct.begin();
+      if (it==distinct.end()) distinct.push_back(sp_block_[b]);
+    }
+    // Off-diagonal nonzeros, grouped by the block of their column
+    std::vector<std::vector<casadi_int>> l_nz(nblocks);
+    const casadi_int *colind = sp_.colind(), *row = sp_.row();
+    for (casadi_int c=0; c<n; ++c) {
+      for (casadi_int k=colind[c]; k<colind[c+1]; ++k) {
+        casadi_int br = which[inv_rowperm[row[k]]], bc = which[inv_colperm[c]];
+        if (br==bc) continue;
+        casadi_assert_dev(br>bc);
+        l_nz[bc].push_back(k);
+      }
+    }
+    std::vector<casadi_int> col = sp_.get_col();
+    l_off_.resize(nblocks + 1);
+    l_off_[0] = 0;
+    l_nz_.clear();
+    l_row_.clear();
+    l_col_.clear();
+    for (casadi_int b=0; b<nblocks; ++b) {
+      for (casadi_int k : l_nz[b]) {
+        l_nz_.push_back(k);
+        l_row_.push_back(inv_rowperm[row[k]]);
+        l_col_.push_back(inv_colperm[col[k]]);
+      }
+      l_off_[b+1] = l_nz_.size();
+    }
+  }
+
+  int LinsolBtf::init_mem(void* mem) const {
+    if (LinsolInternal::init_mem(mem)) return 1;
+    auto m = static_cast<LinsolBtfMemory*>(mem);
+    m->block_mem.resize(nblocks());
+    for (casadi_int b=0; b<nblocks(); ++b) {
+      m->block_mem[b] = linsol_[block_solver_[b]].checkout();
+    }
+    m->a.resize(a_nz_.size());
+    return 0;
+  }
+
+  void LinsolBtf::free_mem(void *mem) const {
+    auto m = static_cast<LinsolBtfMemory*>(mem);
+    for (casadi_int b=0; b<m->block_mem.size(); ++b) {
+      linsol_[block_solver_[b]].release(m->block_mem[b]);
+    }
+    delete m;
+  }
+
+  // Evaluate the task for every stride-th block, starting at first
+  static void btf_work(const std::function<int(casadi_int)>& task, casadi_int first,
+      casadi_int nblocks, casadi_int stride, int& ret) {
+    ret = 0;
+    try {
+      for (casadi_int b=first; b<nblocks && !ret; b+=stride) ret = task(b);
+    } catch (std::exception& e) {
+      ret = 1;
+      casadi_warning("Exception raised: " + std::string(e.what()));
+    } catch (...) {
+      ret = 1;
+      casadi_warning("Uncaught exception.");
+    }
+  }
+
+  int LinsolBtf::parallel(const std::function<int(casadi_int)>& task) const {
+    casadi_int nblocks = this->nblocks();
+#ifdef CASADI_WITH_THREAD
+    casadi_int n_threads = std::min(max_num_threads_, nblocks);
+    if (n_threads>1) {
+      std::vector<int> ret_values(n_threads);
+      std::vector<std::thread> threads;
+      for (casadi_int i=0; i<n_threads; ++i) {
+        threads.emplace_back(btf_work, std::cref(task), i, nblocks, n_threads,
+          std::ref(ret_values[i]));
+      }
+      for (auto&& th : threads) th.join();
+      int ret = 0;
+      for (int e : ret_values) ret = ret || e;
+      return ret;
+    }
+#endif // CASADI_WITH_THREAD
+    for (casadi_int b=0; b<nblocks; ++b) {
+      if (task(b)) return 1;
+    }
+    return 0;
+  }
+
+  int LinsolBtf::nfact(void* mem, const double* A) const {
+    auto m = static_cast<LinsolBtfMemory*>(mem);
+    // Collect the nonzeros of the diagonal blocks
+    for (casadi_int k=0; k<a_nz_.size(); ++k) m->a[k] = A[a_nz_[k]];
+    // The diagonal blocks are factorized independently
+    return parallel([&](casadi_int b) {
+      return linsol_[block_solver_[b]].nfact(get_ptr(m->a) + nz_off_[b], m->block_mem[b]);
+    });
+  }
+
+  int LinsolBtf::solve(void* mem, const double* A, double* x, casadi_int nrhs,
+      bool tr) const {
+    auto m = static_cast<LinsolBtfMemory*>(mem);
+    casadi_int n = nrow(), nblocks = this->nblocks();
+    const std::vector<casadi_int>& in_perm = tr ? colperm_ : rowperm_;
+    const std::vector<casadi_int>& out_perm = tr ? rowperm_ : colperm_;
+    m->y.resize(n * nrhs);
+    m->t.resize(n * nrhs);
+    double* y = get_ptr(m->y);
+    double* t = get_ptr(m->t);
+    // Permute the right-hand-sides
+    for (casadi_int r=0; r<nrhs; ++r) {
+      for (casadi_int k=0; k<n; ++k) y[k + r * n] = x[in_perm[k] + r * n];
+    }
+    // Block forward substitution (non-transposed) or back substitution (transposed)
+    for (casadi_int i=0; i<nblocks; ++i) {
+      casadi_int b = tr ? nblocks - 1 - i : i, nr = nrow(b);
+      // Pull in the solution of the following blocks (transposed)
+      if (tr) {
+        for (casadi_int k=l_off_[b]; k<l_off_[b+1]; ++k) {
+          for (casadi_int r=0; r<nrhs; ++r) {
+            y[l_col_[k] + r * n] -= A[l_nz_[k]] * y[l_row_[k] + r * n];
+          }
+        }
+      }
+      // Solve with the diagonal block
+      for (casadi_int r=0; r<nrhs; ++r) casadi_copy(y + block_[b] + r * n, nr, t + r * nr);
+      if (linsol_[block_solver_[b]].solve(get_ptr(m->a) + nz_off_[b], t, nrhs, tr,
+        m->block_mem[b])) return 1;
+      for (casadi_int r=0; r<nrhs; ++r) casadi_copy(t + r * nr, nr, y + block_[b] + r * n);
+      // Push the solution to the following blocks (non-transposed)
+      if (!tr) {
+        for (casadi_int k=l_off_[b]; k<l_off_[b+1]; ++k) {
+          for (casadi_int r=0; r<nrhs; ++r) {
+            y[l_row_[k] + r * n] -= A[l_nz_[k]] * y[l_col_[k] + r * n];
+          }
+        }
+      }
+    }
+    // Undo the permutation
+    for (casadi_int r=0; r<nrhs; ++r) {
+      for (casadi_int k=0; k<n; ++k) x[out_perm[k] + r * n] = y[k + r * n];
+    }
+    return 0;
+  }
+
+  LinsolBtf::LinsolBtf(DeserializingStream& s) : LinsolInternal(s) {
+    s.version("LinsolBtf", 1);
+    s.unpack("LinsolBtf::max_num_threads", max_num_threads_);
+    s.unpack("LinsolBtf::rowperm", rowperm_);
+    s.unpack("LinsolBtf::colperm", colperm_);
+    s.unpack("LinsolBtf::block", block_);
+    s.unpack("LinsolBtf::linsol", linsol_);
+#ifndef CASADI_WITH_THREAD
+    max_num_threads_ = 1;
+#endif // CASADI_WITH_THREAD
+    set_blocks();
+  }
+
+  void LinsolBtf::serialize_body(SerializingStream &s) const {
+    LinsolInternal::serialize_body(s);
+    s.version("LinsolBtf", 1);
+    s.pack("LinsolBtf::max_num_threads", max_num_threads_);
+    s.pack("LinsolBtf::rowperm", rowperm_);
+    s.pack("LinsolBtf::colperm", colperm_);
+    s.pack("LinsolBtf::block", block_);
+    s.pack("LinsolBtf::linsol", linsol_);
+  }
+
+} // namespace casadi
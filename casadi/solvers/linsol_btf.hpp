@@ -0,0 +1,173 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_LINSOL_BTF_HPP
+#define CASADI_LINSOL_BTF_HPP
+
+/** \defgroup plugin_Linsol_btf Title
+    \par
+
+  * Linear solver for block triangular systems, e.g. the Jacobian of the
+  * collocation equations of consecutive finite elements, which depend on
+  * their own variables and, through the continuity conditions, on those of
+  * the preceding elements. The rows and columns are permuted to block
+  * triangular form using the Dulmage-Mendelsohn decomposition
+  * (Sparsity::btf). Only the diagonal blocks are factorized, with another
+  * Linsol plugin ('linear_solver'), in parallel when 'max_num_threads' is
+  * larger than one. The off-diagonal blocks enter through block
+  * substitution.
+  *
+  * The matrix must be structurally nonsingular and the diagonal blocks
+  * nonsingular.
+
+    \identifier{28c} */
+
+/** \pluginsection{Linsol,btf} */
+
+/// \cond INTERNAL
+#include "casadi/core/linsol_internal.hpp"
+#include "casadi/core/linsol.hpp"
+#include <casadi/solvers/casadi_linsol_btf_export.h>
+
+#include <functional>
+
+namespace casadi {
+  struct CASADI_LINSOL_BTF_EXPORT LinsolBtfMemory : public LinsolMemory {
+    // Memory of the block solvers
+    std::vector<int> block_mem;
+    // Nonzeros of the diagonal blocks
+    std::vector<double> a;
+    // Permuted right-hand-sides and solution, right-hand-sides of a block
+    std::vector<double> y, t;
+  };
+
+  /** \brief \pluginbrief{LinsolInternal,btf}
+   * @copydoc LinsolInternal_doc
+   * @copydoc plugin_LinsolInternal_btf
+   */
+  class CASADI_LINSOL_BTF_EXPORT LinsolBtf : public LinsolInternal {
+  public:
+
+    // Create a linear solver given a sparsity pattern
+    LinsolBtf(const std::string& name, const Sparsity& sp);
+
+    /** \brief  Create a new LinsolInternal */
+    static LinsolInternal* creator(const std::string& name, const Sparsity& sp) {
+      return new LinsolBtf(name, sp);
+    }
+
+    // Destructor
+    ~LinsolBtf() override;
+
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    // Initialize the solver
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new LinsolBtfMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override;
+
+    // Factorize the linear system
+    int nfact(void* mem, const double* A) const override;
+
+    // Solve the linear system
+    int solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "btf";}
+
+    // Get name of the class
+    std::string class_name() const override { return "LinsolBtf";}
+
+    ///@{
+    // Options
+    casadi_int max_num_threads_;
+    ///@}
+
+    // Row and column permutation to block lower triangular form
+    std::vector<casadi_int> rowperm_, colperm_;
+
+    // Offsets of the diagonal blocks in the permuted rows and columns
+    std::vector<casadi_int> block_;
+
+    // Solvers for the distinct block sparsity patterns, solver used by each block
+    std::vector<Linsol> linsol_;
+    std::vector<casadi_int> block_solver_;
+
+    // Sparsity patterns of the blocks
+    std::vector<Sparsity> sp_block_;
+
+    // Offsets of the blocks in the nonzeros
+    std::vector<casadi_int> nz_off_;
+
+    // Nonzeros of A in the diagonal blocks
+    std::vector<casadi_int> a_nz_;
+
+    // Nonzeros of A below the diagonal blocks, sorted by the block of their column
+    std::vector<casadi_int> l_off_, l_nz_, l_row_, l_col_;
+
+    /** \brief Serialize an object without type information */
+    void serialize_body(SerializingStream &s) const override;
+
+    /** \brief Deserialize with type disambiguation */
+    static ProtoFunction* deserialize(DeserializingStream& s) { return new LinsolBtf(s); }
+
+  protected:
+    /** \brief Deserializing constructor */
+    explicit LinsolBtf(DeserializingStream& s);
+
+  private:
+    // Locate the nonzeros of the diagonal and off-diagonal blocks
+    void set_blocks();
+
+    // Number of diagonal blocks
+    casadi_int nblocks() const { return block_.size() - 1;}
+
+    // Number of rows in a block
+    casadi_int nrow(casadi_int b) const { return block_[b+1] - block_[b];}
+    using LinsolInternal::nrow;
+
+    // Evaluate a task for all blocks, in parallel if requested
+    int parallel(const std::function<int(casadi_int)>& task) const;
+  };
+
+} // namespace casadi
+
+/// \endcond
+
+#endif // CASADI_LINSOL_BTF_HPP
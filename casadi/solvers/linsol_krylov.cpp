@@ -0,0 +1,347 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "linsol_krylov.hpp"
+#include "casadi/core/global_options.hpp"
+
+namespace casadi {
+
+  extern "C"
+  int CASADI_LINSOL_KRYLOV_EXPORT
+  casadi_register_linsol_krylov(LinsolInternal::Plugin* plugin) {
+    plugin->creator = LinsolKrylov::creator;
+    plugin->name = "krylov";
+    plugin->doc = LinsolKrylov::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &LinsolKrylov::options_;
+    plugin->deserialize = &LinsolKrylov::deserialize;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_LINSOL_KRYLOV_EXPORT casadi_load_linsol_krylov() {
+    LinsolInternal::registerPlugin(casadi_register_linsol_krylov);
+  }
+
+  LinsolKrylov::LinsolKrylov(const std::string& name, const Sparsity& sp)
+    : LinsolInternal(name, sp) {
+  }
+
+  LinsolKrylov::~LinsolKrylov() {
+    clear_mem();
+  }
+
+  const Options LinsolKrylov::options_
+  = {{&ProtoFunction::options_},
+     {{"method",
+       {OT_STRING,
+        "Krylov method: 'cg' (symmetric positive definite), "
+        "'minres' (symmetric) or 'gmres' (general, default)"}},
+      {"max_iter",
+       {OT_INT,
+        "Maximum number of iterations [10*n+10]"}},
+      {"tol",
+       {OT_DOUBLE,
+        "Relative residual tolerance [1e-10]"}},
+      {"restart",
+       {OT_INT,
+        "Restart length for GMRES [30]"}},
+      {"preconditioner",
+       {OT_STRING,
+        "Preconditioner: 'none' (default), 'jacobi' or the name of a Linsol plugin"}},
+      {"preconditioner_options",
+       {OT_DICT,
+        "Options to be passed to the preconditioner Linsol"}}
+     }
+  };
+
+  void LinsolKrylov::init(const Dict& opts) {
+    // Call the init method of the base class
+    LinsolInternal::init(opts);
+
+    // Default options
+    std::string method = "gmres";
+    std::string precon = "none";
+    Dict precon_options;
+    max_iter_ = 10 * nrow() + 10;
+    tol_ = 1e-10;
+    restart_ = 30;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="method") {
+        method = op.second.to_string();
+      } else if (op.first=="max_iter") {
+        max_iter_ = op.second;
+      } else if (op.first=="tol") {
+        tol_ = op.second;
+      } else if (op.first=="restart") {
+        restart_ = op.second;
+      } else if (op.first=="preconditioner") {
+        precon = op.second.to_string();
+      } else if (op.first=="preconditioner_options") {
+        precon_options = op.second;
+      }
+    }
+
+    // Krylov method
+    if (method=="cg") {
+      method_ = KRYLOV_CG;
+    } else if (method=="minres") {
+      method_ = KRYLOV_MINRES;
+    } else if (method=="gmres") {
+      method_ = KRYLOV_GMRES;
+    } else {
+      casadi_error("Unknown Krylov method '" + method + "', "
+                   "expected 'cg', 'minres' or 'gmres'");
+    }
+    casadi_assert(sp_.is_square(), "Krylov methods require a square matrix");
+    casadi_assert(max_iter_ > 0, "Option 'max_iter' must be positive");
+    casadi_assert(restart_ > 0, "Option 'restart' must be positive");
+
+    // Preconditioner
+    if (precon=="none") {
+      precon_type_ = PRECON_NONE;
+    } else if (precon=="jacobi") {
+      precon_type_ = PRECON_JACOBI;
+    } else {
+      precon_type_ = PRECON_LINSOL;
+      precon_ = Linsol(name_ + "_precon", precon, sp_, precon_options);
+    }
+
+    set_prob();
+  }
+
+  void LinsolKrylov::set_prob() {
+    casadi_krylov_setup(&p_, nrow(), static_cast<casadi_krylov_method_t>(method_));
+    p_.max_iter = max_iter_;
+    p_.restart = std::min(restart_, nrow());
+    p_.tol = tol_;
+  }
+
+  int LinsolKrylov::init_mem(void* mem) const {
+    if (LinsolInternal::init_mem(mem)) return 1;
+    auto m = static_cast<LinsolKrylovMemory*>(mem);
+
+    // Work vectors
+    m->w.resize(casadi_krylov_sz_w(&p_));
+    if (precon_type_==PRECON_JACOBI) m->dinv.resize(nrow());
+    if (precon_type_==PRECON_LINSOL) m->precon_mem = precon_.checkout();
+    m->iter_count = 0;
+    m->success = false;
+    return 0;
+  }
+
+  void LinsolKrylov::free_mem(void *mem) const {
+    auto m = static_cast<LinsolKrylovMemory*>(mem);
+    if (precon_type_==PRECON_LINSOL) precon_.release(m->precon_mem);
+    delete m;
+  }
+
+  int LinsolKrylov::nfact(void* mem, const double* A) const {
+    auto m = static_cast<LinsolKrylovMemory*>(mem);
+    // Only the preconditioner needs to be factorized
+    if (precon_type_==PRECON_JACOBI) {
+      casadi_krylov_jacobi(sp_, A, get_ptr(m->dinv));
+    } else if (precon_type_==PRECON_LINSOL) {
+      if (precon_.nfact(A, m->precon_mem)) return 1;
+      m->precon_a.assign(A, A + sp_.nnz());
+    }
+    return 0;
+  }
+
+  // Data for sparse matrix-vector products
+  struct LinsolKrylovMv {
+    const double* A;
+    const Sparsity* sp;
+    bool tr;
+  };
+
+  static int linsol_krylov_mv(void* data, const double* v, double* Av) {
+    auto d = static_cast<LinsolKrylovMv*>(data);
+    casadi_clear(Av, d->sp->size1());
+    casadi_mv(d->A, *d->sp, v, Av, d->tr);
+    return 0;
+  }
+
+  int LinsolKrylov::solve(void* mem, const double* A, double* x, casadi_int nrhs,
+      bool tr) const {
+    auto m = static_cast<LinsolKrylovMemory*>(mem);
+    LinsolKrylovMv data = {A, &sp_, tr};
+    return solve_loop(m, linsol_krylov_mv, &data, A, x, nrhs, tr);
+  }
+
+  int LinsolKrylov::solve_mv(void* mem, Linsol::MatVec mv, void* data,
+      double* x, casadi_int nrhs) const {
+    auto m = static_cast<LinsolKrylovMemory*>(mem);
+    casadi_assert(precon_type_==PRECON_NONE || m->is_nfact,
+      "Preconditioner has not been factorized");
+    return solve_loop(m, mv, data, get_ptr(m->precon_a), x, nrhs, false);
+  }
+
+  int LinsolKrylov::solve_loop(LinsolKrylovMemory* m, Linsol::MatVec mv, void* data,
+      const double* A, double* x, casadi_int nrhs, bool tr) const {
+    casadi_int n = nrow();
+    // Set up solver
+    casadi_krylov_data<double> d;
+    d.prob = &p_;
+    double* w = get_ptr(m->w);
+    casadi_krylov_init(&d, &w);
+    m->iter_count = 0;
+    m->success = true;
+    for (casadi_int r=0; r<nrhs; ++r) {
+      // Reverse communication loop
+      casadi_krylov_start(&d, x + r*n);
+      while (casadi_krylov(&d)) {
+        if (d.task==KRYLOV_MV) {
+          if (mv(data, d.in, d.out)) return 1;
+        } else if (precon_type_==PRECON_JACOBI) {
+          for (casadi_int i=0; i<n; ++i) d.out[i] = m->dinv[i] * d.in[i];
+        } else {
+          casadi_copy(d.in, n, d.out);
+          if (precon_type_==PRECON_LINSOL) {
+            if (precon_.solve(A, d.out, 1, tr, m->precon_mem)) return 1;
+          }
+        }
+      }
+      m->iter_count += d.iter;
+      if (d.status!=KRYLOV_SUCCESS) {
+        m->success = false;
+        if (verbose_) {
+          if (d.status==KRYLOV_MAX_ITER) {
+            casadi_message("Krylov method reached maximum number of iterations");
+          } else {
+            casadi_message("Krylov method broke down");
+          }
+        }
+        return 1;
+      }
+    }
+    return 0;
+  }
+
+  Dict LinsolKrylov::get_stats(void* mem) const {
+    Dict stats = LinsolInternal::get_stats(mem);
+    auto m = static_cast<LinsolKrylovMemory*>(mem);
+    stats["iter_count"] = m->iter_count;
+    stats["success"] = m->success;
+    return stats;
+  }
+
+  casadi_int LinsolKrylov::generate_sz_w() const {
+    casadi_int sz_w = casadi_krylov_sz_w(&p_);
+    if (precon_type_==PRECON_JACOBI) sz_w += nrow();
+    if (precon_type_==PRECON_LINSOL) sz_w += precon_->generate_sz_w();
+    return sz_w;
+  }
+
+  void LinsolKrylov::generate(CodeGenerator& g, const std::string& A, const std::string& x,
+                          casadi_int nrhs, bool tr) const {
+    g.add_auxiliary(CodeGenerator::AUX_KRYLOV);
+    g.add_auxiliary(CodeGenerator::AUX_MV);
+    casadi_int n = nrow();
+    std::string sp = g.sparsity(sp_);
+
+    // Work vector of the solver, followed by that of the preconditioner
+    std::string precon_w = "w+" + str(casadi_krylov_sz_w(&p_));
+
+    // Place in block to avoid conflicts caused by local variables
+    g << "{\n";
+    g << "casadi_real *krylov_wp;\n";
+    g << "casadi_int krylov_r;\n";
+    if (precon_type_==PRECON_JACOBI) {
+      g << "casadi_real *krylov_dinv = " << precon_w << ";\n";
+      g << "casadi_int krylov_i;\n";
+    }
+    g << "struct casadi_krylov_prob krylov_p;\n";
+    g << "struct casadi_krylov_data krylov_d;\n";
+
+    // Factorize the preconditioner once
+    if (precon_type_==PRECON_LINSOL) precon_->generate_nfact(g, A, precon_w);
+
+    // Set up solver
+    g << "casadi_krylov_setup(&krylov_p, " << n << ", "
+      << (method_==KRYLOV_CG ? "KRYLOV_CG" : method_==KRYLOV_MINRES ? "KRYLOV_MINRES"
+          : "KRYLOV_GMRES") << ");\n";
+    g << "krylov_p.max_iter = " << p_.max_iter << ";\n";
+    g << "krylov_p.restart = " << p_.restart << ";\n";
+    g << "krylov_p.tol = " << g.constant(p_.tol) << ";\n";
+    g << "krylov_d.prob = &krylov_p;\n";
+    g << "krylov_wp = w;\n";
+    g << "casadi_krylov_init(&krylov_d, &krylov_wp);\n";
+    if (precon_type_==PRECON_JACOBI) {
+      g << "casadi_krylov_jacobi(" << sp << ", " << A << ", krylov_dinv);\n";
+    }
+
+    // Reverse communication loop
+    g << "for (krylov_r = 0; krylov_r < " << nrhs << "; ++krylov_r) {\n";
+    g << "casadi_krylov_start(&krylov_d, (" << x << ") + krylov_r * " << n << ");\n";
+    g << "while (casadi_krylov(&krylov_d)) {\n";
+    g << "if (krylov_d.task == KRYLOV_MV) {\n";
+    g << g.clear("krylov_d.out", n) << "\n";
+    g << g.mv(A, sp_, "krylov_d.in", "krylov_d.out", tr) << "\n";
+    g << "} else {\n";
+    if (precon_type_==PRECON_JACOBI) {
+      g << "for (krylov_i = 0; krylov_i < " << n << "; ++krylov_i) "
+        << "krylov_d.out[krylov_i] = krylov_dinv[krylov_i] * krylov_d.in[krylov_i];\n";
+    } else {
+      g << g.copy("krylov_d.in", n, "krylov_d.out") << "\n";
+      if (precon_type_==PRECON_LINSOL) {
+        precon_->generate_solve(g, "krylov_d.out", 1, tr, precon_w);
+      }
+    }
+    g << "}\n";
+    g << "}\n";
+    g << "}\n";
+
+    // End of block
+    g << "}\n";
+  }
+
+  LinsolKrylov::LinsolKrylov(DeserializingStream& s) : LinsolInternal(s) {
+    s.version("LinsolKrylov", 1);
+    s.unpack("LinsolKrylov::method", method_);
+    s.unpack("LinsolKrylov::max_iter", max_iter_);
+    s.unpack("LinsolKrylov::restart", restart_);
+    s.unpack("LinsolKrylov::tol", tol_);
+    int precon_type;
+    s.unpack("LinsolKrylov::precon_type", precon_type);
+    precon_type_ = static_cast<PreconType>(precon_type);
+    if (precon_type_==PRECON_LINSOL) s.unpack("LinsolKrylov::precon", precon_);
+    set_prob();
+  }
+
+  void LinsolKrylov::serialize_body(SerializingStream &s) const {
+    LinsolInternal::serialize_body(s);
+    s.version("LinsolKrylov", 1);
+    s.pack("LinsolKrylov::method", method_);
+    s.pack("LinsolKrylov::max_iter", max_iter_);
+    s.pack("LinsolKrylov::restart", restart_);
+    s.pack("LinsolKrylov::tol", tol_);
+    s.pack("LinsolKrylov::precon_type", static_cast<int>(precon_type_));
+    if (precon_type_==PRECON_LINSOL) s.pack("LinsolKrylov::precon", precon_);
+  }
+
+} // namespace casadi
@@ -0,0 +1,166 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_LINSOL_KRYLOV_HPP
+#define CASADI_LINSOL_KRYLOV_HPP
+
+/** \defgroup plugin_Linsol_krylov Title
+    \par
+
+  * Iterative linear solver using Krylov subspace methods: conjugate gradients
+  * (symmetric positive definite), MINRES (symmetric indefinite) or restarted
+  * GMRES (general). The matrix is only accessed through sparse matrix-vector
+  * products, which can also be supplied by a callback for matrix-free solves,
+  * e.g. the Jacobian-vector products of a Newton-Krylov method.
+  * A preconditioner can be a Jacobi scaling or any other Linsol
+  * plugin, e.g. "ldl" with "incomplete" set. MINRES requires a positive
+  * definite preconditioner.
+
+    \identifier{27r} */
+
+/** \pluginsection{Linsol,krylov} */
+
+/// \cond INTERNAL
+#include "casadi/core/linsol_internal.hpp"
+#include "casadi/core/linsol.hpp"
+#include <casadi/solvers/casadi_linsol_krylov_export.h>
+
+namespace casadi {
+  struct CASADI_LINSOL_KRYLOV_EXPORT LinsolKrylovMemory : public LinsolMemory {
+    // Work vectors
+    std::vector<double> w, dinv;
+    // Matrix of the last numeric factorization, if the preconditioner is a Linsol
+    std::vector<double> precon_a;
+    // Preconditioner memory
+    int precon_mem;
+    // Statistics of the last solve
+    casadi_int iter_count;
+    bool success;
+  };
+
+  /** \brief \pluginbrief{LinsolInternal,krylov}
+   * @copydoc LinsolInternal_doc
+   * @copydoc plugin_LinsolInternal_krylov
+   */
+  class CASADI_LINSOL_KRYLOV_EXPORT LinsolKrylov : public LinsolInternal {
+  public:
+
+    // Create a linear solver given a sparsity pattern
+    LinsolKrylov(const std::string& name, const Sparsity& sp);
+
+    /** \brief  Create a new LinsolInternal */
+    static LinsolInternal* creator(const std::string& name, const Sparsity& sp) {
+      return new LinsolKrylov(name, sp);
+    }
+
+    // Destructor
+    ~LinsolKrylov() override;
+
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    // Initialize the solver
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new LinsolKrylovMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override;
+
+    // Factorize the linear system
+    int nfact(void* mem, const double* A) const override;
+
+    // Solve the linear system
+    int solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const override;
+
+    // Solve the linear system, matrix-free
+    int solve_mv(void* mem, Linsol::MatVec mv, void* data,
+                 double* x, casadi_int nrhs) const override;
+
+    // Reverse communication loop, A is only passed on to the preconditioner
+    int solve_loop(LinsolKrylovMemory* m, Linsol::MatVec mv, void* data,
+                   const double* A, double* x, casadi_int nrhs, bool tr) const;
+
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
+
+    /// Length of the work vector of the generated code
+    casadi_int generate_sz_w() const override;
+
+    /// Generate C code
+    void generate(CodeGenerator& g, const std::string& A, const std::string& x,
+                  casadi_int nrhs, bool tr) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "krylov";}
+
+    // Get name of the class
+    std::string class_name() const override { return "LinsolKrylov";}
+
+    // Preconditioner type
+    enum PreconType {PRECON_NONE, PRECON_JACOBI, PRECON_LINSOL};
+
+    ///@{
+    // Options
+    casadi_int method_, max_iter_, restart_;
+    double tol_;
+    PreconType precon_type_;
+    ///@}
+
+    // Preconditioner, if PRECON_LINSOL
+    Linsol precon_;
+
+    // Problem structure
+    casadi_krylov_prob<double> p_;
+
+    // Set up problem structure
+    void set_prob();
+
+    /** \brief Serialize an object without type information */
+    void serialize_body(SerializingStream &s) const override;
+
+    /** \brief Deserialize with type disambiguation */
+    static ProtoFunction* deserialize(DeserializingStream& s) { return new LinsolKrylov(s); }
+
+  protected:
+    /** \brief Deserializing constructor */
+    explicit LinsolKrylov(DeserializingStream& s);
+  };
+
+} // namespace casadi
+
+/// \endcond
+
+#endif // CASADI_LINSOL_KRYLOV_HPP
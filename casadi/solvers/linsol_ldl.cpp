@@ -60,7 +60,18 @@ namespace casadi {
        "Incomplete factorization, without any fill-in"}},
       {"preordering",
        {OT_BOOL,
-       "Approximate minimal degree (AMD) preordering"}}
+       "Approximate minimal degree (AMD) preordering [true]"}},
+      {"mixed_precision",
+       {OT_BOOL,
+       "Factorize in single precision and recover double precision accuracy "
+       "by iterative refinement, falling back to a double precision "
+       "factorization if the refinement stalls [false]"}},
+      {"refinement_max_iter",
+       {OT_INT,
+       "Maximum number of refinement steps in mixed precision mode [30]"}},
+      {"refinement_tol",
+       {OT_DOUBLE,
+       "Normwise backward error tolerance in mixed precision mode [sqrt(n)*eps]"}}
      }
   };
 
@@ -71,13 +82,23 @@ namespace casadi {
     // Default options
     incomplete_ = false;
     amd_ = true;
+    mixed_precision_ = false;
+    refinement_max_iter_ = 30;
+    refinement_tol_ = std::sqrt(static_cast<double>(nrow()))
+      * std::numeric_limits<double>::epsilon();
 
     // Read user options
     for (auto&& op : opts) {
       if (op.first=="incomplete") {
         incomplete_ = op.second;
-      } else if (op.first=="amd") {
+      } else if (op.first=="preordering") {
         amd_ = op.second;
+      } else if (op.first=="mixed_precision") {
+        mixed_precision_ = op.second;
+      } else if (op.first=="refinement_max_iter") {
+        refinement_max_iter_ = op.second;
+      } else if (op.first=="refinement_tol") {
+        refinement_tol_ = op.second;
       }
     }
 
@@ -105,10 +126,19 @@ namespace casadi {
 
     // Work vectors
     casadi_int nrow = this->nrow();
-    m->d.resize(nrow);
-    m->l.resize(sp_Lt_.nnz());
-    m->w.resize(nrow);
-
+    m->w.resize(2*nrow);
+    if (mixed_precision_) {
+      // Double precision factors are only allocated when needed
+      m->a_s.resize(sp_.nnz());
+      m->l_s.resize(sp_Lt_.nnz());
+      m->d_s.resize(nrow);
+      m->w_s.resize(2*nrow);
+      m->r_s.resize(nrow);
+    } else {
+      m->d.resize(nrow);
+      m->l.resize(sp_Lt_.nnz());
+    }
+    m->fallback = false;
     return 0;
   }
 
@@ -118,6 +148,25 @@ namespace casadi {
 
   int LinsolLdl::nfact(void* mem, const double* A) const {
     auto m = static_cast<LinsolLdlMemory*>(mem);
+    if (mixed_precision_) {
+      // Single precision factorization
+      for (casadi_int k=0; k<sp_.nnz(); ++k) m->a_s[k] = static_cast<float>(A[k]);
+      casadi_ldl(sp_, get_ptr(m->a_s), sp_Lt_, get_ptr(m->l_s), get_ptr(m->d_s),
+                 get_ptr(p_), get_ptr(m->w_s));
+      // Zero pivots, overflow or underflow in single precision?
+      m->fallback = false;
+      for (float d : m->d_s) {
+        if (!(std::fabs(d) > 0 && std::isfinite(d))) m->fallback = true;
+      }
+      if (!m->fallback) return 0;
+      if (verbose_) casadi_message("Single precision LDL factorization failed");
+    }
+    return nfact_double(m, A);
+  }
+
+  int LinsolLdl::nfact_double(LinsolLdlMemory* m, const double* A) const {
+    m->l.resize(sp_Lt_.nnz());
+    m->d.resize(nrow());
     casadi_ldl(sp_, A, sp_Lt_, get_ptr(m->l), get_ptr(m->d), get_ptr(p_), get_ptr(m->w));
     for (double d : m->d) {
       if (d==0) casadi_warning("LDL factorization has zeros in D");
@@ -127,16 +176,76 @@ namespace casadi {
 
   int LinsolLdl::solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const {
     auto m = static_cast<LinsolLdlMemory*>(mem);
+    if (mixed_precision_ && !m->fallback) {
+      casadi_int nrow = this->nrow();
+      for (casadi_int r=0; r<nrhs; ++r) {
+        if (solve_refine(mem, A, x + r*nrow, tr, refinement_max_iter_, refinement_tol_,
+                         get_ptr(m->w), get_ptr(m->r_s))) {
+          // Refinement stalled: solve the remaining right-hand-sides in double precision
+          m->fallback = true;
+          if (nfact_double(m, A)) return 1;
+          x += r*nrow;
+          nrhs -= r;
+          break;
+        }
+      }
+      if (!m->fallback) return 0;
+    }
     casadi_ldl_solve(x, nrhs, sp_Lt_, get_ptr(m->l), get_ptr(m->d), get_ptr(p_), get_ptr(m->w));
     return 0;
   }
 
+  int LinsolLdl::solve_single(void* mem, float* x, casadi_int nrhs, bool tr) const {
+    auto m = static_cast<LinsolLdlMemory*>(mem);
+    casadi_ldl_solve(x, nrhs, sp_Lt_, get_ptr(m->l_s), get_ptr(m->d_s), get_ptr(p_),
+                     get_ptr(m->w_s));
+    return 0;
+  }
+
+  int LinsolLdl::update(void* mem, const double* alpha, const double* V,
+                         casadi_int k) const {
+    // The truncated pattern of an incomplete factor cannot hold the modification
+    casadi_assert(!incomplete_, "LDL^T modification not available for 'incomplete' factors");
+    auto m = static_cast<LinsolLdlMemory*>(mem);
+    casadi_int nrow = this->nrow();
+    // Sequence of rank-1 modifications, one per column of V
+    for (casadi_int i=0; i<k; ++i) {
+      if (alpha[i]==0) continue;
+      if (mixed_precision_ && !m->fallback) {
+        for (casadi_int j=0; j<nrow; ++j) m->r_s[j] = static_cast<float>(V[i*nrow + j]);
+        if (casadi_ldl_update(sp_Lt_, get_ptr(m->l_s), get_ptr(m->d_s), get_ptr(p_),
+                              static_cast<float>(alpha[i]), get_ptr(m->r_s),
+                              get_ptr(m->w_s))) {
+          if (verbose_) casadi_message("LDL modification encountered a zero pivot");
+          return 1;
+        }
+        continue;
+      }
+      if (casadi_ldl_update(sp_Lt_, get_ptr(m->l), get_ptr(m->d), get_ptr(p_),
+                            alpha[i], V + i*nrow, get_ptr(m->w))) {
+        if (verbose_) casadi_message("LDL modification encountered a zero pivot");
+        return 1;
+      }
+    }
+    return 0;
+  }
+
+  Dict LinsolLdl::get_stats(void* mem) const {
+    Dict stats = LinsolInternal::get_stats(mem);
+    stats["permutation"] = p_;
+    return stats;
+  }
+
   casadi_int LinsolLdl::neig(void* mem, const double* A) const {
     // Count number of negative eigenvalues
     auto m = static_cast<LinsolLdlMemory*>(mem);
     casadi_int nrow = this->nrow();
     casadi_int ret = 0;
-    for (casadi_int i=0; i<nrow; ++i) if (m->d[i]<0) ret++;
+    if (mixed_precision_ && !m->fallback) {
+      for (casadi_int i=0; i<nrow; ++i) if (m->d_s[i]<0) ret++;
+    } else {
+      for (casadi_int i=0; i<nrow; ++i) if (m->d[i]<0) ret++;
+    }
     return ret;
   }
 
@@ -145,45 +254,58 @@ namespace casadi {
     auto m = static_cast<LinsolLdlMemory*>(mem);
     casadi_int nrow = this->nrow();
     casadi_int ret = 0;
-    for (casadi_int i=0; i<nrow; ++i) if (m->d[i]!=0) ret++;
+    if (mixed_precision_ && !m->fallback) {
+      for (casadi_int i=0; i<nrow; ++i) if (m->d_s[i]!=0) ret++;
+    } else {
+      for (casadi_int i=0; i<nrow; ++i) if (m->d[i]!=0) ret++;
+    }
     return ret;
   }
 
+  casadi_int LinsolLdl::generate_sz_w() const {
+    return sp_Lt_.nnz() + 2*nrow();
+  }
+
   void LinsolLdl::generate(CodeGenerator& g, const std::string& A, const std::string& x,
                           casadi_int nrhs, bool tr) const {
-    // Codegen the integer vectors
-    std::string sp = g.sparsity(sp_);
-    std::string sp_Lt = g.sparsity(sp_Lt_);
-    std::string p = g.constant(p_);
-
-    // Place in block to avoid conflicts caused by local variables
-    g << "{\n";
-    g.comment("FIXME(@jaeandersson): Memory allocation can be avoided");
-    g << "casadi_real lt[" << sp_Lt_.nnz() << "], "
-         "d[" << nrow() << "], "
-         "w[" << nrow() << "];\n";
-
-    // Factorize
-    g << g.ldl(sp, A, sp_Lt, "lt", "d", p, "w") << "\n";
+    generate_nfact(g, A, "w");
+    generate_solve(g, x, nrhs, tr, "w");
+  }
 
-    // Solve
-    g << g.ldl_solve(x, nrhs, sp_Lt, "lt", "d", p, "w") << "\n";
+  void LinsolLdl::generate_nfact(CodeGenerator& g, const std::string& A,
+                                 const std::string& w) const {
+    // Factors and work vector in w
+    std::string d = w + "+" + str(sp_Lt_.nnz()), ww = w + "+" + str(sp_Lt_.nnz() + nrow());
+    g << g.ldl(g.sparsity(sp_), A, g.sparsity(sp_Lt_), w, d, g.constant(p_), ww) << "\n";
+  }
 
-    // End of block
-    g << "}\n";
+  void LinsolLdl::generate_solve(CodeGenerator& g, const std::string& x,
+                                 casadi_int nrhs, bool tr, const std::string& w) const {
+    std::string d = w + "+" + str(sp_Lt_.nnz()), ww = w + "+" + str(sp_Lt_.nnz() + nrow());
+    g << g.ldl_solve(x, nrhs, g.sparsity(sp_Lt_), w, d, g.constant(p_), ww) << "\n";
   }
 
   LinsolLdl::LinsolLdl(DeserializingStream& s) : LinsolInternal(s) {
-    s.version("LinsolLdl", 1);
+    int version = s.version("LinsolLdl", 1, 2);
     s.unpack("LinsolLdl::p", p_);
     s.unpack("LinsolLdl::sp_Lt", sp_Lt_);
+    if (version >= 2) {
+      s.unpack("LinsolLdl::mixed_precision", mixed_precision_);
+      s.unpack("LinsolLdl::refinement_max_iter", refinement_max_iter_);
+      s.unpack("LinsolLdl::refinement_tol", refinement_tol_);
+    } else {
+      mixed_precision_ = false;
+    }
   }
 
   void LinsolLdl::serialize_body(SerializingStream &s) const {
     LinsolInternal::serialize_body(s);
-    s.version("LinsolLdl", 1);
+    s.version("LinsolLdl", 2);
     s.pack("LinsolLdl::p", p_);
     s.pack("LinsolLdl::sp_Lt", sp_Lt_);
+    s.pack("LinsolLdl::mixed_precision", mixed_precision_);
+    s.pack("LinsolLdl::refinement_max_iter", refinement_max_iter_);
+    s.pack("LinsolLdl::refinement_tol", refinement_tol_);
   }
 
 } // namespace casadi
@@ -42,6 +42,10 @@
 namespace casadi {
   struct CASADI_LINSOL_LDL_EXPORT LinsolLdlMemory : public LinsolMemory {
     std::vector<double> l, d, w;
+    // Single precision factorization, mixed precision mode
+    std::vector<float> a_s, l_s, d_s, w_s, r_s;
+    // Double precision factorization in use, mixed precision mode
+    bool fallback;
   };
 
   /** \brief \pluginbrief{LinsolInternal,ldl}
@@ -86,13 +90,36 @@ namespace casadi {
     // Factorize the linear system
     int nfact(void* mem, const double* A) const override;
 
+    // Factorize the linear system in double precision
+    int nfact_double(LinsolLdlMemory* m, const double* A) const;
+
     // Solve the linear system
     int solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const override;
 
+    // Solve with the single precision factorization
+    int solve_single(void* mem, float* x, casadi_int nrhs, bool tr) const override;
+
+    // Low-rank modification of the factorization
+    int update(void* mem, const double* alpha, const double* V, casadi_int k) const override;
+
     /// Generate C code
     void generate(CodeGenerator& g, const std::string& A, const std::string& x,
                   casadi_int nrhs, bool tr) const override;
 
+    /// Length of the work vector of the generated code
+    casadi_int generate_sz_w() const override;
+
+    /// Generate C code for the numeric factorization only
+    void generate_nfact(CodeGenerator& g, const std::string& A,
+                        const std::string& w) const override;
+
+    /// Generate C code for a solve with the factors of generate_nfact
+    void generate_solve(CodeGenerator& g, const std::string& x,
+                        casadi_int nrhs, bool tr, const std::string& w) const override;
+
+    /// Get all statistics, including the fill-reducing permutation
+    Dict get_stats(void* mem) const override;
+
     /// Number of negative eigenvalues
     casadi_int neig(void* mem, const double* A) const override;
 
@@ -114,7 +141,9 @@ namespace casadi {
 
     ///@{
     // Options
-    bool incomplete_, amd_;
+    bool incomplete_, amd_, mixed_precision_;
+    casadi_int refinement_max_iter_;
+    double refinement_tol_;
     ///@}
 
     /** \brief Serialize an object without type information */
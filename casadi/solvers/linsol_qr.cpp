@@ -60,7 +60,18 @@ namespace casadi {
         "Minimum R entry before singularity is declared [1e-12]"}},
       {"cache",
        {OT_DOUBLE,
-        "Amount of factorisations to remember (thread-local) [0]"}}
+        "Amount of factorisations to remember (thread-local) [0]"}},
+      {"mixed_precision",
+       {OT_BOOL,
+        "Factorize in single precision and recover double precision accuracy "
+        "by iterative refinement, falling back to a double precision "
+        "factorization if the refinement stalls [false]"}},
+      {"refinement_max_iter",
+       {OT_INT,
+        "Maximum number of refinement steps in mixed precision mode [30]"}},
+      {"refinement_tol",
+       {OT_DOUBLE,
+        "Normwise backward error tolerance in mixed precision mode [sqrt(n)*eps]"}}
      }
   };
 
@@ -71,13 +82,27 @@ namespace casadi {
     // Read options
     eps_ = 1e-12;
     n_cache_ = 0;
+    mixed_precision_ = false;
+    refinement_max_iter_ = 30;
+    refinement_tol_ = std::sqrt(static_cast<double>(nrow()))
+      * std::numeric_limits<double>::epsilon();
     for (auto&& op : opts) {
       if (op.first=="eps") {
         eps_ = op.second;
       } else if (op.first=="cache") {
         n_cache_ = op.second;
+      } else if (op.first=="mixed_precision") {
+        mixed_precision_ = op.second;
+      } else if (op.first=="refinement_max_iter") {
+        refinement_max_iter_ = op.second;
+      } else if (op.first=="refinement_tol") {
+        refinement_tol_ = op.second;
       }
     }
+    if (mixed_precision_) {
+      casadi_assert(sp_.is_square(), "Mixed precision mode requires a square matrix");
+      casadi_assert(n_cache_==0, "Mixed precision mode cannot be combined with 'cache'");
+    }
 
     // Symbolic factorization
     sp_.qr_sparse(sp_v_, sp_r_, prinv_, pc_);
@@ -93,14 +118,25 @@ namespace casadi {
     auto m = static_cast<LinsolQrMemory*>(mem);
 
     // Memory for numerical solution
-    m->v.resize(sp_v_.nnz());
-    m->r.resize(sp_r_.nnz());
-    m->beta.resize(ncol());
     m->w.resize(nrow() + ncol());
-
     m->cache.resize(cache_stride_*n_cache_);
     m->cache_loc.resize(n_cache_, -1);
 
+    if (mixed_precision_) {
+      // Double precision factors are only allocated when needed
+      m->a_s.resize(sp_.nnz());
+      m->v_s.resize(sp_v_.nnz());
+      m->r_s.resize(sp_r_.nnz());
+      m->beta_s.resize(ncol());
+      m->w_s.resize(nrow() + ncol());
+      m->x_s.resize(nrow());
+    } else {
+      m->v.resize(sp_v_.nnz());
+      m->r.resize(sp_r_.nnz());
+      m->beta.resize(ncol());
+    }
+    m->fallback = false;
+
     return 0;
   }
 
@@ -110,6 +146,30 @@ namespace casadi {
 
   int LinsolQr::nfact(void* mem, const double* A) const {
     auto m = static_cast<LinsolQrMemory*>(mem);
+    if (mixed_precision_) {
+      // Single precision factorization
+      for (casadi_int k=0; k<sp_.nnz(); ++k) m->a_s[k] = static_cast<float>(A[k]);
+      casadi_qr(sp_, get_ptr(m->a_s), get_ptr(m->w_s),
+                sp_v_, get_ptr(m->v_s), sp_r_, get_ptr(m->r_s),
+                get_ptr(m->beta_s), get_ptr(prinv_), get_ptr(pc_));
+      // Singular, overflow or underflow in single precision?
+      float rmin;
+      casadi_int irmin;
+      m->fallback = casadi_qr_singular(&rmin, &irmin, get_ptr(m->r_s), sp_r_, get_ptr(pc_),
+                                       static_cast<float>(eps_)) > 0;
+      for (float r : m->r_s) {
+        if (!std::isfinite(r)) m->fallback = true;
+      }
+      if (!m->fallback) return 0;
+      if (verbose_) casadi_message("Single precision QR factorization failed");
+    }
+    return nfact_double(m, A);
+  }
+
+  int LinsolQr::nfact_double(LinsolQrMemory* m, const double* A) const {
+    m->v.resize(sp_v_.nnz());
+    m->r.resize(sp_r_.nnz());
+    m->beta.resize(ncol());
 
     // Check for a cache hit
     double* cache = nullptr;
@@ -156,14 +216,47 @@ namespace casadi {
 
   int LinsolQr::solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const {
     auto m = static_cast<LinsolQrMemory*>(mem);
+    if (mixed_precision_ && !m->fallback) {
+      casadi_int nrow = this->nrow();
+      for (casadi_int r=0; r<nrhs; ++r) {
+        if (solve_refine(mem, A, x + r*nrow, tr, refinement_max_iter_, refinement_tol_,
+                         get_ptr(m->w), get_ptr(m->x_s))) {
+          // Refinement stalled: solve the remaining right-hand-sides in double precision
+          m->fallback = true;
+          if (nfact_double(m, A)) return 1;
+          x += r*nrow;
+          nrhs -= r;
+          break;
+        }
+      }
+      if (!m->fallback) return 0;
+    }
     casadi_qr_solve(x, nrhs, tr,
                     sp_v_, get_ptr(m->v), sp_r_, get_ptr(m->r),
                     get_ptr(m->beta), get_ptr(prinv_), get_ptr(pc_), get_ptr(m->w));
     return 0;
   }
 
+  int LinsolQr::solve_single(void* mem, float* x, casadi_int nrhs, bool tr) const {
+    auto m = static_cast<LinsolQrMemory*>(mem);
+    casadi_qr_solve(x, nrhs, tr,
+                    sp_v_, get_ptr(m->v_s), sp_r_, get_ptr(m->r_s),
+                    get_ptr(m->beta_s), get_ptr(prinv_), get_ptr(pc_), get_ptr(m->w_s));
+    return 0;
+  }
+
+  casadi_int LinsolQr::generate_sz_w() const {
+    return sp_v_.nnz() + sp_r_.nnz() + ncol() + nrow() + ncol();
+  }
+
   void LinsolQr::generate(CodeGenerator& g, const std::string& A, const std::string& x,
                           casadi_int nrhs, bool tr) const {
+    generate_nfact(g, A, "w");
+    generate_solve(g, x, nrhs, tr, "w");
+  }
+
+  void LinsolQr::generate_nfact(CodeGenerator& g, const std::string& A,
+                                const std::string& w) const {
     // Codegen the integer vectors
     std::string prinv = g.constant(prinv_);
     std::string pc = g.constant(pc_);
@@ -171,15 +264,19 @@ namespace casadi {
     std::string sp_v = g.sparsity(sp_v_);
     std::string sp_r = g.sparsity(sp_r_);
 
-    // Place in block to avoid conflicts caused by local variables
-    g << "{\n";
-    g.comment("FIXME(@jaeandersson): Memory allocation can be avoided");
-    g << "casadi_real v[" << sp_v_.nnz() << "], "
-         "r[" << sp_r_.nnz() << "], "
-         "beta[" << ncol() << "], "
-         "w[" << nrow() + ncol() << "];\n";
+    // Factors and work vector in w
+    casadi_int off = 0;
+    std::string v = w;
+    off += sp_v_.nnz();
+    std::string r = w + "+" + str(off);
+    off += sp_r_.nnz();
+    std::string beta = w + "+" + str(off);
+    off += ncol();
+    std::string ww = w + "+" + str(off);
 
     if (n_cache_) {
+      // Place in block to avoid conflicts caused by local variables
+      g << "{\n";
       g << "casadi_real *c;\n";
       g << "casadi_real cache[" << cache_stride_*n_cache_ << "];\n";
       g << "int cache_loc[" << n_cache_ << "] = {";
@@ -191,34 +288,40 @@ namespace casadi {
         cache_stride_, n_cache_, sp_.nnz(), "&c") << ") {\n";
       casadi_int offset = sp_.nnz();
       g.comment("Retrieve from cache");
-      g << g.copy("c+" + str(offset), sp_v_.nnz(), "v") << "\n"; offset+=sp_v_.nnz();
-      g << g.copy("c+" + str(offset), sp_r_.nnz(), "r") << "\n"; offset+=sp_r_.nnz();
-      g << g.copy("c+" + str(offset), ncol(), "beta") << "\n"; offset+=ncol();
+      g << g.copy("c+" + str(offset), sp_v_.nnz(), v) << "\n"; offset+=sp_v_.nnz();
+      g << g.copy("c+" + str(offset), sp_r_.nnz(), r) << "\n"; offset+=sp_r_.nnz();
+      g << g.copy("c+" + str(offset), ncol(), beta) << "\n"; offset+=ncol();
       g << "} else {\n";
     }
 
     // Factorize
-    g << g.qr(sp, A, "w", sp_v, "v", sp_r, "r", "beta", prinv, pc) << "\n";
+    g << g.qr(sp, A, ww, sp_v, v, sp_r, r, beta, prinv, pc) << "\n";
 
     if (n_cache_) {
       casadi_int offset = 0;
       g.comment("Store in cache");
       g << g.copy(A, sp_.nnz(), "c") << "\n";; offset+=sp_.nnz();
-      g << g.copy("v", sp_v_.nnz(), "c+"+str(offset)) << "\n"; offset+=sp_v_.nnz();
-      g << g.copy("r", sp_r_.nnz(), "c+"+str(offset)) << "\n"; offset+=sp_r_.nnz();
-      g << g.copy("beta", ncol(), "c+"+str(offset)) << "\n"; offset+=ncol();
+      g << g.copy(v, sp_v_.nnz(), "c+"+str(offset)) << "\n"; offset+=sp_v_.nnz();
+      g << g.copy(r, sp_r_.nnz(), "c+"+str(offset)) << "\n"; offset+=sp_r_.nnz();
+      g << g.copy(beta, ncol(), "c+"+str(offset)) << "\n"; offset+=ncol();
+      g << "}\n";
       g << "}\n";
     }
+  }
 
-    // Solve
-    g << g.qr_solve(x, nrhs, tr, sp_v, "v", sp_r, "r", "beta", prinv, pc, "w") << "\n";
-
-    // End of block
-    g << "}\n";
+  void LinsolQr::generate_solve(CodeGenerator& g, const std::string& x,
+                                casadi_int nrhs, bool tr, const std::string& w) const {
+    casadi_int off = sp_v_.nnz();
+    std::string r = w + "+" + str(off);
+    off += sp_r_.nnz();
+    std::string beta = w + "+" + str(off);
+    off += ncol();
+    g << g.qr_solve(x, nrhs, tr, g.sparsity(sp_v_), w, g.sparsity(sp_r_), r, beta,
+                    g.constant(prinv_), g.constant(pc_), w + "+" + str(off)) << "\n";
   }
 
   LinsolQr::LinsolQr(DeserializingStream& s) : LinsolInternal(s) {
-    int version = s.version("LinsolQr", 1, 2);
+    int version = s.version("LinsolQr", 1, 3);
     s.unpack("LinsolQr::prinv", prinv_);
     s.unpack("LinsolQr::pc", pc_);
     s.unpack("LinsolQr::sp_v", sp_v_);
@@ -229,17 +332,27 @@ namespace casadi {
     } else {
       n_cache_ = 1;
     }
+    if (version>2) {
+      s.unpack("LinsolQr::mixed_precision", mixed_precision_);
+      s.unpack("LinsolQr::refinement_max_iter", refinement_max_iter_);
+      s.unpack("LinsolQr::refinement_tol", refinement_tol_);
+    } else {
+      mixed_precision_ = false;
+    }
   }
 
   void LinsolQr::serialize_body(SerializingStream &s) const {
     LinsolInternal::serialize_body(s);
-    s.version("LinsolQr", 2);
+    s.version("LinsolQr", 3);
     s.pack("LinsolQr::prinv", prinv_);
     s.pack("LinsolQr::pc", pc_);
     s.pack("LinsolQr::sp_v", sp_v_);
     s.pack("LinsolQr::sp_r", sp_r_);
     s.pack("LinsolQr::eps", eps_);
     s.pack("LinsolQr::n_cache", n_cache_);
+    s.pack("LinsolQr::mixed_precision", mixed_precision_);
+    s.pack("LinsolQr::refinement_max_iter", refinement_max_iter_);
+    s.pack("LinsolQr::refinement_tol", refinement_tol_);
   }
 
 } // namespace casadi
@@ -44,6 +44,11 @@ namespace casadi {
     std::vector<double> v, r, beta, w;
     std::vector<double> cache;
 
+    // Single precision factorization, mixed precision mode
+    std::vector<float> a_s, v_s, r_s, beta_s, w_s, x_s;
+    // Double precision factorization in use, mixed precision mode
+    bool fallback;
+
     // Cache locations sorted by access time
     std::vector<int> cache_loc;
   };
@@ -93,13 +98,30 @@ namespace casadi {
     // Factorize the linear system
     int sfact(void* mem, const double* A) const override;
 
+    // Factorize the linear system in double precision
+    int nfact_double(LinsolQrMemory* m, const double* A) const;
+
     // Solve the linear system
     int solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const override;
 
+    // Solve with the single precision factorization
+    int solve_single(void* mem, float* x, casadi_int nrhs, bool tr) const override;
+
     /// Generate C code
     void generate(CodeGenerator& g, const std::string& A, const std::string& x,
                   casadi_int nrhs, bool tr) const override;
 
+    /// Length of the work vector of the generated code
+    casadi_int generate_sz_w() const override;
+
+    /// Generate C code for the numeric factorization only
+    void generate_nfact(CodeGenerator& g, const std::string& A,
+                        const std::string& w) const override;
+
+    /// Generate C code for a solve with the factors of generate_nfact
+    void generate_solve(CodeGenerator& g, const std::string& x,
+                        casadi_int nrhs, bool tr, const std::string& w) const override;
+
     // Get name of the plugin
     const char* plugin_name() const override { return "qr";}
 
@@ -118,6 +140,13 @@ namespace casadi {
     casadi_int n_cache_;
     casadi_int cache_stride_;
 
+    ///@{
+    /// Mixed precision mode
+    bool mixed_precision_;
+    casadi_int refinement_max_iter_;
+    double refinement_tol_;
+    ///@}
+
     /** \brief Serialize an object without type information */
     void serialize_body(SerializingStream &s) const override;
 
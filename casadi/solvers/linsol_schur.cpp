@@ -0,0 +1,545 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "linsol_schur.hpp"
+
+#ifdef CASADI_WITH_THREAD
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.thread.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <thread>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif // CASADI_WITH_THREAD
+
+namespace casadi {
+
+  extern "C"
+  int CASADI_LINSOL_SCHUR_EXPORT
+  casadi_register_linsol_schur(LinsolInternal::Plugin* plugin) {
+    plugin->creator = LinsolSchur::creator;
+    plugin->name = "schur";
+    plugin->doc = LinsolSchur::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &LinsolSchur::options_;
+    plugin->deserialize = &LinsolSchur::deserialize;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_LINSOL_SCHUR_EXPORT casadi_load_linsol_schur() {
+    LinsolInternal::registerPlugin(casadi_register_linsol_schur);
+  }
+
+  LinsolSchur::LinsolSchur(const std::string& name, const Sparsity& sp)
+    : LinsolInternal(name, sp) {
+  }
+
+  LinsolSchur::~LinsolSchur() {
+    clear_mem();
+  }
+
+  const Options LinsolSchur::options_
+  = {{&ProtoFunction::options_},
+     {{"linear_solver",
+       {OT_STRING,
+        "Linsol plugin for the diagonal blocks and the Schur complement [qr]. "
+        "Use 'ldl' for symmetric systems."}},
+      {"linear_solver_options",
+       {OT_DICT,
+        "Options to be passed to the linear solver"}},
+      {"max_num_threads",
+       {OT_INT,
+        "Maximum number of threads used to factorize the diagonal blocks [1]. "
+        "Requires CasADi to be compiled with WITH_THREAD=ON."}},
+      {"min_thread_nnz",
+       {OT_INT,
+        "Minimum average number of nonzeros per diagonal block for a parallel "
+        "evaluation [1000]. Smaller blocks are processed serially, since starting "
+        "the threads would cost more than it saves."}},
+      {"max_border",
+       {OT_INT,
+        "Maximum number of rows and columns in the border [ceil(sqrt(n))]. "
+        "Without a decomposition within this limit, the system is solved as a single block."}}
+     }
+  };
+
+  void LinsolSchur::init(const Dict& opts) {
+    // Call the init method of the base class
+    LinsolInternal::init(opts);
+
+    // Default options
+    std::string linear_solver = "qr";
+    Dict linear_solver_options;
+    max_num_threads_ = 1;
+    min_thread_nnz_ = 1000;
+    max_border_ = static_cast<casadi_int>(std::ceil(std::sqrt(static_cast<double>(nrow()))));
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="linear_solver") {
+        linear_solver = op.second.to_string();
+      } else if (op.first=="linear_solver_options") {
+        linear_solver_options = op.second;
+      } else if (op.first=="max_num_threads") {
+        max_num_threads_ = op.second;
+      } else if (op.first=="min_thread_nnz") {
+        min_thread_nnz_ = op.second;
+      } else if (op.first=="max_border") {
+        max_border_ = op.second;
+      }
+    }
+    casadi_assert(sp_.is_square(), "Schur complement decomposition requires a square matrix");
+    casadi_assert(max_num_threads_>=1, "Option 'max_num_threads' must be positive");
+#ifndef CASADI_WITH_THREAD
+    if (max_num_threads_>1) {
+      casadi_warning("CasADi was not compiled with WITH_THREAD=ON. "
+                     "Falling back to serial factorization.");
+      max_num_threads_ = 1;
+    }
+#endif // CASADI_WITH_THREAD
+
+    // Block structure
+    detect_blocks();
+    set_blocks();
+    if (verbose_) {
+      casadi_int max_rows = 0;
+      for (casadi_int b=0; b<blocks_.size(); ++b) max_rows = std::max(max_rows, nrow(b));
+      casadi_message("Schur complement decomposition: " + str(blocks_.size())
+        + " blocks of up to " + str(max_rows) + " rows, border of " + str(nb()) + " rows");
+    }
+
+    // One solver for each distinct block sparsity pattern
+    linsol_.clear();
+    for (casadi_int b=0; b<blocks_.size(); ++b) {
+      if (block_solver_[b]==linsol_.size()) {
+        linsol_.push_back(Linsol(name_ + "_block" + str(linsol_.size()), linear_solver,
+          sp_block_[b], linear_solver_options));
+      }
+    }
+
+    // Dense solver for the Schur complement
+    if (nb()>0) {
+      schur_ = Linsol(name_ + "_schur", linear_solver, Sparsity::dense(nb(), nb()),
+        linear_solver_options);
+    }
+  }
+
+  // Connected components of a graph, without the removed vertices
+  static void schur_components(casadi_int n, const casadi_int* colind, const casadi_int* row,
+      const std::vector<bool>& removed, std::vector<casadi_int>& comp,
+      std::vector<casadi_int>& comp_size, std::vector<casadi_int>& stack) {
+    std::fill(comp.begin(), comp.end(), -1);
+    comp_size.clear();
+    for (casadi_int j=0; j<n; ++j) {
+      if (removed[j] || comp[j]>=0) continue;
+      casadi_int c = comp_size.size();
+      comp_size.push_back(0);
+      comp[j] = c;
+      stack.push_back(j);
+      while (!stack.empty()) {
+        casadi_int v = stack.back();
+        stack.pop_back();
+        comp_size[c]++;
+        for (casadi_int k=colind[v]; k<colind[v+1]; ++k) {
+          casadi_int r = row[k];
+          if (!removed[r] && comp[r]<0) {
+            comp[r] = c;
+            stack.push_back(r);
+          }
+        }
+      }
+    }
+  }
+
+  void LinsolSchur::detect_blocks() {
+    casadi_int n = nrow();
+    // Graph of the symmetrized sparsity pattern
+    Sparsity g = sp_ + sp_.T();
+    const casadi_int *colind = g.colind(), *row = g.row();
+    std::vector<casadi_int> deg(n, 0);
+    for (casadi_int c=0; c<n; ++c) {
+      for (casadi_int k=colind[c]; k<colind[c+1]; ++k) if (row[k]!=c) deg[c]++;
+    }
+    // Connected components of the graph without the border
+    std::vector<bool> removed(n, false);
+    std::vector<casadi_int> comp(n), comp_size, stack;
+    // Move the vertices with the highest degree to the border until the remaining
+    // graph falls apart into components of at most half of its size
+    border_.clear();
+    bool found = false;
+    while (border_.size() < max_border_) {
+      casadi_int v = -1;
+      for (casadi_int j=0; j<n; ++j) {
+        if (!removed[j] && (v<0 || deg[j]>deg[v])) v = j;
+      }
+      if (v<0 || deg[v]==0) break;
+      removed[v] = true;
+      border_.push_back(v);
+      for (casadi_int k=colind[v]; k<colind[v+1]; ++k) deg[row[k]]--;
+      schur_components(n, colind, row, removed, comp, comp_size, stack);
+      casadi_int n_rem = n - border_.size();
+      if (comp_size.size()>=2
+          && 2 * *std::max_element(comp_size.begin(), comp_size.end()) <= n_rem) {
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      // Single block
+      border_.clear();
+      blocks_ = {range(n)};
+      return;
+    }
+    // Border vertices adjacent to at most one component are returned to it
+    for (casadi_int i=border_.size(); i-- > 0; ) {
+      casadi_int v = border_[i], c = -1;
+      bool single = true;
+      for (casadi_int k=colind[v]; k<colind[v+1] && single; ++k) {
+        casadi_int r = row[k];
+        if (removed[r]) continue;
+        if (c<0) {
+          c = comp[r];
+        } else if (comp[r]!=c) {
+          single = false;
+        }
+      }
+      if (single && c>=0) {
+        removed[v] = false;
+        comp[v] = c;
+        comp_size[c]++;
+        border_.erase(border_.begin() + i);
+      }
+    }
+    std::sort(border_.begin(), border_.end());
+    // Pack consecutive components into blocks no larger than the largest component
+    casadi_int max_size = *std::max_element(comp_size.begin(), comp_size.end());
+    std::vector<casadi_int> comp_block(comp_size.size());
+    casadi_int nblocks = 0, cur_size = 0;
+    for (casadi_int c=0; c<comp_size.size(); ++c) {
+      if (nblocks==0 || cur_size + comp_size[c] > max_size) {
+        nblocks++;
+        cur_size = 0;
+      }
+      comp_block[c] = nblocks - 1;
+      cur_size += comp_size[c];
+    }
+    blocks_.clear();
+    blocks_.resize(nblocks);
+    for (casadi_int j=0; j<n; ++j) {
+      if (!removed[j]) blocks_[comp_block[comp[j]]].push_back(j);
+    }
+  }
+
+  void LinsolSchur::set_blocks() {
+    casadi_int n = nrow(), nb = this->nb(), nblocks = blocks_.size();
+    // Block and local index of each row
+    std::vector<casadi_int> which(n, -1), loc(n);
+    for (casadi_int i=0; i<nb; ++i) loc[border_[i]] = i;
+    row_off_.resize(nblocks + 1);
+    row_off_[0] = 0;
+    for (casadi_int b=0; b<nblocks; ++b) {
+      for (casadi_int i=0; i<nrow(b); ++i) {
+        which[blocks_[b][i]] = b;
+        loc[blocks_[b][i]] = i;
+      }
+      row_off_[b+1] = row_off_[b] + nrow(b);
+    }
+    // Sparsity patterns of the blocks and their nonzeros in A
+    sp_block_.resize(nblocks);
+    block_solver_.resize(nblocks);
+    nz_off_.resize(nblocks + 1);
+    nz_off_[0] = 0;
+    a_nz_.clear();
+    std::vector<Sparsity> distinct;
+    for (casadi_int b=0; b<nblocks; ++b) {
+      std::vector<casadi_int> mapping;
+      sp_block_[b] = sp_.sub(blocks_[b], blocks_[b], mapping);
+      a_nz_.insert(a_nz_.end(), mapping.begin(), mapping.end());
+      nz_off_[b+1] = a_nz_.size();
+      auto it = std::find(distinct.begin(), distinct.end(), sp_block_[b]);
+      block_solver_[b] = it - distinct.begin();
+      if (it==distinct.end()) distinct.push_back(sp_block_[b]);
+    }
+    // Border columns (n_b-by-nb) and border rows (nb-by-n_b) of each block, stacked
+    kib_nz_.clear();
+    kib_pos_.clear();
+    kbi_nz_.clear();
+    kbi_pos_.clear();
+    kbb_nz_.clear();
+    kbb_pos_.clear();
+    const casadi_int *colind = sp_.colind(), *row = sp_.row();
+    for (casadi_int c=0; c<n; ++c) {
+      for (casadi_int k=colind[c]; k<colind[c+1]; ++k) {
+        casadi_int r = row[k], br = which[r], bc = which[c];
+        if (br>=0 && bc<0) {
+          kib_nz_.push_back(k);
+          kib_pos_.push_back(nb * row_off_[br] + loc[r] + loc[c] * nrow(br));
+        } else if (br<0 && bc>=0) {
+          kbi_nz_.push_back(k);
+          kbi_pos_.push_back(nb * row_off_[bc] + loc[r] + loc[c] * nb);
+        } else if (br<0 && bc<0) {
+          kbb_nz_.push_back(k);
+          kbb_pos_.push_back(loc[r] + loc[c] * nb);
+        } else {
+          casadi_assert_dev(br==bc);
+        }
+      }
+    }
+    // Threads are only started for blocks large enough to make up for the overhead
+    n_threads_ = std::min(max_num_threads_, nblocks);
+    if (nblocks==0 || static_cast<casadi_int>(a_nz_.size()) < min_thread_nnz_ * nblocks) {
+      n_threads_ = 1;
+    }
+  }
+
+  int LinsolSchur::init_mem(void* mem) const {
+    if (LinsolInternal::init_mem(mem)) return 1;
+    auto m = static_cast<LinsolSchurMemory*>(mem);
+    casadi_int nb = this->nb(), nblocks = blocks_.size();
+    m->block_mem.resize(nblocks);
+    for (casadi_int b=0; b<nblocks; ++b) {
+      m->block_mem[b] = linsol_[block_solver_[b]].checkout();
+    }
+    if (nb>0) m->schur_mem = schur_.checkout();
+    m->a.resize(a_nz_.size());
+    m->kib.resize(nb * nrow());
+    m->kbi.resize(nb * nrow());
+    m->s.resize(nb * nb);
+    m->sb.resize(nb * nb * nblocks);
+    return 0;
+  }
+
+  void LinsolSchur::free_mem(void *mem) const {
+    auto m = static_cast<LinsolSchurMemory*>(mem);
+    for (casadi_int b=0; b<m->block_mem.size(); ++b) {
+      linsol_[block_solver_[b]].release(m->block_mem[b]);
+    }
+    if (nb()>0) schur_.release(m->schur_mem);
+    delete m;
+  }
+
+  // Evaluate the task for every stride-th block, starting at first
+  static void schur_work(const std::function<int(casadi_int)>& task, casadi_int first,
+      casadi_int nblocks, casadi_int stride, int& ret) {
+    ret = 0;
+    try {
+      for (casadi_int b=first; b<nblocks && !ret; b+=stride) ret = task(b);
+    } catch (std::exception& e) {
+      ret = 1;
+      casadi_warning("Exception raised: " + std::string(e.what()));
+    } catch (...) {
+      ret = 1;
+      casadi_warning("Uncaught exception.");
+    }
+  }
+
+  int LinsolSchur::parallel(const std::function<int(casadi_int)>& task) const {
+    casadi_int nblocks = blocks_.size();
+#ifdef CASADI_WITH_THREAD
+    if (n_threads_>1) {
+      std::vector<int> ret_values(n_threads_);
+      std::vector<std::thread> threads;
+      for (casadi_int i=0; i<n_threads_; ++i) {
+        threads.emplace_back(schur_work, std::cref(task), i, nblocks, n_threads_,
+          std::ref(ret_values[i]));
+      }
+      for (auto&& th : threads) th.join();
+      int ret = 0;
+      for (int e : ret_values) ret = ret || e;
+      return ret;
+    }
+#endif // CASADI_WITH_THREAD
+    for (casadi_int b=0; b<nblocks; ++b) {
+      if (task(b)) return 1;
+    }
+    return 0;
+  }
+
+  int LinsolSchur::nfact(void* mem, const double* A) const {
+    auto m = static_cast<LinsolSchurMemory*>(mem);
+    casadi_int nb = this->nb();
+    // Collect the nonzeros of the blocks and the border
+    for (casadi_int k=0; k<a_nz_.size(); ++k) m->a[k] = A[a_nz_[k]];
+    casadi_clear(get_ptr(m->kib), m->kib.size());
+    casadi_clear(get_ptr(m->kbi), m->kbi.size());
+    casadi_clear(get_ptr(m->s), m->s.size());
+    for (casadi_int k=0; k<kib_nz_.size(); ++k) m->kib[kib_pos_[k]] = A[kib_nz_[k]];
+    for (casadi_int k=0; k<kbi_nz_.size(); ++k) m->kbi[kbi_pos_[k]] = A[kbi_nz_[k]];
+    for (casadi_int k=0; k<kbb_nz_.size(); ++k) m->s[kbb_pos_[k]] = A[kbb_nz_[k]];
+    // Factorize the blocks, W_b = A_bb^{-1} A_b,border and A_border,b W_b
+    if (parallel([&](casadi_int b) {
+        const Linsol& L = linsol_[block_solver_[b]];
+        const double* a = get_ptr(m->a) + nz_off_[b];
+        if (L.nfact(a, m->block_mem[b])) return 1;
+        if (nb==0) return 0;
+        casadi_int nr = nrow(b);
+        double* w = get_ptr(m->kib) + nb * row_off_[b];
+        if (L.solve(a, w, nb, false, m->block_mem[b])) return 1;
+        const double* kbi = get_ptr(m->kbi) + nb * row_off_[b];
+        double* sb = get_ptr(m->sb) + nb * nb * b;
+        casadi_clear(sb, nb * nb);
+        for (casadi_int j=0; j<nb; ++j) {
+          for (casadi_int k=0; k<nr; ++k) {
+            double wkj = w[k + j * nr];
+            if (wkj==0) continue;
+            for (casadi_int i=0; i<nb; ++i) sb[i + j * nb] += kbi[i + k * nb] * wkj;
+          }
+        }
+        return 0;
+      })) return 1;
+    if (nb==0) return 0;
+    // Schur complement
+    for (casadi_int b=0; b<blocks_.size(); ++b) {
+      casadi_axpy(nb * nb, -1., get_ptr(m->sb) + nb * nb * b, get_ptr(m->s));
+    }
+    return schur_.nfact(get_ptr(m->s), m->schur_mem);
+  }
+
+  int LinsolSchur::solve(void* mem, const double* A, double* x, casadi_int nrhs,
+      bool tr) const {
+    auto m = static_cast<LinsolSchurMemory*>(mem);
+    casadi_int n = nrow(), nb = this->nb(), nblocks = blocks_.size();
+    m->xb.resize(n * nrhs);
+    m->rb.resize(nb * nrhs);
+    m->t.resize(nb * nrhs * nblocks);
+    // Right-hand-sides of the border
+    for (casadi_int r=0; r<nrhs; ++r) {
+      for (casadi_int i=0; i<nb; ++i) m->rb[i + r * nb] = x[border_[i] + r * n];
+    }
+    // Block solves (non-transposed) or products with W_b' (transposed)
+    if (parallel([&](casadi_int b) {
+        casadi_int nr = nrow(b);
+        double* xb = get_ptr(m->xb) + nrhs * row_off_[b];
+        for (casadi_int r=0; r<nrhs; ++r) {
+          for (casadi_int i=0; i<nr; ++i) xb[i + r * nr] = x[blocks_[b][i] + r * n];
+        }
+        if (!tr) {
+          const double* a = get_ptr(m->a) + nz_off_[b];
+          if (linsol_[block_solver_[b]].solve(a, xb, nrhs, false, m->block_mem[b])) return 1;
+        }
+        if (nb==0) return 0;
+        // Contribution to the border right-hand-sides
+        const double* v = tr ? get_ptr(m->kib) : get_ptr(m->kbi);
+        v += nb * row_off_[b];
+        double* t = get_ptr(m->t) + nb * nrhs * b;
+        casadi_clear(t, nb * nrhs);
+        for (casadi_int r=0; r<nrhs; ++r) {
+          for (casadi_int k=0; k<nr; ++k) {
+            double xk = xb[k + r * nr];
+            if (xk==0) continue;
+            if (tr) {
+              for (casadi_int i=0; i<nb; ++i) t[i + r * nb] += v[k + i * nr] * xk;
+            } else {
+              for (casadi_int i=0; i<nb; ++i) t[i + r * nb] += v[i + k * nb] * xk;
+            }
+          }
+        }
+        return 0;
+      })) return 1;
+    // Solve for the border
+    if (nb>0) {
+      for (casadi_int b=0; b<nblocks; ++b) {
+        casadi_axpy(nb * nrhs, -1., get_ptr(m->t) + nb * nrhs * b, get_ptr(m->rb));
+      }
+      if (schur_.solve(get_ptr(m->s), get_ptr(m->rb), nrhs, tr, m->schur_mem)) return 1;
+      for (casadi_int r=0; r<nrhs; ++r) {
+        for (casadi_int i=0; i<nb; ++i) x[border_[i] + r * n] = m->rb[i + r * nb];
+      }
+    }
+    // Back substitution
+    return parallel([&](casadi_int b) {
+      casadi_int nr = nrow(b);
+      double* xb = get_ptr(m->xb) + nrhs * row_off_[b];
+      const double* v = tr ? get_ptr(m->kbi) : get_ptr(m->kib);
+      v += nb * row_off_[b];
+      for (casadi_int r=0; r<nrhs; ++r) {
+        for (casadi_int i=0; i<nb; ++i) {
+          double xi = m->rb[i + r * nb];
+          if (xi==0) continue;
+          if (tr) {
+            for (casadi_int k=0; k<nr; ++k) xb[k + r * nr] -= v[i + k * nb] * xi;
+          } else {
+            for (casadi_int k=0; k<nr; ++k) xb[k + r * nr] -= v[k + i * nr] * xi;
+          }
+        }
+      }
+      if (tr) {
+        const double* a = get_ptr(m->a) + nz_off_[b];
+        if (linsol_[block_solver_[b]].solve(a, xb, nrhs, true, m->block_mem[b])) return 1;
+      }
+      for (casadi_int r=0; r<nrhs; ++r) {
+        for (casadi_int i=0; i<nr; ++i) x[blocks_[b][i] + r * n] = xb[i + r * nr];
+      }
+      return 0;
+    });
+  }
+
+  casadi_int LinsolSchur::neig(void* mem, const double* A) const {
+    // Haynsworth inertia additivity: inertia of the blocks plus that of the Schur complement
+    auto m = static_cast<LinsolSchurMemory*>(mem);
+    casadi_int ret = 0;
+    for (casadi_int b=0; b<blocks_.size(); ++b) {
+      ret += linsol_[block_solver_[b]].neig(get_ptr(m->a) + nz_off_[b], m->block_mem[b]);
+    }
+    if (nb()>0) ret += schur_.neig(get_ptr(m->s), m->schur_mem);
+    return ret;
+  }
+
+  casadi_int LinsolSchur::rank(void* mem, const double* A) const {
+    // Blocks are nonsingular, rank deficiency is in the Schur complement
+    auto m = static_cast<LinsolSchurMemory*>(mem);
+    casadi_int ret = nrow() - nb();
+    if (nb()>0) ret += schur_.rank(get_ptr(m->s), m->schur_mem);
+    return ret;
+  }
+
+  LinsolSchur::LinsolSchur(DeserializingStream& s) : LinsolInternal(s) {
+    s.version("LinsolSchur", 1);
+    s.unpack("LinsolSchur::max_num_threads", max_num_threads_);
+    s.unpack("LinsolSchur::min_thread_nnz", min_thread_nnz_);
+    s.unpack("LinsolSchur::max_border", max_border_);
+    s.unpack("LinsolSchur::blocks", blocks_);
+    s.unpack("LinsolSchur::border", border_);
+    s.unpack("LinsolSchur::linsol", linsol_);
+    s.unpack("LinsolSchur::schur", schur_);
+#ifndef CASADI_WITH_THREAD
+    max_num_threads_ = 1;
+#endif // CASADI_WITH_THREAD
+    set_blocks();
+  }
+
+  void LinsolSchur::serialize_body(SerializingStream &s) const {
+    LinsolInternal::serialize_body(s);
+    s.version("LinsolSchur", 1);
+    s.pack("LinsolSchur::max_num_threads", max_num_threads_);
+    s.pack("LinsolSchur::min_thread_nnz", min_thread_nnz_);
+    s.pack("LinsolSchur::max_border", max_border_);
+    s.pack("LinsolSchur::blocks", blocks_);
+    s.pack("LinsolSchur::border", border_);
+    s.pack("LinsolSchur::linsol", linsol_);
+    s.pack("LinsolSchur::schur", schur_);
+  }
+
+} // namespace casadi
@@ -0,0 +1,192 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_LINSOL_SCHUR_HPP
+#define CASADI_LINSOL_SCHUR_HPP
+
+/** \defgroup plugin_Linsol_schur Title
+    \par
+
+  * Linear solver for block-angular systems, e.g. the KKT systems of
+  * scenario-tree problems: independent diagonal blocks coupled through a
+  * small set of border rows and columns. The structure is detected from the
+  * sparsity pattern by moving the rows and columns with the most
+  * off-diagonal entries to the border until the remaining graph falls apart
+  * into balanced components. The diagonal blocks are factorized with
+  * another Linsol plugin ('linear_solver'), in parallel when
+  * 'max_num_threads' is larger than one and the blocks have at least
+  * 'min_thread_nnz' nonzeros on average, and the border is obtained from a
+  * dense Schur complement.
+  *
+  * The diagonal blocks must be nonsingular.
+
+    \identifier{288} */
+
+/** \pluginsection{Linsol,schur} */
+
+/// \cond INTERNAL
+#include "casadi/core/linsol_internal.hpp"
+#include "casadi/core/linsol.hpp"
+#include <casadi/solvers/casadi_linsol_schur_export.h>
+
+#include <functional>
+
+namespace casadi {
+  struct CASADI_LINSOL_SCHUR_EXPORT LinsolSchurMemory : public LinsolMemory {
+    // Memory of the block solvers
+    std::vector<int> block_mem;
+    // Memory of the Schur complement solver
+    int schur_mem;
+    // Nonzeros of the diagonal blocks
+    std::vector<double> a;
+    // Border columns, overwritten by the block solves, and border rows of the blocks
+    std::vector<double> kib, kbi;
+    // Schur complement and its contributions from the blocks
+    std::vector<double> s, sb;
+    // Work vectors for the solve
+    std::vector<double> xb, rb, t;
+  };
+
+  /** \brief \pluginbrief{LinsolInternal,schur}
+   * @copydoc LinsolInternal_doc
+   * @copydoc plugin_LinsolInternal_schur
+   */
+  class CASADI_LINSOL_SCHUR_EXPORT LinsolSchur : public LinsolInternal {
+  public:
+
+    // Create a linear solver given a sparsity pattern
+    LinsolSchur(const std::string& name, const Sparsity& sp);
+
+    /** \brief  Create a new LinsolInternal */
+    static LinsolInternal* creator(const std::string& name, const Sparsity& sp) {
+      return new LinsolSchur(name, sp);
+    }
+
+    // Destructor
+    ~LinsolSchur() override;
+
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    // Initialize the solver
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new LinsolSchurMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override;
+
+    // Factorize the linear system
+    int nfact(void* mem, const double* A) const override;
+
+    // Solve the linear system
+    int solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const override;
+
+    /// Number of negative eigenvalues
+    casadi_int neig(void* mem, const double* A) const override;
+
+    /// Matrix rank
+    casadi_int rank(void* mem, const double* A) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "schur";}
+
+    // Get name of the class
+    std::string class_name() const override { return "LinsolSchur";}
+
+    ///@{
+    // Options
+    casadi_int max_num_threads_, min_thread_nnz_, max_border_;
+    ///@}
+
+    // Number of threads used for the blocks
+    casadi_int n_threads_;
+
+    // Rows and columns of the diagonal blocks and of the border
+    std::vector<std::vector<casadi_int>> blocks_;
+    std::vector<casadi_int> border_;
+
+    // Solvers for the distinct block sparsity patterns, solver used by each block
+    std::vector<Linsol> linsol_;
+    std::vector<casadi_int> block_solver_;
+
+    // Solver for the Schur complement
+    Linsol schur_;
+
+    // Sparsity patterns of the blocks
+    std::vector<Sparsity> sp_block_;
+
+    // Offsets of the blocks in the nonzeros, rows and border columns
+    std::vector<casadi_int> nz_off_, row_off_;
+
+    // Nonzeros of A in the diagonal blocks
+    std::vector<casadi_int> a_nz_;
+
+    // Nonzeros of A in the border columns, border rows and border block
+    std::vector<casadi_int> kib_nz_, kib_pos_, kbi_nz_, kbi_pos_, kbb_nz_, kbb_pos_;
+
+    /** \brief Serialize an object without type information */
+    void serialize_body(SerializingStream &s) const override;
+
+    /** \brief Deserialize with type disambiguation */
+    static ProtoFunction* deserialize(DeserializingStream& s) { return new LinsolSchur(s); }
+
+  protected:
+    /** \brief Deserializing constructor */
+    explicit LinsolSchur(DeserializingStream& s);
+
+  private:
+    // Detect the diagonal blocks and the border
+    void detect_blocks();
+
+    // Locate the nonzeros of the blocks and the border
+    void set_blocks();
+
+    // Number of rows in the border
+    casadi_int nb() const { return border_.size();}
+
+    // Number of rows in a block
+    casadi_int nrow(casadi_int b) const { return blocks_[b].size();}
+    using LinsolInternal::nrow;
+
+    // Evaluate a task for all blocks, in parallel if requested
+    int parallel(const std::function<int(casadi_int)>& task) const;
+  };
+
+} // namespace casadi
+
+/// \endcond
+
+#endif // CASADI_LINSOL_SCHUR_HPP
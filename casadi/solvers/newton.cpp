@@ -69,7 +69,22 @@ namespace casadi {
         "Print information about each iteration"}},
       {"line_search",
        {OT_BOOL,
-        "Enable line-search (default: true)"}}
+        "Enable line-search (default: true)"}},
+      {"jacobian_update",
+       {OT_STRING,
+        "When to evaluate and factorize the Jacobian: 'iteration' (full Newton, default), "
+        "'solve' (simplified Newton, at the start of each call) or 'adaptive' (kept between "
+        "calls). A simplified Newton method also updates the Jacobian when the contraction "
+        "rate exceeds max_contraction."}},
+      {"max_contraction",
+       {OT_DOUBLE,
+        "Largest contraction rate of the iterations accepted before the Jacobian is "
+        "updated in a simplified Newton method (default: 0.5)"}},
+      {"matrix_free",
+       {OT_BOOL,
+        "Compute the Newton steps without forming the Jacobian, using Jacobian-vector "
+        "products from forward derivatives of the residual function. Requires a linear "
+        "solver with matrix-free support, e.g. 'krylov' (default: false)"}}
      }
   };
 
@@ -84,6 +99,9 @@ namespace casadi {
     abstolStep_ = 1e-12;
     print_iteration_ = false;
     line_search_ = true;
+    std::string jacobian_update = "iteration";
+    max_contraction_ = 0.5;
+    matrix_free_ = false;
 
     // Read options
     for (auto&& op : opts) {
@@ -97,9 +115,29 @@ namespace casadi {
         print_iteration_ = op.second;
       } else if (op.first=="line_search") {
         line_search_ = op.second;
+      } else if (op.first=="jacobian_update") {
+        jacobian_update = op.second.to_string();
+      } else if (op.first=="max_contraction") {
+        max_contraction_ = op.second;
+      } else if (op.first=="matrix_free") {
+        matrix_free_ = op.second;
       }
     }
 
+    // Jacobian update strategy
+    if (jacobian_update=="iteration") {
+      jacobian_update_ = JAC_ITERATION;
+    } else if (jacobian_update=="solve") {
+      jacobian_update_ = JAC_SOLVE;
+    } else if (jacobian_update=="adaptive") {
+      jacobian_update_ = JAC_ADAPTIVE;
+    } else {
+      casadi_error("Unknown Jacobian update strategy '" + jacobian_update + "', "
+                   "expected 'iteration', 'solve' or 'adaptive'");
+    }
+    casadi_assert(max_contraction_ > 0 && max_contraction_ < 1,
+      "Option 'max_contraction' must be between 0 and 1");
+
     casadi_assert(oracle_.n_in()>0,
                           "Newton: the supplied f must have at least one input.");
     casadi_assert(!linsol_.is_null(),
@@ -107,13 +145,29 @@ namespace casadi {
 
     set_function(oracle_, "g");
 
+    // Forward derivatives of the residual with respect to the unknown
+    if (matrix_free_) {
+      // A preconditioner would be factorized from the Jacobian, which is never formed
+      auto it = opts.find("linear_solver_options");
+      if (it != opts.end()) {
+        Dict linsol_opts = it->second;
+        auto p = linsol_opts.find("preconditioner");
+        casadi_assert(p == linsol_opts.end() || p->second.to_string() == "none",
+          "Option 'matrix_free' cannot be combined with a preconditioner");
+      }
+      std::vector<std::string> s_in = oracle_.name_in();
+      s_in.push_back("fwd:" + oracle_.name_in(iin_));
+      Function jtimes = oracle_.factory(oracle_.name() + "_jtimes", s_in,
+        {"fwd:" + oracle_.name_out(iout_)});
+      set_function(jtimes, "jtimes_g");
+    }
+
 
     // Allocate memory
     alloc_w(n_, true); // x
     alloc_w(n_, true); // F
     alloc_w(n_, true); // dx trial
     alloc_w(n_, true); // F trial
-    alloc_w(sp_jac_.nnz(), true); // J
   }
 
  void Newton::set_work(void* mem, const double**& arg, double**& res,
@@ -124,23 +178,41 @@ namespace casadi {
      m->f = w; w += n_;
      m->x_trial = w; w += n_;
      m->f_trial = w; w += n_;
-     m->jac = w; w += sp_jac_.nnz();
+  }
+
+  // Data for the Jacobian-vector product callback
+  struct NewtonJtimesData {
+    const Newton* self;
+    NewtonMemory* m;
+  };
+
+  int Newton::jtimes(void* data, const double* v, double* Jv) {
+    auto d = static_cast<NewtonJtimesData*>(data);
+    NewtonMemory* m = d->m;
+    std::copy_n(m->iarg, d->self->n_in_, m->arg);
+    m->arg[d->self->iin_] = m->x;
+    m->arg[d->self->n_in_] = v;
+    m->res[0] = Jv;
+    return d->self->calc_function(m, "jtimes_g");
   }
 
   int Newton::solve(void* mem) const {
     auto m = static_cast<NewtonMemory*>(mem);
 
-    scoped_checkout<Linsol> mem_linsol(linsol_);
-
     // Get the initial guess
     casadi_copy(m->iarg[iin_], n_, m->x);
 
+    // Only the adaptive strategy keeps the Jacobian from a previous call
+    if (jacobian_update_ != JAC_ADAPTIVE) m->jac_valid = false;
+
+    // Norm of the previous Newton step, for the contraction rate
+    double abstolStep_prev = std::numeric_limits<double>::infinity();
+
     // Perform the Newton iterations
-    m->iter=0;
     bool success = true;
     while (true) {
       // Break if maximum number of iterations already reached
-      if (m->iter >= max_iter_) {
+      if (m->iter_count >= max_iter_) {
         if (verbose_) casadi_message("Max iterations reached.");
         m->return_status = "max_iteration_reached";
         m->unified_return_status = SOLVER_RET_LIMITED;
@@ -149,15 +221,22 @@ namespace casadi {
       }
 
       // Start a new iteration
-      m->iter++;
+      m->iter_count++;
 
-      // Use x to evaluate g and J
+      // Use x to evaluate g, and J if needed
+      bool fresh = matrix_free_ || jacobian_update_ == JAC_ITERATION || !m->jac_valid;
       std::copy_n(m->iarg, n_in_, m->arg);
       m->arg[iin_] = m->x;
-      m->res[0] = m->jac;
-      std::copy_n(m->ires, n_out_, m->res+1);
-      m->res[1+iout_] = m->f;
-      calc_function(m, "jac_f_z");
+      if (fresh && !matrix_free_) {
+        m->res[0] = get_ptr(m->jac);
+        std::copy_n(m->ires, n_out_, m->res+1);
+        m->res[1+iout_] = m->f;
+        calc_function(m, "jac_f_z");
+      } else {
+        std::copy_n(m->ires, n_out_, m->res);
+        m->res[iout_] = m->f;
+        calc_function(m, "g");
+      }
 
       // Check convergence
       double abstol = 0;
@@ -171,9 +250,24 @@ namespace casadi {
         }
       }
 
-      // Factorize the linear solver with J
-      linsol_.nfact(m->jac, mem_linsol);
-      linsol_.solve(m->jac, m->f, 1, false, mem_linsol);
+      if (matrix_free_) {
+        // Solve with Jacobian-vector products at x
+        NewtonJtimesData jtimes_data = {this, m};
+        if (linsol_.solve_mv(jtimes, &jtimes_data, m->f, 1, m->linsol_mem)) {
+          if (verbose_) casadi_message("Matrix-free linear solve failed");
+          m->return_status = "linear_solver_failed";
+          success = false;
+          break;
+        }
+      } else {
+        // Factorize the linear solver with J
+        if (fresh) {
+          linsol_.nfact(get_ptr(m->jac), m->linsol_mem);
+          m->n_fact++;
+          m->jac_valid = true;
+        }
+        linsol_.solve(get_ptr(m->jac), m->f, 1, false, m->linsol_mem);
+      }
 
       // Check convergence again
       double abstolStep=0;
@@ -187,6 +281,17 @@ namespace casadi {
         }
       }
 
+      // Slow convergence with an outdated Jacobian: update it
+      if (!fresh && abstolStep > max_contraction_ * abstolStep_prev) {
+        m->jac_valid = false;
+        // Diverging: discard the step
+        if (abstolStep >= abstolStep_prev) {
+          abstolStep_prev = std::numeric_limits<double>::infinity();
+          continue;
+        }
+      }
+      abstolStep_prev = abstolStep;
+
       double alpha = 1;
       if (line_search_) {
         std::copy_n(m->iarg, n_in_, m->arg);
@@ -212,7 +317,14 @@ namespace casadi {
           }
           alpha*= 0.5;
         }
-        if (!success) break;
+        if (!success) {
+          // Retry with an updated Jacobian
+          if (fresh) break;
+          m->jac_valid = false;
+          abstolStep_prev = std::numeric_limits<double>::infinity();
+          success = true;
+          continue;
+        }
       } else {
         // X = Xk - J^(-1) F
         casadi_axpy(n_, -alpha, m->f, m->x);
@@ -220,12 +332,12 @@ namespace casadi {
 
       if (print_iteration_) {
         // Only print iteration header once in a while
-        if ((m->iter-1) % 10 ==0) {
+        if ((m->iter_count-1) % 10 ==0) {
           printIteration(uout());
         }
 
         // Print iteration information
-        printIteration(uout(), m->iter, abstol, abstolStep, alpha);
+        printIteration(uout(), m->iter_count, abstol, abstolStep, alpha);
       }
 
     }
@@ -235,7 +347,7 @@ namespace casadi {
 
     // Store the iteration count
     if (success) m->return_status = "success";
-    if (verbose_) casadi_message("Newton algorithm took " + str(m->iter) + " steps");
+    if (verbose_) casadi_message("Newton algorithm took " + str(m->iter_count) + " steps");
 
     m->success = success;
 
@@ -269,36 +381,60 @@ namespace casadi {
     if (Rootfinder::init_mem(mem)) return 1;
     auto m = static_cast<NewtonMemory*>(mem);
     m->return_status = "";
-    m->iter = 0;
+    m->jac.resize(sp_jac_.nnz());
+    m->jac_valid = false;
+    m->linsol_mem = linsol_.checkout();
     return 0;
   }
 
+  void Newton::free_mem(void *mem) const {
+    auto m = static_cast<NewtonMemory*>(mem);
+    linsol_.release(m->linsol_mem);
+    delete m;
+  }
+
   Dict Newton::get_stats(void* mem) const {
     Dict stats = Rootfinder::get_stats(mem);
     auto m = static_cast<NewtonMemory*>(mem);
     stats["return_status"] = m->return_status;
-    stats["iter_count"] = m->iter;
+    stats["iter_count"] = m->iter_count;
+    stats["n_fact"] = m->n_fact;
     return stats;
   }
 
 
   Newton::Newton(DeserializingStream& s) : Rootfinder(s) {
-    s.version("Newton", 1);
+    int version = s.version("Newton", 1, 3);
     s.unpack("Newton::max_iter", max_iter_);
     s.unpack("Newton::abstol", abstol_);
     s.unpack("Newton::abstolStep", abstolStep_);
     s.unpack("Newton::print_iteration", print_iteration_);
     s.unpack("Newton::line_search", line_search_);
+    if (version >= 2) {
+      s.unpack("Newton::jacobian_update", jacobian_update_);
+      s.unpack("Newton::max_contraction", max_contraction_);
+    } else {
+      jacobian_update_ = JAC_ITERATION;
+      max_contraction_ = 0.5;
+    }
+    if (version >= 3) {
+      s.unpack("Newton::matrix_free", matrix_free_);
+    } else {
+      matrix_free_ = false;
+    }
   }
 
   void Newton::serialize_body(SerializingStream &s) const {
     Rootfinder::serialize_body(s);
-    s.version("Newton", 1);
+    s.version("Newton", 3);
     s.pack("Newton::max_iter", max_iter_);
     s.pack("Newton::abstol", abstol_);
     s.pack("Newton::abstolStep", abstolStep_);
     s.pack("Newton::print_iteration", print_iteration_);
     s.pack("Newton::line_search", line_search_);
+    s.pack("Newton::jacobian_update", jacobian_update_);
+    s.pack("Newton::max_contraction", max_contraction_);
+    s.pack("Newton::matrix_free", matrix_free_);
   }
 
 } // namespace casadi
@@ -34,6 +34,17 @@
 
      Implements simple newton iterations to solve an implicit function.
 
+     With the option 'jacobian_update', the iterations can be turned into a
+     simplified Newton method, where the Jacobian is evaluated and factorized
+     at the start of a call, or kept between calls, and only updated when the
+     observed contraction rate exceeds 'max_contraction'.
+
+     With the option 'matrix_free', the Jacobian is not formed in the iterations.
+     The Newton steps are instead computed by a linear solver that only needs
+     Jacobian-vector products, e.g. 'krylov', with the products obtained from
+     forward derivatives of the residual function. Preconditioners, which would
+     be factorized from the Jacobian, are not supported in this mode.
+
     \identifier{236} */
 
 /** \pluginsection{Rootfinder,newton} */
@@ -52,12 +63,14 @@ namespace casadi {
     double* x_trial;
     // Current residual
     double* f_trial;
-    // Current Jacobian
-    double* jac;
+    // Current Jacobian, kept between calls
+    std::vector<double> jac;
+    // Has jac been evaluated and factorized?
+    bool jac_valid;
+    // Linear solver instance, holding the factorization of jac
+    int linsol_mem;
     // Return status
     const char* return_status;
-    // Number of iterations
-    casadi_int iter;
   };
 
   /** \brief \pluginbrief{Rootfinder,newton}
@@ -103,7 +116,7 @@ namespace casadi {
     int init_mem(void* mem) const override;
 
     /** \brief Free memory block */
-    void free_mem(void *mem) const override { delete static_cast<NewtonMemory*>(mem);}
+    void free_mem(void *mem) const override;
 
     /** \brief Set the (persistent) work vectors */
     void set_work(void* mem, const double**& arg, double**& res,
@@ -145,6 +158,19 @@ namespace casadi {
 
     bool line_search_;
 
+    /// When to reevaluate and refactorize the Jacobian
+    enum JacobianUpdate {JAC_ITERATION, JAC_SOLVE, JAC_ADAPTIVE};
+    casadi_int jacobian_update_;
+
+    /// Largest acceptable contraction rate for an outdated Jacobian
+    double max_contraction_;
+
+    /// Solve the Newton systems with Jacobian-vector products only
+    bool matrix_free_;
+
+    /// Jacobian-vector product, callback for the linear solver
+    static int jtimes(void* data, const double* v, double* Jv);
+
     /// Print iteration header
     void printIteration(std::ostream &stream) const;
 
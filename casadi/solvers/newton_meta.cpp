@@ -30,6 +30,11 @@
       "\n"
 "Implements simple newton iterations to solve an implicit function.\n"
 "\n"
+"With the option 'jacobian_update', the iterations can be turned into a\n"
+"simplified Newton method, where the Jacobian is evaluated and factorized\n"
+"at the start of a call, or kept between calls, and only updated when the\n"
+"observed contraction rate exceeds 'max_contraction'.\n"
+"\n"
 "\n"
 ">List of available options\n"
 "\n"
@@ -46,12 +51,27 @@
 "|                 |                 |                 | tolerance on    |\n"
 "|                 |                 |                 | step size       |\n"
 "+-----------------+-----------------+-----------------+-----------------+\n"
+"| jacobian_update | OT_STRING       | iteration       | When to         |\n"
+"|                 |                 |                 | evaluate and    |\n"
+"|                 |                 |                 | factorize the   |\n"
+"|                 |                 |                 | Jacobian:       |\n"
+"|                 |                 |                 | 'iteration',    |\n"
+"|                 |                 |                 | 'solve' or      |\n"
+"|                 |                 |                 | 'adaptive'      |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
 "| max_iter        | OT_INT      | 1000            | Maximum number  |\n"
 "|                 |                 |                 | of Newton       |\n"
 "|                 |                 |                 | iterations to   |\n"
 "|                 |                 |                 | perform before  |\n"
 "|                 |                 |                 | returning.      |\n"
 "+-----------------+-----------------+-----------------+-----------------+\n"
+"| max_contraction | OT_DOUBLE       | 0.500           | Largest         |\n"
+"|                 |                 |                 | contraction     |\n"
+"|                 |                 |                 | rate accepted   |\n"
+"|                 |                 |                 | before the      |\n"
+"|                 |                 |                 | Jacobian is     |\n"
+"|                 |                 |                 | updated         |\n"
+"+-----------------+-----------------+-----------------+-----------------+\n"
 "| print_iteration | OT_BOOL      | false           | Print           |\n"
 "|                 |                 |                 | information     |\n"
 "|                 |                 |                 | about each      |\n"
@@ -81,7 +101,9 @@
 "+---------------+\n"
 "|      Id       |\n"
 "+===============+\n"
-"| iter          |\n"
+"| iter_count    |\n"
+"+---------------+\n"
+"| n_fact        |\n"
 "+---------------+\n"
 "| return_status |\n"
 "+---------------+\n"
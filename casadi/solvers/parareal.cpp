@@ -0,0 +1,425 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "parareal.hpp"
+#include "casadi/core/casadi_misc.hpp"
+
+namespace casadi {
+
+  extern "C"
+  int CASADI_INTEGRATOR_PARAREAL_EXPORT
+      casadi_register_integrator_parareal(Integrator::Plugin* plugin) {
+    plugin->creator = Parareal::creator;
+    plugin->name = "parareal";
+    plugin->doc = Parareal::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Parareal::options_;
+    plugin->deserialize = &Parareal::deserialize;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_INTEGRATOR_PARAREAL_EXPORT casadi_load_integrator_parareal() {
+    Integrator::registerPlugin(casadi_register_integrator_parareal);
+  }
+
+  Parareal::Parareal(const std::string& name, const Function& dae, double t0,
+      const std::vector<double>& tout)
+      : Integrator(name, dae, t0, tout) {
+  }
+
+  Parareal::~Parareal() {
+    clear_mem();
+  }
+
+  const Options Parareal::options_
+  = {{&Integrator::options_},
+     {{"fine",
+       {OT_STRING,
+        "Integrator plugin for the fine propagator [rk]"}},
+      {"fine_options",
+       {OT_DICT,
+        "Options to be passed to the fine integrator"}},
+      {"coarse",
+       {OT_STRING,
+        "Integrator plugin for the coarse propagator [rk]"}},
+      {"coarse_options",
+       {OT_DICT,
+        "Options to be passed to the coarse integrator "
+        "[number_of_finite_elements: 1 for fixed step integrators]"}},
+      {"parallelization",
+       {OT_STRING,
+        "Parallelization of the fine integration over the time slices, cf. Function::map "
+        "[thread if CasADi was compiled with thread support, otherwise serial]"}},
+      {"number_of_slices",
+       {OT_INT,
+        "Target number of time slices, distributed over the output intervals "
+        "in proportion to their length [one slice per output interval]"}},
+      {"tol",
+       {OT_DOUBLE,
+        "Tolerance for the largest correction of the state at the start of a slice [1e-8]"}},
+      {"max_iter",
+       {OT_INT,
+        "Maximum number of Parareal iterations [number of time slices]"}}
+     }
+  };
+
+  template<typename MatType>
+  Function Parareal::slice_dae(const Function& dae) {
+    // Normalized time, start and length of the slice
+    MatType tau = MatType::sym("tau"), ts = MatType::sym("ts"), hs = MatType::sym("hs");
+    // Evaluate the DAE at the physical time
+    std::vector<MatType> arg = MatType::get_input(dae);
+    std::vector<MatType> a = arg;
+    if (!a[DYN_T].is_empty()) a[DYN_T] = ts + hs * tau;
+    std::vector<MatType> res = dae(a);
+    // Time derivatives with respect to normalized time
+    return Function("slice_" + dae.name(),
+      {tau, arg[DYN_X], arg[DYN_Z], vertcat(arg[DYN_P], ts, hs), arg[DYN_U]},
+      {hs * res[DYN_ODE], res[DYN_ALG], hs * res[DYN_QUAD]},
+      dyn_in(), dyn_out());
+  }
+
+  void Parareal::init(const Dict& opts) {
+    // Call the base class init
+    Integrator::init(opts);
+
+    // Adjoint sensitivities are calculated using forward mode, cf. has_reverse
+    casadi_assert(nadj_ == 0, "Parareal does not support adjoint sensitivities");
+
+    // Default options
+    std::string fine = "rk", coarse = "rk";
+    Dict fine_opts, coarse_opts;
+    bool coarse_opts_given = false;
+#ifdef CASADI_WITH_THREAD
+    std::string parallelization = "thread";
+#else // CASADI_WITH_THREAD
+    std::string parallelization = "serial";
+#endif // CASADI_WITH_THREAD
+    tol_ = 1e-8;
+    max_iter_ = -1;
+    casadi_int ns = nt();
+
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="fine") {
+        fine = op.second.to_string();
+      } else if (op.first=="fine_options") {
+        fine_opts = op.second;
+      } else if (op.first=="coarse") {
+        coarse = op.second.to_string();
+      } else if (op.first=="coarse_options") {
+        coarse_opts = op.second;
+        coarse_opts_given = true;
+      } else if (op.first=="parallelization") {
+        parallelization = op.second.to_string();
+      } else if (op.first=="tol") {
+        tol_ = op.second;
+      } else if (op.first=="max_iter") {
+        max_iter_ = op.second;
+      } else if (op.first=="number_of_slices") {
+        ns = op.second;
+      }
+    }
+
+    // Consistency checks
+    casadi_assert(ns > 0, "Number of time slices must be strictly positive");
+    casadi_assert(tol_ >= 0, "Tolerance must be nonnegative");
+
+    // Number of time slices for each output interval and in total
+    slice_.reserve(1 + nt());
+    slice_.push_back(0);
+    if (ns == nt()) {
+      for (casadi_int k = 0; k < nt(); ++k) slice_.push_back(k + 1);
+    } else {
+      double h_target = (tout_.back() - t0_) / ns;
+      double t_cur = t0_;
+      for (double t_next : tout_) {
+        slice_.push_back(slice_.back() + std::max(casadi_int(1),
+          static_cast<casadi_int>(std::ceil((t_next - t_cur) / h_target))));
+        t_cur = t_next;
+      }
+    }
+    if (max_iter_ < 0) max_iter_ = this->ns();
+    casadi_assert(max_iter_ >= 1, "At least one Parareal iteration is needed");
+
+    // A single step per slice for the coarse integrator, unless specified
+    if (!coarse_opts_given && (coarse == "rk" || coarse == "collocation")) {
+      coarse_opts["number_of_finite_elements"] = 1;
+    }
+
+    // DAE, including any forward sensitivity equations, in the time of a slice
+    Function dae = augmented_dae();
+    Function sdae = dae.is_a("SXFunction") ? slice_dae<SX>(dae) : slice_dae<MX>(dae);
+
+    // Fine integrator over all slices, coarse integrator over one slice
+    Function F = integrator(name_ + "_fine", fine, sdae, 0., 1., fine_opts);
+    set_function(F.map(this->ns(), parallelization), "fine");
+    set_function(integrator(name_ + "_coarse", coarse, sdae, 0., 1., coarse_opts), "coarse");
+
+    // Work vectors
+    alloc_w((this->ns() + 1) * nx_, true); // xs
+    alloc_w(this->ns() * nz_, true); // zs
+    alloc_w(this->ns() * (np_ + 2), true); // ps
+    alloc_w(this->ns() * nu_, true); // us
+    alloc_w(this->ns() * nx_, true); // fx
+    alloc_w(this->ns() * nz_, true); // fz
+    alloc_w(this->ns() * nq_, true); // fq
+    alloc_w(this->ns() * nx_, true); // gx
+  }
+
+  void Parareal::set_work(void* mem, const double**& arg, double**& res,
+      casadi_int*& iw, double*& w) const {
+    auto m = static_cast<PararealMemory*>(mem);
+
+    // Set work in base classes
+    Integrator::set_work(mem, arg, res, iw, w);
+
+    // Work vectors, allocated in base class
+    m->x = w; w += nx_;
+    m->z = w; w += nz_;
+    m->x_prev = w; w += nx_;
+    m->rx = w; w += nrx_;
+    m->rz = w; w += nrz_;
+    m->rx_prev = w; w += nrx_;
+    m->rq = w; w += nrq_;
+
+    // Work vectors, time slices
+    m->xs = w; w += (ns() + 1) * nx_;
+    m->zs = w; w += ns() * nz_;
+    m->ps = w; w += ns() * (np_ + 2);
+    m->us = w; w += ns() * nu_;
+    m->fx = w; w += ns() * nx_;
+    m->fz = w; w += ns() * nz_;
+    m->fq = w; w += ns() * nq_;
+    m->gx = w; w += ns() * nx_;
+  }
+
+  int Parareal::init_mem(void* mem) const {
+    if (Integrator::init_mem(mem)) return 1;
+    auto m = static_cast<PararealMemory*>(mem);
+    m->iter = 0;
+    m->du = 0;
+    m->success = false;
+    return 0;
+  }
+
+  int Parareal::coarse(PararealMemory* m, casadi_int k, double* xf) const {
+    std::fill_n(m->arg, INTEGRATOR_NUM_IN, nullptr);
+    m->arg[INTEGRATOR_X0] = m->xs + k * nx_;
+    m->arg[INTEGRATOR_Z0] = m->zs + k * nz_;
+    m->arg[INTEGRATOR_P] = m->ps + k * (np_ + 2);
+    m->arg[INTEGRATOR_U] = m->us + k * nu_;
+    std::fill_n(m->res, INTEGRATOR_NUM_OUT, nullptr);
+    m->res[INTEGRATOR_XF] = xf;
+    return calc_function(m, "coarse");
+  }
+
+  int Parareal::fine(PararealMemory* m) const {
+    std::fill_n(m->arg, INTEGRATOR_NUM_IN, nullptr);
+    m->arg[INTEGRATOR_X0] = m->xs;
+    m->arg[INTEGRATOR_Z0] = m->zs;
+    m->arg[INTEGRATOR_P] = m->ps;
+    m->arg[INTEGRATOR_U] = m->us;
+    std::fill_n(m->res, INTEGRATOR_NUM_OUT, nullptr);
+    m->res[INTEGRATOR_XF] = m->fx;
+    m->res[INTEGRATOR_ZF] = m->fz;
+    m->res[INTEGRATOR_QF] = m->fq;
+    return calc_function(m, "fine");
+  }
+
+  int Parareal::eval(const double** arg, double** res,
+      casadi_int* iw, double* w, void* mem) const {
+    auto m = static_cast<PararealMemory*>(mem);
+
+    // Read inputs
+    const double* x0 = arg[INTEGRATOR_X0];
+    const double* z0 = arg[INTEGRATOR_Z0];
+    const double* p = arg[INTEGRATOR_P];
+    const double* u = arg[INTEGRATOR_U];
+    arg += INTEGRATOR_NUM_IN;
+
+    // Read outputs
+    double* x = res[INTEGRATOR_XF];
+    double* z = res[INTEGRATOR_ZF];
+    double* q = res[INTEGRATOR_QF];
+    res += INTEGRATOR_NUM_OUT;
+
+    // Setup memory object
+    setup(m, arg, res, iw, w);
+
+    // Parameters, start time, length and controls of each slice
+    double t = t0_;
+    for (casadi_int i = 0; i < nt(); ++i) {
+      double h = (tout_[i] - t) / (slice_[i + 1] - slice_[i]);
+      for (casadi_int k = slice_[i]; k < slice_[i + 1]; ++k) {
+        double* ps = m->ps + k * (np_ + 2);
+        casadi_copy(p, np_, ps);
+        ps[np_] = t + (k - slice_[i]) * h;
+        ps[np_ + 1] = h;
+        casadi_copy(u ? u + i * nu_ : nullptr, nu_, m->us + k * nu_);
+      }
+      t = tout_[i];
+    }
+
+    // Initial state, guess for the algebraic variables
+    casadi_copy(x0, nx_, m->xs);
+    for (casadi_int k = 0; k < ns(); ++k) casadi_copy(z0, nz_, m->zs + k * nz_);
+
+    // Initial approximation from a coarse integration
+    for (casadi_int k = 0; k < ns(); ++k) {
+      if (coarse(m, k, m->gx + k * nx_)) return 1;
+      casadi_copy(m->gx + k * nx_, nx_, m->xs + (k + 1) * nx_);
+    }
+
+    // Parareal iterations
+    m->success = false;
+    for (m->iter = 0; m->iter < std::min(max_iter_, ns()); ) {
+      // Fine integration of all slices, in parallel
+      if (fine(m)) return 1;
+      m->iter++;
+      // Sequential correction using the coarse integrator
+      m->du = 0;
+      bool changed = false;
+      for (casadi_int k = 0; k < ns(); ++k) {
+        double* gx = m->gx + k * nx_;
+        double* xk = m->xs + (k + 1) * nx_;
+        if (changed) {
+          // Coarse solution from the updated start of the slice
+          if (coarse(m, k, m->x)) return 1;
+          // Correction: new coarse solution plus the defect of the previous iteration
+          casadi_copy(m->x, nx_, m->x_prev);
+          casadi_axpy(nx_, 1., m->fx + k * nx_, m->x_prev);
+          casadi_axpy(nx_, -1., gx, m->x_prev);
+          casadi_copy(m->x, nx_, gx);
+        } else {
+          // Unchanged start of the slice: the coarse terms cancel
+          casadi_copy(m->fx + k * nx_, nx_, m->x_prev);
+        }
+        // Largest change of the state at the end of the slice
+        double du = 0;
+        for (casadi_int i = 0; i < nx_; ++i) du = std::max(du, std::fabs(m->x_prev[i] - xk[i]));
+        casadi_copy(m->x_prev, nx_, xk);
+        m->du = std::max(m->du, du);
+        changed = du > 0;
+      }
+      // Algebraic variables at the end of a slice are the guess for the next
+      casadi_copy(m->fz, (ns() - 1) * nz_, m->zs + nz_);
+      if (verbose_) casadi_message("Parareal iteration " + str(m->iter)
+        + ": largest correction " + str(m->du));
+      if (m->du <= tol_) break;
+    }
+
+    // After as many iterations as slices, the fine solution is exact
+    m->success = m->du <= tol_ || m->iter == ns();
+    if (!m->success) {
+      casadi_warning("Parareal stopped after " + str(m->iter) + " iterations without "
+        "convergence: largest correction " + str(m->du) + " exceeds tolerance " + str(tol_));
+    }
+
+    // Return to user, at the end of the last slice of each output interval
+    for (casadi_int i = 0; i < nt(); ++i) {
+      casadi_int k = slice_[i + 1] - 1;
+      casadi_copy(m->xs + (k + 1) * nx_, nx_, x ? x + i * nx_ : nullptr);
+      casadi_copy(m->fz + k * nz_, nz_, z ? z + i * nz_ : nullptr);
+    }
+    if (q) {
+      // Quadratures are accumulated over the slices
+      casadi_clear(q, nt() * nq_);
+      for (casadi_int i = 0; i < nt(); ++i) {
+        if (i > 0) casadi_copy(q + (i - 1) * nq_, nq_, q + i * nq_);
+        for (casadi_int k = slice_[i]; k < slice_[i + 1]; ++k) {
+          casadi_axpy(nq_, 1., m->fq + k * nq_, q + i * nq_);
+        }
+      }
+    }
+
+    // Collect oracle statistics
+    join_results(m);
+
+    // Print integrator statistics
+    if (print_stats_) print_stats(m);
+
+    return 0;
+  }
+
+  void Parareal::reset(IntegratorMemory* mem,
+      const double* x, const double* z, const double* p) const {
+    casadi_error("Parareal integrates all time slices at once");
+  }
+
+  void Parareal::advance(IntegratorMemory* mem,
+      const double* u, double* x, double* z, double* q) const {
+    casadi_error("Parareal integrates all time slices at once");
+  }
+
+  void Parareal::resetB(IntegratorMemory* mem) const {
+    casadi_error("Parareal does not support adjoint sensitivities");
+  }
+
+  void Parareal::impulseB(IntegratorMemory* mem,
+      const double* rx, const double* rz, const double* rp) const {
+    casadi_error("Parareal does not support adjoint sensitivities");
+  }
+
+  void Parareal::retreat(IntegratorMemory* mem, const double* u,
+      double* rx, double* rq, double* uq) const {
+    casadi_error("Parareal does not support adjoint sensitivities");
+  }
+
+  void Parareal::print_stats(IntegratorMemory* mem) const {
+    auto m = static_cast<PararealMemory*>(mem);
+    print("PARAREAL:\n");
+    print("Number of iterations: %lld\n", static_cast<long long>(m->iter));
+    print("Largest correction in the last iteration: %g\n", m->du);
+    print("Converged: %s\n", m->success ? "yes" : "no");
+  }
+
+  Dict Parareal::get_stats(void* mem) const {
+    Dict stats = Integrator::get_stats(mem);
+    auto m = static_cast<PararealMemory*>(mem);
+    stats["iter"] = m->iter;
+    stats["du"] = m->du;
+    stats["success"] = m->success;
+    return stats;
+  }
+
+  Parareal::Parareal(DeserializingStream& s) : Integrator(s) {
+    s.version("Parareal", 1);
+    s.unpack("Parareal::tol", tol_);
+    s.unpack("Parareal::max_iter", max_iter_);
+    s.unpack("Parareal::slice", slice_);
+  }
+
+  void Parareal::serialize_body(SerializingStream &s) const {
+    Integrator::serialize_body(s);
+    s.version("Parareal", 1);
+    s.pack("Parareal::tol", tol_);
+    s.pack("Parareal::max_iter", max_iter_);
+    s.pack("Parareal::slice", slice_);
+  }
+
+} // namespace casadi
@@ -0,0 +1,201 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_PARAREAL_HPP
+#define CASADI_PARAREAL_HPP
+
+#include "casadi/core/integrator_impl.hpp"
+#include <casadi/solvers/casadi_integrator_parareal_export.h>
+
+/** \defgroup plugin_Integrator_parareal Title
+    \par
+
+      Parallel-in-time integration using the Parareal algorithm. The output
+      intervals are divided into time slices, by default one slice per
+      interval. A fine integrator is run on all slices
+      in parallel, starting from the current approximation of the state at
+      the beginning of each slice. These approximations are then corrected
+      sequentially using a cheap coarse integrator. The iterations stop when
+      the largest correction is below a tolerance, or after as many
+      iterations as there are slices, at which point the result equals that
+      of a sequential fine integration. If a smaller maximum number of
+      iterations is reached without convergence, a warning is issued and the
+      "success" statistic is false.
+
+      Fine and coarse propagators are existing integrator plugins, applied to
+      the DAE transformed to the normalized time of a slice. Forward
+      sensitivities are obtained by Parareal on the sensitivity equations.
+      Reverse mode derivatives are calculated using forward mode.
+
+    \identifier{280} */
+/** \pluginsection{Integrator,parareal} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  struct CASADI_INTEGRATOR_PARAREAL_EXPORT PararealMemory : public IntegratorMemory {
+    // Work vectors, allocated in base class
+    double *x, *z, *x_prev, *rx, *rz, *rx_prev, *rq;
+
+    /// State at the start of each slice and guess for the algebraic variables
+    double *xs, *zs;
+
+    /// Parameters, start time and length of each slice
+    double *ps;
+
+    /// Controls for each slice
+    double *us;
+
+    /// Fine solution for each slice
+    double *fx, *fz, *fq;
+
+    /// Coarse solution for each slice
+    double *gx;
+
+    /// Number of iterations, largest correction in the last iteration
+    casadi_int iter;
+    double du;
+
+    /// Converged or integrated exactly
+    bool success;
+  };
+
+  /** \brief \pluginbrief{Integrator,parareal}
+
+      @copydoc plugin_Integrator_parareal
+  */
+  class CASADI_INTEGRATOR_PARAREAL_EXPORT Parareal : public Integrator {
+   public:
+
+    /// Constructor
+    Parareal(const std::string& name, const Function& dae, double t0,
+      const std::vector<double>& tout);
+
+    /** \brief  Create a new integrator */
+    static Integrator* creator(const std::string& name, const Function& dae,
+        double t0, const std::vector<double>& tout) {
+      return new Parareal(name, dae, t0, tout);
+    }
+
+    /// Destructor
+    ~Parareal() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "parareal";}
+
+    // Get name of the class
+    std::string class_name() const override { return "Parareal";}
+
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /// Initialize stage
+    void init(const Dict& opts) override;
+
+    /** \brief Set the (persistent) work vectors */
+    void set_work(void* mem, const double**& arg, double**& res,
+      casadi_int*& iw, double*& w) const override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new PararealMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<PararealMemory*>(mem);}
+
+    /** \brief Evaluate all time slices
+
+        \identifier{281} */
+    int eval(const double** arg, double** res, casadi_int* iw, double* w,
+      void* mem) const override;
+
+    ///@{
+    /// The time slices are integrated at once, cf. eval
+    void reset(IntegratorMemory* mem,
+      const double* x, const double* z, const double* p) const override;
+    void advance(IntegratorMemory* mem,
+      const double* u, double* x, double* z, double* q) const override;
+    void resetB(IntegratorMemory* mem) const override;
+    void impulseB(IntegratorMemory* mem,
+      const double* rx, const double* rz, const double* rp) const override;
+    void retreat(IntegratorMemory* mem, const double* u,
+      double* rx, double* rq, double* uq) const override;
+    ///@}
+
+    /// Reverse mode derivatives are calculated using forward mode
+    bool has_reverse(casadi_int nadj) const override { return false;}
+
+    /// DAE in the normalized time of a slice, with slice start and length as parameters
+    template<typename MatType> static Function slice_dae(const Function& dae);
+
+    /// Run the coarse integrator over slice k
+    int coarse(PararealMemory* m, casadi_int k, double* xf) const;
+
+    /// Run the fine integrator over all slices
+    int fine(PararealMemory* m) const;
+
+    /// Total number of time slices
+    casadi_int ns() const { return slice_.back();}
+
+    /// Print solver statistics
+    void print_stats(IntegratorMemory* mem) const override;
+
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    ///@{
+    /// Options
+    double tol_;
+    casadi_int max_iter_;
+    ///@}
+
+    /// Offsets of the time slices of each output interval
+    std::vector<casadi_int> slice_;
+
+    /** \brief Serialize an object without type information */
+    void serialize_body(SerializingStream &s) const override;
+
+    /** \brief Deserialize into MX */
+    static ProtoFunction* deserialize(DeserializingStream& s) { return new Parareal(s); }
+
+   protected:
+
+    /** \brief Deserializing constructor */
+    explicit Parareal(DeserializingStream& s);
+  };
+
+} // namespace casadi
+
+/// \endcond
+#endif // CASADI_PARAREAL_HPP
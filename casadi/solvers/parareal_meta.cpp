@@ -0,0 +1,79 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+      #include "parareal.hpp"
+      #include <string>
+
+      const std::string casadi::Parareal::meta_doc=
+      "\n"
+"Parallel-in-time integration using the Parareal algorithm. The output\n"
+"intervals are the time slices. A fine integrator is run on all slices\n"
+"in parallel, starting from the current approximation of the state at\n"
+"the beginning of each slice. These approximations are then corrected\n"
+"sequentially using a cheap coarse integrator. The iterations stop when\n"
+"the largest correction is below a tolerance, or after as many\n"
+"iterations as there are slices, at which point the result equals that\n"
+"of a sequential fine integration.\n"
+"\n"
+"Fine and coarse propagators are existing integrator plugins, applied\n"
+"to the DAE transformed to the normalized time of a slice. Forward\n"
+"sensitivities are obtained by Parareal on the sensitivity equations.\n"
+"Reverse mode derivatives are calculated using forward mode.\n"
+"\n"
+"\n"
+">List of available options\n"
+"\n"
+"+-----------------+-----------+-------------------------------------------+\n"
+"|        Id       |    Type   |                Description                |\n"
+"+=================+===========+===========================================+\n"
+"| coarse          | OT_STRING | Integrator plugin for the coarse          |\n"
+"|                 |           | propagator [rk]                           |\n"
+"+-----------------+-----------+-------------------------------------------+\n"
+"| coarse_options  | OT_DICT   | Options to be passed to the coarse        |\n"
+"|                 |           | integrator [number_of_finite_elements: 1  |\n"
+"|                 |           | for fixed step integrators]               |\n"
+"+-----------------+-----------+-------------------------------------------+\n"
+"| fine            | OT_STRING | Integrator plugin for the fine propagator |\n"
+"|                 |           | [rk]                                      |\n"
+"+-----------------+-----------+-------------------------------------------+\n"
+"| fine_options    | OT_DICT   | Options to be passed to the fine          |\n"
+"|                 |           | integrator                                |\n"
+"+-----------------+-----------+-------------------------------------------+\n"
+"| max_iter        | OT_INT    | Maximum number of Parareal iterations     |\n"
+"|                 |           | [number of time slices]                   |\n"
+"+-----------------+-----------+-------------------------------------------+\n"
+"| parallelization | OT_STRING | Parallelization of the fine integration   |\n"
+"|                 |           | over the time slices, cf. Function::map   |\n"
+"|                 |           | [thread if CasADi was compiled with       |\n"
+"|                 |           | thread support, otherwise serial]         |\n"
+"+-----------------+-----------+-------------------------------------------+\n"
+"| tol             | OT_DOUBLE | Tolerance for the largest correction of   |\n"
+"|                 |           | the state at the start of a slice [1e-8]  |\n"
+"+-----------------+-----------+-------------------------------------------+\n"
+"\n"
+"\n"
+"\n"
+"\n"
+;
@@ -0,0 +1,268 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "riccati.hpp"
+
+namespace casadi {
+
+  extern "C"
+  int CASADI_CONIC_RICCATI_EXPORT
+  casadi_register_conic_riccati(Conic::Plugin* plugin) {
+    plugin->creator = Riccati::creator;
+    plugin->name = "riccati";
+    plugin->doc = Riccati::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Ipqp::options_;
+    plugin->deserialize = &Riccati::deserialize;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_CONIC_RICCATI_EXPORT casadi_load_conic_riccati() {
+    Conic::registerPlugin(casadi_register_conic_riccati);
+  }
+
+  Riccati::Riccati(const std::string& name, const std::map<std::string, Sparsity> &st)
+    : Ipqp(name, st) {
+  }
+
+  Riccati::~Riccati() {
+    clear_mem();
+  }
+
+  void Riccati::init(const Dict& opts) {
+    for (auto&& op : opts) {
+      casadi_assert(op.first!="linear_solver" && op.first!="linear_solver_options",
+        "Option '" + op.first + "' not available for 'riccati'");
+    }
+    Ipqp::init(opts);
+  }
+
+  void Riccati::init_kkt() {
+    // Detect stage structure
+    detect_blocks();
+    set_riccati_prob();
+    // Memory for block-tridiagonal factorization
+    casadi_int sz_iw, sz_w;
+    casadi_riccati_work(&r_, &sz_iw, &sz_w);
+    alloc_iw(sz_iw, true);
+    alloc_w(sz_w, true);
+    // Print summary
+    if (print_header_) {
+      casadi_int max_blk = 0;
+      for (casadi_int k = 0; k + 1 < blk_.size(); ++k) {
+        max_blk = std::max(max_blk, blk_[k + 1] - blk_[k]);
+      }
+      print("Number of stages:                %12d\n", r_.nblk);
+      print("Largest stage dimension:         %12d\n", max_blk);
+    }
+  }
+
+  void Riccati::detect_blocks() {
+    // Left-most variable coupled to each variable, either via H or via a constraint
+    // for which it is the right-most variable
+    std::vector<casadi_int> lmost = range(nx_);
+    const casadi_int *h_colind = H_.colind(), *h_row = H_.row();
+    for (casadi_int c = 0; c < nx_; ++c) {
+      for (casadi_int k = h_colind[c]; k < h_colind[c + 1]; ++k) {
+        casadi_int r = h_row[k];
+        if (r < c) {
+          lmost[c] = std::min(lmost[c], r);
+        } else {
+          lmost[r] = std::min(lmost[r], c);
+        }
+      }
+    }
+    // Left-most and right-most variable in each constraint
+    std::vector<casadi_int> a_first(na_, nx_), a_last(na_, -1);
+    const casadi_int *a_colind = A_.colind(), *a_row = A_.row();
+    for (casadi_int c = 0; c < nx_; ++c) {
+      for (casadi_int k = a_colind[c]; k < a_colind[c + 1]; ++k) {
+        casadi_int r = a_row[k];
+        a_first[r] = std::min(a_first[r], c);
+        a_last[r] = std::max(a_last[r], c);
+      }
+    }
+    for (casadi_int i = 0; i < na_; ++i) {
+      if (a_last[i] >= 0) lmost[a_last[i]] = std::min(lmost[a_last[i]], a_first[i]);
+    }
+    // Number of constraints whose right-most variable is a given variable
+    std::vector<casadi_int> ncon(nx_, 0);
+    for (casadi_int i = 0; i < na_; ++i) {
+      if (a_last[i] >= 0) ncon[a_last[i]]++;
+    }
+    // reach[t]: smallest block end such that all variables coupled to a variable
+    // before t are contained
+    std::vector<casadi_int> rmost(nx_, -1), reach(nx_ + 1, 0);
+    for (casadi_int j = 0; j < nx_; ++j) rmost[lmost[j]] = std::max(rmost[lmost[j]], j);
+    for (casadi_int t = 1; t <= nx_; ++t) reach[t] = std::max(reach[t - 1], rmost[t - 1] + 1);
+    // Choose the partition that minimizes the cost of the dense factorizations
+    std::vector<casadi_int> vblk = {0, nx_};
+    if (nx_ > 0) {
+      double best = inf;
+      for (casadi_int s1 = 1; s1 <= reach[1]; ++s1) {
+        // Finest block-tridiagonal partition, given the end of the first block
+        std::vector<casadi_int> s = {0};
+        while (s.back() < nx_) {
+          casadi_int next = s.size() == 1 ? s1 : std::max(s.back() + 1, reach[s.back()]);
+          s.push_back(std::min(next, nx_));
+        }
+        double cost = 0;
+        for (casadi_int k = 0; k + 1 < s.size(); ++k) {
+          casadi_int n = s[k + 1] - s[k];
+          for (casadi_int j = s[k]; j < s[k + 1]; ++j) n += ncon[j];
+          cost += static_cast<double>(n) * n * n;
+        }
+        if (cost < best) {
+          best = cost;
+          vblk = s;
+        }
+      }
+    }
+    casadi_int nblk = vblk.size() - 1;
+    // Block of each constraint, unused constraints go to the first block
+    std::vector<casadi_int> vb(nx_);
+    for (casadi_int k = 0; k < nblk; ++k) {
+      for (casadi_int j = vblk[k]; j < vblk[k + 1]; ++j) vb[j] = k;
+    }
+    std::vector<std::vector<casadi_int>> cons(nblk);
+    for (casadi_int i = 0; i < na_; ++i) {
+      cons[a_last[i] >= 0 ? vb[a_last[i]] : 0].push_back(i);
+    }
+    // Permutation: variables of each block followed by its constraints
+    iperm_.resize(nx_ + na_);
+    iblk_.resize(nx_ + na_);
+    blk_.resize(nblk + 1);
+    casadi_int pos = 0;
+    for (casadi_int k = 0; k < nblk; ++k) {
+      blk_[k] = pos;
+      for (casadi_int j = vblk[k]; j < vblk[k + 1]; ++j) {
+        iperm_[j] = pos++;
+        iblk_[j] = k;
+      }
+      for (casadi_int i : cons[k]) {
+        iperm_[nx_ + i] = pos++;
+        iblk_[nx_ + i] = k;
+      }
+    }
+    blk_[nblk] = pos;
+    // Make sure that the KKT system is block-tridiagonal
+    const casadi_int *kkt_colind = kkt_.colind(), *kkt_row = kkt_.row();
+    for (casadi_int c = 0; c < kkt_.size2(); ++c) {
+      for (casadi_int k = kkt_colind[c]; k < kkt_colind[c + 1]; ++k) {
+        casadi_assert(std::abs(iblk_[kkt_row[k]] - iblk_[c]) <= 1,
+          "Failed to detect a block-tridiagonal structure of the KKT system.");
+      }
+    }
+    // Offsets of the dense blocks
+    s_off_.resize(nblk + 1);
+    c_off_.resize(nblk);
+    s_off_[0] = c_off_[0] = 0;
+    for (casadi_int k = 0; k < nblk; ++k) {
+      casadi_int n0 = blk_[k + 1] - blk_[k];
+      s_off_[k + 1] = s_off_[k] + n0 * n0;
+      if (k + 1 < nblk) c_off_[k + 1] = c_off_[k] + n0 * (blk_[k + 2] - blk_[k + 1]);
+    }
+  }
+
+  void Riccati::set_riccati_prob() {
+    r_.sp = kkt_;
+    r_.nblk = blk_.size() - 1;
+    r_.blk = get_ptr(blk_);
+    r_.iperm = get_ptr(iperm_);
+    r_.iblk = get_ptr(iblk_);
+    r_.s_off = get_ptr(s_off_);
+    r_.c_off = get_ptr(c_off_);
+    r_.sz_x = 0;
+    for (casadi_int k = 0; k < r_.nblk; ++k) {
+      casadi_int n0 = blk_[k + 1] - blk_[k];
+      r_.sz_x = std::max(r_.sz_x, n0);
+      if (k + 1 < r_.nblk) r_.sz_x = std::max(r_.sz_x, n0 * (blk_[k + 2] - blk_[k + 1]));
+    }
+  }
+
+  void Riccati::kkt_setup(IpqpMemory* m, casadi_int*& iw, double*& w) const {
+    auto mm = static_cast<RiccatiMemory*>(m);
+    mm->r.prob = &r_;
+    casadi_riccati_init(&mm->r, &iw, &w);
+  }
+
+  int Riccati::kkt_factor(IpqpMemory* m, const double* nz_kkt) const {
+    auto mm = static_cast<RiccatiMemory*>(m);
+    return casadi_riccati_factor(&mm->r, nz_kkt);
+  }
+
+  int Riccati::kkt_solve(IpqpMemory* m, const double* nz_kkt, double* x) const {
+    auto mm = static_cast<RiccatiMemory*>(m);
+    casadi_riccati_solve(&mm->r, x, 1);
+    return 0;
+  }
+
+  void Riccati::codegen_kkt_setup(CodeGenerator& g) const {
+    g.add_auxiliary(CodeGenerator::AUX_RICCATI);
+    g.local("r", "struct casadi_riccati_data");
+    g.local("pr", "struct casadi_riccati_prob");
+    g << "pr.sp = " << g.sparsity(kkt_) << ";\n";
+    g << "pr.nblk = " << r_.nblk << ";\n";
+    g << "pr.blk = " << g.constant(blk_) << ";\n";
+    g << "pr.iperm = " << g.constant(iperm_) << ";\n";
+    g << "pr.iblk = " << g.constant(iblk_) << ";\n";
+    g << "pr.s_off = " << g.constant(s_off_) << ";\n";
+    g << "pr.c_off = " << g.constant(c_off_) << ";\n";
+    g << "pr.sz_x = " << r_.sz_x << ";\n";
+    g << "r.prob = &pr;\n";
+    g << "casadi_riccati_init(&r, &iw, &w);\n";
+  }
+
+  void Riccati::codegen_kkt_factor(CodeGenerator& g) const {
+    g << "if (casadi_riccati_factor(&r, nz_kkt)) d.status = IPQP_FACTOR_ERROR;\n";
+  }
+
+  void Riccati::codegen_kkt_solve(CodeGenerator& g) const {
+    g << "casadi_riccati_solve(&r, d.linsys, 1);\n";
+  }
+
+  Riccati::Riccati(DeserializingStream& s) : Ipqp(s) {
+    s.version("Riccati", 1);
+    s.unpack("Riccati::blk", blk_);
+    s.unpack("Riccati::iperm", iperm_);
+    s.unpack("Riccati::iblk", iblk_);
+    s.unpack("Riccati::s_off", s_off_);
+    s.unpack("Riccati::c_off", c_off_);
+    set_riccati_prob();
+  }
+
+  void Riccati::serialize_body(SerializingStream &s) const {
+    Ipqp::serialize_body(s);
+
+    s.version("Riccati", 1);
+    s.pack("Riccati::blk", blk_);
+    s.pack("Riccati::iperm", iperm_);
+    s.pack("Riccati::iblk", iblk_);
+    s.pack("Riccati::s_off", s_off_);
+    s.pack("Riccati::c_off", c_off_);
+  }
+
+} // namespace casadi
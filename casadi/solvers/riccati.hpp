@@ -0,0 +1,131 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_RICCATI_HPP
+#define CASADI_RICCATI_HPP
+
+#include "ipqp.hpp"
+#include <casadi/solvers/casadi_conic_riccati_export.h>
+
+/** \defgroup plugin_Conic_riccati Title
+    \par
+
+ Solves QPs with stagewise (optimal control) structure using a Mehrotra
+ predictor-corrector interior point method. The KKT systems are solved with a
+ block Riccati recursion, at a cost that is linear in the number of stages.
+
+ The stage structure is detected from the sparsity patterns of H and A:
+ the variables are partitioned into consecutive blocks such that the KKT matrix
+ becomes block-tridiagonal, with each constraint assigned to the block of its
+ right-most variable. For a multiple-shooting discretization ordered as
+ [x0, u0, x1, u1, ..., xN] this recovers the stages of the OCP.
+
+ The interior point iterations and the options are those of ipqp, except
+ for 'linear_solver' and 'linear_solver_options'.
+
+    \identifier{27q} */
+
+/** \pluginsection{Conic,riccati} */
+
+/// \cond INTERNAL
+namespace casadi {
+  struct CASADI_CONIC_RICCATI_EXPORT RiccatiMemory : public IpqpMemory {
+    // Block-tridiagonal KKT solver
+    casadi_riccati_data<double> r;
+  };
+
+  /** \brief \pluginbrief{Conic,riccati}
+
+      @copydoc Conic_doc
+      @copydoc plugin_Conic_riccati
+  */
+  class CASADI_CONIC_RICCATI_EXPORT Riccati : public Ipqp {
+  public:
+    /** \brief  Create a new Solver */
+    explicit Riccati(const std::string& name,
+                     const std::map<std::string, Sparsity> &st);
+
+    /** \brief  Create a new QP Solver */
+    static Conic* creator(const std::string& name,
+                          const std::map<std::string, Sparsity>& st) {
+      return new Riccati(name, st);
+    }
+
+    /** \brief  Destructor */
+    ~Riccati() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "riccati";}
+
+    // Get name of the class
+    std::string class_name() const override { return "Riccati";}
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new RiccatiMemory();}
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<RiccatiMemory*>(mem);}
+
+    /** \brief Initialize */
+    void init(const Dict& opts) override;
+
+    ///@{
+    /// Block-tridiagonal KKT solver
+    void init_kkt() override;
+    void kkt_setup(IpqpMemory* m, casadi_int*& iw, double*& w) const override;
+    int kkt_factor(IpqpMemory* m, const double* nz_kkt) const override;
+    int kkt_solve(IpqpMemory* m, const double* nz_kkt, double* x) const override;
+    void codegen_kkt_setup(CodeGenerator& g) const override;
+    void codegen_kkt_factor(CodeGenerator& g) const override;
+    void codegen_kkt_solve(CodeGenerator& g) const override;
+    ///@}
+
+    /// A documentation string
+    static const std::string meta_doc;
+    // Memory structure, block-tridiagonal KKT solver
+    casadi_riccati_prob<double> r_;
+    // Block structure of the KKT system
+    std::vector<casadi_int> blk_, iperm_, iblk_, s_off_, c_off_;
+
+    void serialize_body(SerializingStream &s) const override;
+
+    /** \brief Deserialize with type disambiguation */
+    static ProtoFunction* deserialize(DeserializingStream& s) { return new Riccati(s); }
+
+  protected:
+     /** \brief Deserializing constructor */
+    explicit Riccati(DeserializingStream& s);
+
+  private:
+    // Detect stage structure
+    void detect_blocks();
+
+    // Set up the block-tridiagonal KKT solver
+    void set_riccati_prob();
+  };
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_RICCATI_HPP
@@ -0,0 +1,211 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "rosenbrock.hpp"
+
+namespace casadi {
+
+  extern "C"
+  int CASADI_INTEGRATOR_ROSENBROCK_EXPORT
+      casadi_register_integrator_rosenbrock(Integrator::Plugin* plugin) {
+    plugin->creator = Rosenbrock::creator;
+    plugin->name = "rosenbrock";
+    plugin->doc = Rosenbrock::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Rosenbrock::options_;
+    plugin->deserialize = &Rosenbrock::deserialize;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_INTEGRATOR_ROSENBROCK_EXPORT casadi_load_integrator_rosenbrock() {
+    Integrator::registerPlugin(casadi_register_integrator_rosenbrock);
+  }
+
+  Rosenbrock::Rosenbrock(const std::string& name, const Function& dae, double t0,
+      const std::vector<double>& tout)
+      : FixedStepIntegrator(name, dae, t0, tout) {
+  }
+
+  Rosenbrock::~Rosenbrock() {
+  }
+
+  const Options Rosenbrock::options_
+  = {{&FixedStepIntegrator::options_},
+     {{"linear_solver",
+       {OT_STRING,
+        "Linear solver for the iteration matrix [qr]"}},
+      {"linear_solver_options",
+       {OT_DICT,
+        "Options to be passed to the linear solver. "
+        "For qr, the last factorization is cached by default, so that it is reused by "
+        "both stages and by subsequent steps with the same iteration matrix"}},
+      {"jacobian_update",
+       {OT_INT,
+        "Number of consecutive steps using the same Jacobian [1]"}}
+     }
+  };
+
+  void Rosenbrock::init(const Dict& opts) {
+    // Default options
+    linear_solver_ = "qr";
+    jacobian_update_ = 1;
+
+    // Read options
+    for (auto&& op : opts) {
+      if (op.first=="linear_solver") {
+        linear_solver_ = op.second.to_string();
+      } else if (op.first=="linear_solver_options") {
+        linear_solver_options_ = op.second;
+      } else if (op.first=="jacobian_update") {
+        jacobian_update_ = op.second;
+      }
+    }
+
+    // Consistency check
+    casadi_assert(jacobian_update_ >= 1, "'jacobian_update' must be strictly positive");
+
+    // Reuse the factorization for identical iteration matrices
+    if (linear_solver_ == "qr" && linear_solver_options_.find("cache")
+        == linear_solver_options_.end()) {
+      linear_solver_options_["cache"] = 1;
+    }
+
+    // Call the base class init
+    FixedStepIntegrator::init(opts);
+
+    // Algebraic variables not supported
+    casadi_assert(nz_==0 && nrz_==0,
+      "Rosenbrock integrator does not support algebraic variables");
+  }
+
+  MX Rosenbrock::algebraic_state_init(const MX& x0, const MX& z0) const {
+    return MX(DM::nan(nv1_, 1));
+  }
+
+  void Rosenbrock::setup_step() {
+    // Continuous-time dynamics, forward problem
+    Function f = get_function("dae");
+
+    // Symbolic inputs
+    MX t0 = MX::sym("t0", f.sparsity_in(DYN_T));
+    MX h = MX::sym("h");
+    MX x0 = MX::sym("x0", f.sparsity_in(DYN_X));
+    MX p = MX::sym("p", f.sparsity_in(DYN_P));
+    MX u = MX::sym("u", f.sparsity_in(DYN_U));
+
+    // Arguments when calling f
+    std::vector<MX> f_arg(DYN_NUM_IN);
+    std::vector<MX> f_res;
+    f_arg[DYN_P] = p;
+    f_arg[DYN_U] = u;
+
+    // Right-hand side and its Jacobian at the start of the step
+    f_arg[DYN_T] = t0;
+    f_arg[DYN_X] = x0;
+    f_res = f(f_arg);
+    MX J = MX::jacobian(f_res[DYN_ODE], x0);
+
+    // Jacobian from a previous step and number of steps it has been used for
+    MX v0, vf;
+    if (jacobian_update_ > 1) {
+      casadi_int nnz_J = J.nnz();
+      v0 = MX::sym("v0", nnz_J + 1);
+      MX J_prev = MX(J.sparsity(), v0(Slice(0, nnz_J)));
+      MX n_prev = v0(nnz_J);
+      // Reevaluate when used long enough, or at the first step (NaN)
+      MX reuse = n_prev < jacobian_update_;
+      J = if_else(reuse, J_prev, J, true);
+      MX J_nz;
+      J.get_nz(J_nz, false, Slice());
+      vf = vertcat(J_nz, if_else(reuse, n_prev + 1, 1));
+    } else {
+      v0 = vf = MX(0, 1);
+    }
+
+    // Iteration matrix, factorized once for both stages
+    const double gamma = 1 + 1 / std::sqrt(2.);
+    MX W = MX::eye(nx1_) - gamma * h * J;
+    Linsol linsol("linsol", linear_solver_, W.sparsity(), linear_solver_options_);
+
+    // k1
+    MX k1 = linsol.solve(W, h * f_res[DYN_ODE]);
+    MX g1 = f_res[DYN_QUAD];
+
+    // k2
+    f_arg[DYN_T] = t0 + h;
+    f_arg[DYN_X] = x0 + k1;
+    f_res = f(f_arg);
+    MX k2 = linsol.solve(W, h * f_res[DYN_ODE] - 2 * k1);
+    MX g2 = f_res[DYN_QUAD];
+
+    // Take step
+    MX xf = x0 + 1.5 * k1 + 0.5 * k2;
+    MX qf = h / 2 * (g1 + g2);
+
+    // Define discrete time dynamics
+    f_arg.resize(STEP_NUM_IN);
+    f_arg[STEP_T] = t0;
+    f_arg[STEP_H] = h;
+    f_arg[STEP_X0] = x0;
+    f_arg[STEP_V0] = v0;
+    f_arg[STEP_P] = p;
+    f_arg[STEP_U] = u;
+    f_res.resize(STEP_NUM_OUT);
+    f_res[STEP_XF] = xf;
+    f_res[STEP_QF] = qf;
+    f_res[STEP_VF] = vf;
+    Function F("step", f_arg, f_res,
+      {"t", "h", "x0", "v0", "p", "u"}, {"xf", "vf", "qf"});
+    set_function(F, F.name(), true);
+    if (nfwd_ > 0) create_forward("step", nfwd_);
+
+    // Backward integration
+    if (nadj_ > 0) {
+      Function adj_F = F.reverse(nadj_);
+      set_function(adj_F, adj_F.name(), true);
+      if (nfwd_ > 0) {
+        create_forward(adj_F.name(), nfwd_);
+      }
+    }
+  }
+
+  Rosenbrock::Rosenbrock(DeserializingStream& s) : FixedStepIntegrator(s) {
+    s.version("Rosenbrock", 1);
+    s.unpack("Rosenbrock::linear_solver", linear_solver_);
+    s.unpack("Rosenbrock::linear_solver_options", linear_solver_options_);
+    s.unpack("Rosenbrock::jacobian_update", jacobian_update_);
+  }
+
+  void Rosenbrock::serialize_body(SerializingStream &s) const {
+    FixedStepIntegrator::serialize_body(s);
+    s.version("Rosenbrock", 1);
+    s.pack("Rosenbrock::linear_solver", linear_solver_);
+    s.pack("Rosenbrock::linear_solver_options", linear_solver_options_);
+    s.pack("Rosenbrock::jacobian_update", jacobian_update_);
+  }
+
+} // namespace casadi
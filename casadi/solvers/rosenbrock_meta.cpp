@@ -0,0 +1,64 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+      #include "rosenbrock.hpp"
+      #include <string>
+
+      const std::string casadi::Rosenbrock::meta_doc=
+      "\n"
+"Fixed-step linearly implicit integrator for stiff ODEs, using the two-\n"
+"stage, second order Rosenbrock-W method ROS2 of Verwer et al. Each\n"
+"step solves two linear systems with the same iteration matrix I -\n"
+"gamma*h*J, factorized once per step using a CasADi linear solver.\n"
+"Being a W-method, the order is retained for an approximate Jacobian,\n"
+"which allows the Jacobian to be reused over several steps.\n"
+"\n"
+"The step is a symbolic expression, so the integrator can be code\n"
+"generated with the 'simplify' option and a code generatable linear\n"
+"solver.\n"
+"\n"
+"\n"
+">List of available options\n"
+"\n"
+"+-----------------------+-----------+-------------------------------------------+\n"
+"|           Id          |    Type   |                Description                |\n"
+"+=======================+===========+===========================================+\n"
+"| jacobian_update       | OT_INT    | Number of consecutive steps using the     |\n"
+"|                       |           | same Jacobian [1]                         |\n"
+"+-----------------------+-----------+-------------------------------------------+\n"
+"| linear_solver         | OT_STRING | Linear solver for the iteration matrix    |\n"
+"|                       |           | [qr]                                      |\n"
+"+-----------------------+-----------+-------------------------------------------+\n"
+"| linear_solver_options | OT_DICT   | Options to be passed to the linear        |\n"
+"|                       |           | solver. For qr, the last factorization is |\n"
+"|                       |           | cached by default, so that it is reused   |\n"
+"|                       |           | by both stages and by subsequent steps    |\n"
+"|                       |           | with the same iteration matrix            |\n"
+"+-----------------------+-----------+-------------------------------------------+\n"
+"\n"
+"\n"
+"\n"
+"\n"
+;
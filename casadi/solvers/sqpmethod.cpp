@@ -73,7 +73,10 @@ const Options Sqpmethod::options_
       "Options to be passed to the QP solver"}},
     {"hessian_approximation",
       {OT_STRING,
-      "limited-memory|exact"}},
+      "limited-memory|lbfgs|exact. "
+      "limited-memory: BFGS on a dense Hessian, reset every lbfgs_memory iterations. "
+      "lbfgs: compact limited-memory BFGS from the last lbfgs_memory steps, passed to the "
+      "QP solver through 2*lbfgs_memory additional variables and constraints"}},
     {"max_iter",
       {OT_INT,
       "Maximum number of SQP iterations"}},
@@ -150,7 +153,22 @@ const Options Sqpmethod::options_
       "(default: false)."}},
     {"init_feasible",
       {OT_BOOL,
-      "Initialize the QP subproblems with a feasible initial value (default: false)."}}
+      "Initialize the QP subproblems with a feasible initial value (default: false)."}},
+    {"rti",
+      {OT_BOOL,
+      "Real-time iteration mode (default: false). Each call performs one full step "
+      "SQP iteration, split in two phases. The feedback phase embeds 'p' and the bounds "
+      "into the QP linearized in the previous call, to first order, and solves it. "
+      "The preparation phase then evaluates the derivatives at the new iterate for "
+      "the next call. The initial guess is only used in the first call, later calls "
+      "start from the iterate of the previous call. Requires an exact Hessian. "
+      "To keep the feedback latency to one QP solve, the phases can be called separately "
+      "with the functions get_function('rti_feedback') and get_function('rti_preparation') "
+      "of the solver, or the entry points <name>_rti_feedback and <name>_rti_preparation "
+      "of the generated code. The preparation phase then linearizes at the initial guess "
+      "and parameters of its call. The outputs f and g of a feedback phase are the "
+      "linearized values of the last preparation, not evaluated at the returned x, "
+      "unless 'calc_f' and 'calc_g' are set."}}
     }
 };
 
@@ -181,6 +199,7 @@ void Sqpmethod::init(const Dict& opts) {
   gamma_1_min_ = 1e-5;
   so_corr_ = false;
   init_feasible_ = false;
+  rti_ = false;
 
   std::string convexify_strategy = "none";
   double convexify_margin = 1e-7;
@@ -248,6 +267,8 @@ void Sqpmethod::init(const Dict& opts) {
       so_corr_ = op.second;
     } else if (op.first=="init_feasible") {
       init_feasible_ = op.second;
+    } else if (op.first=="rti") {
+      rti_ = op.second;
     }
   }
 
@@ -263,6 +284,11 @@ void Sqpmethod::init(const Dict& opts) {
 
   // Use exact Hessian?
   exact_hessian_ = hessian_approximation =="exact";
+  compact_lbfgs_ = hessian_approximation =="lbfgs";
+  if (compact_lbfgs_) {
+    casadi_assert(lbfgs_memory_ > 0, "'lbfgs_memory' must be positive");
+    casadi_assert(!elastic_mode_, "Elastic mode not implemented for 'lbfgs'");
+  }
 
   convexify_ = false;
 
@@ -292,13 +318,58 @@ void Sqpmethod::init(const Dict& opts) {
       opts["verbose"] = verbose_;
       Hsp_ = Convexify::setup(convexify_data_, Hsp_, opts);
     }
+  } else if (compact_lbfgs_) {
+    // Lifted QP: variables [dx; u], constraints [g; u - Q'*dx], cf. casadi_lbfgs_hess
+    casadi_int nk = 2*lbfgs_memory_;
+    std::vector<casadi_int> colind(1, 0), row;
+    for (casadi_int c=0; c<nx_; ++c) {
+      row.push_back(c);
+      for (casadi_int l=0; l<nk; ++l) row.push_back(nx_ + l);
+      colind.push_back(row.size());
+    }
+    for (casadi_int c=0; c<nk; ++c) {
+      for (casadi_int r=0; r<nx_+nk; ++r) row.push_back(r);
+      colind.push_back(row.size());
+    }
+    Hsp_ = Sparsity(nx_+nk, nx_+nk, colind, row);
+    const casadi_int *a_colind = Asp_.colind(), *a_row = Asp_.row();
+    colind.resize(1);
+    row.clear();
+    for (casadi_int c=0; c<nx_; ++c) {
+      for (casadi_int el=a_colind[c]; el<a_colind[c+1]; ++el) row.push_back(a_row[el]);
+      for (casadi_int l=0; l<nk; ++l) row.push_back(ng_ + l);
+      colind.push_back(row.size());
+    }
+    for (casadi_int c=0; c<nk; ++c) {
+      row.push_back(ng_ + c);
+      colind.push_back(row.size());
+    }
+    Asp_qp_ = Sparsity(ng_+nk, nx_+nk, colind, row);
   } else {
     Hsp_ = Sparsity::dense(nx_, nx_);
   }
 
+  // Derivatives w.r.t. the parameters for the real-time iterations
+  if (rti_) {
+    casadi_assert(exact_hessian_, "Option 'rti' requires an exact Hessian");
+    casadi_assert(!elastic_mode_ && !so_corr_,
+      "Option 'rti' not compatible with elastic mode or second order corrections");
+    if (np_>0) {
+      casadi_assert(oracle_.sparsity_in(NL_P).is_dense(),
+        "Option 'rti' requires a dense parameter vector");
+      Function f = create_function("nlp_rti_p", {"x", "p", "lam:f", "lam:g"},
+                                   {"jac:g:p", "hess:gamma:x:p"}, {{"gamma", {"f", "g"}}});
+      Jpsp_ = f.sparsity_out(0);
+      Hxpsp_ = f.sparsity_out(1);
+    } else {
+      Jpsp_ = Sparsity(ng_, 0);
+      Hxpsp_ = Sparsity(nx_, 0);
+    }
+  }
+
   casadi_assert(!qpsol_plugin.empty(), "'qpsol' option has not been set");
-  qpsol_ = conic("qpsol", qpsol_plugin, {{"h", Hsp_}, {"a", Asp_}},
-                  qpsol_options);
+  qpsol_ = conic("qpsol", qpsol_plugin,
+                  {{"h", Hsp_}, {"a", compact_lbfgs_ ? Asp_qp_ : Asp_}}, qpsol_options);
   alloc(qpsol_);
 
   if (elastic_mode_) {
@@ -324,7 +395,10 @@ void Sqpmethod::init(const Dict& opts) {
 
 
   // BFGS?
-  if (!exact_hessian_) {
+  if (compact_lbfgs_) {
+    casadi_int nk = 2*lbfgs_memory_;
+    alloc_w(std::max(3*nx_ + 2*nk, nk*nk + 3*nk)); // casadi_lbfgs_update, casadi_lbfgs_hess
+  } else if (!exact_hessian_) {
     alloc_w(2*nx_); // casadi_bfgs
   }
 
@@ -332,15 +406,26 @@ void Sqpmethod::init(const Dict& opts) {
   if (print_header_) {
     print("-------------------------------------------\n");
     print("This is casadi::Sqpmethod.\n");
-    if (exact_hessian_) {
+    if (rti_) {
+      print("Using real-time iterations with exact Hessian\n");
+    } else if (exact_hessian_) {
       print("Using exact Hessian\n");
+    } else if (compact_lbfgs_) {
+      print("Using compact limited memory BFGS Hessian approximation, memory %d\n",
+        lbfgs_memory_);
     } else {
       print("Using limited memory BFGS Hessian approximation\n");
     }
     print("Number of variables:                       %9d\n", nx_);
     print("Number of constraints:                     %9d\n", ng_);
     print("Number of nonzeros in constraint Jacobian: %9d\n", Asp_.nnz());
-    print("Number of nonzeros in Lagrangian Hessian:  %9d\n", Hsp_.nnz());
+    if (compact_lbfgs_) {
+      // Hsp_ is the Hessian of the lifted QP, not of the Lagrangian
+      print("Number of variables in lifted QP:          %9d\n", Hsp_.size1());
+      print("Number of nonzeros in lifted QP Hessian:   %9d\n", Hsp_.nnz());
+    } else {
+      print("Number of nonzeros in Lagrangian Hessian:  %9d\n", Hsp_.nnz());
+    }
     print("\n");
   }
 
@@ -362,6 +447,12 @@ void Sqpmethod::set_sqpmethod_prob() {
   p_.sp_a = Asp_;
   p_.merit_memsize = merit_memsize_;
   p_.max_iter_ls = max_iter_ls_;
+  p_.lbfgs_memory = compact_lbfgs_ ? lbfgs_memory_ : 0;
+  p_.rti = rti_;
+  if (rti_) {
+    p_.sp_jp = Jpsp_;
+    p_.sp_hxp = Hxpsp_;
+  }
   p_.nlp = &p_nlp_;
 }
 
@@ -374,6 +465,7 @@ void Sqpmethod::set_work(void* mem, const double**& arg, double**& res,
 
   m->d.prob = &p_;
   casadi_sqpmethod_init(&m->d, &arg, &res, &iw, &w, elastic_mode_, so_corr_);
+  if (rti_) casadi_sqpmethod_rti_init(&m->d, get_ptr(m->rti));
 
   m->iter_count = -1;
 }
@@ -386,6 +478,12 @@ int Sqpmethod::init_mem(void* mem) const {
   m->add_stat("BFGS");
   m->add_stat("QP");
   m->add_stat("linesearch");
+  if (rti_) {
+    m->add_stat("rti_preparation");
+    m->add_stat("rti_feedback");
+    m->rti.resize(casadi_sqpmethod_rti_sz(&p_));
+  }
+  m->rti_phase = SQPMETHOD_RTI_BOTH;
   m->mem_qp = qpsol_->checkout();
   return 0;
 }
@@ -401,6 +499,8 @@ int Sqpmethod::solve(void* mem) const {
   auto d_nlp = &m->d_nlp;
   auto d = &m->d;
 
+  if (rti_) return solve_rti(m);
+
   // Number of SQP iterations
   m->iter_count = 0;
 
@@ -435,16 +535,37 @@ int Sqpmethod::solve(void* mem) const {
 
   casadi_clear(d->dx, nx_);
 
+  // Evaluate the exact Hessian concurrently with the first order derivatives?
+  bool overlap_hess = exact_hessian_ && max_num_threads_>1 && split_functions_.empty();
+  // Infeasibilities of the previous iterate
+  double pr_inf_prev = inf, du_inf_prev = inf;
+
   // MAIN OPTIMIZATION LOOP
   while (true) {
+    // The Hessian is not needed in the last iteration. Skip the concurrent evaluation when
+    // the iteration limit is reached or when the previous iterate was close enough to
+    // converge in one step, i.e. within the square root of the tolerances
+    bool hess_evaluated = overlap_hess && m->iter_count < max_iter_
+      && !(m->iter_count >= min_iter_ && pr_inf_prev < std::sqrt(tol_pr_)
+        && du_inf_prev < std::sqrt(tol_du_));
     // Evaluate f, g and first order derivative information
-    m->arg[0] = d_nlp->z;
-    m->arg[1] = d_nlp->p;
-    m->res[0] = &d_nlp->objective;
-    m->res[1] = d->gf;
-    m->res[2] = d_nlp->z + nx_;
-    m->res[3] = d->Jk;
-    switch (calc_function(m, "nlp_jac_fg")) {
+    int flag;
+    if (hess_evaluated) {
+      // Together with the exact Hessian, both at (z, lam)
+      flag = calc_functions(m, {
+        {"nlp_jac_fg", {d_nlp->z, d_nlp->p},
+          {&d_nlp->objective, d->gf, d_nlp->z + nx_, d->Jk}},
+        {"nlp_hess_l", {d_nlp->z, d_nlp->p, &one, d_nlp->lam + nx_}, {d->Bk}}});
+    } else {
+      m->arg[0] = d_nlp->z;
+      m->arg[1] = d_nlp->p;
+      m->res[0] = &d_nlp->objective;
+      m->res[1] = d->gf;
+      m->res[2] = d_nlp->z + nx_;
+      m->res[3] = d->Jk;
+      flag = calc_function(m, "nlp_jac_fg");
+    }
+    switch (flag) {
       case -1:
         m->return_status = "Non_Regular_Sensitivities";
         m->unified_return_status = SOLVER_RET_NAN;
@@ -511,17 +632,31 @@ int Sqpmethod::solve(void* mem) const {
     }
 
     if (exact_hessian_) {
-      // Update/reset exact Hessian
-      m->arg[0] = d_nlp->z;
-      m->arg[1] = d_nlp->p;
-      m->arg[2] = &one;
-      m->arg[3] = d_nlp->lam + nx_;
-      m->res[0] = d->Bk;
-      if (calc_function(m, "nlp_hess_l")) return 1;
+      // Update/reset exact Hessian, unless already evaluated concurrently
+      if (!hess_evaluated) {
+        m->arg[0] = d_nlp->z;
+        m->arg[1] = d_nlp->p;
+        m->arg[2] = &one;
+        m->arg[3] = d_nlp->lam + nx_;
+        m->res[0] = d->Bk;
+        if (calc_function(m, "nlp_hess_l")) return 1;
+      }
       if (convexify_) {
         ScopedTiming tic(m->fstats.at("convexify"));
         if (convexify_eval(&convexify_data_.config, d->Bk, d->Bk, m->iw, m->w)) return 1;
       }
+    } else if (compact_lbfgs_) {
+      ScopedTiming tic(m->fstats.at("BFGS"));
+      // Store the last step, rebuild the approximation from the memory
+      casadi_int ind = 0;
+      if (m->iter_count > 0) {
+        ind = (m->iter_count - 1) % lbfgs_memory_;
+        casadi_lbfgs_update(Hsp_, lbfgs_memory_, ind, d->Bk, d->lbfgs_q, d->lbfgs_s,
+          d->lbfgs_y, d->dx, d->gLag, d->gLag_old, m->w);
+      }
+      casadi_lbfgs_hess(nx_, lbfgs_memory_, std::min<casadi_int>(m->iter_count, lbfgs_memory_), ind,
+        d->lbfgs_s, d->lbfgs_y, d->lbfgs_q, d->Bk, m->w);
+      casadi_lbfgs_jac(Asp_, lbfgs_memory_, d->Jk, d->lbfgs_q, d->qp_a);
     } else if (m->iter_count==0) {
       ScopedTiming tic(m->fstats.at("BFGS"));
       // Initialize BFGS
@@ -555,6 +690,8 @@ int Sqpmethod::solve(void* mem) const {
 
     // Increase counter
     m->iter_count++;
+    pr_inf_prev = pr_inf;
+    du_inf_prev = du_inf;
 
     // Solve the QP
     int ret = solve_QP(m, d->Bk, d->gf, d->lbdz, d->ubdz, d->Jk, d->dx, d->dlam, 0);
@@ -586,7 +723,8 @@ int Sqpmethod::solve(void* mem) const {
     }
 
     // Detecting indefiniteness
-    double gain = casadi_bilin(d->Bk, Hsp_, d->dx, d->dx);
+    double gain = casadi_bilin(d->Bk, Hsp_, compact_lbfgs_ ? d->qp_x : d->dx,
+      compact_lbfgs_ ? d->qp_x : d->dx);
     if (gain < 0) {
       if (print_status_) print("WARNING(sqpmethod): Indefinite Hessian detected\n");
     }
@@ -809,6 +947,99 @@ int Sqpmethod::solve(void* mem) const {
   return 0;
 }
 
+int Sqpmethod::solve_rti(SqpmethodMemory* m) const {
+  auto d_nlp = &m->d_nlp;
+  auto d = &m->d;
+  m->iter_count = 0;
+
+  // Preparation only, at the initial guess
+  if (m->rti_phase == SQPMETHOD_RTI_PREPARATION) {
+    if (rti_preparation(m)) {
+      d->rti_prepared[0] = 0;
+      return 1;
+    }
+    m->success = true;
+    m->unified_return_status = SOLVER_RET_SUCCESS;
+    m->return_status = "RTI_Prepared";
+    return 0;
+  }
+
+  // First call: linearize at the initial guess
+  if (!d->rti_prepared[0] && rti_preparation(m)) return 1;
+
+  // Feedback phase
+  if (rti_feedback(m)) return 1;
+  m->iter_count = 1;
+  auto m_qpsol = static_cast<ConicMemory*>(qpsol_->memory(m->mem_qp));
+  m->success = m_qpsol->d_qp.success;
+  m->unified_return_status = m->success ? SOLVER_RET_SUCCESS : SOLVER_RET_UNKNOWN;
+  m->return_status = m->success ? "RTI_Step_Taken" : "QP_Failed";
+
+  // Preparation phase for the next call, also evaluates f and g at the new iterate
+  if (m->rti_phase == SQPMETHOD_RTI_BOTH && rti_preparation(m)) {
+    d->rti_prepared[0] = 0;
+    return 1;
+  }
+
+  if (print_iteration_) {
+    print_iteration();
+    print_iteration(m->iter_count, d_nlp->objective,
+                    casadi_max_viol(nx_+ng_, d_nlp->z, d_nlp->lbz, d_nlp->ubz), nan,
+                    casadi_norm_inf(nx_, d->dx), m->reg, 0, true, false, "RTI");
+  }
+  if (print_status_) {
+    print("MESSAGE(sqpmethod): Real-time iteration %s\n", m->return_status);
+  }
+  return 0;
+}
+
+int Sqpmethod::rti_preparation(SqpmethodMemory* m) const {
+  ScopedTiming tic(m->fstats.at("rti_preparation"));
+  auto d_nlp = &m->d_nlp;
+  auto d = &m->d;
+  const double one = 1.;
+
+  // Linearization point
+  casadi_sqpmethod_rti_save(d, d_nlp);
+
+  // Jacobian, Hessian and derivatives w.r.t. p, concurrently if possible
+  std::vector<OracleCall> calls = {
+    {"nlp_jac_fg", {d->rti_z, d->rti_p},
+      {&d_nlp->objective, d->rti_gf, d->rti_z + nx_, d->rti_jk}},
+    {"nlp_hess_l", {d->rti_z, d->rti_p, &one, d->rti_lam + nx_}, {d->rti_bk}}};
+  if (np_>0) {
+    calls.push_back({"nlp_rti_p", {d->rti_z, d->rti_p, &one, d->rti_lam + nx_},
+      {d->rti_jp, d->rti_hxp}});
+  }
+  if (calc_functions(m, calls)) return 1;
+  if (convexify_) {
+    ScopedTiming tic(m->fstats.at("convexify"));
+    if (convexify_eval(&convexify_data_.config, d->rti_bk, d->rti_bk, m->iw, m->w)) return 1;
+  }
+  d->rti_prepared[0] = 1;
+
+  // Constraints at the new iterate
+  casadi_copy(d->rti_z + nx_, ng_, d_nlp->z + nx_);
+  return 0;
+}
+
+int Sqpmethod::rti_feedback(SqpmethodMemory* m) const {
+  ScopedTiming tic(m->fstats.at("rti_feedback"));
+  auto d_nlp = &m->d_nlp;
+  auto d = &m->d;
+
+  // Embed the parameters and the bounds
+  casadi_sqpmethod_rti_feedback(d, d_nlp);
+
+  // Solve the QP
+  if (solve_QP(m, d->rti_bk, d->gf, d->lbdz, d->ubdz, d->rti_jk, d->dx, d->dlam, 0)) return 1;
+
+  // Full step
+  casadi_axpy(nx_, 1., d->dx, d_nlp->z);
+  casadi_copy(d->dlam, nx_ + ng_, d_nlp->lam);
+  return 0;
+}
+
 void Sqpmethod::print_iteration() const {
   print("%4s %14s %9s %9s %9s %7s %2s %7s\n", "iter", "objective", "inf_pr",
         "inf_du", "||d||", "lg(rg)", "ls", "info");
@@ -846,29 +1077,49 @@ int Sqpmethod::solve_QP(SqpmethodMemory* m, const double* H, const double* g,
     const double* lbdz, const double* ubdz, const double* A,
     double* x_opt, double* dlam, int mode) const {
   ScopedTiming tic(m->fstats.at("QP"));
+  // Number of QP variables, QP solution
+  casadi_int nx_qp = nx_;
+  double *x_qp = x_opt, *lam_qp = dlam;
+  if (compact_lbfgs_) {
+    // Lifted QP
+    auto d = &m->d;
+    nx_qp += 2*lbfgs_memory_;
+    casadi_lbfgs_qp_pack(nx_, ng_, lbfgs_memory_, d->lbfgs_q, g, lbdz, ubdz, x_opt, dlam,
+      d->qp_g, d->qp_lbz, d->qp_ubz, d->qp_x, d->qp_lam);
+    g = d->qp_g;
+    lbdz = d->qp_lbz;
+    ubdz = d->qp_ubz;
+    A = d->qp_a;
+    x_qp = d->qp_x;
+    lam_qp = d->qp_lam;
+  }
+
   // Inputs
   std::fill_n(m->arg, qpsol_.n_in(), nullptr);
   m->arg[CONIC_H] = H;
   m->arg[CONIC_G] = g;
-  m->arg[CONIC_X0] = x_opt;
-  m->arg[CONIC_LAM_X0] = dlam;
-  m->arg[CONIC_LAM_A0] = dlam + nx_;
+  m->arg[CONIC_X0] = x_qp;
+  m->arg[CONIC_LAM_X0] = lam_qp;
+  m->arg[CONIC_LAM_A0] = lam_qp + nx_qp;
   m->arg[CONIC_LBX] = lbdz;
   m->arg[CONIC_UBX] = ubdz;
   m->arg[CONIC_A] = A;
-  m->arg[CONIC_LBA] = lbdz+nx_;
-  m->arg[CONIC_UBA] = ubdz+nx_;
+  m->arg[CONIC_LBA] = lbdz+nx_qp;
+  m->arg[CONIC_UBA] = ubdz+nx_qp;
 
   // Outputs
   std::fill_n(m->res, qpsol_.n_out(), nullptr);
-  m->res[CONIC_X] = x_opt;
-  m->res[CONIC_LAM_X] = dlam;
-  m->res[CONIC_LAM_A] = dlam + nx_;
+  m->res[CONIC_X] = x_qp;
+  m->res[CONIC_LAM_X] = lam_qp;
+  m->res[CONIC_LAM_A] = lam_qp + nx_qp;
   double cost;
   m->res[CONIC_COST] = &cost;
 
   // Solve the QP
   qpsol_(m->arg, m->res, m->iw, m->w, m->mem_qp);
+  if (compact_lbfgs_) {
+    casadi_lbfgs_qp_unpack(nx_, ng_, lbfgs_memory_, x_qp, lam_qp, x_opt, dlam);
+  }
   auto m_qpsol = static_cast<ConicMemory*>(qpsol_->memory(m->mem_qp));
 
   // Check if the QP was infeasible for elastic mode
@@ -1024,14 +1275,28 @@ double Sqpmethod::calc_gamma_1(SqpmethodMemory* m) const {
 void Sqpmethod::codegen_declarations(CodeGenerator& g) const {
   Nlpsol::codegen_declarations(g);
 
-  if (max_iter_ls_ || so_corr_) g.add_dependency(get_function("nlp_fg"));
+  // Real-time iterations take full steps without a line-search
+  if ((max_iter_ls_ || so_corr_) && !rti_) g.add_dependency(get_function("nlp_fg"));
   g.add_dependency(get_function("nlp_jac_fg"));
   if (exact_hessian_) g.add_dependency(get_function("nlp_hess_l"));
   if (calc_f_ || calc_g_ || calc_lam_x_ || calc_lam_p_)
     g.add_dependency(get_function("nlp_grad"));
   g.add_dependency(qpsol_);
   if (elastic_mode_) g.add_dependency(qpsol_ela_);
-  if (!exact_hessian_) g.add_auxiliary(CodeGenerator::AUX_BFGS);
+  if (compact_lbfgs_) {
+    g.add_auxiliary(CodeGenerator::AUX_LBFGS);
+  } else if (!exact_hessian_) {
+    g.add_auxiliary(CodeGenerator::AUX_BFGS);
+  }
+  if (rti_) {
+    if (np_>0) g.add_dependency(get_function("nlp_rti_p"));
+    // Linearization from the preparation phase and phases of the next call, for each memory
+    std::string name = codegen_name(g, false);
+    g.auxiliaries << "static casadi_real " << g.shorthand(name + "_rti")
+      << "[CASADI_MAX_NUM_THREADS][" << casadi_sqpmethod_rti_sz(&p_) << "];\n";
+    g.auxiliaries << "static int " << g.shorthand(name + "_rti_phase")
+      << "[CASADI_MAX_NUM_THREADS];\n";
+  }
 }
 
 void Sqpmethod::codegen_body(CodeGenerator& g) const {
@@ -1048,9 +1313,20 @@ void Sqpmethod::codegen_body(CodeGenerator& g) const {
   g << "p.sp_a = " << g.sparsity(Asp_) << ";\n";
   g << "p.merit_memsize = " << merit_memsize_ << ";\n";
   g << "p.max_iter_ls = " << max_iter_ls_ << ";\n";
+  g << "p.lbfgs_memory = " << (compact_lbfgs_ ? lbfgs_memory_ : 0) << ";\n";
+  g << "p.rti = " << rti_ << ";\n";
+  if (rti_) {
+    g << "p.sp_jp = " << g.sparsity(Jpsp_) << ";\n";
+    g << "p.sp_hxp = " << g.sparsity(Hxpsp_) << ";\n";
+  }
   g << "p.nlp = &p_nlp;\n";
   g << "casadi_sqpmethod_init(d, &arg, &res, &iw, &w, "
     << elastic_mode_ << ", " << so_corr_ << ");\n";
+  if (rti_) {
+    codegen_rti(g);
+    codegen_body_exit(g);
+    return;
+  }
 
   if (elastic_mode_) {
     g.local("gamma_1", "double");
@@ -1127,6 +1403,20 @@ void Sqpmethod::codegen_body(CodeGenerator& g) const {
       std::string ret = g.convexify_eval(convexify_data_, "d->Bk", "d->Bk", "d->iw", "d->w");
       g << "if (" << ret << ") return 1;\n";
     }
+  } else if (compact_lbfgs_) {
+    g.local("lbfgs_ind", "casadi_int");
+    g << "lbfgs_ind = 0;\n";
+    g << "if (iter_count>0) {\n";
+    g.comment("Store the last step");
+    g << "lbfgs_ind = (iter_count-1) % " << lbfgs_memory_ << ";\n";
+    g << "casadi_lbfgs_update(p.sp_h, " << lbfgs_memory_ << ", lbfgs_ind, d->Bk, d->lbfgs_q, "
+      << "d->lbfgs_s, d->lbfgs_y, d->dx, d->gLag, d->gLag_old, d->w);\n";
+    g << "}\n";
+    g.comment("Rebuild the approximation from the memory");
+    g << "casadi_lbfgs_hess(" << nx_ << ", " << lbfgs_memory_ << ", "
+      << g.min("iter_count", str(lbfgs_memory_)) << ", lbfgs_ind, "
+      << "d->lbfgs_s, d->lbfgs_y, d->lbfgs_q, d->Bk, d->w);\n";
+    g << "casadi_lbfgs_jac(p.sp_a, " << lbfgs_memory_ << ", d->Jk, d->lbfgs_q, d->qp_a);\n";
   } else {
     g << "if (iter_count==0) {\n";
     g.comment("Initialize BFGS");
@@ -1408,26 +1698,193 @@ void Sqpmethod::codegen_body(CodeGenerator& g) const {
   g << "}\n";
   codegen_body_exit(g);
 }
+void Sqpmethod::codegen_rti(CodeGenerator& g) const {
+  std::string name = codegen_name(g, false);
+  std::string phase = g.shorthand(name + "_rti_phase") + "[mem]";
+  g.local("ret", "int");
+  g << "casadi_sqpmethod_rti_init(d, " << g.shorthand(name + "_rti") << "[mem]);\n";
+  g << "if (" << phase << "!=" << SQPMETHOD_RTI_PREPARATION << ") {\n";
+  g.comment("First call: linearize at the initial guess");
+  g << "if (!d->rti_prepared[0]) {\n";
+  codegen_rti_preparation(g);
+  g << "}\n";
+  g.comment("Feedback phase: embed the parameters and bounds, solve the QP");
+  g << "casadi_sqpmethod_rti_feedback(d, &d_nlp);\n";
+  codegen_qp_solve(g, "d->rti_bk", "d->gf", "d->lbdz", "d->ubdz", "d->rti_jk",
+    "d->dx", "d->dlam", 0);
+  g.comment("Full step");
+  g << g.axpy(nx_, "1.0", "d->dx", "d_nlp.z") << "\n";
+  g << g.copy("d->dlam", nx_ + ng_, "d_nlp.lam") << "\n";
+  g << "}\n";
+  g << "if (" << phase << "!=" << SQPMETHOD_RTI_FEEDBACK << ") {\n";
+  g.comment("Preparation phase for the next call");
+  codegen_rti_preparation(g);
+  g << "}\n";
+}
+
+void Sqpmethod::codegen_meta(CodeGenerator& g) const {
+  Nlpsol::codegen_meta(g);
+  if (!rti_) return;
+  // Entry points evaluating a single phase of a real-time iteration
+  std::string name = codegen_name(g, false);
+  std::string phase = g.shorthand(name + "_rti_phase") + "[mem]";
+  for (int p : {SQPMETHOD_RTI_FEEDBACK, SQPMETHOD_RTI_PREPARATION}) {
+    std::string fname = name_ + (p == SQPMETHOD_RTI_FEEDBACK ? "_rti_feedback"
+                                                             : "_rti_preparation");
+    g << g.declare(signature(fname)) << " {\n";
+    g << "int ret;\n";
+    g << phase << " = " << p << ";\n";
+    g << "ret = " << codegen_name(g) << "(arg, res, iw, w, mem);\n";
+    g << phase << " = " << SQPMETHOD_RTI_BOTH << ";\n";
+    g << "return ret;\n";
+    g << "}\n\n";
+  }
+  g.flush(g.body);
+}
+
+void Sqpmethod::finalize() {
+  Nlpsol::finalize();
+  if (rti_) {
+    rti_feedback_ = Function::create(new SqpmethodRti(name_ + "_rti_feedback", self(),
+      SQPMETHOD_RTI_FEEDBACK), Dict());
+    rti_preparation_ = Function::create(new SqpmethodRti(name_ + "_rti_preparation", self(),
+      SQPMETHOD_RTI_PREPARATION), Dict());
+  }
+}
+
+std::vector<std::string> Sqpmethod::get_function() const {
+  std::vector<std::string> ret = Nlpsol::get_function();
+  if (rti_) {
+    ret.push_back("rti_feedback");
+    ret.push_back("rti_preparation");
+  }
+  return ret;
+}
+
+const Function& Sqpmethod::get_function(const std::string &name) const {
+  if (rti_ && name=="rti_feedback") return rti_feedback_;
+  if (rti_ && name=="rti_preparation") return rti_preparation_;
+  return Nlpsol::get_function(name);
+}
+
+bool Sqpmethod::has_function(const std::string& fname) const {
+  if (rti_ && (fname=="rti_feedback" || fname=="rti_preparation")) return true;
+  return Nlpsol::has_function(fname);
+}
+
+SqpmethodRti::SqpmethodRti(const std::string& name, const Function& solver, int phase)
+  : FunctionInternal(name), solver_(solver), phase_(phase) {
+}
+
+SqpmethodRti::~SqpmethodRti() {
+  clear_mem();
+}
+
+Sparsity SqpmethodRti::get_sparsity_in(casadi_int i) {
+  return shared_cast<Function>(solver_.shared()).sparsity_in(i);
+}
+
+Sparsity SqpmethodRti::get_sparsity_out(casadi_int i) {
+  return shared_cast<Function>(solver_.shared()).sparsity_out(i);
+}
+
+void SqpmethodRti::init(const Dict& opts) {
+  // Call the initialization method of the base class
+  FunctionInternal::init(opts);
+
+  // Work vectors of the solver
+  alloc(shared_cast<Function>(solver_.shared()));
+}
+
+int SqpmethodRti::eval(const double** arg, double** res, casadi_int* iw, double* w,
+    void* mem) const {
+  casadi_assert(solver_.alive(), "The solver of '" + name_ + "' no longer exists");
+  Function solver = shared_cast<Function>(solver_.shared());
+  // Memory object of numerical calls of the solver, with the phase set
+  auto sm = static_cast<SqpmethodMemory*>(solver->memory(0));
+  sm->rti_phase = phase_;
+  int flag;
+  try {
+    flag = solver(arg, res, iw, w, 0);
+  } catch (...) {
+    sm->rti_phase = SQPMETHOD_RTI_BOTH;
+    throw;
+  }
+  sm->rti_phase = SQPMETHOD_RTI_BOTH;
+  return flag;
+}
+
+void Sqpmethod::codegen_rti_preparation(CodeGenerator& g) const {
+  g << "casadi_sqpmethod_rti_save(d, &d_nlp);\n";
+  g << "d->arg[0] = d->rti_z;\n";
+  g << "d->arg[1] = d->rti_p;\n";
+  g << "d->res[0] = &d_nlp.objective;\n";
+  g << "d->res[1] = d->rti_gf;\n";
+  g << "d->res[2] = d->rti_z+" + str(nx_) + ";\n";
+  g << "d->res[3] = d->rti_jk;\n";
+  std::string nlp_jac_fg = g(get_function("nlp_jac_fg"), "d->arg", "d->res", "d->iw", "d->w");
+  g << "if (" + nlp_jac_fg + ") return 1;\n";
+  g.local("one", "const casadi_real");
+  g.init_local("one", "1");
+  g << "d->arg[2] = &one;\n";
+  g << "d->arg[3] = d->rti_lam+" + str(nx_) + ";\n";
+  g << "d->res[0] = d->rti_bk;\n";
+  std::string nlp_hess_l = g(get_function("nlp_hess_l"), "d->arg", "d->res", "d->iw", "d->w");
+  g << "if (" + nlp_hess_l + ") return 1;\n";
+  if (convexify_) {
+    std::string ret = g.convexify_eval(convexify_data_, "d->rti_bk", "d->rti_bk", "d->iw", "d->w");
+    g << "if (" << ret << ") return 1;\n";
+  }
+  if (np_>0) {
+    g << "d->res[0] = d->rti_jp;\n";
+    g << "d->res[1] = d->rti_hxp;\n";
+    std::string nlp_rti_p = g(get_function("nlp_rti_p"), "d->arg", "d->res", "d->iw", "d->w");
+    g << "if (" + nlp_rti_p + ") return 1;\n";
+  }
+  g << "d->rti_prepared[0] = 1;\n";
+  g << g.copy("d->rti_z+" + str(nx_), ng_, "d_nlp.z+" + str(nx_)) << "\n";
+}
+
 void Sqpmethod::codegen_qp_solve(CodeGenerator& cg, const std::string&  H, const std::string& g,
     const std::string&  lbdz, const std::string& ubdz,
     const std::string&  A, const std::string& x_opt, const std::string&  dlam, int mode) const {
+  // Number of QP variables, QP data
+  casadi_int nx_qp = nx_;
+  std::string g_qp = g, lbz_qp = lbdz, ubz_qp = ubdz, a_qp = A, x_qp = x_opt, lam_qp = dlam;
+  if (compact_lbfgs_) {
+    cg.comment("Lifted QP");
+    nx_qp += 2*lbfgs_memory_;
+    cg << "casadi_lbfgs_qp_pack(" << nx_ << ", " << ng_ << ", " << lbfgs_memory_
+       << ", d->lbfgs_q, " << g << ", " << lbdz << ", " << ubdz << ", " << x_opt << ", "
+       << dlam << ", d->qp_g, d->qp_lbz, d->qp_ubz, d->qp_x, d->qp_lam);\n";
+    g_qp = "d->qp_g";
+    lbz_qp = "d->qp_lbz";
+    ubz_qp = "d->qp_ubz";
+    a_qp = "d->qp_a";
+    x_qp = "d->qp_x";
+    lam_qp = "d->qp_lam";
+  }
   for (casadi_int i=0;i<qpsol_.n_in();++i) cg << "d->arg[" << i << "] = 0;\n";
   cg << "d->arg[" << CONIC_H << "] = " << H << ";\n";
-  cg << "d->arg[" << CONIC_G << "] = " << g << ";\n";
-  cg << "d->arg[" << CONIC_X0 << "] = " << x_opt << ";\n";
-  cg << "d->arg[" << CONIC_LAM_X0 << "] = " << dlam << ";\n";
-  cg << "d->arg[" << CONIC_LAM_A0 << "] = " << dlam << "+" << nx_ << ";\n";
-  cg << "d->arg[" << CONIC_LBX << "] = " << lbdz << ";\n";
-  cg << "d->arg[" << CONIC_UBX << "] = " << ubdz << ";\n";
-  cg << "d->arg[" << CONIC_A << "] = " << A << ";\n";
-  cg << "d->arg[" << CONIC_LBA << "] = " << lbdz << "+" << nx_ << ";\n";
-  cg << "d->arg[" << CONIC_UBA << "] = " << ubdz << "+" << nx_ << ";\n";
+  cg << "d->arg[" << CONIC_G << "] = " << g_qp << ";\n";
+  cg << "d->arg[" << CONIC_X0 << "] = " << x_qp << ";\n";
+  cg << "d->arg[" << CONIC_LAM_X0 << "] = " << lam_qp << ";\n";
+  cg << "d->arg[" << CONIC_LAM_A0 << "] = " << lam_qp << "+" << nx_qp << ";\n";
+  cg << "d->arg[" << CONIC_LBX << "] = " << lbz_qp << ";\n";
+  cg << "d->arg[" << CONIC_UBX << "] = " << ubz_qp << ";\n";
+  cg << "d->arg[" << CONIC_A << "] = " << a_qp << ";\n";
+  cg << "d->arg[" << CONIC_LBA << "] = " << lbz_qp << "+" << nx_qp << ";\n";
+  cg << "d->arg[" << CONIC_UBA << "] = " << ubz_qp << "+" << nx_qp << ";\n";
   for (casadi_int i=0;i<qpsol_.n_out();++i) cg << "d->res[" << i << "] = 0;\n";
-  cg << "d->res[" << CONIC_X << "] = " << x_opt << ";\n";
-  cg << "d->res[" << CONIC_LAM_X << "] = " << dlam << ";\n";
-  cg << "d->res[" << CONIC_LAM_A << "] = " << dlam << "+" << nx_ << ";\n";
+  cg << "d->res[" << CONIC_X << "] = " << x_qp << ";\n";
+  cg << "d->res[" << CONIC_LAM_X << "] = " << lam_qp << ";\n";
+  cg << "d->res[" << CONIC_LAM_A << "] = " << lam_qp << "+" << nx_qp << ";\n";
   std::string flag = cg(qpsol_, "d->arg", "d->res", "d->iw", "d->w");
   cg << "ret = " << flag << ";\n";
+  if (compact_lbfgs_) {
+    cg << "casadi_lbfgs_qp_unpack(" << nx_ << ", " << ng_ << ", " << lbfgs_memory_
+       << ", d->qp_x, d->qp_lam, " << x_opt << ", " << dlam << ");\n";
+  }
   cg << "if (ret == -1000) return -1000;\n"; // equivalent to raise Exception
 }
 
@@ -1537,7 +1994,7 @@ Dict Sqpmethod::get_stats(void* mem) const {
 }
 
 Sqpmethod::Sqpmethod(DeserializingStream& s) : Nlpsol(s) {
-  int version = s.version("Sqpmethod", 1, 3);
+  int version = s.version("Sqpmethod", 1, 5);
   s.unpack("Sqpmethod::qpsol", qpsol_);
   if (version>=3) {
     s.unpack("Sqpmethod::qpsol_ela", qpsol_ela_);
@@ -1606,12 +2063,25 @@ Sqpmethod::Sqpmethod(DeserializingStream& s) : Nlpsol(s) {
     s.unpack("Sqpmethod::convexify", convexify_);
     if (convexify_) Convexify::deserialize(s, "Sqpmethod::", convexify_data_);
   }
+  if (version>=4) {
+    s.unpack("Sqpmethod::compact_lbfgs", compact_lbfgs_);
+    s.unpack("Sqpmethod::Asp_qp", Asp_qp_);
+  } else {
+    compact_lbfgs_ = false;
+  }
+  if (version>=5) {
+    s.unpack("Sqpmethod::rti", rti_);
+    s.unpack("Sqpmethod::Jpsp", Jpsp_);
+    s.unpack("Sqpmethod::Hxpsp", Hxpsp_);
+  } else {
+    rti_ = false;
+  }
   set_sqpmethod_prob();
 }
 
 void Sqpmethod::serialize_body(SerializingStream &s) const {
   Nlpsol::serialize_body(s);
-  s.version("Sqpmethod", 3);
+  s.version("Sqpmethod", 5);
   s.pack("Sqpmethod::qpsol", qpsol_);
   s.pack("Sqpmethod::qpsol_ela", qpsol_ela_);
   s.pack("Sqpmethod::exact_hessian", exact_hessian_);
@@ -1642,6 +2112,11 @@ void Sqpmethod::serialize_body(SerializingStream &s) const {
   s.pack("Sqpmethod::Asp", Asp_);
   s.pack("Sqpmethod::convexify", convexify_);
   if (convexify_) Convexify::serialize(s, "Sqpmethod::", convexify_data_);
+  s.pack("Sqpmethod::compact_lbfgs", compact_lbfgs_);
+  s.pack("Sqpmethod::Asp_qp", Asp_qp_);
+  s.pack("Sqpmethod::rti", rti_);
+  s.pack("Sqpmethod::Jpsp", Jpsp_);
+  s.pack("Sqpmethod::Hxpsp", Hxpsp_);
 }
 
 } // namespace casadi
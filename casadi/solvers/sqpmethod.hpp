@@ -41,6 +41,16 @@
 /// \cond INTERNAL
 namespace casadi {
 
+  /// Phases performed by a call in real-time iteration mode, cf. SqpmethodMemory::rti_phase
+  enum SqpmethodRtiPhase {
+    /// Feedback, then preparation for the next call
+    SQPMETHOD_RTI_BOTH,
+    /// Feedback only, using the linearization of the last preparation
+    SQPMETHOD_RTI_FEEDBACK,
+    /// Preparation only, linearizing at the initial guess and parameters
+    SQPMETHOD_RTI_PREPARATION
+  };
+
   struct CASADI_NLPSOL_SQPMETHOD_EXPORT SqpmethodMemory : public NlpsolMemory {
     // Problem data structure
     casadi_sqpmethod_data<double> d;
@@ -59,6 +69,12 @@ namespace casadi {
 
     /// Iteration count
     int iter_count;
+
+    /// Real-time iterations: linearization from the preparation phase
+    std::vector<double> rti;
+
+    /// Real-time iterations: phases performed by the next call, cf. SqpmethodRtiPhase
+    int rti_phase;
   };
 
   /** \brief  \pluginbrief{Nlpsol,sqpmethod}
@@ -121,6 +137,9 @@ namespace casadi {
     /// Exact Hessian?
     bool exact_hessian_;
 
+    /// Compact limited-memory BFGS, passed to the QP solver in lifted form?
+    bool compact_lbfgs_;
+
     /// Maximum block size of Hessian
     casadi_int block_size_ = 0;
 
@@ -162,6 +181,9 @@ namespace casadi {
     // Jacobian sparsity
     Sparsity Asp_;
 
+    // Constraint Jacobian sparsity of the lifted QP (compact L-BFGS)
+    Sparsity Asp_qp_;
+
     /// Data for convexification
     ConvexifyData convexify_data_;
 
@@ -171,6 +193,12 @@ namespace casadi {
     // Second order corrections
     bool so_corr_;
 
+    /// Real-time iterations
+    bool rti_;
+
+    // Sparsity of the Jacobian of the constraints and the mixed Hessian w.r.t. p
+    Sparsity Jpsp_, Hxpsp_;
+
     /** \brief Generate code for the function body */
     void codegen_body(CodeGenerator& g) const override;
 
@@ -228,6 +256,45 @@ namespace casadi {
     // Calculate gamma_1
     double calc_gamma_1(SqpmethodMemory* m) const;
 
+    /** \brief Real-time iteration: the phases selected by m->rti_phase */
+    int solve_rti(SqpmethodMemory* m) const;
+
+    /** \brief Real-time iteration, preparation phase
+
+     * Linearizes at the current iterate and parameters: Jacobian, Hessian and
+     * derivatives w.r.t. p, stored in the memory until the next feedback phase.
+     */
+    int rti_preparation(SqpmethodMemory* m) const;
+
+    /** \brief Real-time iteration, feedback phase
+
+     * Embeds the new parameters and bounds into the prepared QP, solves it
+     * and takes a full step.
+     */
+    int rti_feedback(SqpmethodMemory* m) const;
+
+    // Codegen of a real-time iteration
+    void codegen_rti(CodeGenerator& g) const;
+
+    // Codegen of the preparation phase
+    void codegen_rti_preparation(CodeGenerator& g) const;
+
+    /** \brief Generate entry points for the feedback and preparation phases */
+    void codegen_meta(CodeGenerator& g) const override;
+
+    /** \brief Finalize initialization, creates the real-time iteration phase functions */
+    void finalize() override;
+
+    ///@{
+    /** \brief Oracle functions, and "rti_feedback", "rti_preparation" in RTI mode */
+    std::vector<std::string> get_function() const override;
+    const Function& get_function(const std::string &name) const override;
+    bool has_function(const std::string& fname) const override;
+    ///@}
+
+    /// Real-time iterations: functions evaluating the feedback and the preparation phase
+    Function rti_feedback_, rti_preparation_;
+
     /// A documentation string
     static const std::string meta_doc;
 
@@ -246,6 +313,48 @@ namespace casadi {
     void set_sqpmethod_prob();
   };
 
+  /** \brief A single phase of the real-time iterations of an Sqpmethod instance
+
+      Has the inputs and outputs of the solver, and calls it with the phase set in the
+      memory object used by numerical calls of the solver. Only holds a weak reference to the solver, which must be kept alive.
+      Available as the functions "rti_feedback" and "rti_preparation" of the solver. */
+  class CASADI_NLPSOL_SQPMETHOD_EXPORT SqpmethodRti : public FunctionInternal {
+  public:
+    SqpmethodRti(const std::string& name, const Function& solver, int phase);
+    ~SqpmethodRti() override;
+
+    // Name of the class
+    std::string class_name() const override { return "SqpmethodRti";}
+
+    ///@{
+    /** \brief Number of function inputs and outputs */
+    size_t get_n_in() override { return NLPSOL_NUM_IN;}
+    size_t get_n_out() override { return NLPSOL_NUM_OUT;}
+    ///@}
+
+    ///@{
+    /** \brief Names and sparsities of function inputs and outputs, as the solver */
+    std::string get_name_in(casadi_int i) override { return nlpsol_in(i);}
+    std::string get_name_out(casadi_int i) override { return nlpsol_out(i);}
+    Sparsity get_sparsity_in(casadi_int i) override;
+    Sparsity get_sparsity_out(casadi_int i) override;
+    double get_default_in(casadi_int ind) const override { return nlpsol_default_in(ind);}
+    ///@}
+
+    // Initialize
+    void init(const Dict& opts) override;
+
+    // Evaluate numerically
+    int eval(const double** arg, double** res, casadi_int* iw, double* w,
+      void* mem) const override;
+
+    // Solver, weak reference to avoid a cycle
+    mutable WeakRef solver_;
+
+    // Phase, cf. SqpmethodRtiPhase
+    int phase_;
+  };
+
 } // namespace casadi
 /// \endcond
 #endif // CASADI_SQPMETHOD_HPP
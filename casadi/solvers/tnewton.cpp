@@ -0,0 +1,520 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "tnewton.hpp"
+
+#include "casadi/core/casadi_misc.hpp"
+
+#include <cmath>
+#include <cfloat>
+
+namespace casadi {
+
+  extern "C"
+  int CASADI_NLPSOL_TNEWTON_EXPORT
+      casadi_register_nlpsol_tnewton(Nlpsol::Plugin* plugin) {
+    plugin->creator = Tnewton::creator;
+    plugin->name = "tnewton";
+    plugin->doc = Tnewton::meta_doc.c_str();
+    plugin->version = CASADI_VERSION;
+    plugin->options = &Tnewton::options_;
+    plugin->deserialize = &Tnewton::deserialize;
+    return 0;
+  }
+
+  extern "C"
+  void CASADI_NLPSOL_TNEWTON_EXPORT casadi_load_nlpsol_tnewton() {
+    Nlpsol::registerPlugin(casadi_register_nlpsol_tnewton);
+  }
+
+  Tnewton::Tnewton(const std::string& name, const Function& nlp)
+    : Nlpsol(name, nlp) {
+  }
+
+  Tnewton::~Tnewton() {
+    clear_mem();
+  }
+
+  const Options Tnewton::options_
+  = {{&Nlpsol::options_},
+     {{"max_iter",
+       {OT_INT,
+        "Maximum number of Newton iterations [200]"}},
+      {"max_iter_cg",
+       {OT_INT,
+        "Maximum number of conjugate gradient iterations per Newton step "
+        "[number of variables]"}},
+      {"tol_pr",
+       {OT_DOUBLE,
+        "Stopping criterion for primal infeasibility [1e-6]"}},
+      {"tol_du",
+       {OT_DOUBLE,
+        "Stopping criterion for the projected gradient of the Lagrangian [1e-6]"}},
+      {"min_step_size",
+       {OT_DOUBLE,
+        "Terminate if the trust-region radius becomes smaller than this [1e-10]"}},
+      {"trust_region_radius",
+       {OT_DOUBLE,
+        "Initial trust-region radius [1]"}},
+      {"penalty_init",
+       {OT_DOUBLE,
+        "Initial penalty parameter of the augmented Lagrangian [10]"}},
+      {"penalty_factor",
+       {OT_DOUBLE,
+        "Increase of the penalty parameter when the infeasibility does not "
+        "decrease sufficiently [10]"}},
+      {"print_header",
+       {OT_BOOL,
+        "Print the header with problem statistics"}},
+      {"print_iteration",
+       {OT_BOOL,
+        "Print the iterations"}},
+      {"print_status",
+       {OT_BOOL,
+        "Print a status message after solving"}}
+     }
+  };
+
+  void Tnewton::init(const Dict& opts) {
+    // Call the init method of the base class
+    Nlpsol::init(opts);
+
+    // Default options
+    max_iter_ = 200;
+    max_iter_cg_ = nx_;
+    tol_pr_ = 1e-6;
+    tol_du_ = 1e-6;
+    min_step_size_ = 1e-10;
+    radius_init_ = 1;
+    rho_init_ = 10;
+    rho_factor_ = 10;
+    print_header_ = true;
+    print_iteration_ = true;
+    print_status_ = true;
+
+    // Read user options
+    for (auto&& op : opts) {
+      if (op.first=="max_iter") {
+        max_iter_ = op.second;
+      } else if (op.first=="max_iter_cg") {
+        max_iter_cg_ = op.second;
+      } else if (op.first=="tol_pr") {
+        tol_pr_ = op.second;
+      } else if (op.first=="tol_du") {
+        tol_du_ = op.second;
+      } else if (op.first=="min_step_size") {
+        min_step_size_ = op.second;
+      } else if (op.first=="trust_region_radius") {
+        radius_init_ = op.second;
+      } else if (op.first=="penalty_init") {
+        rho_init_ = op.second;
+      } else if (op.first=="penalty_factor") {
+        rho_factor_ = op.second;
+      } else if (op.first=="print_header") {
+        print_header_ = op.second;
+      } else if (op.first=="print_iteration") {
+        print_iteration_ = op.second;
+      } else if (op.first=="print_status") {
+        print_status_ = op.second;
+      }
+    }
+    casadi_assert(radius_init_ > 0, "'trust_region_radius' must be positive");
+    casadi_assert(rho_init_ > 0, "'penalty_init' must be positive");
+    casadi_assert(rho_factor_ > 1, "'penalty_factor' must be larger than one");
+
+    // Function and constraint values
+    create_function("nlp_fg", {"x", "p"}, {"f", "g"});
+    // Gradient of the Lagrangian
+    create_function("nlp_grad_l", {"x", "p", "lam:f", "lam:g"},
+                    {"grad:gamma:x"}, {{"gamma", {"f", "g"}}});
+    // Hessian-vector product of the Lagrangian and Jacobian-vector product of the constraints
+    create_function("nlp_hess_vec", {"x", "p", "lam:f", "lam:g", "fwd:x"},
+                    {"fwd:grad:gamma:x", "fwd:g"}, {{"gamma", {"f", "g"}}});
+
+    // Header
+    if (print_header_) {
+      print("-------------------------------------------\n");
+      print("This is casadi::Tnewton.\n");
+      print("Using Hessian-vector products, the Hessian is not formed\n");
+      print("Number of variables:                       %9d\n", nx_);
+      print("Number of constraints:                     %9d\n", ng_);
+      print("\n");
+    }
+
+    // Candidate point
+    alloc_w(nx_ + ng_, true); // z_cand
+
+    // Gradient of the augmented Lagrangian
+    alloc_w(nx_, true); // gf
+
+    // Step, Hessian-vector product and work vector
+    alloc_w(nx_, true); // dx
+    alloc_w(nx_, true); // hv
+    alloc_w(nx_, true); // v
+
+    // Multiplier estimates, multipliers and work vector
+    alloc_w(ng_, true); // mu
+    alloc_w(ng_, true); // mu_cand
+    alloc_w(ng_, true); // lam
+    alloc_w(ng_, true); // jv
+
+    // Truncated conjugate gradients
+    casadi_krylov_prob<double> kp;
+    casadi_krylov_setup(&kp, nx_, KRYLOV_CG);
+    alloc_w(casadi_krylov_sz_w(&kp), true);
+  }
+
+  void Tnewton::set_work(void* mem, const double**& arg, double**& res,
+                         casadi_int*& iw, double*& w) const {
+    auto m = static_cast<TnewtonMemory*>(mem);
+
+    // Set work in base classes
+    Nlpsol::set_work(mem, arg, res, iw, w);
+
+    // Candidate point
+    m->z_cand = w; w += nx_ + ng_;
+
+    // Gradient of the augmented Lagrangian
+    m->gf = w; w += nx_;
+
+    // Step, Hessian-vector product and work vector
+    m->dx = w; w += nx_;
+    m->hv = w; w += nx_;
+    m->v = w; w += nx_;
+
+    // Multiplier estimates, multipliers and work vector
+    m->mu = w; w += ng_;
+    m->mu_cand = w; w += ng_;
+    m->lam = w; w += ng_;
+    m->jv = w; w += ng_;
+
+    // Truncated conjugate gradients
+    casadi_krylov_setup(&m->kp, nx_, KRYLOV_CG);
+    m->kp.max_iter = max_iter_cg_;
+    m->kd.prob = &m->kp;
+    casadi_krylov_init(&m->kd, &w);
+  }
+
+  double Tnewton::calc_mu(TnewtonMemory* m, const double* g, double* mu) const {
+    const double *lbg = m->d_nlp.lbz + nx_, *ubg = m->d_nlp.ubz + nx_;
+    double pen = 0;
+    for (casadi_int i = 0; i < ng_; ++i) {
+      // Shifted constraint value and its distance to the bounds
+      double t = g[i] + m->lam[i] / m->rho;
+      mu[i] = m->rho * (t - std::fmin(std::fmax(t, lbg[i]), ubg[i]));
+      pen += mu[i] * mu[i];
+    }
+    return pen / (2 * m->rho);
+  }
+
+  int Tnewton::calc_grad(TnewtonMemory* m) const {
+    const double one = 1;
+    m->arg[0] = m->d_nlp.z;
+    m->arg[1] = m->d_nlp.p;
+    m->arg[2] = &one;
+    m->arg[3] = m->mu;
+    m->res[0] = m->gf;
+    return calc_function(m, "nlp_grad_l");
+  }
+
+  bool Tnewton::is_fixed(TnewtonMemory* m, casadi_int i) const {
+    const double *x = m->d_nlp.z, *lbx = m->d_nlp.lbz, *ubx = m->d_nlp.ubz;
+    return lbx[i] == ubx[i] || (x[i] <= lbx[i] && m->gf[i] > 0)
+      || (x[i] >= ubx[i] && m->gf[i] < 0);
+  }
+
+  int Tnewton::calc_hess_vec(TnewtonMemory* m, const double* v, double* hv) const {
+    const double one = 1, zero = 0;
+    const double *lbg = m->d_nlp.lbz + nx_, *ubg = m->d_nlp.ubz + nx_;
+    // Direction, restricted to the free variables
+    for (casadi_int i = 0; i < nx_; ++i) m->v[i] = is_fixed(m, i) ? 0 : v[i];
+    // Hessian of the Lagrangian with the multiplier estimates, forward over reverse
+    m->arg[0] = m->d_nlp.z;
+    m->arg[1] = m->d_nlp.p;
+    m->arg[2] = &one;
+    m->arg[3] = m->mu;
+    m->arg[4] = m->v;
+    m->res[0] = hv;
+    m->res[1] = m->jv;
+    if (calc_function(m, "nlp_hess_vec")) return 1;
+    // Generalized Hessian of the penalty term: rho * J_A' * J_A * v, A active rows
+    bool any_active = false;
+    for (casadi_int i = 0; i < ng_; ++i) {
+      if (m->mu[i] != 0 || lbg[i] == ubg[i]) {
+        m->jv[i] *= m->rho;
+        any_active = true;
+      } else {
+        m->jv[i] = 0;
+      }
+    }
+    if (any_active) {
+      m->arg[0] = m->d_nlp.z;
+      m->arg[1] = m->d_nlp.p;
+      m->arg[2] = &zero;
+      m->arg[3] = m->jv;
+      m->res[0] = m->v;
+      if (calc_function(m, "nlp_grad_l")) return 1;
+      casadi_axpy(nx_, 1., m->v, hv);
+    }
+    // Restrict to the free variables
+    for (casadi_int i = 0; i < nx_; ++i) if (is_fixed(m, i)) hv[i] = 0;
+    m->n_hvp++;
+    return 0;
+  }
+
+  int Tnewton::solve(void* mem) const {
+    auto m = static_cast<TnewtonMemory*>(mem);
+    auto d_nlp = &m->d_nlp;
+    double *x = d_nlp->z, *g = d_nlp->z + nx_;
+    const double *lbx = d_nlp->lbz, *ubx = d_nlp->ubz;
+    const double *lbg = d_nlp->lbz + nx_, *ubg = d_nlp->ubz + nx_;
+
+    // Reset
+    m->iter_count = 0;
+    m->cg_iter = 0;
+    m->n_hvp = 0;
+    m->rho = rho_init_;
+    m->radius = radius_init_;
+
+    // Multipliers of the augmented Lagrangian
+    casadi_copy(d_nlp->lam + nx_, ng_, m->lam);
+
+    // Project the initial guess onto the bounds
+    for (casadi_int i = 0; i < nx_; ++i) x[i] = std::fmin(std::fmax(x[i], lbx[i]), ubx[i]);
+
+    // Tolerance of the augmented Lagrangian subproblems
+    double omega = ng_ > 0 ? std::fmax(tol_du_, 1e-1) : tol_du_;
+
+    // Infeasibility after the last multiplier update
+    double pr_inf_ref = inf;
+
+    // Information for printing
+    double dx_norm = 0;
+    casadi_int cg_iter = 0;
+    std::string info = "";
+
+    // Function values, multiplier estimates and gradient in the initial point
+    m->arg[0] = x;
+    m->arg[1] = d_nlp->p;
+    m->res[0] = &d_nlp->objective;
+    m->res[1] = g;
+    if (calc_function(m, "nlp_fg")) return 1;
+    double phi = d_nlp->objective + calc_mu(m, g, m->mu);
+    if (calc_grad(m)) return 1;
+
+    // MAIN OPTIMIZATION LOOP
+    while (true) {
+      // Primal infeasibility, projected gradient of the augmented Lagrangian
+      double pr_inf = casadi_max_viol(ng_, g, lbg, ubg);
+      double du_inf = 0;
+      for (casadi_int i = 0; i < nx_; ++i) {
+        double t = std::fmin(std::fmax(x[i] - m->gf[i], lbx[i]), ubx[i]);
+        du_inf = std::fmax(du_inf, std::fabs(x[i] - t));
+      }
+
+      // Subproblem solved: update the multipliers and, if needed, the penalty parameter
+      if (du_inf <= omega && (pr_inf > tol_pr_ || du_inf > tol_du_)) {
+        casadi_copy(m->mu, ng_, m->lam);
+        if (pr_inf > 0.25 * pr_inf_ref) {
+          m->rho *= rho_factor_;
+          info += "p";
+        }
+        pr_inf_ref = pr_inf;
+        omega = std::fmax(tol_du_, 0.1 * omega);
+        phi = d_nlp->objective + calc_mu(m, g, m->mu);
+        if (calc_grad(m)) return 1;
+        continue;
+      }
+
+      // Printing information about the actual iterate
+      if (print_iteration_) {
+        if (m->iter_count % 10 == 0) print_iteration();
+        print_iteration(m->iter_count, d_nlp->objective, pr_inf, du_inf, dx_norm,
+                        m->radius, cg_iter, m->rho, info);
+        info = "";
+      }
+
+      // Callback function
+      if (callback(m)) {
+        if (print_status_) print("WARNING(tnewton): Aborted by callback...\n");
+        m->return_status = "User_Requested_Stop";
+        break;
+      }
+
+      // Checking convergence criteria
+      if (pr_inf <= tol_pr_ && du_inf <= tol_du_) {
+        if (print_status_)
+          print("MESSAGE(tnewton): Convergence achieved after %d iterations\n", m->iter_count);
+        m->return_status = "Solve_Succeeded";
+        m->success = true;
+        m->unified_return_status = SOLVER_RET_SUCCESS;
+        break;
+      }
+
+      if (m->iter_count >= max_iter_) {
+        if (print_status_) print("MESSAGE(tnewton): Maximum number of iterations reached.\n");
+        m->return_status = "Maximum_Iterations_Exceeded";
+        m->unified_return_status = SOLVER_RET_LIMITED;
+        break;
+      }
+
+      if (m->radius < min_step_size_) {
+        if (print_status_) print("MESSAGE(tnewton): Trust region becomes too small without "
+              "convergence criteria being met.\n");
+        m->return_status = "Search_Direction_Becomes_Too_Small";
+        break;
+      }
+
+      // Newton step for the free variables, truncated conjugate gradients with
+      // relative tolerance min(0.1, sqrt(||gradient||)) for superlinear convergence
+      for (casadi_int i = 0; i < nx_; ++i) m->dx[i] = is_fixed(m, i) ? 0 : -m->gf[i];
+      m->kp.tol = std::fmin(0.1, std::sqrt(std::sqrt(casadi_dot(nx_, m->dx, m->dx))));
+      casadi_krylov_start(&m->kd, m->dx);
+      m->kd.radius = m->radius;
+      while (casadi_krylov(&m->kd)) {
+        if (m->kd.task == KRYLOV_MV) {
+          if (calc_hess_vec(m, m->kd.in, m->kd.out)) return 1;
+        } else {
+          casadi_copy(m->kd.in, nx_, m->kd.out);
+        }
+      }
+      cg_iter = m->kd.iter;
+      m->cg_iter += cg_iter;
+
+      // Project the candidate onto the bounds
+      for (casadi_int i = 0; i < nx_; ++i) {
+        m->z_cand[i] = std::fmin(std::fmax(x[i] + m->dx[i], lbx[i]), ubx[i]);
+        m->dx[i] = m->z_cand[i] - x[i];
+      }
+      dx_norm = casadi_norm_inf(nx_, m->dx);
+      double step = std::sqrt(casadi_dot(nx_, m->dx, m->dx));
+
+      // Predicted reduction of the quadratic model
+      if (calc_hess_vec(m, m->dx, m->hv)) return 1;
+      double pred = -casadi_dot(nx_, m->gf, m->dx) - 0.5 * casadi_dot(nx_, m->dx, m->hv);
+
+      // Actual reduction
+      double f_cand;
+      m->arg[0] = m->z_cand;
+      m->arg[1] = d_nlp->p;
+      m->res[0] = &f_cand;
+      m->res[1] = m->z_cand + nx_;
+      double ratio = -1;
+      if (!calc_function(m, "nlp_fg")) {
+        double phi_cand = f_cand + calc_mu(m, m->z_cand + nx_, m->mu_cand);
+        double ared = phi - phi_cand;
+        if (std::fabs(ared - pred) <= 10 * DBL_EPSILON * std::fmax(1., std::fabs(phi))) {
+          // Difference at the level of rounding errors
+          ratio = 1;
+        } else if (pred > 0) {
+          ratio = ared / pred;
+        }
+        // Accept step
+        if (ratio > 1e-4) {
+          casadi_copy(m->z_cand, nx_ + ng_, d_nlp->z);
+          casadi_copy(m->mu_cand, ng_, m->mu);
+          d_nlp->objective = f_cand;
+          phi = phi_cand;
+          if (calc_grad(m)) return 1;
+        } else {
+          info += "r";
+        }
+      } else {
+        info += "e";
+      }
+
+      // Update the trust-region radius
+      if (ratio < 0.25) {
+        m->radius = 0.25 * step;
+      } else if (ratio > 0.75 && step >= 0.99 * m->radius) {
+        m->radius *= 2;
+      }
+
+      m->iter_count++;
+    }
+
+    // Bound multipliers from the gradient of the Lagrangian, at the active bounds
+    for (casadi_int i = 0; i < nx_; ++i) d_nlp->lam[i] = is_fixed(m, i) ? -m->gf[i] : 0;
+    casadi_copy(m->mu, ng_, d_nlp->lam + nx_);
+    return 0;
+  }
+
+  void Tnewton::print_iteration() const {
+    print("%4s %14s %9s %9s %9s %9s %4s %9s\n", "iter", "objective", "inf_pr",
+          "inf_du", "||d||", "radius", "cg", "rho");
+  }
+
+  void Tnewton::print_iteration(casadi_int iter, double obj,
+                                double pr_inf, double du_inf,
+                                double dx_norm, double radius, casadi_int cg_iter, double rho,
+                                const std::string& info) const {
+    print("%4d %14.6e %9.2e %9.2e %9.2e %9.2e %4d %9.2e", iter, obj, pr_inf, du_inf,
+          dx_norm, radius, cg_iter, rho);
+    if (!info.empty()) print(" %s", info.c_str());
+    print("\n");
+  }
+
+  Dict Tnewton::get_stats(void* mem) const {
+    Dict stats = Nlpsol::get_stats(mem);
+    auto m = static_cast<TnewtonMemory*>(mem);
+    stats["return_status"] = m->return_status;
+    stats["iter_count"] = m->iter_count;
+    stats["cg_iter"] = m->cg_iter;
+    stats["n_hess_vec"] = m->n_hvp;
+    return stats;
+  }
+
+  Tnewton::Tnewton(DeserializingStream& s) : Nlpsol(s) {
+    s.version("Tnewton", 1);
+    s.unpack("Tnewton::max_iter", max_iter_);
+    s.unpack("Tnewton::max_iter_cg", max_iter_cg_);
+    s.unpack("Tnewton::tol_pr", tol_pr_);
+    s.unpack("Tnewton::tol_du", tol_du_);
+    s.unpack("Tnewton::min_step_size", min_step_size_);
+    s.unpack("Tnewton::radius_init", radius_init_);
+    s.unpack("Tnewton::rho_init", rho_init_);
+    s.unpack("Tnewton::rho_factor", rho_factor_);
+    s.unpack("Tnewton::print_header", print_header_);
+    s.unpack("Tnewton::print_iteration", print_iteration_);
+    s.unpack("Tnewton::print_status", print_status_);
+  }
+
+  void Tnewton::serialize_body(SerializingStream &s) const {
+    Nlpsol::serialize_body(s);
+    s.version("Tnewton", 1);
+    s.pack("Tnewton::max_iter", max_iter_);
+    s.pack("Tnewton::max_iter_cg", max_iter_cg_);
+    s.pack("Tnewton::tol_pr", tol_pr_);
+    s.pack("Tnewton::tol_du", tol_du_);
+    s.pack("Tnewton::min_step_size", min_step_size_);
+    s.pack("Tnewton::radius_init", radius_init_);
+    s.pack("Tnewton::rho_init", rho_init_);
+    s.pack("Tnewton::rho_factor", rho_factor_);
+    s.pack("Tnewton::print_header", print_header_);
+    s.pack("Tnewton::print_iteration", print_iteration_);
+    s.pack("Tnewton::print_status", print_status_);
+  }
+
+} // namespace casadi
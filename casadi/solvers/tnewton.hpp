@@ -0,0 +1,185 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_TNEWTON_HPP
+#define CASADI_TNEWTON_HPP
+
+#include "casadi/core/nlpsol_impl.hpp"
+#include <casadi/solvers/casadi_nlpsol_tnewton_export.h>
+
+/** \defgroup plugin_Nlpsol_tnewton Title
+    \par
+
+ Matrix-free truncated Newton method. Bound constraints are handled by
+ projection and general constraints by an augmented Lagrangian, whose
+ subproblems are solved with a trust-region Newton method. The Newton
+ steps are computed with Steihaug's truncated conjugate gradients, using
+ Hessian-vector products of the Lagrangian (forward-over-reverse
+ differentiation of its gradient), so that the Hessian is never formed.
+
+    \identifier{289} */
+
+/** \pluginsection{Nlpsol,tnewton} */
+
+/// \cond INTERNAL
+namespace casadi {
+
+  struct CASADI_NLPSOL_TNEWTON_EXPORT TnewtonMemory : public NlpsolMemory {
+    // Candidate point, primal variables followed by constraints
+    double *z_cand;
+
+    // Gradient of the augmented Lagrangian
+    double *gf;
+
+    // Step, Hessian-vector product and work vector
+    double *dx, *hv, *v;
+
+    // Multiplier estimates and their candidate values
+    double *mu, *mu_cand;
+
+    // Multipliers of the augmented Lagrangian and work vector
+    double *lam, *jv;
+
+    // Truncated conjugate gradients
+    casadi_krylov_prob<double> kp;
+    casadi_krylov_data<double> kd;
+
+    /// Penalty parameter
+    double rho;
+
+    /// Trust-region radius
+    double radius;
+
+    /// Last return status
+    const char* return_status;
+
+    /// Iteration count
+    casadi_int iter_count;
+
+    /// Number of conjugate gradient iterations and Hessian-vector products
+    casadi_int cg_iter, n_hvp;
+  };
+
+  /** \brief  \pluginbrief{Nlpsol,tnewton}
+  *  @copydoc NLPSolver_doc
+  *  @copydoc plugin_Nlpsol_tnewton
+  */
+  class CASADI_NLPSOL_TNEWTON_EXPORT Tnewton : public Nlpsol {
+  public:
+    explicit Tnewton(const std::string& name, const Function& nlp);
+    ~Tnewton() override;
+
+    // Get name of the plugin
+    const char* plugin_name() const override { return "tnewton";}
+
+    // Name of the class
+    std::string class_name() const override { return "Tnewton";}
+
+    /** \brief  Create a new NLP Solver */
+    static Nlpsol* creator(const std::string& name, const Function& nlp) {
+      return new Tnewton(name, nlp);
+    }
+
+    ///@{
+    /** \brief Options */
+    static const Options options_;
+    const Options& get_options() const override { return options_;}
+    ///@}
+
+    /// Get all statistics
+    Dict get_stats(void* mem) const override;
+
+    // Initialize the solver
+    void init(const Dict& opts) override;
+
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new TnewtonMemory();}
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override { delete static_cast<TnewtonMemory*>(mem);}
+
+    /** \brief Set the (persistent) work vectors */
+    void set_work(void* mem, const double**& arg, double**& res,
+                          casadi_int*& iw, double*& w) const override;
+
+    // Solve the NLP
+    int solve(void* mem) const override;
+
+    /// Maximum number of iterations, of conjugate gradient iterations per step
+    casadi_int max_iter_, max_iter_cg_;
+
+    /// Tolerance of primal and dual infeasibility
+    double tol_pr_, tol_du_;
+
+    /// Minimum trust-region radius
+    double min_step_size_;
+
+    /// Initial trust-region radius
+    double radius_init_;
+
+    /// Initial penalty parameter and increase factor
+    double rho_init_, rho_factor_;
+
+    // Print options
+    bool print_header_, print_iteration_, print_status_;
+
+    /// Print iteration header
+    void print_iteration() const;
+
+    /// Print iteration
+    void print_iteration(casadi_int iter, double obj, double pr_inf, double du_inf,
+                         double dx_norm, double radius, casadi_int cg_iter, double rho,
+                         const std::string& info) const;
+
+    /// A documentation string
+    static const std::string meta_doc;
+
+    /** \brief Serialize an object without type information */
+    void serialize_body(SerializingStream &s) const override;
+
+    /** \brief Deserialize into MX */
+    static ProtoFunction* deserialize(DeserializingStream& s) { return new Tnewton(s); }
+
+  protected:
+    /** \brief Deserializing constructor */
+    explicit Tnewton(DeserializingStream& s);
+
+  private:
+    // Multipliers for constraint values g, returns the penalty term of the merit function
+    double calc_mu(TnewtonMemory* m, const double* g, double* mu) const;
+
+    // Gradient of the augmented Lagrangian
+    int calc_grad(TnewtonMemory* m) const;
+
+    // Hessian-vector product of the augmented Lagrangian, restricted to the free variables
+    int calc_hess_vec(TnewtonMemory* m, const double* v, double* hv) const;
+
+    // Is a variable fixed at a bound for the gradient gf?
+    bool is_fixed(TnewtonMemory* m, casadi_int i) const;
+  };
+
+} // namespace casadi
+/// \endcond
+#endif // CASADI_TNEWTON_HPP
@@ -0,0 +1,71 @@
+#
+#     MIT No Attribution
+#
+#     Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+#
+#     Permission is hereby granted, free of charge, to any person obtaining a copy of this
+#     software and associated documentation files (the "Software"), to deal in the Software
+#     without restriction, including without limitation the rights to use, copy, modify,
+#     merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+#     permit persons to whom the Software is furnished to do so.
+#
+#     THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+#     INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+#     PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+#     HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+#     OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+#     SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+#
+#
+# Closed-loop MPC of a damped pendulum, comparing a plain warm start from
+# the previous solution with the tangential predictor of Nlpsol
+import time
+from casadi import *
+
+# Dynamics, discretized with RK4
+x = MX.sym('x', 2)
+u = MX.sym('u')
+f = Function('f', [x, u], [vertcat(x[1], -10*sin(x[0]) - 0.2*x[1] + u)])
+dt = 0.05
+k1 = f(x, u)
+k2 = f(x + dt/2*k1, u)
+k3 = f(x + dt/2*k2, u)
+k4 = f(x + dt*k3, u)
+F = Function('F', [x, u], [x + dt/6*(k1 + 2*k2 + 2*k3 + k4)])
+
+# Multiple shooting OCP, parametrized by the initial state
+N = 30
+X = MX.sym('X', 2, N+1)
+U = MX.sym('U', 1, N)
+P = MX.sym('P', 2)
+nlp = {'x': vertcat(vec(X), vec(U)), 'p': P,
+       'f': sumsqr(X) + 0.1*sumsqr(U),
+       'g': vertcat(vec(F.map(N)(X[:, :-1], U) - X[:, 1:]), X[:, 0] - P)}
+lbx = vertcat(-inf*DM.ones(2*(N+1)), -2*DM.ones(N))
+ubx = -lbx
+
+opts = {'qpsol': 'qrqp', 'expand': True, 'print_time': False,
+        'print_header': False, 'print_iteration': False, 'print_status': False,
+        'qpsol_options': {'print_iter': False, 'print_header': False, 'error_on_fail': False}}
+
+for predictor in [False, True]:
+    opts['tangential_predictor'] = predictor
+    solver = nlpsol('solver', 'sqpmethod', nlp, opts)
+    xs = DM([1, 0])
+    sol = {'x': 0, 'lam_x': 0, 'lam_g': 0}
+    n_iter = 0
+    t = 0
+    for k in range(60):
+        t0 = time.time()
+        if predictor:
+            # The initial guess would be overwritten by the prediction
+            sol = solver(p=xs, lbx=lbx, ubx=ubx, lbg=0, ubg=0)
+        else:
+            sol = solver(x0=sol['x'], lam_x0=sol['lam_x'], lam_g0=sol['lam_g'], p=xs,
+                         lbx=lbx, ubx=ubx, lbg=0, ubg=0)
+        t += time.time() - t0
+        n_iter += solver.stats()['iter_count']
+        # Apply the first control
+        xs = F(xs, sol['x'][2*(N+1)])
+    print('tangential_predictor=%d: %d SQP iterations, %.1f ms per sample'
+          % (predictor, n_iter, 1000*t/60))
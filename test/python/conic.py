@@ -99,6 +99,59 @@ if "SKIP_HIGHS_TESTS" not in os.environ and has_conic("highs"):
 
 print(conics)
 
+def ocp_qp(N=10, x0_constraint=False):
+  """Linear-quadratic OCP with stage-wise ordered variables and constraints
+
+  The initial state is fixed via the bounds, or via a constraint when
+  x0_constraint is set
+  """
+  A = DM([[1, 0.1], [0, 1]])
+  B = DM([[0], [0.1]])
+
+  Xs = SX.sym('X', 2, 1, N+1)
+  Us = SX.sym('U', 1, 1, N)
+
+  w = []
+  lbw = []
+  ubw = []
+  g = []
+  lbg = []
+  ubg = []
+  J = 0
+  for k in range(N):
+    w += [Xs[k], Us[k]]
+    if x0_constraint:
+      lbw += [-inf, -0.5]
+      ubw += [inf, inf]
+      if k==0:
+        g += [Xs[0]]
+        lbg += [1, 0]
+        ubg += [1, 0]
+    elif k==0:
+      lbw += [1, 0]
+      ubw += [1, 0]
+    else:
+      lbw += [-inf, -inf]
+      ubw += [inf, inf]
+    lbw += [-0.4]
+    ubw += [0.4]
+    J += sumsqr(Xs[k]) + 0.1*Us[k]**2 + 0.2*Xs[k][0]*Us[k] - Xs[k][1]
+    g += [mtimes(A, Xs[k]) + mtimes(B, Us[k]) - Xs[k+1]]
+    lbg += [0, 0]
+    ubg += [0, 0]
+    g += [Xs[k][1] - Us[k]]
+    lbg += [-0.3]
+    ubg += [inf]
+  w += [Xs[N]]
+  lbw += [-inf, -inf]
+  ubw += [inf, inf]
+  J += 10*sumsqr(Xs[N])
+
+  prob = {'f': J, 'x': vertcat(*w), 'g': vertcat(*g)}
+  args = dict(lbx=lbw, ubx=ubw, lbg=lbg, ubg=ubg)
+  return prob, args
+
+
 
 class ConicTests(casadiTestCase):
 
@@ -949,6 +1002,99 @@ class ConicTests(casadiTestCase):
     
     
 
+  @requires_conic("ipqp")
+  def test_ipqp_warm_start(self):
+    x = SX.sym("x", 6)
+    H = DM.eye(6) + 0.1
+    g = DM([1, -2, 0.5, 3, -1, 2])
+    A = DM([[1, 1, 0, 0, 1, 0], [0, 1, -1, 1, 0, 1], [1, 0, 1, 0, -1, 1]])
+    prob = {'x': x, 'f': 0.5*bilin(H, x, x) + dot(g, x), 'g': mtimes(A, x)}
+    args = dict(lbx=-1, ubx=1, lbg=[-0.5, -inf, 0.2], ubg=[0.5, 1, inf])
+
+    opts = {"print_iter": False, "print_header": False}
+    cold = qpsol('cold', 'ipqp', prob, opts)
+    opts["warm_start"] = True
+    warm = qpsol('warm', 'ipqp', prob, opts)
+
+    sol = cold(**args)
+    args["lbx"] = -0.9
+    sol_cold = cold(**args)
+    iter_cold = cold.stats()["iter_count"]
+    sol_warm = warm(x0=sol["x"], lam_x0=sol["lam_x"], lam_g0=sol["lam_g"], **args)
+    iter_warm = warm.stats()["iter_count"]
+
+    # Same solution, in fewer iterations
+    for k in ["x", "f", "lam_x", "lam_g"]:
+      self.checkarray(sol_cold[k], sol_warm[k], digits=7, failmessage=k)
+    self.assertTrue(iter_warm < iter_cold)
+
+  @requires_conic("riccati")
+  @requires_conic("qrqp")
+  def test_riccati(self):
+    prob, args = ocp_qp()
+
+    solver_ref = qpsol('solver', 'qrqp', prob, {"print_iter": False, "print_header": False})
+    sol_ref = solver_ref(**args)
+
+    solver = qpsol('solver', 'riccati', prob, {"print_iter": False, "print_header": False,
+      "pr_tol": 1e-10, "du_tol": 1e-10, "co_tol": 1e-10, "mu_tol": 1e-10})
+    sol = solver(**args)
+
+    self.checkarray(sol_ref["x"], sol["x"], digits=7)
+    self.checkarray(sol_ref["lam_g"], sol["lam_g"], digits=7)
+    self.checkarray(sol_ref["lam_x"], sol["lam_x"], digits=7)
+    self.checkarray(sol_ref["f"], sol["f"], digits=7)
+
+    self.check_serialize(solver, args)
+    self.check_codegen(solver, args, std="c99")
+
+    # The same iterations with a general sparse KKT solver
+    solver = qpsol('solver', 'ipqp', prob, {"print_iter": False, "print_header": False,
+      "pr_tol": 1e-10, "du_tol": 1e-10, "co_tol": 1e-10, "mu_tol": 1e-10,
+      "linear_solver": "qr"})
+    sol = solver(**args)
+    self.checkarray(sol_ref["x"], sol["x"], digits=7)
+    self.check_codegen(solver, args, std="c99")
+
+  @requires_conic("condensing")
+  @requires_conic("qrqp")
+  def test_condensing(self):
+    prob, args = ocp_qp(x0_constraint=True)
+
+    options = {"print_iter": False, "print_header": False}
+    solver_ref = qpsol('solver', 'qrqp', prob, options)
+    sol_ref = solver_ref(**args)
+
+    for block_size in [0, 1, 3]:
+      solver = qpsol('solver', 'condensing', prob,
+        {"qpsol": "qrqp", "qpsol_options": options, "block_size": block_size})
+      sol = solver(**args)
+
+      self.checkarray(sol_ref["x"], sol["x"], digits=7)
+      self.checkarray(sol_ref["lam_g"], sol["lam_g"], digits=7)
+      self.checkarray(sol_ref["lam_x"], sol["lam_x"], digits=7)
+      self.checkarray(sol_ref["f"], sol["f"], digits=7)
+      self.assertTrue(solver.stats()["success"])
+
+      self.check_serialize(solver, args)
+      self.check_codegen(solver, args, std="c99")
+
+    # A dynamics constraint that is not an equality, or a rejected pivot:
+    # solved without condensing
+    args_ineq = dict(args)
+    args_ineq["lbg"] = list(args["lbg"])
+    args_ineq["lbg"][2] = -0.01
+    for a, opts in [(args_ineq, {}), (args, {"pivot_tol": 10})]:
+      sol_ref = solver_ref(**a)
+      solver = qpsol('solver', 'condensing', prob,
+        dict(qpsol="qrqp", qpsol_options=options, **opts))
+      sol = solver(**a)
+      self.checkarray(sol_ref["x"], sol["x"], digits=7)
+      self.checkarray(sol_ref["lam_g"], sol["lam_g"], digits=7)
+      self.assertFalse(solver.stats()["condensed"])
+      self.assertTrue(solver.stats()["success"])
+      self.check_codegen(solver, a, std="c99")
+
   @requires_conic("hpipm")
   @requires_conic("qpoases")
   def test_hpipm(self):
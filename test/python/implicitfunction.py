@@ -338,5 +338,23 @@ class ImplicitFunctiontests(casadiTestCase):
     g = Function("g",[x],[x - rf(x, x)])
     self.check_codegen(g,[1.01])
 
+  def test_newton_matrix_free(self):
+    x=SX.sym("x",3)
+    p=SX.sym("p")
+    g=vertcat(x[0]+0.1*x[1]**2-p,2*x[1]-0.5*sin(x[2])+0.1*x[0]**3,3*x[2]+x[0]*x[1]-1)
+    ref = rootfinder("ref","newton",{"x":x,"p":p,"g":g})(x0=[0.5,0.5,0.5],p=1)["x"]
+    solver = rootfinder("solver","newton",{"x":x,"p":p,"g":g},
+      {"matrix_free":True,"linear_solver":"krylov"})
+    res = solver(x0=[0.5,0.5,0.5],p=1)["x"]
+    self.checkarray(res,ref,digits=8)
+    self.check_serialize(solver,inputs=[[0.5,0.5,0.5],1])
+    # No Jacobian factorizations in the iterations
+    self.assertEqual(solver.stats()["n_fact"],0)
+    # A preconditioner would need the Jacobian
+    with self.assertInException("cannot be combined with a preconditioner"):
+      rootfinder("solver","newton",{"x":x,"p":p,"g":g},
+        {"matrix_free":True,"linear_solver":"krylov",
+         "linear_solver_options":{"preconditioner":"jacobi"}})
+
 if __name__ == '__main__':
     unittest.main()
@@ -60,6 +60,8 @@ integrators.append(("collocation",["dae","ode"],{"rootfinder":"newton","number_o
 
 integrators.append(("rk",["ode"],{"number_of_finite_elements": 1000,"simplify":True}))
 
+integrators.append(("dopri",["ode"],{"abstol": 1e-12,"reltol":1e-12}))
+
 
 print("Will test these integrators:")
 for cl, t, options in integrators:
@@ -995,6 +997,236 @@ class Integrationtests(casadiTestCase):
 
     self.assertTrue(intg.nnz_out("zf")==0)
 
+  def forced_vdp(self):
+    # Van der Pol oscillator with a control, a time-varying forcing and a quadrature
+    x = SX.sym("x",2)
+    p = SX.sym("p")
+    u = SX.sym("u")
+    t = SX.sym("t")
+    return {"x":x,"p":p,"u":u,"t":t,"ode":vertcat(x[1],-x[0]+p*(1-x[0]**2)*x[1]+u+0.1*sin(t)),"quad":x[0]**2}
+
+  def test_ensemble(self):
+    dae = self.forced_vdp()
+    x = dae["x"]
+    intg = integrator("intg","rk",dae,0,[0.5,1.0,2.0],{"number_of_finite_elements":40})
+
+    # Trajectories in lockstep, including a partial block
+    for N in [5,70]:
+      inputs = {"x0":DM.rand(2,N),"p":DM.rand(1,N),"u":DM.rand(1,3*N)}
+      F = intg.map(N,"ensemble")
+      self.assertTrue(F.is_a("FixedStepEnsemble"))
+      if N<10:
+        self.checkfunction(F,intg.map(N),inputs=inputs,digits=12,hessian=False,sens_der=False,evals=False)
+      else:
+        self.checkfunction_light(F,intg.map(N),inputs=inputs,digits=12)
+      self.check_serialize(F,inputs=inputs)
+
+    with self.assertInException("requires an explicit integration scheme"):
+      integrator("intg","collocation",dae,0,[0.5,1.0,2.0]).map(3,"ensemble")
+    with self.assertInException("requires a fixed step integrator"):
+      Function("f",[x],[2*x]).map(3,"ensemble")
+
+  def test_checkpoints(self):
+    dae = self.forced_vdp()
+    tout = [0.3,1.0,1.7,2.5,4.0]
+    inputs = {"x0":DM([0.5,-0.3]),"p":0.8,"u":DM([[0.1,0.1,-0.2,-0.2,0.3]])}
+    for plugin in ["rk","collocation"]:
+      ref = integrator("ref",plugin,dae,0,tout,{"number_of_finite_elements":37})
+      for c in [1,3,100]:
+        intg = integrator("intg",plugin,dae,0,tout,{"number_of_finite_elements":37,"checkpoints":c})
+        self.checkfunction(intg,ref,inputs=inputs,digits=12,hessian=False,sens_der=False,evals=False)
+        self.check_serialize(intg,inputs=inputs)
+
+    # Recomputation traded for memory: one interval of 100 steps
+    for c, max_steps in [(0,100),(2,1000),(10,300)]:
+      intg = integrator("intg","rk",dae,0,1.0,{"number_of_finite_elements":100,"checkpoints":c})
+      B = intg.reverse(1)
+      B = [f for f in B.find_functions() if f.class_name()=="RungeKutta"][0]
+      B.call([DM.ones(B.sparsity_in(i)) for i in range(B.n_in())])
+      self.assertTrue(B.stats()["n_call_step"]<=max_steps)
+
+  def test_dense_output(self):
+    dae = self.forced_vdp()
+    x = dae["x"]
+
+    # Fine output grid, no extra steps
+    tgrid = [0.01*k for k in range(1,1001)]
+    inputs = {"x0":DM([1,0]),"p":1,"u":0.1}
+    ref = integrator("ref","rk",dae,0,tgrid)
+    for plugin in ["rk","collocation"]:
+      intg = integrator("intg",plugin,dae,0,tgrid,{"number_of_finite_elements":200,"dense_output":True})
+      res = intg(**inputs)
+      self.assertEqual(intg.stats()["n_call_step"],200)
+      self.checkarray(res["xf"],ref(**inputs)["xf"],digits=4)
+      self.checkarray(res["qf"],ref(**inputs)["qf"],digits=4)
+
+    # Steps restart at changes in the controls
+    tout = [0.3,1.0,1.7,2.5,4.0]
+    inputs = {"x0":DM([0.5,-0.3]),"p":0.8,"u":DM([[0.1,0.15,-0.2,-0.25,0.3]])}
+    ref = integrator("ref","rk",dae,0,tout,{"number_of_finite_elements":2000})
+    intg = integrator("intg","rk",dae,0,tout,{"number_of_finite_elements":100,"dense_output":True})
+    self.checkfunction(intg,ref,inputs=inputs,digits=5,hessian=False,sens_der=False,evals=False)
+    self.check_serialize(intg,inputs=inputs)
+
+    with self.assertInException("Dense output is only supported for ODEs"):
+      z = SX.sym("z")
+      integrator("intg","collocation",{"x":x,"z":z,"ode":vertcat(x[1],z),"alg":z-x[0]},0,tout,{"dense_output":True})
+
+  def test_simplified_newton(self):
+    x = SX.sym("x",2)
+    z = SX.sym("z")
+    p = SX.sym("p")
+    dae = {"x":x,"z":z,"p":p,"ode":vertcat(x[1],z),"alg":z-p*(1-x[0]**2)*x[1]+x[0],"quad":x[0]**2}
+    tout = [0.02*k for k in range(1,101)]
+    inputs = {"x0":DM([2,0]),"p":5}
+    ref = integrator("ref","collocation",dae,0,tout,{"number_of_finite_elements":5})
+    ref(**inputs)
+    nfact = {"iteration":ref.stats()["nlinsetups"]}
+    for jacobian_update in ["solve","adaptive"]:
+      intg = integrator("intg","collocation",dae,0,tout,{"number_of_finite_elements":5,
+        "rootfinder_options":{"jacobian_update":jacobian_update}})
+      self.checkfunction(intg,ref,inputs=inputs,digits=10,hessian=False,sens_der=False,evals=False)
+      self.check_serialize(intg,inputs=inputs)
+      intg(**inputs)
+      nfact[jacobian_update] = intg.stats()["nlinsetups"]
+      self.assertTrue(intg.stats()["nniters"]>=ref.stats()["nniters"])
+    # At least once per step, or only when the convergence slows down
+    self.assertTrue(nfact["adaptive"]<100<=nfact["solve"]<nfact["iteration"])
+
+    # Rootfinder statistics
+    g = Function("g",[x],[vertcat(x[0]**3+x[1]-2,x[1]-x[0])])
+    n_fact = {}
+    for jacobian_update in ["iteration","solve"]:
+      rf = rootfinder("rf","newton",g,{"jacobian_update":jacobian_update})
+      self.checkarray(rf(DM([2,2])),DM([1,1]),digits=10)
+      n_fact[jacobian_update] = rf.stats()["n_fact"]
+    self.assertTrue(n_fact["solve"]<n_fact["iteration"])
+
+  def test_collocation_elements_per_step(self):
+    x = SX.sym("x",2)
+    z = SX.sym("z")
+    p = SX.sym("p")
+    u = SX.sym("u")
+    t = SX.sym("t")
+    dae = {"x":x,"z":z,"p":p,"u":u,"t":t,"ode":vertcat(x[1],-x[0]+p*(1-z)*x[1]+u+0.1*sin(t)),
+           "alg":z-x[0]**2,"quad":x[0]**2}
+    tout = [0.5,1.0,2.0]
+    inputs = {"x0":DM([0.5,-0.3]),"z0":0.25,"p":0.8,"u":DM([[0.1,-0.2,0.3]])}
+    ref = integrator("ref","collocation",dae,0,tout,{"number_of_finite_elements":16})
+    for parallelization in ["serial","unroll"]:
+      intg = integrator("intg","collocation",dae,0,tout,{"number_of_finite_elements":16,
+        "elements_per_step":4,"parallelization":parallelization})
+      # Same discretization, one rootfinder call per four finite elements
+      self.checkfunction(intg,ref,inputs=inputs,digits=10,hessian=False,sens_der=False,evals=False)
+      self.check_serialize(intg,inputs=inputs)
+      intg(**inputs)
+      ref(**inputs)
+      self.assertEqual(4*intg.stats()["n_call_step"],ref.stats()["n_call_step"])
+
+    # Block triangular Jacobian, factorized block by block or as a whole
+    for linear_solver in ["btf","qr"]:
+      intg = integrator("intg","collocation",dae,0,tout,{"number_of_finite_elements":16,
+        "elements_per_step":4,"collocation_scheme":"legendre",
+        "rootfinder_options":{"linear_solver":linear_solver}})
+      self.checkarray(intg(**inputs)["xf"],ref(**inputs)["xf"],digits=5)
+
+    with self.assertInException("must be a multiple of elements_per_step"):
+      integrator("intg","collocation",dae,0,tout,{"number_of_finite_elements":18,"elements_per_step":4})
+
+  def test_parareal(self):
+    dae = self.forced_vdp()
+    x, p = dae["x"], dae["p"]
+    tout = [0.5*k for k in range(1,13)]
+    inputs = {"x0":DM([0.5,-0.3]),"p":0.8,"u":DM.rand(1,12)}
+    ref = integrator("ref","rk",dae,0,tout,{"number_of_finite_elements":240})
+    intg = integrator("intg","parareal",dae,0,tout,{"fine_options":{"number_of_finite_elements":20},"tol":1e-12})
+    self.checkfunction(intg,ref,inputs=inputs,digits=9,hessian=False,sens_der=False,evals=False)
+    self.check_serialize(intg,inputs=inputs)
+
+    # Converges in fewer iterations than slices
+    intg(**inputs)
+    self.assertTrue(intg.stats()["iter"]<6)
+
+    # Without tolerance, equal to the sequential fine integration
+    intg = integrator("intg","parareal",dae,0,tout,{"fine_options":{"number_of_finite_elements":20},"tol":0})
+    self.checkarray(intg(**inputs)["xf"],ref(**inputs)["xf"],digits=13)
+    self.assertEqual(intg.stats()["iter"],12)
+    self.assertTrue(intg.stats()["success"])
+
+    # Too few iterations to converge
+    intg = integrator("intg","parareal",dae,0,tout,{"fine_options":{"number_of_finite_elements":20},"tol":0,"max_iter":2})
+    intg(**inputs)
+    self.assertEqual(intg.stats()["iter"],2)
+    self.assertFalse(intg.stats()["success"])
+
+    # Time slices independent of the output grid
+    ref = integrator("ref","rk",dae,0,3.0,{"number_of_finite_elements":240})
+    intg = integrator("intg","parareal",dae,0,3.0,{"number_of_slices":6,"fine_options":{"number_of_finite_elements":40},"tol":1e-12})
+    inputs = {"x0":DM([0.5,-0.3]),"p":0.8,"u":0.1}
+    self.checkfunction(intg,ref,inputs=inputs,digits=9,hessian=False,sens_der=False,evals=False)
+    self.check_serialize(intg,inputs=inputs)
+    intg(**inputs)
+    self.assertTrue(1<intg.stats()["iter"]<6)
+
+    # Algebraic variables
+    z = SX.sym("z")
+    dae = {"x":x,"z":z,"p":p,"ode":vertcat(x[1],z),"alg":z+x[0]-p*x[1],"quad":z**2}
+    ref = integrator("ref","collocation",dae,0,tout,{"number_of_finite_elements":120})
+    intg = integrator("intg","parareal",dae,0,tout,{"fine":"collocation","coarse":"collocation",
+      "fine_options":{"number_of_finite_elements":10},"tol":1e-12})
+    self.checkfunction(intg,ref,inputs={"x0":DM([0.5,-0.3]),"p":0.3},digits=7,hessian=False,sens_der=False,evals=False)
+
+  def test_rosenbrock(self):
+    dae = self.forced_vdp()
+    x = dae["x"]
+    tout = [0.5*k for k in range(1,5)]
+    inputs = {"x0":DM([0.5,-0.3]),"p":0.8,"u":DM([[0.1,-0.2,-0.2,0.3]])}
+    ref = integrator("ref","rk",dae,0,tout,{"number_of_finite_elements":100})
+
+    # Second order convergence, also when reusing the Jacobian
+    for jacobian_update in [1, 4]:
+      err = []
+      for N in [40, 80]:
+        intg = integrator("intg","rosenbrock",dae,0,tout,{"number_of_finite_elements":N,"jacobian_update":jacobian_update})
+        err.append(float(norm_inf(intg(**inputs)["xf"]-ref(**inputs)["xf"])))
+      self.assertTrue(3.5<err[0]/err[1]<4.5)
+      self.checkfunction(intg,ref,inputs=inputs,digits=2,hessian=False,sens_der=False,evals=False)
+
+    intg = integrator("intg","rosenbrock",dae,0,tout,{"number_of_finite_elements":20})
+    self.check_serialize(intg,inputs=inputs)
+
+    # Stiff problem (Robertson) on a geometric grid
+    y = SX.sym("y",3)
+    ode = vertcat(-0.04*y[0]+1e4*y[1]*y[2],0.04*y[0]-1e4*y[1]*y[2]-3e7*y[1]**2,3e7*y[1]**2)
+    tg = [1e-6*(4e7)**(k/1000.) for k in range(1,1001)]
+    intg = integrator("intg","rosenbrock",{"x":y,"ode":ode},0,tg,{"number_of_finite_elements":1})
+    self.checkarray(intg(x0=DM([1,0,0]))["xf"][:,-1],DM([0.715827,9.18553e-06,0.284164]),digits=4)
+
+    # Code generation via the simplified expression graph
+    intg = integrator("intg","rosenbrock",dae,0,2.0,{"number_of_finite_elements":10,"simplify":True})
+    self.check_codegen(intg,inputs={"x0":DM([0.5,-0.3]),"p":0.8,"u":0.1},std="c99")
+
+    with self.assertInException("does not support algebraic variables"):
+      integrator("intg","rosenbrock",{"x":x[0],"z":x[1],"ode":x[1],"alg":x[1]-x[0]},0,1.0)
+
+  def test_dopri(self):
+    dae = self.forced_vdp()
+    tout = [0.3,1.0,1.7,2.5,4.0]
+    ref = integrator("ref","rk",dae,0,tout,{"number_of_finite_elements":400})
+    intg = integrator("intg","dopri",dae,0,tout,{"abstol":1e-10,"reltol":1e-10})
+    inputs = {"x0":DM([0.5,-0.3]),"p":0.8,"u":DM([[0.1,0.1,-0.2,-0.2,0.3]])}
+
+    # Dense output and step changes in the controls
+    self.checkfunction(intg,ref,inputs=inputs,digits=7,sens_der=False,evals=False)
+    self.assertTrue(intg.stats()["nsteps"]<200)
+
+    self.check_serialize(intg,inputs=inputs)
+    self.check_codegen(intg,inputs=inputs,with_forward=True)
+
+    for k in ["abstol","reltol"]:
+      with self.assertInException("Tolerances must be positive"):
+        integrator("intg","dopri",dae,0,tout,{k:-1})
+
   @requires_integrator('cvodes')
   def test_step_options_cvodes(self):
     x = SX.sym("x")
@@ -1025,6 +1257,33 @@ class Integrationtests(casadiTestCase):
     print(stats["nsteps"])
     self.assertTrue(stats["nsteps"]>=int(0.5/1.1e-4))
 
+  def test_nvector(self):
+    x = SX.sym("x",2)
+    p = SX.sym("p")
+    dae = {"x":x,"p":p,"ode":vertcat(x[1],p*(1-x[0]**2)*x[1]-x[0]),"quad":x[0]**2}
+    inputs = {"x0":DM([2,0]),"p":1}
+    for plugin in ["cvodes","idas"]:
+      if not has_integrator(plugin): continue
+      ref = integrator("ref",plugin,dae,0,[0.5,1.0])
+      intg = integrator("intg",plugin,dae,0,[0.5,1.0],{"nvector":"openmp"})
+      self.checkfunction(intg,ref,inputs=inputs,digits=10,hessian=False,evals=False)
+      self.check_serialize(intg,inputs=inputs)
+
+  def test_max_jacobian_age(self):
+    x = SX.sym("x",2)
+    p = SX.sym("p")
+    dae = {"x":x,"p":p,"ode":vertcat(x[1],p*(1-x[0]**2)*x[1]-x[0]),"quad":x[0]**2}
+    inputs = {"x0":DM([2,0]),"p":5}
+    for plugin in ["cvodes","idas"]:
+      if not has_integrator(plugin): continue
+      ref = integrator("ref",plugin,dae,0,[0.5,1.0])
+      intg = integrator("intg",plugin,dae,0,[0.5,1.0],{"max_jacobian_age":100})
+      self.checkfunction(intg,ref,inputs=inputs,digits=5,hessian=False,evals=False)
+      self.check_serialize(intg,inputs=inputs)
+      ref(**inputs)
+      intg(**inputs)
+      self.assertTrue(intg.stats()["njevals"]<ref.stats()["njevals"])
+
   @requires_integrator('idas')
   def test_constraints_idas(self):
     x = SX.sym("x")
@@ -545,6 +545,179 @@ class LinearSolverTests(casadiTestCase):
         B = f(diagcat(1,2,3),bn)
         self.checkarray(A,B)
 
+  def test_ldl_update(self):
+    numpy.random.seed(1)
+    n = 6
+    A = DM(numpy.random.rand(n,n))
+    A_dense = mtimes(A,A.T)+n*DM.eye(n)
+    V_dense = DM(numpy.random.rand(n,2))
+    # Sparse arrow matrix, fill-in without preordering
+    n = 8
+    A = 4*numpy.eye(n)-numpy.eye(n,k=1)-numpy.eye(n,k=-1)
+    A[0,:] = A[:,0] = 0.5
+    A[0,0] = n
+    A_sparse = sparsify(DM(A))
+    # Modifications within the sparsity pattern of A
+    V_sparse = DM.zeros(n,2)
+    V_sparse[2,0] = 0.3
+    V_sparse[3,0] = -0.4
+    V_sparse[0,1] = 0.2
+    V_sparse[5,1] = 0.6
+    for A, V in [(A_dense, V_dense), (A_sparse, V_sparse)]:
+      b = DM(numpy.random.rand(A.size1()))
+      for alpha in [[0.7, -0.3], [1, -100], [-100, -100]]:
+        A_mod = A + mtimes([V, diag(DM(alpha)), V.T])
+        ref = Linsol("ref", "ldl", A.sparsity())
+        ref.nfact(A_mod)
+        for opts in [{},{"preordering":False}]:
+          s = Linsol("s", "ldl", A.sparsity(), opts)
+          s.nfact(A)
+          self.assertEqual(s.neig(A), 0)
+          # Without preordering, the factors are not permuted
+          perm = list(s.stats(0)["permutation"])
+          if opts:
+            self.assertEqual(perm, list(range(A.size1())))
+          elif A is A_sparse:
+            self.assertNotEqual(perm, list(range(A.size1())))
+          # Modified factorization, compared with a fresh one
+          s.update(V, alpha)
+          self.assertEqual(s.neig(A_mod), ref.neig(A_mod))
+          self.checkarray(s.solve_factorized(A_mod, b), ref.solve(A_mod, b), digits=10)
+          # Undo the modification
+          s.update(V, [-a for a in alpha])
+          self.assertEqual(s.neig(A), 0)
+          self.checkarray(s.solve_factorized(A, b), solve(A, b), digits=10)
+    # Not available for incomplete factorizations
+    s = Linsol("s", "ldl", A_sparse.sparsity(), {"incomplete":True})
+    s.nfact(A_sparse)
+    with self.assertRaises(Exception):
+      s.update(V_sparse, [1, 1])
+
+  def test_krylov(self):
+    numpy.random.seed(1)
+    n = 8
+    M = DM(numpy.random.rand(n,n))
+    A_spd = mtimes(M,M.T)+n*DM.eye(n)
+    H = A_spd[:5,:5]
+    J = DM(numpy.random.rand(3,5))
+    A_kkt = blockcat([[H,J.T],[J,DM.zeros(3,3)]])
+    A_gen = M+n*DM.eye(n)
+    b = DM(numpy.random.rand(n))
+    for A, methods in [(A_spd, ["cg","minres","gmres"]),
+                       (A_kkt, ["minres","gmres"]),
+                       (A_gen, ["gmres"])]:
+      for method in methods:
+        for precon, popts in [("none",{}),("jacobi",{}),("ldl",{"incomplete":True}),("qr",{})]:
+          # Incomplete LDL breaks down on the zero block of the KKT matrix
+          if precon=="ldl" and A is A_kkt: continue
+          # An exact, indefinite, preconditioner is only tested once
+          if precon=="qr" and (A is A_kkt or method!="gmres"): continue
+          # Short restarts may stagnate for indefinite matrices
+          for restart in ([30, 3] if method=="gmres" and A is not A_kkt else [30]):
+            opts = {"method":method,"preconditioner":precon,
+                    "preconditioner_options":popts,"restart":restart,"tol":1e-12}
+            solver = Linsol("solver", "krylov", A.sparsity(), opts)
+            x = solver.solve(A, b)
+            self.checkarray(x, np.linalg.solve(A, b), digits=8)
+            self.assertTrue(solver.stats()["success"])
+
+            As = MX.sym("A",A.sparsity())
+            bs = MX.sym("b",n)
+            if method=="gmres":
+              f = Function("f",[As,bs],[solver.solve(As,bs,True)])
+              self.checkarray(f(A,b), np.linalg.solve(A.T, b), digits=8)
+              if restart==30: continue
+            f = Function("f",[As,bs],[solver.solve(As,bs)])
+            self.check_serialize(f,inputs=[A,b])
+            self.check_codegen(f,inputs=[A,b],std="c99")
+
+  def test_mixed_precision(self):
+    numpy.random.seed(1)
+    n = 20
+    M = DM(numpy.random.rand(n,n))
+    A_spd = mtimes(M,M.T)+n*DM.eye(n)
+    V = M[:,:n-1]
+    b = DM(numpy.random.rand(n))
+    for Solver, options, req in lsolvers:
+      if Solver not in ["ldl","qr","lapacklu"]: continue
+      print(Solver)
+      # Well-conditioned, overflow in single precision, refinement stalls
+      for A, digits in [(A_spd, 12), (1e60*A_spd, 12), (mtimes(V,V.T)+1e-7*DM.eye(n), 7)]:
+        ref = Linsol("ref", Solver, A.sparsity()).solve(A, b)
+        solver = Linsol("solver", Solver, A.sparsity(), {"mixed_precision":True})
+        x = solver.solve(A, b)
+        self.checkarray(x/norm_inf(ref), ref/norm_inf(ref), digits=digits)
+
+        As = MX.sym("A",A.sparsity())
+        bs = MX.sym("b",n)
+        f = Function("f",[As,bs],[solver.solve(As,bs)])
+        self.check_serialize(f,inputs=[A,b])
+
+  def test_schur(self):
+    numpy.random.seed(1)
+    # Block-angular system: 6 blocks coupled through a border of 2, shuffled
+    nblocks = 6
+    m = 5
+    nb = 2
+    blocks = [DM(numpy.random.rand(m,m))+m*DM.eye(m) for i in range(nblocks)]
+    Kib = [sparsify(DM(numpy.random.rand(m,nb))*(numpy.random.rand(m,nb)>0.5)) for i in range(nblocks)]
+    Kbi = [sparsify(DM(numpy.random.rand(nb,m))*(numpy.random.rand(nb,m)>0.5)) for i in range(nblocks)]
+    Kbb = DM(numpy.random.rand(nb,nb))+nb*DM.eye(nb)
+    A = blockcat([[diagcat(*blocks), vertcat(*Kib)],[horzcat(*Kbi), Kbb]])
+    p = list(numpy.random.permutation(A.size1()))
+    A = A[p,p]
+    n = A.size1()
+    b = DM(numpy.random.rand(n,3))
+    for opts in [{}, {"max_num_threads":2}, {"max_num_threads":2, "min_thread_nnz":0},
+                 {"max_border":1}]:
+      solver = Linsol("solver", "schur", A.sparsity(), opts)
+      self.checkarray(solver.solve(A, b), np.linalg.solve(A, b), digits=10)
+      self.checkarray(solver.solve(A, b, True), np.linalg.solve(A.T, b), digits=10)
+
+    # Symmetric indefinite, inertia from the blocks and the Schur complement
+    H = A+A.T-4*DM.eye(n)
+    ref = Linsol("ref", "ldl", H.sparsity())
+    solver = Linsol("solver", "schur", H.sparsity(), {"linear_solver":"ldl"})
+    self.checkarray(solver.solve(H, b), np.linalg.solve(H, b), digits=10)
+    ref.nfact(H)
+    solver.nfact(H)
+    self.assertEqual(solver.neig(H), ref.neig(H))
+    self.assertEqual(solver.rank(H), n)
+
+    As = MX.sym("A",A.sparsity())
+    bs = MX.sym("b",n,3)
+    f = Function("f",[As,bs],[solve(As,bs,"schur")])
+    self.check_serialize(f,inputs=[A,b])
+
+  def test_btf(self):
+    numpy.random.seed(1)
+    # Block lower bidiagonal system: 6 blocks coupled to their predecessor, shuffled
+    nblocks = 6
+    m = 4
+    A = DM(nblocks*m,nblocks*m)
+    for i in range(nblocks):
+      A[i*m:(i+1)*m,i*m:(i+1)*m] = DM(numpy.random.rand(m,m))+m*DM.eye(m)
+      if i>0:
+        A[i*m:(i+1)*m,(i-1)*m:i*m] = sparsify(DM(numpy.random.rand(m,m))*(numpy.random.rand(m,m)>0.5))
+    p = list(numpy.random.permutation(A.size1()))
+    q = list(numpy.random.permutation(A.size1()))
+    A = A[p,q]
+    n = A.size1()
+    b = DM(numpy.random.rand(n,3))
+    As = MX.sym("A",A.sparsity())
+    bs = MX.sym("b",n,3)
+    for opts in [{}, {"max_num_threads":2}]:
+      solver = Linsol("solver", "btf", A.sparsity(), opts)
+      self.checkarray(solver.solve(A, b), np.linalg.solve(A, b), digits=10)
+      f = Function("f",[As,bs],[solver.solve(As,bs,True)])
+      self.checkarray(f(A, b), np.linalg.solve(A.T, b), digits=10)
+
+    with self.assertInException("structurally singular"):
+      Linsol("solver", "btf", sparsify(DM([[1,1,0],[1,1,0],[0,1,0]])).sparsity())
+
+    f = Function("f",[As,bs],[solve(As,bs,"btf")])
+    self.check_serialize(f,inputs=[A,b])
+
   @memory_heavy()
   def test_issue3489(self):
 
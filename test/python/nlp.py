@@ -86,6 +86,27 @@ if "SKIP_SNOPT_TESTS" not in os.environ and has_nlpsol("snopt"):
 
 print(solvers)
 
+def sqpmethod_options(**kwargs):
+  """Silent sqpmethod options with qrqp as QP solver"""
+  opts = {"qpsol":"qrqp","qpsol_options":{"print_iter":False,"print_header":False},
+          "print_header":False,"print_iteration":False,"print_time":False}
+  opts.update(kwargs)
+  return opts
+
+def chain_nlp(sym=SX, n=20):
+  """Parametric chain of n variables, with a sum and a bilinear constraint"""
+  x = sym.sym("x",n)
+  p = sym.sym("p")
+  f = sum1((x[:-1]-p)**2 + (x[1:]-x[:-1])**4 + 0.1*exp(x[:-1]/5))
+  return {"x":x,"p":p,"f":f,"g":vertcat(sum1(x),x[0]*x[1])}
+
+def small_parametric_nlp():
+  """Three variables and two parameters, for warm started sequences of solves"""
+  x = MX.sym("x",3)
+  p = MX.sym("p",2)
+  return {"x":x,"p":p,"f":sumsqr(x-vertcat(p,p[0]*p[1]))+x[0]*x[1]*x[2],
+          "g":vertcat(x[0]**2+x[1]-p[1],x[2]+x[0])}
+
 class NLPtests(casadiTestCase):
 
   @requires_nlpsol("alpaqa")
@@ -1652,6 +1673,185 @@ class NLPtests(casadiTestCase):
     self.assertTrue(stats_reg["iter_count"]==1)
     self.assertTrue("H:\n[[1, 0], \n [0, 2]]" in result[0])
 
+  @requires_conic("qrqp")
+  def test_lbfgs_sqpmethod(self):
+    nlp = chain_nlp()
+    solver_in = dict(x0=0,p=1.2,lbg=vertcat(10,-inf),ubg=vertcat(10,0.1),lbx=-0.5,ubx=2)
+    opts = sqpmethod_options()
+    ref = nlpsol("ref","sqpmethod",nlp,opts)(**solver_in)
+    for memory in [1,4,30]:
+      opts_lbfgs = dict(opts)
+      opts_lbfgs["hessian_approximation"] = "lbfgs"
+      opts_lbfgs["lbfgs_memory"] = memory
+      solver = nlpsol("solver","sqpmethod",nlp,opts_lbfgs)
+      res = solver(**solver_in)
+      self.assertTrue(solver.stats()["success"])
+      self.checkarray(res["x"],ref["x"],digits=5)
+      self.checkarray(res["lam_g"],ref["lam_g"],digits=5)
+    self.check_serialize(solver,solver_in)
+    self.check_codegen(solver,solver_in,std="c99")
+
+  @requires_conic("qrqp")
+  def test_max_num_threads(self):
+    x = SX.sym("x",10)
+    f = sum1(100*(x[1:]-x[:-1]**2)**2 + (1-x[:-1])**2)
+    g = 3*x[1:-1]**3+2*x[2:]-5+sin(x[1:-1]-x[2:])*sin(x[1:-1]+x[2:])+4*x[1:-1]-x[:-2]*exp(x[:-2]-x[1:-1])-3
+    nlp = {"x":x,"f":f,"g":g}
+    solver_in = dict(x0=0,lbg=0,ubg=0)
+    opts = sqpmethod_options()
+    ref = nlpsol("ref","sqpmethod",nlp,opts)(**solver_in)
+    for split in [[],["nlp_jac_fg","nlp_hess_l"]]:
+      opts_thread = dict(opts)
+      opts_thread["max_num_threads"] = 3
+      opts_thread["split_functions"] = split
+      solver = nlpsol("solver","sqpmethod",nlp,opts_thread)
+      res = solver(**solver_in)
+      self.assertTrue(solver.stats()["success"])
+      self.checkarray(res["x"],ref["x"],digits=10)
+      self.checkarray(res["lam_g"],ref["lam_g"],digits=10)
+    self.check_serialize(solver,solver_in)
+
+  @requires_conic("qrqp")
+  def test_tangential_predictor(self):
+    nlp = small_parametric_nlp()
+    opts = sqpmethod_options(tol_pr=1e-12,tol_du=1e-12)
+    ref = nlpsol("ref","sqpmethod",nlp,opts)
+    opts["tangential_predictor"] = True
+    solver = nlpsol("solver","sqpmethod",nlp,opts)
+    for k in range(4):
+      solver_in = dict(p=[1+1e-3*k,2-1e-3*k],lbx=[-inf,-inf,1.2+1e-3*k],lbg=[0,-inf],ubg=[0,0.5])
+      res = solver(**solver_in)
+      res_ref = ref(**solver_in)
+      self.assertTrue(solver.stats()["success"])
+      if k>0: self.assertTrue(solver.stats()["iter_count"]<=1)
+      for f in ["x","lam_x","lam_g"]:
+        self.checkarray(res[f],res_ref[f],digits=8)
+    self.check_serialize(solver,solver_in)
+
+  @requires_conic("qrqp")
+  def test_sqpmethod_rti(self):
+    nlp = small_parametric_nlp()
+    opts = sqpmethod_options(print_status=False)
+    ref = nlpsol("ref","sqpmethod",nlp,opts)
+    opts["rti"] = True
+    solver_in = dict(p=[1,2],x0=[0.1,0.2,0.3],lbx=[-inf,-inf,1.2],lbg=[0,-inf],ubg=[0,0.5])
+    # One full step SQP iteration per call, converges for a fixed parameter
+    solver = nlpsol("solver","sqpmethod",nlp,opts)
+    for k in range(6):
+      res = solver(**solver_in)
+      self.assertEqual(solver.stats()["iter_count"],1)
+    res_ref = ref(**solver_in)
+    for f in ["x","lam_x","lam_g"]:
+      self.checkarray(res[f],res_ref[f],digits=8)
+    # Separate feedback and preparation phases, as a full step for varying p
+    solver = nlpsol("solver","sqpmethod",nlp,opts)
+    split = nlpsol("split","sqpmethod",nlp,opts)
+    feedback = split.get_function("rti_feedback")
+    preparation = split.get_function("rti_preparation")
+    for k in range(4):
+      solver_in["p"] = [1+0.01*k,2-0.02*k]
+      res = solver(**solver_in)
+      res_split = feedback(**solver_in)
+      for f in ["x","lam_x","lam_g"]:
+        self.checkarray(res_split[f],res[f],digits=12)
+      preparation(**dict(solver_in,x0=res_split["x"],lam_x0=res_split["lam_x"],
+                         lam_g0=res_split["lam_g"]))
+      self.assertEqual(split.stats()["return_status"],"RTI_Prepared")
+    solver_in["p"] = [1,2]
+    # Cold start in generated code
+    solver = nlpsol("solver","sqpmethod",nlp,opts)
+    self.check_codegen(solver,solver_in,std="c99")
+    solver = nlpsol("solver","sqpmethod",nlp,opts)
+    self.check_serialize(solver,solver_in)
+
+  @requires_conic("qrqp")
+  def test_detect_map(self):
+    x = MX.sym("x",2)
+    u = MX.sym("u")
+    F = Function("F",[x,u],[vertcat(x[0]+0.1*x[1],x[1]+0.1*(u-sin(x[0]))),x[0]**2*u])
+    N = 6
+    X = MX.sym("X",2,N+1)
+    U = MX.sym("U",1,N)
+    [Xn,L] = F.map(N)(X[:,:-1],U)
+    nlp = {"x":vertcat(vec(X),vec(U)),"f":sumsqr(U)+sum2(L)+sumsqr(X),
+           "g":vertcat(vec(Xn-X[:,1:]),X[:,0]-DM([1,0]))}
+    solver_in = dict(x0=0.3,lbg=0,ubg=0)
+    opts = sqpmethod_options()
+    ref = nlpsol("ref","sqpmethod",nlp,opts)
+    opts["detect_map"] = True
+    solver = nlpsol("solver","sqpmethod",nlp,opts)
+    for fname in ["nlp_jac_fg","nlp_hess_l"]:
+      f_ref = ref.get_function(fname)
+      args = [DM.rand(f_ref.sparsity_in(i)) for i in range(f_ref.n_in())]
+      self.checkfunction_light(solver.get_function(fname),f_ref,inputs=args)
+    res = solver(**solver_in)
+    self.checkarray(res["x"],ref(**solver_in)["x"],digits=10)
+    self.check_serialize(solver,solver_in)
+
+  @requires_conic("qrqp")
+  def test_tnewton(self):
+    nlp = chain_nlp(MX)
+    x, p, f, g = nlp["x"], nlp["p"], nlp["f"], nlp["g"]
+    solver_in = dict(x0=0,p=1.2,lbg=vertcat(10,-inf),ubg=vertcat(10,0.1),lbx=-0.5,ubx=2)
+    ref = nlpsol("ref","sqpmethod",nlp,sqpmethod_options())(**solver_in)
+    for expand in [False,True]:
+      solver = nlpsol("solver","tnewton",nlp,{"expand":expand,"tol_pr":1e-10,"tol_du":1e-10,
+        "print_header":False,"print_iteration":False,"print_time":False})
+      res = solver(**solver_in)
+      self.assertTrue(solver.stats()["success"])
+      self.assertTrue(solver.stats()["n_hess_vec"]>0)
+      for k in ["x","lam_x","lam_g"]:
+        self.checkarray(res[k],ref[k],digits=8)
+      # Hessian-vector product oracle
+      lam = MX.sym("lam",2)
+      v = MX.sym("v",20)
+      hv = Function("hv",[x,p,lam,v],[mtimes(hessian(f+dot(lam,g),x)[0],v),mtimes(jacobian(g,x),v)])
+      args = [DM.rand(20),1.2,DM.rand(2),DM.rand(20)]
+      out = solver.get_function("nlp_hess_vec")(args[0],args[1],1,args[2],args[3])
+      self.checkarray(out[0],hv(*args)[0],digits=12)
+      self.checkarray(out[1],hv(*args)[1],digits=12)
+    self.check_serialize(solver,solver_in)
+
+  @requires_conic("qrqp")
+  def test_ipmethod(self):
+    nlp = chain_nlp(MX,5)
+    nlp["g"] = vertcat(nlp["g"],nlp["x"][2]-nlp["x"][3])
+    # Equality, inequality and unbounded constraints, fixed variable
+    solver_in = dict(x0=0,p=1.2,lbg=vertcat(4,-inf,-inf),ubg=vertcat(4,0.1,inf),
+                     lbx=vertcat(-0.5,-0.5,-0.5,0.3,-0.5),ubx=vertcat(2,2,2,0.3,2))
+    ref = nlpsol("ref","sqpmethod",nlp,sqpmethod_options(tol_pr=1e-12,tol_du=1e-12))(**solver_in)
+    for expand in [False,True]:
+      solver = nlpsol("solver","ipmethod",nlp,{"expand":expand,"tol":1e-10,
+        "print_header":False,"print_iteration":False,"print_time":False})
+      res = solver(**solver_in)
+      self.assertTrue(solver.stats()["success"])
+      for k in ["x","f","g","lam_x","lam_g"]:
+        self.checkarray(res[k],ref[k],digits=7)
+    self.check_serialize(solver,solver_in)
+    self.check_codegen(solver,solver_in,std="c99")
+
+  @requires_conic("qrqp")
+  def test_cache_derived(self):
+    def build(c):
+      x = MX.sym("x",10)
+      p = MX.sym("p")
+      return {"x":x,"p":p,"f":sumsqr(x-p)+sum1(x[:-1]*x[1:]),"g":vertcat(sum1(x),c*x[0]*x[1])}
+    solver_in = dict(p=1.2,lbg=vertcat(10,-inf),ubg=vertcat(10,0.1))
+    opts = sqpmethod_options()
+    solver1 = nlpsol("solver","sqpmethod",build(1),opts)
+    res1 = solver1(**solver_in)
+    for cache in [True,False]:
+      for c in [1,2]:
+        opts_cache = dict(opts)
+        opts_cache["cache_derived"] = cache
+        opts_cache["max_iter"] = 30
+        solver2 = nlpsol("solver","sqpmethod",build(c),opts_cache)
+        # Identical oracle, rebuilt from scratch: derived functions are shared
+        for fname in ["nlp_jac_fg","nlp_hess_l"]:
+          same = solver1.get_function(fname).__hash__()==solver2.get_function(fname).__hash__()
+          self.assertEqual(same,cache and c==1)
+        if c==1: self.checkarray(solver2(**solver_in)["x"],res1["x"],digits=12)
+
   def test_infeasible(self):
     x = MX.sym("x")
 